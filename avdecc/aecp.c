@@ -27,6 +27,8 @@ static const u8 aecp_mvu_protocol_id[6] = MILAN_VENDOR_UNIQUE_PROTOCOL_ID;
 
 static int aecp_aem_send_command(struct aecp_ctx *aecp, struct avdecc_port *port, struct aecp_aem_pdu *pdu, struct net_tx_desc *desc, u8 *mac_dst, u16 len, struct ipc_tx *ipc, unsigned int ipc_dst);
 static int aecp_aem_send_response(struct aecp_ctx *aecp, struct avdecc_port *port, struct aecp_aem_pdu *pdu, struct net_tx_desc *desc, u64 controller_id, u16 sequence_id, u8 status, u8 unsolicited, u8 *mac_dst, u16 len);
+static void aecp_unsolicited_coalesce_timer_handler(void *data);
+static void aecp_unsolicited_pending_flush(struct aecp_ctx *aecp);
 
 #define IS_VALID_GET_COUNTERS_DESCRIPTOR_TYPE(desc_type) ((desc_type) == AEM_DESC_TYPE_ENTITY || \
 							 (desc_type) == AEM_DESC_TYPE_CLOCK_SOURCE || \
@@ -264,6 +266,30 @@ __init static void aecp_unsolicited_init(struct aecp_ctx *aecp)
 	os_log(LOG_INIT, "aecp(%p) %d unsolicited registration max\n", aecp, aecp->max_unsolicited_registrations);
 }
 
+__init static int aecp_unsolicited_pending_init(struct aecp_ctx *aecp)
+{
+	struct entity *entity = container_of(aecp, struct entity, aecp);
+	int i;
+
+	list_head_init(&aecp->free_pending_unsolicited);
+	list_head_init(&aecp->pending_unsolicited);
+
+	for (i = 0; i < aecp->max_unsolicited_pending; i++)
+		list_add(&aecp->free_pending_unsolicited, &aecp->pending_storage[i].list);
+
+	aecp->coalesce_timer.func = aecp_unsolicited_coalesce_timer_handler;
+	aecp->coalesce_timer.data = aecp;
+
+	if (timer_create(entity->avdecc->timer_ctx, &aecp->coalesce_timer, 0, CFG_AECP_UNSOLICITED_COALESCE_GRANULARITY_MS) < 0) {
+		os_log(LOG_ERR, "aecp(%p) cannot create unsolicited notifications coalescing timer\n", aecp);
+		return -1;
+	}
+
+	os_log(LOG_INIT, "aecp(%p) unsolicited notifications coalescing window %u ms, %u pending max\n", aecp, aecp->coalesce_ms, aecp->max_unsolicited_pending);
+
+	return 0;
+}
+
 /** Find an unsolicited entry based on the controller ID.
  * \param	aecp		AECP context to search into.
  * \param	controller_id	Pointer to the controller ID to match.
@@ -1579,6 +1605,8 @@ err_prepare_rsp:
  */
 static int aecp_aem_send_sync_unsolicited_notification_full(struct aecp_ctx *aecp, struct net_tx_desc *desc, struct aecp_aem_pdu *aecp_pdu, u64 controller_id, u16 len)
 {
+	aecp_unsolicited_pending_flush(aecp);
+
 	return aecp_aem_send_unsolicited_notification(aecp, desc, aecp_pdu, controller_id, len);
 }
 
@@ -1592,7 +1620,7 @@ static int aecp_aem_send_sync_unsolicited_notification_full(struct aecp_ctx *aec
  * \param descriptor_type, type of the aem_desc
  * \param descriptor_index, id of the aem_desc
  */
-int aecp_aem_send_async_unsolicited_notification(struct aecp_ctx *aecp, u16 notification_type, u16 descriptor_type, u16 descriptor_index)
+static int aecp_aem_send_async_unsolicited_notification_now(struct aecp_ctx *aecp, u16 notification_type, u16 descriptor_type, u16 descriptor_index)
 {
 	struct entity *entity = container_of(aecp, struct entity, aecp);
 	struct unsolicited_ctx *unsolicited_entry;
@@ -1703,6 +1731,200 @@ err_tx_alloc:
 	return -1;
 }
 
+/** Checks if a synchronous unsolicited notification can be merged with a later one for the same descriptor.
+ * Only commands whose response carries the complete new state of the descriptor are coalesced (a later response
+ * supersedes an earlier one). Commands with incremental effects (mappings, matrix, ...) are always sent immediately.
+ * \return	true if the notification can be coalesced, false otherwise.
+ * \param	cmd_type	AEM command type of the notification.
+ */
+static bool aecp_unsolicited_coalescable(u16 cmd_type)
+{
+	switch (cmd_type) {
+	case AECP_AEM_CMD_SET_STREAM_FORMAT:
+	case AECP_AEM_CMD_SET_STREAM_INFO:
+	case AECP_AEM_CMD_SET_SAMPLING_RATE:
+	case AECP_AEM_CMD_SET_CLOCK_SOURCE:
+	case AECP_AEM_CMD_SET_CONTROL:
+	case AECP_AEM_CMD_INCREMENT_CONTROL:
+	case AECP_AEM_CMD_DECREMENT_CONTROL:
+	case AECP_AEM_CMD_SET_SIGNAL_SELECTOR:
+	case AECP_AEM_CMD_SET_MIXER:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Sends up to max pending unsolicited notifications, oldest first, to the registered controllers.
+ * \return	none
+ * \param	aecp	AECP context
+ * \param	max	maximum number of pending notifications to send.
+ */
+static void aecp_unsolicited_pending_drain(struct aecp_ctx *aecp, unsigned int max)
+{
+	struct unsolicited_pending *pending;
+	unsigned int n = 0;
+
+	while (!list_empty(&aecp->pending_unsolicited) && (n < max)) {
+		pending = container_of(list_first(&aecp->pending_unsolicited), struct unsolicited_pending, list);
+
+		list_del(&pending->list);
+
+		if (pending->sync)
+			aecp_aem_send_sync_unsolicited_notification(aecp, (struct aecp_aem_pdu *)pending->buf, pending->excluded_controller_id, pending->len);
+		else
+			aecp_aem_send_async_unsolicited_notification_now(aecp, pending->notification_type, pending->descriptor_type, pending->descriptor_index);
+
+		list_add(&aecp->free_pending_unsolicited, &pending->list);
+
+		n++;
+	}
+
+	if (n)
+		os_log(LOG_DEBUG, "aecp(%p) drained %u pending unsolicited notification(s)\n", aecp, n);
+}
+
+/** Sends all pending unsolicited notifications.
+ * Used before sending a notification that bypasses the coalescing queue, to preserve the ordering seen by the controllers.
+ * \return	none
+ * \param	aecp	AECP context
+ */
+static void aecp_unsolicited_pending_flush(struct aecp_ctx *aecp)
+{
+	if (!aecp->coalesce_ms)
+		return;
+
+	aecp_unsolicited_pending_drain(aecp, aecp->max_unsolicited_pending);
+
+	if (timer_is_running(&aecp->coalesce_timer))
+		timer_stop(&aecp->coalesce_timer);
+}
+
+static void aecp_unsolicited_coalesce_timer_handler(void *data)
+{
+	struct aecp_ctx *aecp = (struct aecp_ctx *)data;
+
+	aecp_unsolicited_pending_drain(aecp, CFG_AECP_UNSOLICITED_COALESCE_BATCH);
+
+	/* Leftovers are sent in the next window, merging with any update received meanwhile */
+	if (!list_empty(&aecp->pending_unsolicited))
+		timer_start(&aecp->coalesce_timer, aecp->coalesce_ms);
+}
+
+/** Adds an unsolicited notification to the coalescing queue.
+ * If a notification is already pending for the same (notification_type, descriptor_type, descriptor_index), it is replaced
+ * and moved to the tail of the queue, so that the last notification sent for a descriptor always reflects its latest state.
+ * If the queue is full, all the pending notifications are sent, followed by this one.
+ * \return	0 on success, negative value otherwise.
+ * \param	aecp			AECP context
+ * \param	notification_type	AEM command type of the notification.
+ * \param	descriptor_type		type of the aem_desc
+ * \param	descriptor_index	id of the aem_desc
+ * \param	aecp_pdu		AECP AEM PDU of a synchronous notification (copied), NULL for an asynchronous notification.
+ * \param	excluded_controller_id	Controller entity ID which sent the command (synchronous notification only)
+ * \param	len			Length of the AECP AEM PDU (synchronous notification only).
+ */
+static int aecp_unsolicited_pending_add(struct aecp_ctx *aecp, u16 notification_type, u16 descriptor_type, u16 descriptor_index,
+					struct aecp_aem_pdu *aecp_pdu, u64 excluded_controller_id, u16 len)
+{
+	struct unsolicited_pending *pending = NULL;
+	struct list_head *list_entry;
+
+	for (list_entry = list_first(&aecp->pending_unsolicited); list_entry != &aecp->pending_unsolicited; list_entry = list_next(list_entry)) {
+		pending = container_of(list_entry, struct unsolicited_pending, list);
+
+		if ((pending->notification_type == notification_type) && (pending->descriptor_type == descriptor_type)
+		&& (pending->descriptor_index == descriptor_index)) {
+			list_del(&pending->list);
+			goto found;
+		}
+	}
+
+	if (list_empty(&aecp->free_pending_unsolicited)) {
+		aecp_unsolicited_pending_flush(aecp);
+
+		if (aecp_pdu)
+			return aecp_aem_send_sync_unsolicited_notification(aecp, aecp_pdu, excluded_controller_id, len);
+		else
+			return aecp_aem_send_async_unsolicited_notification_now(aecp, notification_type, descriptor_type, descriptor_index);
+	}
+
+	pending = container_of(list_first(&aecp->free_pending_unsolicited), struct unsolicited_pending, list);
+	list_del(&pending->list);
+
+	pending->notification_type = notification_type;
+	pending->descriptor_type = descriptor_type;
+	pending->descriptor_index = descriptor_index;
+
+found:
+	if (aecp_pdu) {
+		pending->sync = true;
+		pending->excluded_controller_id = excluded_controller_id;
+		pending->len = len;
+		os_memcpy(pending->buf, aecp_pdu, len);
+	} else {
+		pending->sync = false;
+		pending->excluded_controller_id = 0;
+		pending->len = 0;
+	}
+
+	list_add_tail(&aecp->pending_unsolicited, &pending->list);
+
+	if (!timer_is_running(&aecp->coalesce_timer))
+		timer_start(&aecp->coalesce_timer, aecp->coalesce_ms);
+
+	return 0;
+}
+
+/** Sends an AECP AEM asynchronous unsolicited notification on the network to the registered controllers.
+ * Notifies changes in the state/dynamic descriptors of the entity.
+ * If coalescing is enabled, the notification is queued and the AECP PDU is only built (from the current state of the
+ * descriptor) when the coalescing window expires, merging all the changes notified in between.
+ *
+ * \return int, 0 if successful -1 otherwise
+ * \param aecp, pointer to the aecp context
+ * \param notification_type, type of the notification (IEEE Std 1722.1-2013 7.5.2 for the list of available unsolicited notification types)
+ * \param descriptor_type, type of the aem_desc
+ * \param descriptor_index, id of the aem_desc
+ */
+int aecp_aem_send_async_unsolicited_notification(struct aecp_ctx *aecp, u16 notification_type, u16 descriptor_type, u16 descriptor_index)
+{
+	if (list_empty(&aecp->unsolicited))
+		return 0;
+
+	if (!aecp->coalesce_ms)
+		return aecp_aem_send_async_unsolicited_notification_now(aecp, notification_type, descriptor_type, descriptor_index);
+
+	return aecp_unsolicited_pending_add(aecp, notification_type, descriptor_type, descriptor_index, NULL, 0, 0);
+}
+
+/** Sends (or queues for coalescing) an AECP AEM synchronous unsolicited notification.
+ * Does not take ownership of the specified buffer pointing to the AECP PDU.
+ * \return 		0 on success or negative value otherwise.
+ * \param aecp		Pointer to the aecp context struct
+ * \param aecp_rsp	Pointer to the AECP AEM PDU containing the successful response.
+ * \param controller_id	Controller entity ID which sent the command (to be excluded from the notification if registered)
+ * \param len		Length of the AECP AEM PDU (after the AVTP header).
+ */
+static int aecp_aem_coalesce_sync_unsolicited_notification(struct aecp_ctx *aecp, struct aecp_aem_pdu *aecp_rsp, u64 controller_id, u16 len)
+{
+	u16 cmd_type = AECP_AEM_GET_CMD_TYPE(aecp_rsp);
+	struct aecp_aem_set_get_control_pdu *desc_hdr = (struct aecp_aem_set_get_control_pdu *)(aecp_rsp + 1);
+
+	if (list_empty(&aecp->unsolicited))
+		return 0;
+
+	/* All coalesced commands start with the descriptor type and index */
+	if (!aecp->coalesce_ms || !aecp_unsolicited_coalescable(cmd_type)
+	|| (len < sizeof(struct aecp_aem_pdu) + 2 * sizeof(u16)) || (len > AVDECC_AECP_MAX_SIZE)) {
+		aecp_unsolicited_pending_flush(aecp);
+
+		return aecp_aem_send_sync_unsolicited_notification(aecp, aecp_rsp, controller_id, len);
+	}
+
+	return aecp_unsolicited_pending_add(aecp, cmd_type, ntohs(desc_hdr->descriptor_type), ntohs(desc_hdr->descriptor_index), aecp_rsp, controller_id, len);
+}
+
 /** This function directly sends a GET_COUNTER async unsolicited notification, if no previous notification has been sent in the past timer period (i.e timer not running).
  * Otherwise, it just registers a new notification to be sent at timer expiration.
  * \return none
@@ -3308,7 +3530,7 @@ static int aecp_aem_received_entity_response(struct aecp_ctx *aecp, struct aecp_
 	int rc;
 
 	if (!AECP_AEM_GET_U(pdu)) {
-		entry = avdecc_inflight_find(&aecp->inflight_network, ntohs(pdu->sequence_id));
+		entry = avdecc_inflight_find(entity, &aecp->inflight_network, ntohs(pdu->sequence_id));
 		if (entry) {
 			ipc = (void *)entry->data.priv[0];
 			ipc_dst = (unsigned int)entry->data.priv[1];
@@ -3353,7 +3575,7 @@ static int aecp_aem_received_controller_response(struct aecp_ctx *aecp, struct a
 	int rc = 0;
 
 	if (!AECP_AEM_GET_U(pdu)) {
-		entry = avdecc_inflight_find(&aecp->inflight_network, ntohs(pdu->sequence_id));
+		entry = avdecc_inflight_find(entity, &aecp->inflight_network, ntohs(pdu->sequence_id));
 		if (entry) {
 			switch (AECP_AEM_GET_CMD_TYPE(pdu)) {
 			case AECP_AEM_CMD_CONTROLLER_AVAILABLE:
@@ -3397,7 +3619,14 @@ exit:
 
 __init unsigned int aecp_data_size(struct avdecc_entity_config *cfg)
 {
-	return cfg->max_unsolicited_registrations * sizeof(struct unsolicited_ctx);
+	unsigned int size;
+
+	size = cfg->max_unsolicited_registrations * sizeof(struct unsolicited_ctx);
+
+	if (cfg->unsolicited_coalesce_ms)
+		size += cfg->max_unsolicited_pending * sizeof(struct unsolicited_pending);
+
+	return size;
 }
 
 __init int aecp_init_timers(struct entity *entity)
@@ -3524,6 +3753,15 @@ __init int aecp_init(struct aecp_ctx *aecp, void *data, struct avdecc_entity_con
 
 	aecp_unsolicited_init(aecp);
 
+	aecp->coalesce_ms = cfg->unsolicited_coalesce_ms;
+	if (aecp->coalesce_ms) {
+		aecp->max_unsolicited_pending = cfg->max_unsolicited_pending;
+		aecp->pending_storage = (struct unsolicited_pending *)(aecp->unsolicited_storage + aecp->max_unsolicited_registrations);
+
+		if (aecp_unsolicited_pending_init(aecp) < 0)
+			goto err_pending_init;
+	}
+
 	if (aecp_init_timers(entity) < 0)
 		goto err_timer_init;
 
@@ -3532,6 +3770,10 @@ __init int aecp_init(struct aecp_ctx *aecp, void *data, struct avdecc_entity_con
 	return 0;
 
 err_timer_init:
+	if (aecp->coalesce_ms)
+		timer_destroy(&aecp->coalesce_timer);
+
+err_pending_init:
 	return -1;
 }
 
@@ -3580,6 +3822,9 @@ __exit int aecp_exit(struct aecp_ctx *aecp)
 {
 	aecp_exit_timers(aecp);
 
+	if (aecp->coalesce_ms)
+		timer_destroy(&aecp->coalesce_timer);
+
 	os_log(LOG_INIT, "done\n");
 
 	return 0;
@@ -3770,7 +4015,7 @@ void aecp_ipc_rx_controlled(struct entity *entity, struct ipc_aecp_msg *aecp_msg
 
 	/* Get the in-flight entry if regular AECP response (Not Unsolicited)*/
 	if (!AECP_AEM_GET_U(aecp_rx_rsp)) {
-		entry = aem_inflight_find_controller(&aecp->inflight_application, ntohs(aecp_rx_rsp->sequence_id), aecp_rx_rsp->controller_entity_id);
+		entry = aem_inflight_find_controller(entity, &aecp->inflight_application, ntohs(aecp_rx_rsp->sequence_id), aecp_rx_rsp->controller_entity_id);
 		if (!entry) {
 			os_log(LOG_ERR, "avdecc(%p) Received regular AECP response from application with sequence id %d,"
 					"but no command was received with that sequence id.\n", avdecc, ntohs(aecp_rx_rsp->sequence_id));
@@ -4004,7 +4249,7 @@ void aecp_ipc_rx_controlled(struct entity *entity, struct ipc_aecp_msg *aecp_msg
 		case AECP_AEM_CMD_REMOVE_SENSOR_MAPPINGS:
 		{
 			// TODO check for acquired, send to controller ( if != from previous)
-			aecp_aem_send_sync_unsolicited_notification(aecp, (struct aecp_aem_pdu *)aecp_msg->buf, inflight_controller_id, aecp_msg->len);
+			aecp_aem_coalesce_sync_unsolicited_notification(aecp, (struct aecp_aem_pdu *)aecp_msg->buf, inflight_controller_id, aecp_msg->len);
 
 			break;
 		}
@@ -45,6 +45,23 @@ struct unsolicited_ctx {
 	struct aecp_ctx *aecp; /**< Parent AECP context. */
 };
 
+/**
+ * Unsolicited notification waiting in the coalescing queue.
+ * Entries are keyed by (notification_type, descriptor_type, descriptor_index): a new notification matching a pending
+ * entry replaces it, so that controllers only receive the latest state of the descriptor once the window expires.
+ * The controller dimension is resolved when the entry is drained, from the list of registered controllers.
+ */
+struct unsolicited_pending {
+	struct list_head list;
+	u16 notification_type;		/**< AEM command type of the notification. */
+	u16 descriptor_type;
+	u16 descriptor_index;
+	bool sync;			/**< True if the notification PDU is stored in buf (synchronous notification), false if it's built when drained. */
+	u64 excluded_controller_id;	/**< Controller that generated the latest synchronous notification (not notified), 0 otherwise. */
+	u16 len;			/**< Length of the AECP AEM PDU stored in buf. */
+	u8 buf[AVDECC_AECP_MAX_SIZE];
+};
+
 /**
  * Context variables for the AECP protocol.
  */
@@ -56,6 +73,12 @@ struct aecp_ctx {
 	struct unsolicited_ctx *unsolicited_storage;
 	struct list_head free_unsolicited;
 	unsigned int max_unsolicited_registrations;
+	struct list_head pending_unsolicited;		/**< Coalescing queue of unsolicited notifications, oldest first. */
+	struct list_head free_pending_unsolicited;
+	struct unsolicited_pending *pending_storage;
+	unsigned int max_unsolicited_pending;
+	struct timer coalesce_timer;			/**< Coalescing window timer, drains the queue on expiration. */
+	unsigned int coalesce_ms;			/**< Coalescing window, 0 if disabled. */
 };
 
 struct avdecc_port;
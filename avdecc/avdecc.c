@@ -298,6 +298,7 @@ void avdecc_inflight_timeout(void *data)
 
 	if (rc == AVDECC_INFLIGHT_TIMER_STOP) {
 		list_del(&entry->list);
+		list_del(&entry->hash);
 		list_add(&entry->entity->free_inflight, &entry->list);
 		timer_stop(&entry->timeout);
 	}
@@ -336,9 +337,11 @@ struct inflight_ctx *avdecc_inflight_get(struct entity *entity)
  */
 int avdecc_inflight_start(struct list_head *inflight_head, struct inflight_ctx *entry, unsigned int timeout)
 {
+	struct entity *entity = entry->entity;
 
 	entry->list_head = inflight_head;
 	list_add(inflight_head, &entry->list);
+	list_add(&entity->inflight_hash[entry->data.sequence_id & entity->inflight_hash_mask], &entry->hash);
 	entry->timeout_ms = timeout;
 	timer_start(&entry->timeout, timeout);
 
@@ -361,17 +364,25 @@ void avdecc_inflight_abort(struct entity *entity, struct inflight_ctx *entry)
 
 
 
-struct inflight_ctx *avdecc_inflight_find(struct list_head *inflight_head, u16 sequence_id)
+/**
+ * Find an inflight entry matching the provided sequence ID.
+ * \return pointer to found inflight entry or NULL.
+ * \param entity	Entity context owning the inflight list.
+ * \param inflight_head	Inflight list to search.
+ * \param sequence_id	sequence ID to match.
+ */
+struct inflight_ctx *avdecc_inflight_find(struct entity *entity, struct list_head *inflight_head, u16 sequence_id)
 {
+	struct list_head *hash_head = &entity->inflight_hash[sequence_id & entity->inflight_hash_mask];
 	struct list_head *list_entry;
 	struct inflight_ctx *entry;
 
-	list_entry = list_first(inflight_head);
+	list_entry = list_first(hash_head);
 
-	while (list_entry != inflight_head) {
-		entry = container_of(list_entry, struct inflight_ctx, list);
+	while (list_entry != hash_head) {
+		entry = container_of(list_entry, struct inflight_ctx, hash);
 
-		if (sequence_id == entry->data.sequence_id)
+		if ((sequence_id == entry->data.sequence_id) && (entry->list_head == inflight_head))
 			return entry;
 
 		list_entry = list_next(list_entry);
@@ -423,21 +434,24 @@ bool avdecc_entity_is_acquired(struct entity *entity, u64 controller_id)
 /**
  * Find an inflight entry matching the provided sequence ID and controller entity ID.
  * \return pointer to found inflight entry or NULL.
+ * \param entity	Entity context owning the inflight list.
  * \param inflight_head	Inflight list to search.
  * \param sequence_id	sequence ID to match.
  * \param controller_id	controller entity ID to match.
  */
-struct inflight_ctx *aem_inflight_find_controller(struct list_head *inflight_head, u16 sequence_id, u64 controller_id)
+struct inflight_ctx *aem_inflight_find_controller(struct entity *entity, struct list_head *inflight_head, u16 sequence_id, u64 controller_id)
 {
+	struct list_head *hash_head = &entity->inflight_hash[sequence_id & entity->inflight_hash_mask];
 	struct list_head *list_entry;
 	struct inflight_ctx *entry;
 
-	list_entry = list_first(inflight_head);
+	list_entry = list_first(hash_head);
 
-	while (list_entry != inflight_head) {
-		entry = container_of(list_entry, struct inflight_ctx, list);
+	while (list_entry != hash_head) {
+		entry = container_of(list_entry, struct inflight_ctx, hash);
 
-		if ((sequence_id == entry->data.sequence_id) && (controller_id == entry->data.pdu.aem.controller_entity_id))
+		if ((sequence_id == entry->data.sequence_id) && (entry->list_head == inflight_head)
+		&& (controller_id == entry->data.pdu.aem.controller_entity_id))
 			return entry;
 
 		list_entry = list_next(list_entry);
@@ -452,6 +466,7 @@ void avdecc_inflight_remove(struct entity *entity, struct inflight_ctx *entry)
 	if (entry) {
 		timer_stop(&entry->timeout);
 		list_del(&entry->list);
+		list_del(&entry->hash);
 		list_add(&entity->free_inflight, &entry->list);
 		os_log(LOG_DEBUG, "Removed inflight (%p)\n", entry);
 	}
@@ -472,7 +487,7 @@ int avdecc_inflight_cancel(struct entity *entity, struct list_head *inflight_hea
 {
 	struct inflight_ctx *entry;
 
-	entry = avdecc_inflight_find(inflight_head, sequence_id);
+	entry = avdecc_inflight_find(entity, inflight_head, sequence_id);
 	if (entry) {
 		if (orig_seq_id)
 			*orig_seq_id = entry->data.orig_seq_id;
@@ -490,18 +505,36 @@ int avdecc_inflight_cancel(struct entity *entity, struct list_head *inflight_hea
 	return -1;
 }
 
+/* Smallest power of 2 number of hash buckets, so that each bucket holds about one inflight entry */
+__init static unsigned int avdecc_inflight_hash_size(struct avdecc_entity_config *cfg)
+{
+	unsigned int size = 1;
+
+	while ((size < cfg->max_inflights) && (size < AVDECC_INFLIGHT_HASH_MAX))
+		size <<= 1;
+
+	return size;
+}
+
 __init static unsigned int avdecc_inflight_data_size(struct avdecc_entity_config *cfg)
 {
-	return cfg->max_inflights * sizeof(struct inflight_ctx);
+	return cfg->max_inflights * sizeof(struct inflight_ctx) + avdecc_inflight_hash_size(cfg) * sizeof(struct list_head);
 }
 
 __init static int avdecc_inflight_init(struct entity *entity, void *data, struct avdecc_entity_config *cfg)
 {
+	unsigned int hash_size = avdecc_inflight_hash_size(cfg);
 	int i;
 
 	entity->inflight_storage = (struct inflight_ctx *)data;
 	entity->max_inflights = cfg->max_inflights;
 
+	entity->inflight_hash = (struct list_head *)(entity->inflight_storage + entity->max_inflights);
+	entity->inflight_hash_mask = hash_size - 1;
+
+	for (i = 0; i < hash_size; i++)
+		list_head_init(&entity->inflight_hash[i]);
+
 	list_head_init(&entity->free_inflight);
 
 	for (i = 0; i < entity->max_inflights; i++) {
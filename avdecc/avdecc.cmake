@@ -20,3 +20,9 @@ if(CONFIG_AVDECC)
   genavb_link_libraries(TARGET ${avb} LIB avdecc)
 
 endif()
+
+if(BUILD_TESTS)
+
+  include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+
+endif()
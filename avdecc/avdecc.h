@@ -32,6 +32,8 @@
 #define AVDECC_INFLIGHT_TIMER_RESTART	0
 #define AVDECC_INFLIGHT_TIMER_STOP	1
 
+#define AVDECC_INFLIGHT_HASH_MAX	256 /* Inflight hash buckets, indexed on the low bits of the sequence ID */
+
 /* The Presentation time offset can be changed to any value in the range between 0x0 and 0x7FFFFFFF ns
  * as per MILAN Specification v1.2 5.3.7.6
  */
@@ -64,6 +66,7 @@ struct inflight_ctx {
 	struct inflight_data data;
 	int(*cb)(struct inflight_ctx *);
 	struct list_head list;
+	struct list_head hash;			/**< Entry in the entity inflight hash, keyed on the sequence ID */
 	struct list_head *list_head;
 	struct entity *entity;
 };
@@ -80,6 +83,8 @@ struct entity {
 	struct avdecc_ctx *avdecc;
 	struct inflight_ctx *inflight_storage;
 	struct list_head free_inflight;
+	struct list_head *inflight_hash;	/**< Inflight entries of all lists, indexed on sequence ID */
+	unsigned int inflight_hash_mask;
 	unsigned int channel_openmask;
 	unsigned int channel_waitmask;
 	unsigned int valid_time;			/**< Valid time is in units of seconds. */
@@ -175,8 +180,8 @@ bool avdecc_entity_port_valid(struct entity *entity, unsigned int port_id);
 struct inflight_ctx *avdecc_inflight_get(struct entity *entity);
 int avdecc_inflight_start(struct list_head *inflight, struct inflight_ctx *entry, unsigned int timeout);
 void avdecc_inflight_restart(struct inflight_ctx *entry);
-struct inflight_ctx *avdecc_inflight_find(struct list_head *inflight_head, u16 sequence_id);
-struct inflight_ctx *aem_inflight_find_controller(struct list_head *inflight_head, u16 sequence_id, u64 controller_id);
+struct inflight_ctx *avdecc_inflight_find(struct entity *entity, struct list_head *inflight_head, u16 sequence_id);
+struct inflight_ctx *aem_inflight_find_controller(struct entity *entity, struct list_head *inflight_head, u16 sequence_id, u64 controller_id);
 void avdecc_inflight_remove(struct entity *entity, struct inflight_ctx *entry);
 int avdecc_inflight_cancel(struct entity *entity, struct list_head *inflight_head, u16 sequence_id, u16 *orig_seq_id, void **priv0, void **priv1);
 struct entity *avdecc_get_local_controller_any(struct avdecc_ctx *avdecc);
@@ -19,7 +19,7 @@
 
 #define avdecc_CFG_LOG	CFG_LOG
 
-#define CFG_AVDECC_MAX_TIMERS_PER_ENTITY	6
+#define CFG_AVDECC_MAX_TIMERS_PER_ENTITY	7
 
 #define AVDECC_CFG_INFLIGHT_TIMER_RESOLUTION	10
 
@@ -32,6 +32,17 @@
 #define CFG_AECP_MAX_NUM_UNSOLICITED			64
 #define CFG_AECP_MIN_NUM_UNSOLICITED			1
 
+#define CFG_AECP_DEFAULT_UNSOLICITED_COALESCE_MS	10
+#define CFG_AECP_MAX_UNSOLICITED_COALESCE_MS		1000
+#define CFG_AECP_MIN_UNSOLICITED_COALESCE_MS		0 /* 0 disables coalescing, notifications are sent immediately */
+
+/* Number of distinct (notification, descriptor) pending in the coalescing queue, only allocated if coalescing is enabled */
+#define CFG_AECP_DEFAULT_NUM_UNSOLICITED_PENDING	16
+#define CFG_AECP_MAX_NUM_UNSOLICITED_PENDING		64
+#define CFG_AECP_MIN_NUM_UNSOLICITED_PENDING		1
+#define CFG_AECP_UNSOLICITED_COALESCE_BATCH		16 /* Maximum number of pending notifications drained per coalescing window */
+#define CFG_AECP_UNSOLICITED_COALESCE_GRANULARITY_MS	10
+
 #define CFG_ADP_DEFAULT_NUM_ENTITIES_DISCOVERY		16
 #define CFG_ADP_MIN_NUM_ENTITIES_DISCOVERY		8
 #define CFG_ADP_MAX_NUM_ENTITIES_DISCOVERY		128
@@ -63,6 +63,8 @@ const struct avdecc_config avdecc_default_config = {
 	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].max_talker_streams = 3,
 	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].max_inflights = CFG_AVDECC_DEFAULT_NUM_INFLIGHTS,
 	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].max_unsolicited_registrations = CFG_AECP_DEFAULT_NUM_UNSOLICITED,
+	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].unsolicited_coalesce_ms = CFG_AECP_DEFAULT_UNSOLICITED_COALESCE_MS,
+	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].max_unsolicited_pending = CFG_AECP_DEFAULT_NUM_UNSOLICITED_PENDING,
 	.entity_cfg[0 ... CFG_AVDECC_NUM_ENTITIES - 1].max_ptlv_entries = CFG_AEM_DEFAULT_NUM_PTLV_ENTRIES,
 };
 
@@ -92,6 +94,8 @@ __init static void process_avdecc_entity(struct avdecc_entity_config *entity_cfg
 	clip_config_values(&entity_cfg->max_listener_pairs, CFG_ACMP_MIN_NUM_LISTENER_PAIRS, CFG_ACMP_MAX_NUM_LISTENER_PAIRS);
 	clip_config_values(&entity_cfg->max_inflights, CFG_AVDECC_MIN_NUM_INFLIGHTS, CFG_AVDECC_MAX_NUM_INFLIGHTS);
 	clip_config_values(&entity_cfg->max_unsolicited_registrations, CFG_AECP_MIN_NUM_UNSOLICITED, CFG_AECP_MAX_NUM_UNSOLICITED);
+	clip_config_values(&entity_cfg->unsolicited_coalesce_ms, CFG_AECP_MIN_UNSOLICITED_COALESCE_MS, CFG_AECP_MAX_UNSOLICITED_COALESCE_MS);
+	clip_config_values(&entity_cfg->max_unsolicited_pending, CFG_AECP_MIN_NUM_UNSOLICITED_PENDING, CFG_AECP_MAX_NUM_UNSOLICITED_PENDING);
 }
 
 /**
@@ -0,0 +1,369 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief AVDECC inflight hash test
+ @details
+ The AVDECC stack sources are included, so that the static inflight initialization functions can be used directly
+ (see stubs.c for the other stack services). About TEST_TARGET commands are kept in flight, spread over the ACMP,
+ AECP network and AECP application lists of an entity, with random sequence IDs (so that the same sequence ID is
+ in flight on several lists, or several times on the same list). Entries are randomly started, cancelled, removed,
+ and timed out (with the callback either stopping or restarting them), and after each change random lookups are
+ checked against a linear scan of the inflight list:
+ - avdecc_inflight_find() and aem_inflight_find_controller() must return the same entry as the linear scan.
+ - each hash bucket must only hold in flight entries with a matching sequence ID, and the hash must hold all the
+   in flight entries exactly once.
+ With -b, the lookup cost with TEST_TARGET commands in flight is compared to a linear scan of the inflight list.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "avdecc/config.h"
+#include "avdecc/avdecc.c"
+
+#define TEST_INFLIGHTS		1024
+#define TEST_TARGET		1000
+#define TEST_STEPS		100000
+#define TEST_QUERIES		8
+#define TEST_SEQ_RANGE		2048	/* smaller than the sequence ID space, so that sequence IDs collide */
+#define TEST_CONTROLLERS	4
+#define TEST_LISTS		3
+#define TEST_SYS_TIMERS		1
+#define TEST_BENCH_QUERIES	(1000 * 1000)
+
+static struct avdecc_ctx avdecc;
+static struct entity entity;
+static struct list_head *lists[TEST_LISTS];
+static unsigned int inflight_n;
+static int cb_rc;
+
+static unsigned int seed = 1;
+
+static int test_cb(struct inflight_ctx *entry)
+{
+	return cb_rc;
+}
+
+static u64 test_controller(unsigned int i)
+{
+	return 0x0001f2fffe000000ULL + i;
+}
+
+/* Linear scan of the inflight list, as done before the hash */
+static struct inflight_ctx *test_find_linear(struct list_head *head, u16 sequence_id, bool match_controller, u64 controller_id)
+{
+	struct list_head *list_entry;
+	struct inflight_ctx *entry;
+
+	for (list_entry = list_first(head); list_entry != head; list_entry = list_next(list_entry)) {
+		entry = container_of(list_entry, struct inflight_ctx, list);
+
+		if ((entry->data.sequence_id == sequence_id)
+		&& (!match_controller || (entry->data.pdu.aem.controller_entity_id == controller_id)))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static int test_init(void)
+{
+	struct avdecc_entity_config cfg;
+	void *data;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.max_inflights = TEST_INFLIGHTS;
+
+	data = malloc(avdecc_inflight_data_size(&cfg));
+	avdecc.timer_ctx = malloc(timer_pool_size(TEST_SYS_TIMERS));
+	if (!data || !avdecc.timer_ctx)
+		return -1;
+
+	/* All the inflight timers share a single system timer, with the inflight timer resolution */
+	if (timer_pool_init(avdecc.timer_ctx, TEST_SYS_TIMERS, 0) < 0)
+		return -1;
+
+	entity.avdecc = &avdecc;
+
+	if (avdecc_inflight_init(&entity, data, &cfg) < 0)
+		return -1;
+
+	list_head_init(&entity.acmp.inflight);
+	list_head_init(&entity.aecp.inflight_network);
+	list_head_init(&entity.aecp.inflight_application);
+
+	lists[0] = &entity.acmp.inflight;
+	lists[1] = &entity.aecp.inflight_network;
+	lists[2] = &entity.aecp.inflight_application;
+
+	inflight_n = 0;
+
+	return 0;
+}
+
+static int test_start(void)
+{
+	struct inflight_ctx *entry = avdecc_inflight_get(&entity);
+
+	if (!entry) {
+		printf("no free inflight entry with %u in flight\n", inflight_n);
+		return -1;
+	}
+
+	entry->data.sequence_id = rand_r(&seed) % TEST_SEQ_RANGE;
+	entry->data.pdu.aem.controller_entity_id = test_controller(rand_r(&seed) % TEST_CONTROLLERS);
+	entry->cb = test_cb;
+
+	avdecc_inflight_start(lists[rand_r(&seed) % TEST_LISTS], entry, 100);
+	inflight_n++;
+
+	return 0;
+}
+
+/* Random in flight entry */
+static struct inflight_ctx *test_pick(void)
+{
+	struct inflight_ctx *entry;
+
+	do {
+		entry = &entity.inflight_storage[rand_r(&seed) % TEST_INFLIGHTS];
+	} while (!(entry->timeout.flags & TIMER_STATE_STARTED));
+
+	return entry;
+}
+
+static int test_end(void)
+{
+	struct inflight_ctx *entry = test_pick();
+	struct list_head *head = entry->list_head;
+	u16 sequence_id = entry->data.sequence_id;
+	u16 orig_seq_id;
+
+	switch (rand_r(&seed) % 4) {
+	case 0:
+		/* Cancels the first entry with the sequence ID, not necessarily the picked one */
+		entry = test_find_linear(head, sequence_id, false, 0);
+
+		if (avdecc_inflight_cancel(&entity, head, sequence_id, &orig_seq_id, NULL, NULL) < 0) {
+			printf("cancel of sequence ID %u failed\n", sequence_id);
+			return -1;
+		}
+
+		break;
+
+	case 1:
+		avdecc_inflight_remove(&entity, entry);
+		break;
+
+	default:
+		/* Timeout, the callback restarts the entry (retry) or stops it */
+		cb_rc = (rand_r(&seed) & 1) ? AVDECC_INFLIGHT_TIMER_STOP : AVDECC_INFLIGHT_TIMER_RESTART;
+
+		avdecc_inflight_timeout(entry);
+
+		if (cb_rc == AVDECC_INFLIGHT_TIMER_RESTART) {
+			if (!(entry->timeout.flags & TIMER_STATE_STARTED)) {
+				printf("restarted entry not in flight\n");
+				return -1;
+			}
+
+			return 0;
+		}
+
+		break;
+	}
+
+	if (entry->timeout.flags & TIMER_STATE_STARTED) {
+		printf("ended entry still in flight\n");
+		return -1;
+	}
+
+	inflight_n--;
+
+	return 0;
+}
+
+static int test_check_hash(void)
+{
+	struct list_head *list_entry;
+	struct inflight_ctx *entry;
+	unsigned int i, n = 0, listed = 0, hashed = 0;
+
+	for (i = 0; i <= entity.inflight_hash_mask; i++) {
+		for (list_entry = list_first(&entity.inflight_hash[i]); list_entry != &entity.inflight_hash[i]; list_entry = list_next(list_entry)) {
+			entry = container_of(list_entry, struct inflight_ctx, hash);
+
+			if (((entry->data.sequence_id & entity.inflight_hash_mask) != i) || !(entry->timeout.flags & TIMER_STATE_STARTED)) {
+				printf("bucket %u: unexpected entry, sequence ID %u\n", i, entry->data.sequence_id);
+				return -1;
+			}
+
+			hashed++;
+		}
+	}
+
+	for (i = 0; i < TEST_LISTS; i++)
+		for (list_entry = list_first(lists[i]); list_entry != lists[i]; list_entry = list_next(list_entry))
+			listed++;
+
+	for (i = 0; i < TEST_INFLIGHTS; i++)
+		if (entity.inflight_storage[i].timeout.flags & TIMER_STATE_STARTED)
+			n++;
+
+	if ((hashed != inflight_n) || (listed != inflight_n) || (n != inflight_n)) {
+		printf("%u entries hashed, %u listed, %u started, expected %u\n", hashed, listed, n, inflight_n);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_check_find(void)
+{
+	struct list_head *head = lists[rand_r(&seed) % TEST_LISTS];
+	u16 sequence_id = rand_r(&seed) % TEST_SEQ_RANGE;
+	u64 controller_id = test_controller(rand_r(&seed) % TEST_CONTROLLERS);
+	struct inflight_ctx *found, *expected;
+
+	found = avdecc_inflight_find(&entity, head, sequence_id);
+	expected = test_find_linear(head, sequence_id, false, 0);
+
+	if (found != expected) {
+		printf("find(%u): %p, expected %p\n", sequence_id, found, expected);
+		return -1;
+	}
+
+	found = aem_inflight_find_controller(&entity, head, sequence_id, controller_id);
+	expected = test_find_linear(head, sequence_id, true, controller_id);
+
+	if (found != expected) {
+		printf("find_controller(%u, %llx): %p, expected %p\n", sequence_id, (unsigned long long)controller_id, found, expected);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_random(void)
+{
+	unsigned int step, q;
+
+	if (test_init() < 0)
+		return -1;
+
+	for (step = 0; step < TEST_STEPS; step++) {
+		/* Fill up to the target, then keep just below it */
+		if (inflight_n < TEST_TARGET - rand_r(&seed) % 64) {
+			if (test_start() < 0)
+				return -1;
+		} else {
+			if (test_end() < 0)
+				return -1;
+		}
+
+		if (!(step % 64) && (test_check_hash() < 0))
+			return -1;
+
+		for (q = 0; q < TEST_QUERIES; q++)
+			if (test_check_find() < 0)
+				return -1;
+	}
+
+	printf("%u lookups checked, %u commands in flight at the end\n", TEST_STEPS * TEST_QUERIES, inflight_n);
+
+	return test_check_hash();
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void test_bench(void)
+{
+	static u16 sequence_id[TEST_BENCH_QUERIES];
+	static u8 list[TEST_BENCH_QUERIES];
+	volatile unsigned int sink = 0;
+	unsigned int i;
+	double start, hashed, linear;
+
+	if (test_init() < 0)
+		return;
+
+	while (inflight_n < TEST_TARGET)
+		if (test_start() < 0)
+			return;
+
+	for (i = 0; i < TEST_BENCH_QUERIES; i++) {
+		sequence_id[i] = rand_r(&seed) % TEST_SEQ_RANGE;
+		list[i] = rand_r(&seed) % TEST_LISTS;
+	}
+
+	start = test_time();
+
+	for (i = 0; i < TEST_BENCH_QUERIES; i++)
+		if (avdecc_inflight_find(&entity, lists[list[i]], sequence_id[i]))
+			sink++;
+
+	hashed = test_time() - start;
+
+	start = test_time();
+
+	for (i = 0; i < TEST_BENCH_QUERIES; i++)
+		if (test_find_linear(lists[list[i]], sequence_id[i], false, 0))
+			sink++;
+
+	linear = test_time() - start;
+
+	printf("%u commands in flight, lookup: hash %.1f ns, linear scan %.1f ns (%.1fx)\n", inflight_n,
+		hashed * 1e9 / TEST_BENCH_QUERIES, linear * 1e9 / TEST_BENCH_QUERIES, linear / hashed);
+
+	(void)sink;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (test_random() < 0)
+		goto fail;
+
+	if (bench)
+		test_bench();
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
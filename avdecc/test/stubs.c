@@ -0,0 +1,320 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief avdecc unit tests, stubbed stack services
+ @details
+ The tests only exercise the inflight entries of an entity, the ADP, ACMP, AECP and AEM protocol handlers, the network
+ and ipc services are never called. The timer service is the common one, with the OS timers stubbed (inflight
+ timeouts are triggered by the tests).
+*/
+
+#include "avdecc/avdecc.h"
+#include "avdecc/avdecc_ieee.h"
+
+#include "common/ipc.h"
+
+#include "os/net.h"
+#include "os/timer.h"
+
+unsigned int acmp_data_size(struct avdecc_entity_config *cfg)
+{
+	return 0;
+}
+
+int acmp_init(struct acmp_ctx *acmp, void *data, struct avdecc_entity_config *cfg)
+{
+	return -1;
+}
+
+int acmp_exit(struct acmp_ctx *acmp)
+{
+	return -1;
+}
+
+int acmp_net_rx(struct avdecc_port *port, struct acmp_pdu *pdu, u8 msg_type, u8 status)
+{
+	return -1;
+}
+
+int acmp_ipc_rx(struct entity *entity, struct ipc_acmp_command *acmp_command, u32 len, struct ipc_tx *ipc, unsigned int ipc_dst)
+{
+	return -1;
+}
+
+bool acmp_is_stream_running(struct entity *entity, u16 stream_desc_type, u16 stream_desc_index)
+{
+	return false;
+}
+
+int acmp_milan_get_listener_unique_id(struct entity *entity, u64 stream_id, u16 *listener_unique_id)
+{
+	return -1;
+}
+
+int acmp_milan_get_talker_unique_id(struct entity *entity, u64 stream_id, u16 *talker_unique_id)
+{
+	return -1;
+}
+
+void acmp_milan_listener_srp_state_sm(struct entity *entity, u16 listener_unique_id, struct genavb_msg_listener_status *ipc_listener_status)
+{
+}
+
+void acmp_milan_talker_update_status(struct entity *entity, u16 talker_unique_id, struct genavb_msg_talker_status *ipc_talker_status)
+{
+}
+
+void acmp_milan_talker_update_declaration(struct entity *entity, u16 talker_unique_id, struct genavb_msg_talker_declaration_status *ipc_talker_declaration_status)
+{
+}
+
+int acmp_milan_talkers_maap_start(struct entity *entity)
+{
+	return -1;
+}
+
+void acmp_milan_talker_maap_conflict(struct entity *entity, avb_u16 port_id, avb_u32 range_id, avb_u8 *base_address, avb_u16 count)
+{
+}
+
+void acmp_milan_talker_maap_valid(struct entity *entity, avb_u16 port_id, avb_u32 range_id, avb_u8 *base_address, avb_u16 count)
+{
+}
+
+int acmp_milan_listener_sink_rcv_binding_params(struct entity *entity, struct genavb_msg_media_stack_bind *binding_params)
+{
+	return -1;
+}
+
+int adp_init(struct adp_ctx *adp)
+{
+	return -1;
+}
+
+void adp_exit(struct adp_ctx *adp)
+{
+}
+
+void adp_update(struct adp_ctx *adp)
+{
+}
+
+int adp_discovery_init(struct adp_discovery_ctx *disc, void *data, struct avdecc_config *cfg)
+{
+	return -1;
+}
+
+void adp_discovery_exit(struct adp_discovery_ctx *disc)
+{
+}
+
+unsigned int adp_discovery_data_size(unsigned int max_entities_discovery)
+{
+	return 0;
+}
+
+int adp_net_rx(struct avdecc_port *port, struct adp_pdu *pdu, u8 msg_type, u8 valid_time, u8 *mac_src)
+{
+	return -1;
+}
+
+int adp_ipc_rx(struct entity *entity, struct ipc_adp_msg *adp_msg, u32 len, struct ipc_tx *ipc, unsigned int ipc_dst)
+{
+	return -1;
+}
+
+int adp_ieee_advertise_interface_sm(struct entity *entity, unsigned int port_id, adp_ieee_advertise_interface_event_t event)
+{
+	return -1;
+}
+
+int adp_milan_advertise_sm(struct entity *entity, unsigned int port_id, adp_milan_advertise_event_t event)
+{
+	return -1;
+}
+
+int aecp_init(struct aecp_ctx *aecp, void *data, struct avdecc_entity_config *cfg)
+{
+	return -1;
+}
+
+int aecp_exit(struct aecp_ctx *aecp)
+{
+	return -1;
+}
+
+unsigned int aecp_data_size(struct avdecc_entity_config *cfg)
+{
+	return 0;
+}
+
+int aecp_net_rx(struct avdecc_port *port, struct aecp_pdu *pdu, u8 msg_type, u8 status, u16 len, u8 *mac_src)
+{
+	return -1;
+}
+
+int aecp_ipc_rx_controller(struct entity *entity, struct ipc_aecp_msg *aecp_msg, u32 len, struct ipc_tx *ipc, unsigned int ipc_dst)
+{
+	return -1;
+}
+
+void aecp_ipc_rx_controlled(struct entity *entity, struct ipc_aecp_msg *aecp_msg, u32 len)
+{
+}
+
+int aecp_aem_send_async_unsolicited_notification(struct aecp_ctx *aecp, u16 response_type, u16 descriptor_type, u16 descriptor_index)
+{
+	return -1;
+}
+
+void aecp_register_get_counters_async_notification(struct entity *entity, u16 descriptor_type, u16 descriptor_index)
+{
+}
+
+void aecp_register_get_as_path_asyn_notification(struct entity *entity, unsigned int port_id)
+{
+}
+
+struct aem_desc_hdr *aem_entity_static_init(void)
+{
+	return NULL;
+}
+
+void aem_init(struct aem_desc_hdr *aem_desc, struct avdecc_entity_config *cfg, int entity_num)
+{
+}
+
+void *aem_dynamic_descs_init(struct aem_desc_hdr *aem_descs, struct avdecc_entity_config *cfg)
+{
+	return NULL;
+}
+
+unsigned int aem_get_descriptor_max(struct aem_desc_hdr *aem_desc, avb_u16 type)
+{
+	return 0;
+}
+
+void *aem_get_descriptor(struct aem_desc_hdr *aem_desc, avb_u16 type, avb_u16 index, avb_u16 *len)
+{
+	return NULL;
+}
+
+unsigned int aem_get_talker_streams(struct aem_desc_hdr *aem_desc)
+{
+	return 0;
+}
+
+void avdecc_ieee_try_fast_connect(struct entity *entity, struct entity_discovery *entity_disc, unsigned int port_id)
+{
+}
+
+int ipc_rx_init(struct ipc_rx *rx, ipc_id_t id, void (*func)(struct ipc_rx const *, struct ipc_desc *), unsigned long priv)
+{
+	return -1;
+}
+
+void ipc_rx_exit(struct ipc_rx *rx)
+{
+}
+
+int ipc_tx_init(struct ipc_tx *tx, ipc_id_t id)
+{
+	return -1;
+}
+
+void ipc_tx_exit(struct ipc_tx *tx)
+{
+}
+
+int ipc_tx_connect(struct ipc_tx *tx, struct ipc_rx *rx)
+{
+	return -1;
+}
+
+struct ipc_desc *ipc_alloc(struct ipc_tx const *tx, unsigned int size)
+{
+	return NULL;
+}
+
+void ipc_free(void const *ipc, struct ipc_desc *desc)
+{
+}
+
+int ipc_tx(struct ipc_tx const *tx, struct ipc_desc *desc)
+{
+	return -1;
+}
+
+int net_rx_init(struct net_rx *rx, struct net_address *addr, void (*func)(struct net_rx *, struct net_rx_desc *), unsigned long priv)
+{
+	return -1;
+}
+
+void net_rx_exit(struct net_rx *rx)
+{
+}
+
+void net_rx_free(struct net_rx_desc *buf)
+{
+}
+
+int net_tx_init(struct net_tx *tx, struct net_address *addr)
+{
+	return -1;
+}
+
+void net_tx_exit(struct net_tx *tx)
+{
+}
+
+struct net_tx_desc *net_tx_clone(struct net_tx *tx, struct net_tx_desc *src)
+{
+	return NULL;
+}
+
+int net_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	return -1;
+}
+
+void net_tx_free(struct net_tx_desc *buf)
+{
+}
+
+int net_get_local_addr(unsigned int port_id, unsigned char *addr)
+{
+	return -1;
+}
+
+int net_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+int net_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+int os_timer_create(struct os_timer *t, os_clock_id_t id, unsigned int flags, void (*func)(struct os_timer *t, int count), unsigned long priv)
+{
+	return 0;
+}
+
+void os_timer_destroy(struct os_timer *t)
+{
+}
+
+int os_timer_start(struct os_timer *t, u64 value, u64 interval_p, u64 interval_q, unsigned int flags)
+{
+	return 0;
+}
+
+void os_timer_stop(struct os_timer *t)
+{
+}
@@ -0,0 +1,5 @@
+# avdecc unit tests, the tests include the avdecc sources to reach the static functions (see stubs.c, or the end of
+# the test file, for the stack services). The avdecc configuration is included by the test itself, after _GNU_SOURCE
+# is defined.
+genavb_add_test(NAME avdecc-inflight COMPONENT common SRCS inflight.c stubs.c LIBS common)
+genavb_add_test(NAME avdecc-unsolicited COMPONENT common SRCS unsolicited.c LIBS common)
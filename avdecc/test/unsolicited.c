@@ -0,0 +1,608 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief AECP unsolicited notifications coalescing test
+ @details
+ The AECP sources are included, so that the synchronous notification entry point (called on successful controller
+ commands) can be used directly. The stack services are stubbed at the bottom of this file: the entity has a single
+ avdecc port, two controllers (A and B) are registered for unsolicited notifications, and every PDU sent on the
+ network is recorded. The coalescing timer is fired by the test, one TEST_COALESCE_MS window at a time.
+ Scripted bursts of SET_CONTROL commands from controller A are checked for the number of PDUs they generate:
+ - TEST_BURST updates of one control: a single notification to B, with the last value, at the end of the window.
+ - Updates of more distinct controls than the queue holds: when the queue is full, the pending notifications and
+   the new one are sent immediately, the following ones at the end of the window, all in order.
+ - A non coalescable command (audio mappings) sends the pending notifications first.
+ - Asynchronous (LOCK_ENTITY) notifications are merged the same way, and sent to both controllers.
+ - With coalescing disabled, each update is sent immediately.
+ Sequence IDs of the notifications must be consecutive for each controller.
+ With -b, the number of PDUs and the processing time per update are compared with and without coalescing.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "avdecc/config.h"
+#include "avdecc/aecp.c"
+
+#include "common/aecp.h"
+
+#define TEST_COALESCE_MS	10
+#define TEST_PENDING		4
+#define TEST_REGISTRATIONS	4
+#define TEST_BURST		100
+#define TEST_CONTROLS		(2 * TEST_PENDING)
+#define TEST_SYS_TIMERS		4
+#define TEST_MAX_PDUS		1024
+#define TEST_BENCH_UPDATES	(100 * 1000)
+
+#define TEST_CONTROLLER_A	0x0001f2fffe000001ULL
+#define TEST_CONTROLLER_B	0x0001f2fffe000002ULL
+
+struct test_pdu {
+	u64 controller_id;
+	u16 sequence_id;
+	u16 cmd_type;
+	u16 descriptor_index;
+	u32 value;
+};
+
+static struct avdecc_ctx *avdecc;
+static struct entity entity;
+static struct entity_descriptor entity_desc;
+static struct entity_dynamic_desc *entity_dynamic;
+static u64 aem_storage[512];	/* Backs the dynamic descriptors returned by aem_get_descriptor(), large enough for any type */
+static void *aecp_data;
+
+static struct test_pdu pdus[TEST_MAX_PDUS];
+static unsigned int pdu_n;
+static bool pdu_record = true;
+static unsigned int pdu_errors;
+static u16 next_sequence_id[2];
+
+static void (*test_timer_func)(struct os_timer *t, int count);
+
+static u8 test_mac_a[6] = {0x00, 0x01, 0xf2, 0x00, 0x00, 0x01};
+static u8 test_mac_b[6] = {0x00, 0x01, 0xf2, 0x00, 0x00, 0x02};
+
+static int test_init(unsigned int coalesce_ms)
+{
+	struct avdecc_entity_config cfg;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.max_unsolicited_registrations = TEST_REGISTRATIONS;
+	cfg.unsolicited_coalesce_ms = coalesce_ms;
+	cfg.max_unsolicited_pending = TEST_PENDING;
+
+	memset(&entity, 0, sizeof(entity));
+	entity.avdecc = avdecc;
+	entity.desc = &entity_desc;
+
+	free(aecp_data);
+	aecp_data = malloc(aecp_data_size(&cfg));
+	if (!aecp_data)
+		return -1;
+
+	if (aecp_init(&entity.aecp, aecp_data, &cfg) < 0)
+		return -1;
+
+	/* Controller A sends the commands, B is only notified */
+	if ((aecp_unsolicited_add(&entity.aecp, test_mac_a, htonll(TEST_CONTROLLER_A), 0) < 0)
+	|| (aecp_unsolicited_add(&entity.aecp, test_mac_b, htonll(TEST_CONTROLLER_B), 0) < 0))
+		return -1;
+
+	pdu_n = 0;
+	pdu_errors = 0;
+	next_sequence_id[0] = 0;
+	next_sequence_id[1] = 0;
+
+	return 0;
+}
+
+static void test_exit(void)
+{
+	aecp_unsolicited_remove(&entity.aecp, htonll(TEST_CONTROLLER_A), 0);
+	aecp_unsolicited_remove(&entity.aecp, htonll(TEST_CONTROLLER_B), 0);
+
+	aecp_exit(&entity.aecp);
+}
+
+/* Ends the current coalescing window (the timer service adds one granularity period to the timeout) */
+static void test_window(void)
+{
+	if (entity.aecp.coalesce_ms && timer_is_running(&entity.aecp.coalesce_timer))
+		test_timer_func(&entity.aecp.coalesce_timer.timer_sys->os_timer,
+				TEST_COALESCE_MS / CFG_AECP_UNSOLICITED_COALESCE_GRANULARITY_MS + 1);
+}
+
+/* Successful command from controller A, as passed to the notification code once the response is built */
+static int test_command(u16 cmd_type, u16 descriptor_index, u32 value)
+{
+	u8 buf[sizeof(struct aecp_aem_pdu) + sizeof(struct aecp_aem_set_get_control_pdu) + sizeof(u32)];
+	struct aecp_aem_pdu *pdu = (struct aecp_aem_pdu *)buf;
+	struct aecp_aem_set_get_control_pdu *control = (struct aecp_aem_set_get_control_pdu *)(pdu + 1);
+	u64 controller_id = htonll(TEST_CONTROLLER_A);
+
+	memset(buf, 0, sizeof(buf));
+
+	AECP_AEM_SET_U_CMD_TYPE(pdu, 0, cmd_type);
+	copy_64(&pdu->controller_entity_id, &controller_id);
+	control->descriptor_type = htons(AEM_DESC_TYPE_CONTROL);
+	control->descriptor_index = htons(descriptor_index);
+	memcpy(control + 1, &value, sizeof(value));
+
+	return aecp_aem_coalesce_sync_unsolicited_notification(&entity.aecp, pdu, controller_id, sizeof(buf));
+}
+
+static int test_set_control(u16 descriptor_index, u32 value)
+{
+	return test_command(AECP_AEM_CMD_SET_CONTROL, descriptor_index, value);
+}
+
+static int test_expect_pdus(const char *step, unsigned int n)
+{
+	if (pdu_n != n) {
+		printf("%s: %u PDUs sent, expected %u\n", step, pdu_n, n);
+		return -1;
+	}
+
+	if (pdu_errors) {
+		printf("%s: %u invalid notifications\n", step, pdu_errors);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_expect_pdu(unsigned int i, u64 controller_id, u16 cmd_type, u16 descriptor_index, u32 value)
+{
+	struct test_pdu *pdu = &pdus[i];
+
+	if ((pdu->controller_id != controller_id) || (pdu->cmd_type != cmd_type) || (pdu->descriptor_index != descriptor_index)
+	|| ((cmd_type == AECP_AEM_CMD_SET_CONTROL) && (pdu->value != value))) {
+		printf("PDU %u: controller %016llx, command %x, descriptor %u, value %u, expected %016llx, %x, %u, %u\n", i,
+			(unsigned long long)pdu->controller_id, pdu->cmd_type, pdu->descriptor_index, pdu->value,
+			(unsigned long long)controller_id, cmd_type, descriptor_index, value);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_same_control(void)
+{
+	unsigned int i;
+
+	if (test_init(TEST_COALESCE_MS) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_BURST; i++)
+		if (test_set_control(0, i) < 0)
+			return -1;
+
+	if (test_expect_pdus("same control burst", 0) < 0)
+		return -1;
+
+	test_window();
+
+	/* Controller A sent the commands, only B is notified, with the latest value */
+	if ((test_expect_pdus("same control window", 1) < 0)
+	|| (test_expect_pdu(0, TEST_CONTROLLER_B, AECP_AEM_CMD_SET_CONTROL, 0, TEST_BURST - 1) < 0))
+		return -1;
+
+	if (timer_is_running(&entity.aecp.coalesce_timer)) {
+		printf("same control: timer running with an empty queue\n");
+		return -1;
+	}
+
+	test_exit();
+
+	return 0;
+}
+
+static int test_queue_full(void)
+{
+	unsigned int i;
+
+	if (test_init(TEST_COALESCE_MS) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_PENDING; i++)
+		if (test_set_control(i, i) < 0)
+			return -1;
+
+	if (test_expect_pdus("queue filled", 0) < 0)
+		return -1;
+
+	/* Queue full: the pending notifications are sent, then the new one */
+	if (test_set_control(TEST_PENDING, TEST_PENDING) < 0)
+		return -1;
+
+	if (test_expect_pdus("queue full", TEST_PENDING + 1) < 0)
+		return -1;
+
+	for (i = TEST_PENDING + 1; i < TEST_CONTROLS; i++)
+		if (test_set_control(i, i) < 0)
+			return -1;
+
+	if (test_expect_pdus("after queue full", TEST_PENDING + 1) < 0)
+		return -1;
+
+	if (!timer_is_running(&entity.aecp.coalesce_timer)) {
+		printf("queue full: timer not running with pending notifications\n");
+		return -1;
+	}
+
+	test_window();
+
+	if (test_expect_pdus("queue full window", TEST_CONTROLS) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_CONTROLS; i++)
+		if (test_expect_pdu(i, TEST_CONTROLLER_B, AECP_AEM_CMD_SET_CONTROL, i, i) < 0)
+			return -1;
+
+	test_exit();
+
+	return 0;
+}
+
+static int test_not_coalescable(void)
+{
+	if (test_init(TEST_COALESCE_MS) < 0)
+		return -1;
+
+	if ((test_set_control(0, 10) < 0) || (test_set_control(1, 11) < 0) || (test_set_control(0, 12) < 0))
+		return -1;
+
+	if (test_expect_pdus("coalesced", 0) < 0)
+		return -1;
+
+	if (test_command(AECP_AEM_CMD_ADD_AUDIO_MAPPINGS, 0, 0) < 0)
+		return -1;
+
+	/* Pending notifications first, in the order of their latest update */
+	if ((test_expect_pdus("not coalescable", 3) < 0)
+	|| (test_expect_pdu(0, TEST_CONTROLLER_B, AECP_AEM_CMD_SET_CONTROL, 1, 11) < 0)
+	|| (test_expect_pdu(1, TEST_CONTROLLER_B, AECP_AEM_CMD_SET_CONTROL, 0, 12) < 0)
+	|| (test_expect_pdu(2, TEST_CONTROLLER_B, AECP_AEM_CMD_ADD_AUDIO_MAPPINGS, 0, 0) < 0))
+		return -1;
+
+	test_window();
+
+	if (test_expect_pdus("not coalescable window", 3) < 0)
+		return -1;
+
+	test_exit();
+
+	return 0;
+}
+
+static int test_async(void)
+{
+	unsigned int i;
+
+	if (test_init(TEST_COALESCE_MS) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_BURST; i++) {
+		entity_dynamic->lock_status = (i & 1) ? LOCKED : UNLOCKED;
+
+		if (aecp_aem_send_async_unsolicited_notification(&entity.aecp, AECP_AEM_CMD_LOCK_ENTITY, AEM_DESC_TYPE_ENTITY, 0) < 0)
+			return -1;
+	}
+
+	if (test_expect_pdus("async burst", 0) < 0)
+		return -1;
+
+	test_window();
+
+	/* Not generated by a controller command, sent to both controllers */
+	if (test_expect_pdus("async window", 2) < 0)
+		return -1;
+
+	test_exit();
+
+	return 0;
+}
+
+static int test_disabled(void)
+{
+	unsigned int i;
+
+	if (test_init(0) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_BURST; i++)
+		if (test_set_control(0, i) < 0)
+			return -1;
+
+	if (test_expect_pdus("coalescing disabled", TEST_BURST) < 0)
+		return -1;
+
+	for (i = 0; i < TEST_BURST; i++)
+		if (test_expect_pdu(i, TEST_CONTROLLER_B, AECP_AEM_CMD_SET_CONTROL, 0, i) < 0)
+			return -1;
+
+	test_exit();
+
+	return 0;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void test_bench_run(unsigned int coalesce_ms)
+{
+	unsigned int i, n = 0;
+	double start, elapsed;
+
+	if (test_init(coalesce_ms) < 0)
+		return;
+
+	pdu_record = false;
+
+	start = test_time();
+
+	/* A control updated continuously (e.g. a fader), TEST_BURST updates per coalescing window */
+	for (i = 0; i < TEST_BENCH_UPDATES; i++) {
+		test_set_control(0, i);
+
+		if (!((i + 1) % TEST_BURST))
+			test_window();
+	}
+
+	test_window();
+
+	elapsed = test_time() - start;
+
+	n = pdu_n;
+	pdu_record = true;
+
+	printf("coalescing %s: %u updates, %u PDUs, %.1f ns per update\n", coalesce_ms ? "enabled" : "disabled",
+		TEST_BENCH_UPDATES, n, elapsed * 1e9 / TEST_BENCH_UPDATES);
+
+	test_exit();
+}
+
+static void test_bench(void)
+{
+	test_bench_run(TEST_COALESCE_MS);
+	test_bench_run(0);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	avdecc = calloc(1, sizeof(*avdecc) + sizeof(struct avdecc_port));
+	if (!avdecc)
+		goto fail;
+
+	avdecc->timer_ctx = malloc(timer_pool_size(TEST_SYS_TIMERS));
+	if (!avdecc->timer_ctx || (timer_pool_init(avdecc->timer_ctx, TEST_SYS_TIMERS, 0) < 0))
+		goto fail;
+
+	entity_desc.entity_id = htonll(0x0001f2fffe000100ULL);
+	entity_dynamic = (struct entity_dynamic_desc *)aem_storage;
+
+	if ((test_same_control() < 0) || (test_queue_full() < 0) || (test_not_coalescable() < 0)
+	|| (test_async() < 0) || (test_disabled() < 0))
+		goto fail;
+
+	if (bench)
+		test_bench();
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
+
+/*
+ * Stubbed stack services
+ */
+
+/* Records the notifications sent, and checks their sequence IDs */
+int avdecc_net_tx(struct avdecc_port *port, struct net_tx_desc *desc)
+{
+	struct aecp_aem_pdu *pdu = (struct aecp_aem_pdu *)((char *)NET_DATA_START(desc) + OFFSET_TO_AECP);
+	struct aecp_aem_set_get_control_pdu *control = (struct aecp_aem_set_get_control_pdu *)(pdu + 1);
+	struct test_pdu *rec = &pdus[pdu_n % TEST_MAX_PDUS];
+	u64 controller_id;
+	unsigned int c;
+
+	copy_64(&controller_id, &pdu->controller_entity_id);
+	controller_id = ntohll(controller_id);
+	c = (controller_id == TEST_CONTROLLER_B);
+
+	if (!AECP_AEM_GET_U(pdu) || (ntohs(pdu->sequence_id) != next_sequence_id[c])) {
+		printf("notification %u: U %u, sequence ID %u, expected %u\n", pdu_n, AECP_AEM_GET_U(pdu), ntohs(pdu->sequence_id), next_sequence_id[c]);
+		pdu_errors++;
+	}
+
+	next_sequence_id[c]++;
+
+	if (pdu_record) {
+		rec->controller_id = controller_id;
+		rec->sequence_id = ntohs(pdu->sequence_id);
+		rec->cmd_type = AECP_AEM_GET_CMD_TYPE(pdu);
+		rec->descriptor_index = ntohs(control->descriptor_index);
+		memcpy(&rec->value, control + 1, sizeof(rec->value));
+	}
+
+	pdu_n++;
+
+	net_tx_free(desc);
+
+	return 0;
+}
+
+struct net_tx_desc *net_tx_alloc(struct net_tx *tx, unsigned int size)
+{
+	struct net_tx_desc *desc = malloc(NET_DATA_OFFSET + size);
+
+	if (desc) {
+		memset(desc, 0, sizeof(*desc));
+		desc->l2_offset = NET_DATA_OFFSET;
+	}
+
+	return desc;
+}
+
+void net_tx_free(struct net_tx_desc *desc)
+{
+	free(desc);
+}
+
+size_t avdecc_add_common_header(void *buf, u8 subtype, u8 msg_type, u16 length, u8 status)
+{
+	memset(buf, 0, sizeof(struct avtp_ctrl_hdr));
+
+	return sizeof(struct avtp_ctrl_hdr);
+}
+
+unsigned int aem_get_descriptor_max(struct aem_desc_hdr *aem_desc, avb_u16 type)
+{
+	return 0;
+}
+
+void *aem_get_descriptor(struct aem_desc_hdr *aem_desc, avb_u16 type, avb_u16 index, avb_u16 *len)
+{
+	if (len)
+		*len = 0;
+
+	if ((type == AEM_DESC_TYPE_ENTITY) && !index)
+		return aem_storage;
+
+	return NULL;
+}
+
+struct ipc_desc *ipc_alloc(struct ipc_tx const *tx, unsigned int size)
+{
+	return NULL;
+}
+
+void ipc_free(void const *ipc, struct ipc_desc *desc)
+{
+}
+
+int ipc_tx(struct ipc_tx const *tx, struct ipc_desc *desc)
+{
+	return -1;
+}
+
+int acmp_start_streaming(struct entity *entity, u16 stream_desc_type, u16 stream_desc_index)
+{
+	return -1;
+}
+
+int acmp_stop_streaming(struct entity *entity, u16 stream_desc_type, u16 stream_desc_index)
+{
+	return -1;
+}
+
+struct entity_discovery *adp_find_entity_discovery_any(struct avdecc_ctx *avdecc, u64 entity_id, unsigned int num_interfaces)
+{
+	return NULL;
+}
+
+struct entity *avdecc_get_entity(struct avdecc_ctx *avdecc, u64 entity_id)
+{
+	return NULL;
+}
+
+bool avdecc_entity_port_valid(struct entity *entity, unsigned int port_id)
+{
+	return false;
+}
+
+bool avdecc_entity_is_locked(struct entity *entity, u64 controller_id)
+{
+	return false;
+}
+
+bool avdecc_entity_is_acquired(struct entity *entity, u64 controller_id)
+{
+	return false;
+}
+
+struct inflight_ctx *avdecc_inflight_get(struct entity *entity)
+{
+	return NULL;
+}
+
+int avdecc_inflight_start(struct list_head *inflight, struct inflight_ctx *entry, unsigned int timeout)
+{
+	return -1;
+}
+
+void avdecc_inflight_restart(struct inflight_ctx *entry)
+{
+}
+
+struct inflight_ctx *avdecc_inflight_find(struct entity *entity, struct list_head *inflight_head, u16 sequence_id)
+{
+	return NULL;
+}
+
+struct inflight_ctx *aem_inflight_find_controller(struct entity *entity, struct list_head *inflight_head, u16 sequence_id, u64 controller_id)
+{
+	return NULL;
+}
+
+void avdecc_inflight_remove(struct entity *entity, struct inflight_ctx *entry)
+{
+}
+
+int os_timer_create(struct os_timer *t, os_clock_id_t id, unsigned int flags, void (*func)(struct os_timer *t, int count), unsigned long priv)
+{
+	test_timer_func = func;
+
+	return 0;
+}
+
+void os_timer_destroy(struct os_timer *t)
+{
+}
+
+int os_timer_start(struct os_timer *t, u64 value, u64 interval_p, u64 interval_q, unsigned int flags)
+{
+	return 0;
+}
+
+void os_timer_stop(struct os_timer *t)
+{
+}
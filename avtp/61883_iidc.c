@@ -224,6 +224,7 @@ static void talker_stream_61883_iidc_init(struct stream_talker *stream, unsigned
 	case IEC_61883_CIP_FMT_4:
 		/* There is no real syt_interval in this case, but the ratio timestamp/sample is still a valid concept */
 		stream->subtype_data.iec61883.syt_interval_ln2 = 0;
+		os_memset(&stream->subtype_data.iec61883.pcr, 0, sizeof(stream->subtype_data.iec61883.pcr));
 		stream->net_tx = avtp_61883_4_net_tx;
 		*hdr_len = avtp_61883_4_prepare_header(stream->avtp_hdr, format);
 		break;
@@ -279,6 +280,21 @@ int talker_stream_61883_iidc_check(struct stream_talker *stream, struct avdecc_f
 		goto err_format;
 	}
 
+	stream->subtype_data.iec61883.conceal = AVTP_61883_6_CONCEAL_NONE;
+
+	if (ipc->flags & (IPC_AVTP_FLAGS_CONCEAL_SILENCE | IPC_AVTP_FLAGS_CONCEAL_REPEAT)) {
+		if ((format->u.s.subtype_u.iec61883.fmt != IEC_61883_CIP_FMT_6)
+		|| ((ipc->flags & IPC_AVTP_FLAGS_CONCEAL_SILENCE) && (ipc->flags & IPC_AVTP_FLAGS_CONCEAL_REPEAT))) {
+			os_log(LOG_ERR, "stream_id(%016"PRIx64") invalid concealment flags (%x)\n", ntohll(stream->id), ipc->flags);
+			return -GENAVB_ERR_INVALID_PARAMS;
+		}
+
+		if (ipc->flags & IPC_AVTP_FLAGS_CONCEAL_REPEAT)
+			stream->subtype_data.iec61883.conceal = AVTP_61883_6_CONCEAL_REPEAT;
+		else
+			stream->subtype_data.iec61883.conceal = AVTP_61883_6_CONCEAL_SILENCE;
+	}
+
 	stream->init = talker_stream_61883_iidc_init;
 
 	return rc;
@@ -562,10 +578,135 @@ static unsigned int avtp_61883_4_prepare_header(struct avtp_data_hdr *hdr, const
 	return sizeof(struct iec_61883_hdr);
 }
 
+/** Extracts the PCR from a MPEG2-TS packet
+ * \return 1 if the packet carries a PCR, 0 otherwise
+ * \param tsp			pointer to the transport stream packet
+ * \param pid			pointer to the PID of the packet
+ * \param pcr			pointer to the PCR value, in ns
+ * \param discontinuity	pointer to the discontinuity indicator of the packet adaptation field
+ */
+static int mpeg2ts_get_pcr(const u8 *tsp, u16 *pid, u64 *pcr, bool *discontinuity)
+{
+	u64 pcr_base;
+	u16 pcr_ext;
+
+	if (tsp[0] != MPEG2TS_SYNC_BYTE)
+		return 0;
+
+	*pid = ((u16)(tsp[1] & 0x1f) << 8) | tsp[2];
+
+	/* adaptation_field_control: adaptation field only or adaptation field followed by payload */
+	if (!(tsp[3] & 0x20))
+		return 0;
+
+	/* adaptation_field_length must cover the flags and the PCR */
+	if (tsp[4] < 7)
+		return 0;
+
+	/* PCR_flag */
+	if (!(tsp[5] & 0x10))
+		return 0;
+
+	*discontinuity = (tsp[5] & 0x80) != 0;
+
+	pcr_base = ((u64)tsp[6] << 25) | ((u64)tsp[7] << 17) | ((u64)tsp[8] << 9) | ((u64)tsp[9] << 1) | (tsp[10] >> 7);
+	pcr_ext = ((u16)(tsp[10] & 0x1) << 8) | tsp[11];
+
+	*pcr = ((pcr_base * 300 + pcr_ext) * 1000) / (MPEG2TS_PCR_FREQUENCY / 1000000);
+
+	return 1;
+}
+
+/** Checks a PID against the locked PCR_PID, locking on it if none is locked yet
+ * \return true if the PCRs of this PID drive the source packet timestamps, false otherwise
+ * \param pcr_state		pointer to 61883-4 PCR timestamping context
+ * \param pid			PID of a packet carrying a PCR
+ */
+static bool avtp_61883_4_pcr_pid_match(struct iec_61883_4_pcr *pcr_state, u16 pid)
+{
+	if (!pcr_state->pid_locked) {
+		pcr_state->pid = pid;
+		pcr_state->pid_locked = true;
+	}
+
+	return (pid == pcr_state->pid);
+}
+
+/** Computes the timestamp of a 61883-4 source packet
+ *
+ * Timestamps supplied by the media stack are used as is. Otherwise, the timestamp of a source packet carrying
+ * a PCR is derived from the previous PCR (the transport stream mux schedule), and source packets in between are
+ * spaced by the interval measured between the last two PCRs. Timestamps never go backwards, in case the measured
+ * interval overshoots the next PCR (transport rate increase), and the lead of a held back timestamp over the PCR
+ * time base is absorbed over the next PCR interval.
+ * Only the PCRs of a single PID are used, the first PID seen carrying a PCR (each program of a multi program
+ * transport stream has its own, unrelated, PCR time base). The PID lock is released on media stack reset.
+ * The PCR anchor is reset on PCR discontinuities, gaps above the maximum PCR interval, or if the PCR goes backwards.
+ *
+ * \return source packet timestamp
+ * \param stream		pointer to talker stream context
+ * \param tsp			pointer to the transport stream packet
+ * \param media_ts		pointer to the timestamp supplied by the media stack, NULL if none
+ */
+static u32 avtp_61883_4_sp_ts(struct stream_talker *stream, const u8 *tsp, const u32 *media_ts)
+{
+	struct iec_61883_4_pcr *pcr_state = &stream->subtype_data.iec61883.pcr;
+	u32 ts_now, ts_pcr, lead;
+	u64 pcr, pcr_interval;
+	bool discontinuity = false;
+	u16 pid;
+
+	pcr_state->sp_count++;
+
+	if (media_ts)
+		ts_now = *media_ts;
+	else
+		ts_now = stream->ts_media_prev + pcr_state->sp_period;
+
+	if (mpeg2ts_get_pcr(tsp, &pid, &pcr, &discontinuity) && avtp_61883_4_pcr_pid_match(pcr_state, pid)) {
+		pcr_interval = pcr - pcr_state->pcr_last;
+
+		if (pcr_state->valid && !discontinuity && (pcr > pcr_state->pcr_last) && (pcr_interval <= MPEG2TS_PCR_MAX_INTERVAL)) {
+			ts_pcr = pcr_state->ts_last + (u32)pcr_interval;
+			lead = 0;
+
+			if (!media_ts) {
+				if ((s32)(ts_pcr - stream->ts_media_prev) >= 0) {
+					ts_now = ts_pcr;
+				} else {
+					ts_now = stream->ts_media_prev;
+					lead = ts_now - ts_pcr;
+				}
+			}
+
+			/* A held back timestamp leads the PCR time base, shorten the spacing up to the next PCR to absorb
+			 * (up to half of) the lead, so that it doesn't accumulate over successive transport rate increases */
+			if (lead > pcr_interval / 2)
+				lead = pcr_interval / 2;
+
+			pcr_state->sp_period = (pcr_interval - lead) / pcr_state->sp_count;
+
+			/* Keep the anchor on the PCR time base, even if the timestamp was held back */
+			pcr_state->ts_last = media_ts ? ts_now : ts_pcr;
+		} else {
+			pcr_state->ts_last = ts_now;
+		}
+
+		pcr_state->pcr_last = pcr;
+		pcr_state->sp_count = 0;
+		pcr_state->valid = true;
+	}
+
+	stream->ts_media_prev = ts_now;
+
+	return ts_now;
+}
+
 /** Handles transmission of 61883-4 avtp packets
  *
  * Reads data from media stack, converts media descriptors to network descriptors, including protocol encapsulation,
- * and transmit packets. AVTP timestamps are read from media clock generation layer.
+ * and transmit packets. AVTP timestamps are supplied by the media stack or derived from the transport stream PCRs
+ * (see avtp_61883_4_sp_ts()), the media clock generation layer provides the time base on reset.
  *
  * \return none
  * \param stream pointer to talker stream context
@@ -594,9 +735,9 @@ void avtp_61883_4_net_tx(struct stream_talker *stream)
 		goto media_rx_fail;
 	}
 
-	/* The media clock outputs timestamps at a constant (max) rate, but less may be required depending on
-	 * instantaneous media bandwidth, so make sure to always fetch max timestamps. */
-	ts_batch = stream->tx_batch * stream->frames_per_packet;
+	/* Source packet timestamps come from the media stack or the transport stream PCRs, the media clock only
+	 * provides the time base. Its grid runs at the (max) packet rate, fetch one timestamp per packet slot. */
+	ts_batch = stream->tx_batch;
 
 	if (ts_batch > TS_TX_BATCH) {
 		os_log(LOG_ERR, "stream(%p) Unexpected number of timestamps needed(%u), clamping down to %u\n", stream, ts_batch, TS_TX_BATCH);
@@ -614,6 +755,7 @@ void avtp_61883_4_net_tx(struct stream_talker *stream)
 	if (flags & MCG_FLAGS_RESET) {
 		avtp_data_header_toggle_mcr(stream->avtp_hdr);
 		stream->ts_media_prev = ts[0];
+		stream->subtype_data.iec61883.pcr.valid = false;
 	}
 
 	stream->stats.clock_rx += ts_n;
@@ -642,14 +784,16 @@ void avtp_61883_4_net_tx(struct stream_talker *stream)
 
 		desc_ts_n = 0;
 		for (j = 0; j < frames_in_packet; j++) {
+			const u8 *tsp;
+
 			offset = j * IEC_61883_4_SP_SIZE;
+			tsp = (u8 *)buf + stream->header_len + offset + (IEC_61883_4_SP_SIZE - IEC_61883_4_SP_PAYLOAD_SIZE);
 
 			if ((desc_ts_n < media_desc->ts_n) && (media_desc->avtp_ts[desc_ts_n].offset == offset)) {
-				ts_now = media_desc->avtp_ts[desc_ts_n].val;
-				stream->ts_media_prev = ts_now;
+				ts_now = avtp_61883_4_sp_ts(stream, tsp, &media_desc->avtp_ts[desc_ts_n].val);
 				desc_ts_n++;
 			} else
-				ts_now = stream->ts_media_prev;
+				ts_now = avtp_61883_4_sp_ts(stream, tsp, NULL);
 
 			*(u32 *)((char *)buf + stream->header_len + offset) = htonl(ts_now);
 
@@ -690,6 +834,8 @@ media_rx_fail:
 	/* Reset the avtp stream since it was reset by the media stack */
 	stream->media_count = 0;
 	iec_hdr->dbc = 0;
+	stream->subtype_data.iec61883.pcr.valid = false;
+	stream->subtype_data.iec61883.pcr.pid_locked = false;
 
 	return;
 
@@ -747,6 +893,50 @@ static inline void avtp_61883_6_stream_ts_reset(struct stream_talker *stream, st
 	stream->frame_with_ts = 0;
 	stream->ts_n = 0;
 	iec_hdr->dbc = 0;
+	stream->subtype_data.iec61883.last_frame_valid = false;
+}
+
+/** Conceals a 61883-6 media underrun
+ *
+ * Pads a partial media descriptor up to a full packet, with silence or by repeating the last frame
+ * (depending on the stream concealment mode), so that DBC and SYT continuity is preserved.
+ *
+ * \return none
+ * \param stream	pointer to talker stream context
+ * \param net_desc	pointer to the partial network descriptor (len only covers the media payload)
+ */
+static void avtp_61883_6_conceal(struct stream_talker *stream, struct net_tx_desc *net_desc)
+{
+	unsigned int stride = avdecc_fmt_sample_stride(&stream->format);
+	unsigned int frames = net_desc->len / stride;
+	u8 *data = NET_DATA_START(net_desc);
+	u8 *last_frame = NULL;
+	u32 silence;
+	unsigned int i, j;
+
+	if (stream->subtype_data.iec61883.conceal == AVTP_61883_6_CONCEAL_REPEAT) {
+		if (frames)
+			last_frame = data + (frames - 1) * stride;
+		else if (stream->subtype_data.iec61883.last_frame_valid)
+			last_frame = stream->subtype_data.iec61883.last_frame;
+	}
+
+	if (stream->format.u.s.subtype_u.iec61883.format_u.iec61883_6.fdf_u.fdf.evt == IEC_61883_6_FDF_EVT_AM824)
+		silence = htonl(IEC_61883_6_AM824_LABEL_MBLA << 24);
+	else
+		silence = 0;
+
+	for (i = frames; i < stream->frames_per_packet; i++) {
+		if (last_frame)
+			os_memcpy(data + i * stride, last_frame, stride);
+		else
+			for (j = 0; j < stride; j += 4)
+				*(u32 *)(data + i * stride + j) = silence;
+	}
+
+	net_desc->len = stream->frames_per_packet * stride;
+
+	stream->stats.concealed += stream->frames_per_packet - frames;
 }
 
 /** Handles transmission of 61883-6 avtp packets
@@ -820,6 +1010,19 @@ void avtp_61883_6_net_tx(struct stream_talker *stream)
 		net_desc = &media_desc->net;
 
 		partial = net_desc->flags & NET_TX_FLAGS_PARTIAL;
+
+		if (unlikely(partial) && (stream->subtype_data.iec61883.conceal != AVTP_61883_6_CONCEAL_NONE)) {
+			avtp_61883_6_conceal(stream, net_desc);
+			partial = 0;
+		}
+
+		if (stream->subtype_data.iec61883.conceal == AVTP_61883_6_CONCEAL_REPEAT) {
+			os_memcpy(stream->subtype_data.iec61883.last_frame,
+				  (u8 *)NET_DATA_START(net_desc) + net_desc->len - avdecc_fmt_sample_stride(&stream->format),
+				  avdecc_fmt_sample_stride(&stream->format));
+			stream->subtype_data.iec61883.last_frame_valid = true;
+		}
+
 		net_desc->l2_offset -= stream->header_len;
 		net_desc->len += stream->header_len;
 		net_desc->flags = NET_TX_FLAGS_TS;
@@ -18,6 +18,18 @@
 
 #include "stream.h"
 
+/* ISO/IEC 13818-1 transport stream fields used for source packet timestamping */
+#define MPEG2TS_SYNC_BYTE		0x47
+#define MPEG2TS_PCR_FREQUENCY		27000000	/* System clock frequency, in Hz */
+#define MPEG2TS_PCR_MAX_INTERVAL	100000000	/* Maximum interval between two PCRs of a program, in ns */
+
+/* 61883-6 talker underrun concealment modes (IPC_AVTP_FLAGS_CONCEAL_* stream flags) */
+#define AVTP_61883_6_CONCEAL_NONE	0	/* partial packets are sent short and the stream is restarted */
+#define AVTP_61883_6_CONCEAL_SILENCE	1	/* partial packets are padded with silence */
+#define AVTP_61883_6_CONCEAL_REPEAT	2	/* partial packets are padded by repeating the last frame */
+
+#define IEC_61883_6_AM824_LABEL_MBLA	0x40	/* AM824 multi-bit linear audio label, 24 bit samples */
+
 int listener_stream_61883_iidc_check(struct stream_listener *stream, struct avdecc_format const *format, u16 flags);
 int talker_stream_61883_iidc_check(struct stream_talker *stream, struct avdecc_format const *format,
 					struct ipc_avtp_connect *ipc);
@@ -26,6 +26,67 @@ static unsigned int avtp_tscf_prepare_header(struct stream_talker *stream)
 	return sizeof(struct avtp_stream_hdr);
 }
 
+static bool acf_pack_fits(struct stream_talker *stream, struct media_rx_desc *pdu, struct media_rx_desc *media_desc)
+{
+	s32 spread;
+
+	if ((pdu->net.len + media_desc->net.len) > stream->subtype_data.acf.pack_max)
+		return false;
+
+	if (pdu->ts_n && media_desc->ts_n) {
+		spread = media_desc->avtp_ts[0].val - pdu->avtp_ts[0].val;
+
+		if ((spread > CFG_AVTP_ACF_PACK_DEADLINE) || (spread < -CFG_AVTP_ACF_PACK_DEADLINE))
+			return false;
+	}
+
+	return true;
+}
+
+/** Aggregates consecutive ACF media descriptors into larger AVTP PDUs
+ * Each media descriptor payload is appended to the previous one, as long as the resulting PDU payload fits
+ * in pack_max bytes and, for timestamped descriptors, the presentation times stay within CFG_AVTP_ACF_PACK_DEADLINE.
+ * The packed descriptor keeps the earliest presentation time of all the messages it holds.
+ * Descriptors merged into a previous one are freed, the array is compacted in place.
+ * \return number of media descriptors (AVTP PDUs) remaining in the array
+ * \param stream	pointer to talker stream context
+ * \param desc		array of media descriptors
+ * \param n		number of media descriptors in the array
+ */
+static unsigned int acf_pack(struct stream_talker *stream, struct media_rx_desc **desc, unsigned int n)
+{
+	struct media_rx_desc *pdu = NULL, *media_desc;
+	unsigned int i, n_pdu = 0;
+
+	for (i = 0; i < n; i++) {
+		media_desc = desc[i];
+
+		if (!pdu || !acf_pack_fits(stream, pdu, media_desc)) {
+			pdu = media_desc;
+			desc[n_pdu++] = pdu;
+			continue;
+		}
+
+		/* Keep the earliest presentation time */
+		if (media_desc->ts_n) {
+			if (!pdu->ts_n) {
+				pdu->ts_n = 1;
+				pdu->avtp_ts[0].val = media_desc->avtp_ts[0].val;
+			} else if ((s32)(media_desc->avtp_ts[0].val - pdu->avtp_ts[0].val) < 0)
+				pdu->avtp_ts[0].val = media_desc->avtp_ts[0].val;
+		}
+
+		os_memcpy((u8 *)NET_DATA_START(&pdu->net) + pdu->net.len, NET_DATA_START(&media_desc->net), media_desc->net.len);
+		pdu->net.len += media_desc->net.len;
+
+		net_tx_free(&media_desc->net);
+
+		stream->stats.packed++;
+	}
+
+	return n_pdu;
+}
+
 static void acf_tscf_net_tx(struct stream_talker *stream)
 {
 	struct media_rx_desc *media_desc_array[NET_TX_BATCH], *media_desc;
@@ -62,6 +123,9 @@ static void acf_tscf_net_tx(struct stream_talker *stream)
 		}
 	}
 
+	if (stream->subtype_data.acf.pack_max)
+		n_now = acf_pack(stream, media_desc_array, n_now);
+
 	i = 0;
 	while (i < n_now) {
 		media_desc = media_desc_array[i];
@@ -155,6 +219,9 @@ static void acf_ntscf_net_tx(struct stream_talker *stream)
 
 	n_now = rc;
 
+	if (stream->subtype_data.acf.pack_max)
+		n_now = acf_pack(stream, media_desc_array, n_now);
+
 	i = 0;
 	while (i < n_now) {
 		media_desc = media_desc_array[i];
@@ -263,18 +330,20 @@ static void acf_ntscf_net_rx(struct stream_listener *stream, struct avtp_rx_desc
 			continue;
 		}
 
-		/* Check for lost packets using sequence_num */
-		if (likely(stream->stats.media_tx)) {
-			if (unlikely(hdr->sequence_num != ((stream->sequence_num + 1) & 0xff))) {
+		/* Check for lost, duplicate and reordered packets using sequence_num */
+		switch (stream_listener_seq_check(stream, hdr->sequence_num, desc[i]->desc.ts)) {
+		case STREAM_SEQ_LOST:
+			desc[i]->flags |= AVTP_PACKET_LOST;
+			break;
 
-				desc[i]->flags |= AVTP_PACKET_LOST;
-				stream->stats.pkt_lost++;
-			}
-		}
-
-		stream->sequence_num = hdr->sequence_num;
+		case STREAM_SEQ_DUPLICATE:
+		case STREAM_SEQ_REORDERED:
+			net_rx_free(&desc[i]->desc);
+			continue;
 
-		stream->pkt_received++;
+		default:
+			break;
+		}
 
 		payload_size = desc[i]->l4_len;
 
@@ -372,6 +441,11 @@ int talker_stream_acf_tscf_check(struct stream_talker *stream, struct avdecc_for
 		goto err;
 	}
 
+	if (ipc->flags & IPC_AVTP_FLAGS_ACF_PACKING)
+		stream->subtype_data.acf.pack_max = ipc->talker.max_frame_size;
+	else
+		stream->subtype_data.acf.pack_max = 0;
+
 	stream->init = talker_stream_acf_tscf_init;
 err:
 	return rc;
@@ -400,6 +474,11 @@ int talker_acf_ntscf_check(struct stream_talker *stream, struct ipc_avtp_connect
 		goto err;
 	}
 
+	if (ipc->flags & IPC_AVTP_FLAGS_ACF_PACKING)
+		stream->subtype_data.acf.pack_max = ipc->talker.max_frame_size;
+	else
+		stream->subtype_data.acf.pack_max = 0;
+
 	stream->init = talker_acf_ntscf_init;
 err:
 	return rc;
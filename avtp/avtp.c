@@ -453,6 +453,14 @@ void avtp_net_tx_event(void *data)
 	stream->net_tx(stream);
 }
 
+void avtp_net_tx_error_event(void *data)
+{
+	struct net_tx *tx = (struct net_tx *)data;
+	struct stream_talker *stream = container_of(tx, struct stream_talker, tx);
+
+	stream_talker_launch_errors(stream);
+}
+
 void avtp_stats_dump(void *avtp_ctx, struct process_stats *stats)
 {
 	struct avtp_ctx *avtp = (struct avtp_ctx *)avtp_ctx;
@@ -647,13 +655,24 @@ void avtp_stream_net_rx(struct net_rx *net_rx, struct net_rx_desc **desc, unsign
 			continue;
 		}
 
-		if (likely(stream->pkt_received)) {
-			if (unlikely(hdr->sequence_num != ((stream->sequence_num + 1) & 0xff))) {
-				avtp_stream_desc_flush(stream, avtp_desc_first, &desc_n, ts, &ts_n);
+		switch (stream_listener_seq_check(stream, hdr->sequence_num, avtp_desc->desc.ts)) {
+		case STREAM_SEQ_LOST:
+			avtp_stream_desc_flush(stream, avtp_desc_first, &desc_n, ts, &ts_n);
 
-				avtp_desc->flags |= AVTP_PACKET_LOST;
-				stream->stats.pkt_lost++;
-			}
+			avtp_desc->flags |= AVTP_PACKET_LOST;
+			break;
+
+		case STREAM_SEQ_DUPLICATE:
+		case STREAM_SEQ_REORDERED:
+			avtp_stream_desc_flush(stream, avtp_desc_first, &desc_n, ts, &ts_n);
+
+			net_rx_free(&avtp_desc->desc);
+
+			/* skip this descriptor */
+			continue;
+
+		default:
+			break;
 		}
 
 		if (unlikely(hdr->mr != stream->mr)) {
@@ -664,10 +683,6 @@ void avtp_stream_net_rx(struct net_rx *net_rx, struct net_rx_desc **desc, unsign
 			stream->stats.mr++;
 		}
 
-		stream->sequence_num = hdr->sequence_num;
-
-		stream->pkt_received++;
-
 #ifdef CFG_AVTP_1722A
 		avtp_desc->format_specific_data_2 = hdr->format_specific_data_2;
 #endif
@@ -680,6 +695,9 @@ void avtp_stream_net_rx(struct net_rx *net_rx, struct net_rx_desc **desc, unsign
 		if (likely(hdr->tv)) {
 			avtp_desc->avtp_timestamp = ntohl(hdr->avtp_timestamp);
 
+			if (likely(!hdr->tu))
+				stream_listener_margin_update(stream, avtp_desc->desc.ts, avtp_desc->avtp_timestamp);
+
 			if (stream->source) {
 				ts[ts_n].ts_nsec = avtp_desc->avtp_timestamp;
 				ts[ts_n].flags = avtp_desc->flags;
@@ -30,6 +30,7 @@ int avtp_exit(void *avtp_ctx);
 void avtp_stats_dump(void *avtp_ctx, struct process_stats *stats);
 void avtp_media_event(void *data);
 void avtp_net_tx_event(void *data);
+void avtp_net_tx_error_event(void *data);
 void stats_ipc_rx(struct ipc_rx const *rx, struct ipc_desc *desc);
 void avtp_ipc_rx(void *avtp_ctx);
 void avtp_stream_free(void *avtp_ctx, u64 current_time);
@@ -58,9 +58,7 @@ static struct clock_source *clock_domain_find_source(struct clock_domain *domain
 
 int __clock_domain_update_source(struct clock_domain *domain, struct clock_source *new_source, void *data)
 {
-	struct avtp_ctx *avtp = container_of(domain, struct avtp_ctx, domain[domain->id]);
-	struct avtp_port *port;
-	int i;
+	struct list_head *entry;
 
 	/* Setting a null source is not supported. */
 	if (!new_source) {
@@ -68,19 +66,11 @@ int __clock_domain_update_source(struct clock_domain *domain, struct clock_sourc
 		goto err;
 	}
 
-	/* Look up all talker streams and disable clock generation  */
-	for (i = 0; i < avtp->port_max; i++) {
-		struct list_head *entry;
-
-		port = &avtp->port[i];
-
-		for (entry = list_first(&port->talker); entry != &port->talker; entry = list_next(entry)) {
-			struct stream_talker *stream = container_of(entry, struct stream_talker, common.list);
+	/* Disable clock generation for all talkers in the domain (if not previously disabled) */
+	for (entry = list_first(&domain->talkers); entry != &domain->talkers; entry = list_next(entry)) {
+		struct stream_talker *stream = container_of(entry, struct stream_talker, domain_list);
 
-			/* For talkers in the specified domain, disable clock consumer (if not previously disabled). */
-			if (stream->domain == domain)
-				stream_clock_consumer_disable(stream);
-		}
+		stream_clock_consumer_disable(stream);
 	}
 
 	/* Setup domain with new source */
@@ -88,24 +78,16 @@ int __clock_domain_update_source(struct clock_domain *domain, struct clock_sourc
 		goto err;
 
 	/* Start with new source */
-	for (i = 0; i < avtp->port_max; i++) {
-		struct list_head *entry;
-
-		port = &avtp->port[i];
-
-		for (entry = list_first(&port->talker); entry != &port->talker; entry = list_next(entry)) {
-			struct stream_talker *stream = container_of(entry, struct stream_talker, common.list);
+	for (entry = list_first(&domain->talkers); entry != &domain->talkers; entry = list_next(entry)) {
+		struct stream_talker *stream = container_of(entry, struct stream_talker, domain_list);
 
-			/* Enable clock consumer for all talkers in the domain. The loop (with consumer disable) above guarantees
-			 * that all talkers are disabled at this stage.
-			 */
-			if (stream->domain == domain) {
-				if (stream_clock_consumer_enable(stream) < 0)
-					goto err;
+		/* Enable clock consumer for all talkers in the domain. The loop (with consumer disable) above guarantees
+		 * that all talkers are disabled at this stage.
+		 */
+		if (stream_clock_consumer_enable(stream) < 0)
+			goto err;
 
-				stream_media_clock_reset(stream);
-			}
-		}
+		stream_media_clock_reset(stream);
 	}
 
 	return 0;
@@ -114,6 +96,206 @@ err:
 	return -1;
 }
 
+static unsigned int clock_domain_source_uses_hw_sync(struct clock_domain *domain, struct clock_source *source)
+{
+	switch (source->grid.producer.type) {
+	case GRID_PRODUCER_STREAM:
+		return 1;
+
+	case GRID_PRODUCER_PTP:
+		return domain->hw_sync != NULL;
+
+	default:
+		return 0;
+	}
+}
+
+static unsigned int clock_domain_has_sched_streams(struct clock_domain *domain)
+{
+	int i;
+
+	for (i = 0; i < CFG_SR_CLASS_MAX; i++)
+		if (!list_empty(&domain->sched_streams[i]))
+			return 1;
+
+	return 0;
+}
+
+/** Cancels a pending hitless source switch, if any.
+ * The pending source is released without touching the domain state, the current source keeps running.
+ * \return	none
+ * \param domain	pointer to clock domain
+ */
+void clock_domain_switch_cancel(struct clock_domain *domain)
+{
+	struct clock_source *source = domain->pending_source;
+
+	if (!source)
+		return;
+
+	domain->pending_source = NULL;
+	domain->pending_data = NULL;
+
+	clock_source_release(source);
+	clock_domain_remove_grid(&source->grid);
+
+	os_log(LOG_INFO, "domain(%p): %d => pending source(%p) cancelled\n", domain, domain->id, source);
+}
+
+/** Starts a hitless (make-before-break) switch to a new source.
+ * The new source is opened while the current one keeps feeding all the domain grids. Once the new source is locked
+ * (see clock_domain_switch_check()), the multiplier grids are moved to it, phase aligned, so that talkers
+ * see no grid reset.
+ * \return	0 if the switch was started, -1 if a switch with reset is required
+ * \param domain	pointer to clock domain
+ * \param source	pointer to new clock source
+ * \param data		source specific data (stream listener for a stream source)
+ */
+static int clock_domain_switch_source(struct clock_domain *domain, struct clock_source *source, void *data)
+{
+	struct clock_grid *grid = &source->grid;
+
+	clock_domain_switch_cancel(domain);
+
+	if (!domain->source || (domain->source == source))
+		return -1;
+
+	/* Without talkers being scheduled, there is nothing to keep running (and nothing to check the new source lock) */
+	if (!clock_domain_has_sched_streams(domain))
+		return -1;
+
+	/* Both sources need to run at the same time */
+	if (clock_domain_source_uses_hw_sync(domain, domain->source) && clock_domain_source_uses_hw_sync(domain, source))
+		return -1;
+
+	if ((source->grid.producer.type == GRID_PRODUCER_STREAM) && !data)
+		return -1;
+
+	if (((u64)grid->nominal_freq_p * domain->source->grid.nominal_freq_q) != ((u64)grid->nominal_freq_q * domain->source->grid.nominal_freq_p))
+		return -1;
+
+	if (os_clock_gettime64(avtp_to_clock(CFG_DEFAULT_PORT_ID), &domain->pending_time) < 0)
+		return -1;
+
+	clock_domain_add_grid(domain, grid);
+	if (clock_source_open(source, data) < 0) {
+		clock_domain_remove_grid(grid);
+		return -1;
+	}
+
+	domain->pending_source = source;
+	domain->pending_data = data;
+
+	os_log(LOG_INFO, "domain(%p): %d => pending source grid(%p), %s\n",
+	       domain, domain->id, source, clock_grid_producer_type2string(grid->producer.type));
+
+	return 0;
+}
+
+static unsigned int clock_domain_source_locked(struct clock_source *source)
+{
+	struct clock_grid *grid = &source->grid;
+	struct media_clock_rec *rec;
+	unsigned int reset;
+
+	switch (grid->producer.type) {
+	case GRID_PRODUCER_HW:
+	case GRID_PRODUCER_PTP:
+		/* Not the domain source yet, so not updated by the domain scheduler */
+		clock_grid_ts_update(grid, 0, &reset);
+		break;
+
+	case GRID_PRODUCER_STREAM:
+		rec = grid->producer.u.stream.rec;
+		if (!rec || (rec->state != RUNNING_LOCKED))
+			return 0;
+
+		break;
+
+	default:
+		return 0;
+	}
+
+	return clock_grid_start_count(grid) >= grid->max_start_count;
+}
+
+/** Completes a hitless source switch, once the new source is locked.
+ * Called from the domain scheduler, so that grids and wake-up timers are only updated from the talkers context.
+ * \return	none
+ * \param domain	pointer to clock domain
+ */
+static void clock_domain_switch_check(struct clock_domain *domain)
+{
+	struct clock_source *source = domain->pending_source;
+	struct clock_source *source_prev = domain->source;
+	struct clock_scheduling_params *sched_params;
+	struct list_head *entry, *next;
+	struct clock_grid *grid;
+	u64 now;
+	int i;
+
+	if (!clock_domain_source_locked(source)) {
+		if (os_clock_gettime64(avtp_to_clock(CFG_DEFAULT_PORT_ID), &now) < 0)
+			return;
+
+		if ((now - domain->pending_time) > ((u64)CLOCK_DOMAIN_SWITCH_TIMEOUT_MS * NSECS_PER_MS)) {
+			void *data = domain->pending_data;
+
+			os_log(LOG_ERR, "domain(%p): %d => pending source(%p) not locked after %u ms, switching with reset\n",
+			       domain, domain->id, source, CLOCK_DOMAIN_SWITCH_TIMEOUT_MS);
+
+			clock_domain_switch_cancel(domain);
+			__clock_domain_update_source(domain, source, data);
+		}
+
+		return;
+	}
+
+	/* Move all multiplier grids to the new source grid */
+	for (entry = list_first(&domain->grids); next = list_next(entry), entry != &domain->grids; entry = next) {
+		grid = container_of(entry, struct clock_grid, list);
+
+		if ((grid->producer.type == GRID_PRODUCER_MULT) && (grid->producer.u.mult.source.grid == &source_prev->grid))
+			if (clock_grid_consumer_switch(&grid->producer.u.mult.source, &source->grid) < 0)
+				os_log(LOG_ERR, "domain(%p): %d => grid(%p) could not switch to source(%p)\n", domain, domain->id, grid, source);
+	}
+
+	domain->source = source;
+	domain->pending_source = NULL;
+	domain->pending_data = NULL;
+
+	/* Move the talkers wake-up to the new source */
+	for (i = 0; i < CFG_SR_CLASS_MAX; i++) {
+		if (list_empty(&domain->sched_streams[i]))
+			continue;
+
+		sched_params = &source_prev->sched_params[i];
+
+		os_timer_stop(&source_prev->timer[i]);
+
+		if (os_timer_start(&source->timer[i], 0, sched_params->wake_freq_p, sched_params->wake_freq_q, 0) < 0)
+			os_log(LOG_ERR, "domain(%p): %d => source(%p) could not start wake-up timer\n", domain, domain->id, source);
+
+		source->sched_params[i] = *sched_params;
+	}
+
+	for (entry = list_first(&domain->talkers); entry != &domain->talkers; entry = list_next(entry)) {
+		struct stream_talker *stream = container_of(entry, struct stream_talker, domain_list);
+
+		stream_clock_consumer_switch_source(stream);
+	}
+
+	clock_source_release(source_prev);
+	clock_domain_remove_grid(&source_prev->grid);
+
+	/* New source is locked */
+	clock_domain_clear_state(domain, CLOCK_DOMAIN_STATE_FREE_WHEELING);
+	clock_domain_set_state(domain, CLOCK_DOMAIN_STATE_LOCKED);
+
+	os_log(LOG_INFO, "domain(%p): %d => hitless switch from source(%p) to source grid(%p), %s\n",
+	       domain, domain->id, source_prev, source, clock_grid_producer_type2string(source->grid.producer.type));
+}
+
 static int clock_domain_update_source(struct clock_domain *domain, struct clock_source *new_source)
 {
 	struct avtp_ctx *avtp = container_of(domain, struct avtp_ctx, domain[domain->id]);
@@ -139,6 +321,10 @@ static int clock_domain_update_source(struct clock_domain *domain, struct clock_
 	 * but domain needs to be updated with new source
 	 */
 
+	/* Try to switch without disturbing the talkers first */
+	if (!clock_domain_switch_source(domain, new_source, stream_source))
+		return 0;
+
 	return __clock_domain_update_source(domain, new_source, stream_source);
 }
 
@@ -232,8 +418,11 @@ static int clock_domain_set_source_hdlr(struct clock_domain *domain, struct avtp
 		goto err;
 
 	if ((new_source == domain->source) &&
-			(domain->source_type != GENAVB_CLOCK_SOURCE_TYPE_INPUT_STREAM || !os_memcmp(domain->stream_id, set_source->stream_id, 8)))
+			(domain->source_type != GENAVB_CLOCK_SOURCE_TYPE_INPUT_STREAM || !os_memcmp(domain->stream_id, set_source->stream_id, 8))) {
+		/* Back to the current source, drop any pending switch */
+		clock_domain_switch_cancel(domain);
 		return 0;
+	}
 
 	/* Save domain source info */
 	domain->source_type = set_source->source_type;
@@ -481,6 +670,28 @@ void clock_domain_stats_dump(struct clock_domain *domain, struct ipc_tx *tx)
 	}
 }
 
+/** Updates the domain source grid and then all the multiplier grids derived from it.
+ * This is the only context producing the domain grids, consumers (see clock_grid_consumer_get_ts())
+ * only read them.
+ * \return	none
+ * \param domain	pointer to clock domain
+ */
+void clock_domain_grids_update(struct clock_domain *domain)
+{
+	struct list_head *entry;
+	struct clock_grid *grid;
+	unsigned int reset;
+
+	clock_grid_ts_update(&domain->source->grid, domain->ts_update_n, &reset);
+
+	for (entry = list_first(&domain->grids); entry != &domain->grids; entry = list_next(entry)) {
+		grid = container_of(entry, struct clock_grid, list);
+
+		/* Generate all the timestamps the source grid allows, bounded to the grid valid window */
+		clock_grid_ts_update(grid, grid->max_valid_count, &reset);
+	}
+}
+
 /** User clock generation wake-up scheduler.
  * This scheduler is woken-up by the lower-level HW clock, updates HW user clocks wake-up counters
  * and if expired calls the network transmit callback associated to the stream.
@@ -491,15 +702,17 @@ void clock_domain_sched(struct clock_domain *domain, unsigned int prio)
 {
 	struct list_head *entry, *next;
 	struct stream_talker *stream;
-	unsigned int reset;
 
-	clock_grid_ts_update(&domain->source->grid, domain->ts_update_n, &reset);
+	clock_domain_grids_update(domain);
 
 	for (entry = list_first(&domain->sched_streams[prio]); next = list_next(entry), entry != &domain->sched_streams[prio]; entry = next) {
 		stream = container_of(entry, struct stream_talker, consumer.list);
 
 		stream_net_tx_handler(stream);
 	}
+
+	if (domain->pending_source)
+		clock_domain_switch_check(domain);
 }
 
 void clock_domain_exit_consumer_wakeup(struct clock_grid_consumer *consumer)
@@ -636,6 +849,15 @@ int clock_domain_init_consumer(struct clock_domain *domain, struct clock_grid_co
 }
 
 
+/** Looks up a multiplier grid of the domain, for a new consumer.
+ * Source grids (current and pending) are never returned, even if they have the requested frequency: only
+ * multiplier grids are moved to the new source on a hitless switch (see clock_domain_switch_check()), a consumer
+ * attached to the previous source grid would be left without timestamps once that source is released.
+ * \return	pointer to the grid, NULL if there is none with the requested frequency
+ * \param domain	pointer to clock domain
+ * \param nominal_freq_p grid nominal frequency (in the form p/q Hz)
+ * \param nominal_freq_q grid nominal frequency
+ */
 struct clock_grid *clock_domain_find_grid(struct clock_domain *domain, u32 nominal_freq_p, u32 nominal_freq_q)
 {
 	struct list_head *entry, *next;
@@ -644,6 +866,9 @@ struct clock_grid *clock_domain_find_grid(struct clock_domain *domain, u32 nomin
 	for (entry = list_first(&domain->grids); next = list_next(entry), entry != &domain->grids; entry = next) {
 		grid = container_of(entry, struct clock_grid, list);
 
+		if (grid->producer.type != GRID_PRODUCER_MULT)
+			continue;
+
 		if (((u64)grid->nominal_freq_p * nominal_freq_q) == ((u64)grid->nominal_freq_q * nominal_freq_p))
 			return grid;
 	}
@@ -681,6 +906,8 @@ unsigned int clock_domain_is_locked(struct clock_domain *domain)
 
 int clock_domain_set_source(struct clock_domain *domain, struct clock_source *source, void *data)
 {
+	clock_domain_switch_cancel(domain);
+
 	/* Close previous source */
 	if (domain->source) {
 		clock_source_close(domain->source);
@@ -706,32 +933,43 @@ int clock_domain_set_source(struct clock_domain *domain, struct clock_source *so
 	return 0;
 }
 
-int clock_domain_has_stream(struct avtp_ctx *avtp, struct clock_domain *domain)
+/** Adds a talker stream to the domain stream index
+ * \return none
+ * \param domain	pointer to clock domain
+ * \param stream	pointer to talker stream
+ */
+void clock_domain_add_talker(struct clock_domain *domain, struct stream_talker *stream)
 {
-	struct stream_talker *talker;
-	struct stream_listener *listener;
-	struct list_head *entry;
-	struct avtp_port *port;
-	int i;
-
-	for (i = 0; i < avtp->port_max; i++) {
-		port = &avtp->port[i];
+	list_add_tail(&domain->talkers, &stream->domain_list);
+	domain->talker_count++;
+}
 
-		for (entry = list_first(&port->talker); entry != &port->talker; entry = list_next(entry)) {
-			talker = container_of(entry, struct stream_talker, common.list);
+void clock_domain_remove_talker(struct clock_domain *domain, struct stream_talker *stream)
+{
+	list_del(&stream->domain_list);
+	domain->talker_count--;
+}
 
-			if (talker->domain == domain)
-				return 1;
-		}
+/** Adds a listener stream to the domain stream index
+ * \return none
+ * \param domain	pointer to clock domain
+ * \param stream	pointer to listener stream
+ */
+void clock_domain_add_listener(struct clock_domain *domain, struct stream_listener *stream)
+{
+	list_add_tail(&domain->listeners, &stream->domain_list);
+	domain->listener_count++;
+}
 
-		for (entry = list_first(&port->listener); entry != &port->listener; entry = list_next(entry)) {
-			listener = container_of(entry, struct stream_listener, common.list);
+void clock_domain_remove_listener(struct clock_domain *domain, struct stream_listener *stream)
+{
+	list_del(&stream->domain_list);
+	domain->listener_count--;
+}
 
-			if (listener->domain == domain)
-				return 1;
-		}
-	}
-	return 0;
+unsigned int clock_domain_has_stream(struct clock_domain *domain)
+{
+	return domain->talker_count || domain->listener_count;
 }
 
 struct clock_domain *clock_domain_get(struct avtp_ctx *avtp, unsigned int id)
@@ -775,11 +1013,17 @@ __init void clock_domain_init(struct clock_domain *domain, unsigned int id, unsi
 	int i;
 
 	domain->id = id;
+	domain->pending_source = NULL;
 	list_head_init(&domain->grids);
 
 	for (i = 0; i < CFG_SR_CLASS_MAX; i++)
 		list_head_init(&domain->sched_streams[i]);
 
+	list_head_init(&domain->talkers);
+	list_head_init(&domain->listeners);
+	domain->talker_count = 0;
+	domain->listener_count = 0;
+
 	clock_source_init(&domain->stream_source, GRID_PRODUCER_STREAM, id, priv);
 	clock_source_init(&domain->hw_source, GRID_PRODUCER_HW, id, priv);
 
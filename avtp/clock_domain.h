@@ -22,6 +22,8 @@
 #include "clock_source.h"
 
 struct avtp_ctx;
+struct stream_talker;
+struct stream_listener;
 
 struct clock_domain {
 	unsigned int id;
@@ -36,8 +38,15 @@ struct clock_domain {
 	unsigned int locked_count;
 	unsigned int ts_update_n;
 	struct clock_source *source;
+	struct clock_source *pending_source;		/**< New source being locked, before a hitless switch (see clock_domain_switch_source()) */
+	void *pending_data;
+	u64 pending_time;				/**< Time the new source was opened, in ns */
 	struct list_head grids;				/**< List of existing grids for the clock_domain. Each grid may be used by one or more consumers. */
 	struct list_head sched_streams[CFG_SR_CLASS_MAX];		/**< FIXME WAKEUP list of consumer streams to schedule for this domain (will be removed when switching to media and net event wake-up). */
+	struct list_head talkers;			/**< List of talker streams in the domain (all ports) */
+	struct list_head listeners;			/**< List of listener streams in the domain (all ports) */
+	unsigned int talker_count;
+	unsigned int listener_count;
 	struct media_clock_rec *hw_sync;
 	struct clock_source hw_source;
 	struct clock_source stream_source;
@@ -45,6 +54,8 @@ struct clock_domain {
 
 #define CLOCK_DOMAIN_SOURCE_FLAG_USER	(1 << 0)
 
+#define CLOCK_DOMAIN_SWITCH_TIMEOUT_MS	5000	/* Maximum time for a new source to lock, before falling back to a source switch with reset */
+
 typedef enum {
 	CLOCK_DOMAIN_STATE_LOCKED = (1 << 0),
 	CLOCK_DOMAIN_STATE_FREE_WHEELING = (1 << 1)
@@ -61,6 +72,7 @@ struct ipc_avtp_clock_domain_stats {
 void clock_domain_stats_print(struct ipc_avtp_clock_domain_stats *msg);
 void clock_domain_ipc_rx_media_stack(struct ipc_rx const *rx, struct ipc_desc *desc);
 int clock_domain_set_source(struct clock_domain *domain, struct clock_source *source, void *data);
+void clock_domain_switch_cancel(struct clock_domain *domain);
 int clock_domain_set_wakeup(struct clock_domain *domain, unsigned int freq_p, unsigned int freq_q);
 void clock_domain_clear_state(struct clock_domain *domain, clock_domain_state_t state);
 void clock_domain_set_state(struct clock_domain *domain, clock_domain_state_t state);
@@ -70,6 +82,7 @@ unsigned int clock_domain_is_source_stream(struct clock_domain *domain, void *st
 int __clock_domain_update_source(struct clock_domain *domain, struct clock_source *new_source, void *data);
 int clock_domain_set_source_legacy(struct clock_domain *domain, struct avtp_ctx *avtp, struct ipc_avtp_connect *ipc);
 void clock_domain_stats_dump(struct clock_domain *domain, struct ipc_tx *tx);
+void clock_domain_grids_update(struct clock_domain *domain);
 void clock_domain_sched(struct clock_domain *domain, unsigned int prio);
 int clock_domain_init_consumer(struct clock_domain *domain, struct clock_grid_consumer *consumer, unsigned int offset, u32 nominal_freq_p, u32 nominal_freq_q, unsigned int alignment, unsigned int prio);
 void clock_domain_exit_consumer(struct clock_grid_consumer *consumer);
@@ -78,6 +91,11 @@ void clock_domain_exit_consumer_wakeup(struct clock_grid_consumer *consumer);
 struct clock_grid *clock_domain_find_grid(struct clock_domain *domain, u32 nominal_freq_p, u32 nominal_freq_q);
 void clock_domain_add_grid(struct clock_domain *domain, struct clock_grid *grid);
 void clock_domain_remove_grid(struct clock_grid *grid);
+void clock_domain_add_talker(struct clock_domain *domain, struct stream_talker *stream);
+void clock_domain_remove_talker(struct clock_domain *domain, struct stream_talker *stream);
+void clock_domain_add_listener(struct clock_domain *domain, struct stream_listener *stream);
+void clock_domain_remove_listener(struct clock_domain *domain, struct stream_listener *stream);
+unsigned int clock_domain_has_stream(struct clock_domain *domain);
 void clock_domain_init(struct clock_domain *domain, unsigned int id, unsigned long priv);
 void clock_domain_exit(struct clock_domain *domain);
 
@@ -45,6 +45,10 @@ struct clock_grid_consumer {
 	u32 prev_period;	/* initialized with nominal period, updated each time a timestamp is consumed */
 	u32 init;		/* flag that indicates if prev_ts is valid */
 	u32 count;
+	u32 reset_count;	/* last grid reset_count seen by the consumer */
+	u32 decim_p;		/* decimation, only decim_p out of every decim_q grid timestamps are returned */
+	u32 decim_q;
+	u32 decim_acc;		/* decimation phase, the next grid timestamp is returned if less than decim_p */
 	unsigned int prio;
 	struct list_head list;		/* FIXME WAKEUP Used for scheduling. Likely to be removed when switching to media/net event wake-up scheme. */
 	struct clock_grid_consumer_stats {
@@ -93,6 +97,8 @@ struct clock_grid_producer {
 
 #define CLOCK_GRID_FLAGS_STATIC	(1 << 0)
 
+#define CLOCK_GRID_CACHE_LINE_SIZE	64
+
 struct clock_grid {
 	struct list_head list;
 	unsigned int flags;
@@ -107,11 +113,19 @@ struct clock_grid {
 
 	unsigned int ring_size; 		/**< Number of timestamps in the ring buffer */
 	u32 *ts; /* switch to u64 in the future */
-	u32 valid_count;
-	u32 count;
+
+	/* Producer published state, polled by all the consumers, on its own cache line so that it is not
+	 * invalidated by producer private state updates. Grids are embedded in the avtp context or allocated
+	 * with os_malloc(), so they only have the malloc alignment: the alignment attributes keep at least
+	 * 48 bytes between the published state and the other members, which is enough for any grid aligned
+	 * on 16 bytes.
+	 */
+	u32 count __attribute__((aligned(CLOCK_GRID_CACHE_LINE_SIZE)));	/**< Only updated through clock_grid_publish() */
 	u32 write_index;
+	u32 valid_count;
+	u32 reset_count;			/**< Incremented by the producer each time the grid timestamps are reset */
 
-	void (*ts_update)(struct clock_grid *grid, unsigned int requested, unsigned int *reset);
+	void (*ts_update)(struct clock_grid *grid, unsigned int requested, unsigned int *reset) __attribute__((aligned(CLOCK_GRID_CACHE_LINE_SIZE)));
 	struct clock_grid_producer producer;  /* no need for a pointer, since a given producer should always produce the same grid. */
 	struct clock_grid_stats {
 		unsigned int err_period;
@@ -127,6 +141,22 @@ struct ipc_avtp_clock_grid_stats {
 	struct clock_grid_stats stats;
 };
 
+/* The grid ring is single producer/multiple consumers. The producer (the domain scheduler for source and
+ * multiplier grids, see clock_domain_grids_update(), or the listener stream for stream grids) writes timestamps
+ * to the ring and then publishes the new write index with release semantics. Consumers load the write index with
+ * acquire semantics, so that all timestamps up to it are visible, and only update their own read index.
+ */
+static inline void clock_grid_publish(struct clock_grid *grid, u32 write_index, u32 count)
+{
+	__atomic_store_n(&grid->count, count, __ATOMIC_RELAXED);
+	__atomic_store_n(&grid->write_index, write_index, __ATOMIC_RELEASE);
+}
+
+static inline u32 clock_grid_write_index(struct clock_grid *grid)
+{
+	return __atomic_load_n(&grid->write_index, __ATOMIC_ACQUIRE);
+}
+
 struct clock_grid *clock_grid_alloc(void);
 void clock_grid_free(struct clock_grid *grid);
 
@@ -99,8 +99,7 @@ static void clock_source_hw_update(struct clock_grid *grid, unsigned int request
 		}
 	}
 
-	grid->write_index = w_idx;
-	grid->count = count + source->extra_count;
+	clock_grid_publish(grid, w_idx, count + source->extra_count);
 
 	if (&grid->domain->source->grid == grid)
 		clock_domain_set_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
@@ -285,27 +284,51 @@ int clock_source_open(struct clock_source *source, void *data)
 	return rc;
 }
 
-void clock_source_close(struct clock_source *source)
+/** Closes the source producer, without updating the domain state.
+ * Used for sources which are not (or no longer) the domain source, during a hitless source switch.
+ * \param source	pointer to clock source
+ */
+void clock_source_release(struct clock_source *source)
 {
-	struct clock_grid *grid = &source->grid;
-
-	switch (grid->producer.type) {
+	switch (source->grid.producer.type) {
 	case GRID_PRODUCER_STREAM:
 		clock_source_stream_close(source);
-
-		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
-		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_FREE_WHEELING);
 		break;
 
 	case GRID_PRODUCER_HW:
 		clock_source_hw_close(source);
-
-		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
 		break;
 
 	case GRID_PRODUCER_PTP:
 		clock_source_ptp_close(source);
+		break;
+
+	default:
+		break;
+	}
+}
 
+/** Closes the source producer.
+ * The domain state is only reset if the source is the domain source.
+ * \param source	pointer to clock source
+ */
+void clock_source_close(struct clock_source *source)
+{
+	struct clock_grid *grid = &source->grid;
+
+	clock_source_release(source);
+
+	if (!grid->domain || (grid->domain->source != source))
+		return;
+
+	switch (grid->producer.type) {
+	case GRID_PRODUCER_STREAM:
+		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
+		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_FREE_WHEELING);
+		break;
+
+	case GRID_PRODUCER_HW:
+	case GRID_PRODUCER_PTP:
 		clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
 		break;
 
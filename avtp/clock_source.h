@@ -53,6 +53,7 @@ int clock_source_ready(struct clock_source *source);
 void clock_source_exit(struct clock_source *source);
 int clock_source_open(struct clock_source *source, void *data);
 void clock_source_close(struct clock_source *source);
+void clock_source_release(struct clock_source *source);
 
 
 #endif /* _CLOCK_SOURCE_H_ */
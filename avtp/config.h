@@ -19,6 +19,8 @@
 #define avtp_CFG_LOG	CFG_LOG
 
 #define CFG_AVTP_MAX_TIMERS	2	/* one per CRF stream */
+#define CFG_AVTP_CRF_PERIOD_WINDOW	64	/* Number of received CRF timestamps used to fit the listener period */
+#define CFG_AVTP_TALKER_LAUNCH_SAMPLING	16	/* Talker launch time deviation sampling, one transmit batch out of N (0 = disabled) */
 
 #define CFG_AVTP_61883_6_MAX_CHANNELS	32
 #define CFG_AVTP_AAF_PCM_MAX_CHANNELS	32
@@ -26,4 +28,6 @@
 #define CFG_AVTP_AAF_AES3_MAX_STREAMS	10
 #define CFG_AVTP_AAF_AES3_MAX_FRAMES	256  /* Matches 1 packet per interval for SR Class C at 192KHz and SR Class D at 176.4KHz */
 
+#define CFG_AVTP_ACF_PACK_DEADLINE	125000	/* Maximum presentation time spread (ns) of the ACF messages packed in a single TSCF PDU */
+
 #endif /* _AVTP_CFG_H_ */
@@ -55,7 +55,7 @@ static void crf_net_tx(struct stream_talker *stream)
 	unsigned int ts_n, ts_batch;
 	unsigned int flags;
 	struct net_tx_desc *net_tx_desc_array[CRF_TX_BATCH], *net_desc;
-	u32 ts[CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX * 2];
+	u32 ts[CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX];
 	int n_now;
 	void *buf;
 	int rc;
@@ -78,11 +78,11 @@ static void crf_net_tx(struct stream_talker *stream)
 
 	stream->stats.media_rx += rc;
 
-	ts_batch = rc * crf_fmt->timestamps_per_pdu * 2;
+	ts_batch = rc * crf_fmt->timestamps_per_pdu;
 
-	if (ts_batch > (CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX * 2)) {
-		os_log(LOG_ERR, "stream(%p) Unexpected number of timestamps needed(%u), clamping down to %u\n", stream, ts_batch, CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX * 2);
-		ts_batch = CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX * 2;
+	if (ts_batch > (CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX)) {
+		os_log(LOG_ERR, "stream(%p) Unexpected number of timestamps needed(%u), clamping down to %u\n", stream, ts_batch, CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX);
+		ts_batch = CRF_TX_BATCH * CRF_TIMESTAMPS_PER_PDU_MAX;
 	}
 
 	if (stream_domain_phase_change(stream))
@@ -147,9 +147,7 @@ static void crf_net_tx(struct stream_talker *stream)
 
 			stream->ts_last = ts_now;
 
-			/* Skip every other timestamp, dividing the frequency by 2,
-			 * workaround for minimum generator frequency */
-			ts_n += 2;
+			ts_n++;
 		}
 
 		i++;
@@ -175,6 +173,9 @@ void crf_os_timer_handler(struct os_timer *t, int count)
 {
 	struct stream_talker *stream = container_of(t, struct stream_talker, subtype_data.crf.t);
 
+	/* CRF talkers are not scheduled by the domain, update the grids before consuming them */
+	clock_domain_grids_update(stream->domain);
+
 	stream_net_tx_handler(stream);
 }
 
@@ -200,6 +201,95 @@ static unsigned int crf_prepare_header(struct avtp_crf_hdr *hdr, const struct av
 	return sizeof(struct avtp_crf_hdr);
 }
 
+static void crf_period_window_reset(struct crf_subtype_data *crf)
+{
+	crf->window.n = 0;
+	crf->window.write = 0;
+}
+
+/** Adds a received timestamp to the period fit window
+ * The timestamp is unwrapped (relatively to the previous one in the window), so the window must not span
+ * more than 2^31 ns between two consecutive entries. The window is also limited to 2 * CFG_AVTP_CRF_PERIOD_WINDOW periods,
+ * which keeps the fit sums within 64 bits.
+ * \return none
+ * \param crf	pointer to CRF listener context
+ * \param x	timestamp index, in periods
+ * \param ts	received timestamp, in ns
+ */
+static void crf_period_window_add(struct crf_subtype_data *crf, u32 x, u32 ts)
+{
+	unsigned int last;
+	u64 y;
+
+	if (crf->window.n) {
+		last = (crf->window.write + CFG_AVTP_CRF_PERIOD_WINDOW - 1) % CFG_AVTP_CRF_PERIOD_WINDOW;
+
+		if ((u64)(x - crf->window.x[last]) * crf->period >= (1ULL << 31))
+			crf_period_window_reset(crf);
+	}
+
+	if (crf->window.n) {
+		y = crf->window.y[last] + (u32)(ts - (u32)crf->window.y[last]);
+
+		/* Drop the oldest entries, to bound the window time span */
+		while (crf->window.n && ((x - crf->window.x[(crf->window.write + CFG_AVTP_CRF_PERIOD_WINDOW - crf->window.n) % CFG_AVTP_CRF_PERIOD_WINDOW]) >= 2 * CFG_AVTP_CRF_PERIOD_WINDOW))
+			crf->window.n--;
+	} else
+		y = ts;
+
+	crf->window.x[crf->window.write] = x;
+	crf->window.y[crf->window.write] = y;
+	crf->window.write = (crf->window.write + 1) % CFG_AVTP_CRF_PERIOD_WINDOW;
+
+	if (crf->window.n < CFG_AVTP_CRF_PERIOD_WINDOW)
+		crf->window.n++;
+}
+
+/** Updates the period estimate with a least-squares fit of the received timestamps window
+ * The slope of the fitted line (timestamp vs index) is the period, computed in Q32.32 fixed point.
+ * \return none
+ * \param crf	pointer to CRF listener context
+ */
+static void crf_period_fit(struct crf_subtype_data *crf)
+{
+	unsigned int first, i, k;
+	s64 n, x, y, sx = 0, sy = 0, sxx = 0, sxy = 0;
+	s64 num, den;
+
+	n = crf->window.n;
+	if (n < 2)
+		return;
+
+	first = (crf->window.write + CFG_AVTP_CRF_PERIOD_WINDOW - n) % CFG_AVTP_CRF_PERIOD_WINDOW;
+
+	for (i = 0; i < n; i++) {
+		k = (first + i) % CFG_AVTP_CRF_PERIOD_WINDOW;
+
+		x = crf->window.x[k] - crf->window.x[first];
+		y = crf->window.y[k] - crf->window.y[first];
+
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	num = n * sxy - sx * sy;
+	den = n * sxx - sx * sx;
+
+	if ((num <= 0) || (den <= 0))
+		return;
+
+	/* Keep den below 2^32, so that the division remainder can be scaled to Q32 */
+	while (den >> 32) {
+		num >>= 1;
+		den >>= 1;
+	}
+
+	crf->period_q32 = ((u64)(num / den) << 32) + (((u64)(num % den) << 32) / den);
+	crf->period = (crf->period_q32 + (1ULL << 31)) >> 32;
+}
+
 static int crf_measure_period(struct stream_listener *stream, struct timestamp *ts, unsigned *ts_n)
 {
 	struct crf_subtype_data *crf = &stream->subtype_data.crf;
@@ -215,20 +305,20 @@ static int crf_measure_period(struct stream_listener *stream, struct timestamp *
 			if (os_abs(period - crf->period_nominal) > crf->period_err) {
 				rc = -1;
 				crf->timestamp = 0;
-			} else {
-				if (crf->timestamp == 1)
-					crf->period = period;
-				else
-					crf->period = (crf->period * 3 + 2) / 4 + (period + 2) / 4;
+				crf_period_window_reset(crf);
 			}
 		}
 
+		crf_period_window_add(crf, crf->ts_index + 1 + i, ts[i].ts_nsec);
+
 		if (crf->timestamp < 0xffffffff) /* Just a big number to avoid overflow */
 			crf->timestamp++;
 
 		crf->received_ts_last = ts[i].ts_nsec;
 	}
 
+	crf_period_fit(crf);
+
 	if (rc < 0)
 		return rc;
 	else if (crf->timestamp > crf->free_wheeling_to_locked_delay)
@@ -241,18 +331,27 @@ static void crf_generate_timestamps(struct stream_listener *stream, struct times
 {
 	struct crf_subtype_data *crf = &stream->subtype_data.crf;
 	unsigned int ts_last;
+	u64 frac;
 	int i;
 
-	if (crf->ts_last_set)
+	if (crf->ts_last_set) {
 		ts_last = crf->ts_last;
-	else
+		frac = crf->ts_last_frac;
+	} else {
 		ts_last = stream->gptp_current + crf->period;
+		frac = 0;
+	}
 
 	for (i = 0; i < *ts_n; i++) {
-		ts_last += crf->period;
+		frac += crf->period_q32;
+		ts_last += frac >> 32;
+		frac &= 0xffffffff;
+
 		ts[i].ts_nsec = ts_last;
 		ts[i].flags = 0;
 	}
+
+	crf->ts_last_frac = frac;
 }
 
 static unsigned int crf_next_timeout(struct stream_listener *stream)
@@ -297,7 +396,8 @@ static void crf_set_state(struct stream_listener *stream, crf_state_t state, crf
 
 	crf->state = state;
 
-	if (stream->source) {
+	/* Only the domain source updates the domain state (not a source pending a hitless switch) */
+	if (stream->source && (stream->source->grid.domain->source == stream->source)) {
 		switch (state) {
 		case CRF_STATE_FREE_WHEELING:
 			clock_domain_set_state(stream->source->grid.domain, CLOCK_DOMAIN_STATE_FREE_WHEELING);
@@ -367,6 +467,7 @@ static void crf_state_handler(struct stream_listener *stream, crf_event_t event,
 			/* make sure we check the period against the last used timestamp */
 			crf->received_ts_last = crf->ts_last;
 			crf->timestamp = 1;
+			crf_period_window_reset(crf);
 
 			rc = crf_measure_period(stream, ts, ts_n);
 			if (rc < 0) {
@@ -452,9 +553,12 @@ static void crf_state_handler(struct stream_listener *stream, crf_event_t event,
 
 	if (action & CRF_ACTION_GENERATE_TIMESTAMPS)
 		crf_generate_timestamps(stream, ts, ts_n);
+	else
+		crf->ts_last_frac = 0;
 
 	crf->ts_last = ts[(*ts_n) - 1].ts_nsec;
 	crf->ts_last_set = 1;
+	crf->ts_index += *ts_n;
 
 	dt = crf_next_timeout(stream);
 	timer_start(&crf->timer, dt);
@@ -591,6 +695,7 @@ static void crf_net_rx(struct stream_listener *stream, struct avtp_rx_desc **des
 			avtp_latency_stats(stream, desc[i]);
 		}
 
+		stream_listener_margin_update(stream, desc[i]->desc.ts, desc[i]->avtp_timestamp);
 		stream_listener_check_timestamps(stream, desc[i]->desc.ts, desc[i]->avtp_timestamp, 0);
 
 		desc_n++;
@@ -726,6 +831,11 @@ static int listener_crf_init(struct stream_listener *stream)
 
 	crf->period_nominal = ((u64)NSECS_PER_SEC * avdecc_fmt_samples_per_timestamp(format, stream->class)) / avdecc_fmt_sample_rate(format);
 	crf->period = crf->period_nominal;
+	crf->period_q32 = ((u64)crf->period_nominal << 32)
+			+ ((((u64)NSECS_PER_SEC * avdecc_fmt_samples_per_timestamp(format, stream->class)) % avdecc_fmt_sample_rate(format)) << 32) / avdecc_fmt_sample_rate(format);
+	crf->ts_last_frac = 0;
+	crf->ts_index = 0;
+	crf_period_window_reset(crf);
 	crf->period_err = crf->period / 64;
 	crf->state = CRF_STATE_LOCKED;
 	crf->ts_last_set = 0;
@@ -1 +1,5 @@
 genavb_target_add_srcs(TARGET ${avb} SRCS main.c)
+
+if(BUILD_TESTS)
+  include(${CMAKE_CURRENT_LIST_DIR}/../test/test.cmake)
+endif()
@@ -101,7 +101,12 @@ static void *stats_thread_main(void *arg)
 		}
 
 		for (i = 0; i < ready; i++) {
-			if (event[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+			epoll_data = (struct linux_epoll_data *)event[i].data.ptr;
+
+			if ((event[i].events & EPOLLERR) && (epoll_data->type == EPOLL_TYPE_NET_TX_EVENT))
+				/* Launch time errors queued on the transmit socket */
+				avtp_net_tx_error_event(epoll_data->ptr);
+			else if (event[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
 				os_log(LOG_ERR, "event error, 0x%x, data = 0x%llx\n", event[i].events, event[i].data.u64);
 
 			if (event[i].events & EPOLLIN) {
@@ -219,6 +219,7 @@ restart:
 
 			rec->state = MEASUREMENT;
 			rec->period_mean = 0;
+			filter_q_reset(&rec->period_filter);
 			rec->offset_max = offset;
 			rec->offset_min = offset;
 			*rec->write_idx = 0;
@@ -270,12 +271,11 @@ restart:
 			/* For now we don't do much with the measurements but they will be needed for
 			 * supporting various clock stream input
 			 */
-			if (rec->nb_meas != 0)
-				rec->period_mean = (rec->period_mean + period) / 2;
-			else {
+			rec->period_mean = filter_q_to_int(filter_q(&rec->period_filter, filter_q_from_int(period)));
+
+			if (!rec->nb_meas) {
 				rec->period_min = period;
 				rec->period_max = period;
-				rec->period_mean = period;
 			}
 
 			if (period < rec->period_min)
@@ -543,6 +543,8 @@ __init struct media_clock_rec *media_clock_rec_init(int domain_id)
 	rec->array_size = rec->os.array_size;
 	rec->write_idx = rec->array_addr + rec->array_size;
 
+	filter_q_exp_decay_init(&rec->period_filter, MCR_PERIOD_FILTER_COEF);
+
 	/* Success */
 	os_log(LOG_INIT, "clock id %d, init done\n", domain_id);
 
@@ -629,14 +631,9 @@ void clock_grid_mult_exit(struct clock_grid *grid)
 
 static unsigned int ts_available(struct clock_grid_consumer *consumer)
 {
-	unsigned int avail;
-
-	if (consumer->grid->write_index >= consumer->read_index)
-		avail = consumer->grid->write_index - consumer->read_index;
-	else
-		avail = (consumer->grid->write_index + consumer->grid->ring_size) - consumer->read_index;
+	struct clock_grid *grid = consumer->grid;
 
-	return avail;
+	return (clock_grid_write_index(grid) - consumer->read_index) & (grid->ring_size - 1);
 }
 
 static void ts_put(struct clock_grid *grid, unsigned int ts)
@@ -653,9 +650,7 @@ static void ts_put(struct clock_grid *grid, unsigned int ts)
 
 	grid->ts[grid->write_index] = ts;
 
-	grid->write_index = (grid->write_index + 1) & (grid->ring_size - 1);
-	grid->count++;
-
+	clock_grid_publish(grid, (grid->write_index + 1) & (grid->ring_size - 1), grid->count + 1);
 }
 
 static unsigned int ts_peek_n(struct clock_grid_consumer *consumer, unsigned int n)
@@ -681,38 +676,108 @@ static void _clock_grid_consumer_reset(struct clock_grid_consumer *consumer)
 	consumer->count = grid->count - start_count;
 }
 
-static unsigned int ts_get(struct clock_grid_consumer *consumer)
+/** Returns the number of grid timestamps to read, to get a given number of decimated timestamps.
+ * The grid timestamps dropped after the last returned one are included, so that the next read
+ * starts with a returned timestamp.
+ * \return	number of grid timestamps
+ * \param consumer	pointer to clock grid consumer context
+ * \param ts_n		number of decimated timestamps requested, updated with the number actually available
+ * \param grid_n	maximum number of grid timestamps to read
+ */
+static unsigned int ts_decim_grid_n(struct clock_grid_consumer *consumer, unsigned int *ts_n, unsigned int grid_n)
 {
-	struct clock_grid *grid = consumer->grid;
-	unsigned int ts = consumer->grid->ts[consumer->read_index];
-	unsigned int period, next_ts, prev_offset;
+	u32 acc = consumer->decim_acc;
+	unsigned int n = 0, m = 0;
 
-	/* Detect discontinuities caused by the producer */
-	if (consumer->init) {
-		period = ts - consumer->prev_ts;
+	while (m < grid_n) {
+		if (acc < consumer->decim_p) {
+			if (n == *ts_n)
+				break;
 
-		if (os_abs((int)period - (int)grid->nominal_period) > grid->period_jitter) {
-			/* Adjust consumer offset to hide discontinuity */
+			n++;
+		}
 
-			next_ts = consumer->prev_ts + consumer->prev_period;
-			prev_offset = consumer->offset;
-			consumer->offset += next_ts - ts;
+		acc += consumer->decim_p;
+		if (acc >= consumer->decim_q)
+			acc -= consumer->decim_q;
 
-			os_log(LOG_DEBUG, "consumer(%p) discontinuity %u, next: %u, %u %u %u %d %d\n",
-				consumer, consumer->count, next_ts, ts + consumer->offset, ts, consumer->prev_ts, consumer->offset, prev_offset);
-		} else {
-			consumer->prev_period = period;
-		}
+		m++;
 	}
 
-	consumer->prev_ts = ts;
-	ts += consumer->offset;
+	*ts_n = n;
+
+	return m;
+}
+
+/** Reads timestamps from the grid ring, in bulk.
+ * The ring is read in (at most) two contiguous chunks, with consumer state kept in locals
+ * for the duration of the copy. All grid timestamps are tracked for discontinuities, but only
+ * the ones selected by the consumer decimation are returned.
+ * \return	 none
+ * \param consumer	pointer to clock grid consumer context
+ * \param ts		pointer to timestamps array
+ * \param n		number of grid timestamps to read, must be less or equal to ts_available()
+ */
+static void ts_get_n(struct clock_grid_consumer *consumer, u32 *ts, unsigned int n)
+{
+	struct clock_grid *grid = consumer->grid;
+	u32 read_index = consumer->read_index;
+	u32 prev_ts = consumer->prev_ts;
+	u32 prev_period = consumer->prev_period;
+	u32 offset = consumer->offset;
+	u32 init = consumer->init;
+	u32 count = consumer->count;
+	u32 decim_acc = consumer->decim_acc;
+	unsigned int i, chunk;
+	u32 *ring;
+
+	while (n) {
+		chunk = min(n, grid->ring_size - read_index);
+		ring = &grid->ts[read_index];
+
+		for (i = 0; i < chunk; i++) {
+			u32 cur_ts = ring[i];
+			u32 period = cur_ts - prev_ts;
+
+			/* Detect discontinuities caused by the producer */
+			if (init) {
+				if (os_abs((int)period - (int)grid->nominal_period) > grid->period_jitter) {
+					/* Adjust consumer offset to hide discontinuity */
+					u32 next_ts = prev_ts + prev_period;
+					u32 prev_offset = offset;
+
+					offset += next_ts - cur_ts;
+
+					os_log(LOG_DEBUG, "consumer(%p) discontinuity %u, next: %u, %u %u %u %d %d\n",
+						consumer, count + i, next_ts, cur_ts + offset, cur_ts, prev_ts, offset, prev_offset);
+				} else {
+					prev_period = period;
+				}
+			}
+
+			prev_ts = cur_ts;
+			init = 1;
 
-	consumer->read_index = (consumer->read_index + 1) & (consumer->grid->ring_size - 1);
-	consumer->count++;
-	consumer->init = 1;
+			if (decim_acc < consumer->decim_p)
+				*ts++ = cur_ts + offset;
 
-	return ts;
+			decim_acc += consumer->decim_p;
+			if (decim_acc >= consumer->decim_q)
+				decim_acc -= consumer->decim_q;
+		}
+
+		read_index = (read_index + chunk) & (grid->ring_size - 1);
+		count += chunk;
+		n -= chunk;
+	}
+
+	consumer->read_index = read_index;
+	consumer->count = count;
+	consumer->prev_ts = prev_ts;
+	consumer->prev_period = prev_period;
+	consumer->offset = offset;
+	consumer->init = init;
+	consumer->decim_acc = decim_acc;
 }
 
 static void clock_grid_consumer_reset(struct clock_grid_consumer *consumer)
@@ -757,35 +822,29 @@ static void ts_generate_new(struct clock_grid *grid)
 	}
 }
 
-static void clock_grid_consumer_ts_update(struct clock_grid_consumer *consumer, unsigned int requested, unsigned int *reset)
+/** Synchronizes the consumer with the grid producer state.
+ * Grids are only updated by their producer (see clock_domain_grids_update()), the consumer only checks
+ * for overflow and producer resets here.
+ * \return	 none
+ * \param consumer	pointer to clock grid consumer context
+ * \param flags		pointer to consumer flags, MCG_FLAGS_RESET is set if the producer was reset
+ */
+static void clock_grid_consumer_sync(struct clock_grid_consumer *consumer, unsigned int *flags)
 {
 	struct clock_grid *grid = consumer->grid;
-	unsigned int ts_avail;
 
 	if (grid->ts_update) {
-
-		if (consumer->init) {
-			clock_grid_consumer_overflow_check(consumer);
-
-			ts_avail = ts_available(consumer);
-			if (requested > ts_avail)
-				requested -= ts_avail;
-			else
-				goto exit;	/* Amount requested is less than available, exit early */
-
-		}
-
-		grid->ts_update(grid, requested, reset);
-		clock_grid_update_valid_count(grid);
-
 		if (consumer->init)
 			clock_grid_consumer_overflow_check(consumer);
 		else
 			_clock_grid_consumer_reset(consumer);
 	}
 
-exit:
-	return;
+	if (consumer->reset_count != grid->reset_count) {
+		consumer->reset_count = grid->reset_count;
+		*flags |= MCG_FLAGS_RESET;
+		consumer->stats.err_reset++;
+	}
 }
 
 /** Updates the HW user clock grid based on the evolution of the HW clock.
@@ -833,6 +892,7 @@ init:
 			grid, mult->source.grid->write_index, mult->source.grid->count, mult->source.count, mult->source.offset,
 			mult->source.grid->ts[mult->source.grid->write_index], mult->source.grid->ts[mult->source.read_index]);
 
+		grid->reset_count++;
 		*reset = 1;
 	}
 
@@ -954,40 +1014,37 @@ static void clock_grid_consumer_compute_offset(struct clock_grid_consumer *consu
 int clock_grid_consumer_get_ts(struct clock_grid_consumer *consumer, u32 *ts, unsigned int ts_n, unsigned int *flags, unsigned int alignment_ts)
 {
 	unsigned int written = 0;
-	unsigned int reset = 0;
 	unsigned int ts_n_actual;
 	unsigned int ts_avail;
+	unsigned int grid_n;
 
-	if (ts_n)
-		clock_grid_consumer_ts_update(consumer, ts_n, &reset);
+	clock_grid_consumer_sync(consumer, flags);
 
 	if (*flags & MCG_FLAGS_DO_ALIGN)
 		clock_grid_consumer_compute_offset(consumer, alignment_ts);
 
-	if (reset) {
-		*flags |= MCG_FLAGS_RESET;
-		consumer->stats.err_reset++;
+	ts_avail = ts_available(consumer);
+	if (consumer->decim_p != consumer->decim_q) {
+		ts_n_actual = ts_n;
+		grid_n = ts_decim_grid_n(consumer, &ts_n_actual, ts_avail);
+	} else {
+		ts_n_actual = min(ts_n, ts_avail);
+		grid_n = ts_n_actual;
 	}
 
-	ts_avail = ts_available(consumer);
-	ts_n_actual = min(ts_n, ts_avail);
 	if (ts_n_actual < ts_n) {
 		consumer->stats.err_starved++;
 		os_log(LOG_DEBUG, "consumer(%p): Not enough timestamps: ts_n %u avail %u read %u write %u grid_count %u consumer_count %u\n",
 				consumer, ts_n, ts_n_actual, consumer->read_index, consumer->grid->write_index, consumer->grid->count, consumer->count);
 	}
 
-	while (written < ts_n_actual) {
-		*ts = ts_get(consumer);
+	if (ts_n_actual) {
+		ts_get_n(consumer, ts, grid_n);
 
-		if (!written) {
-			stats_update(&consumer->stats.ts_err, (int)*ts - (int)consumer->gptp_current);
-			//stats_update(&consumer->stats.ts_err, (consumer->grid->write_index - consumer->read_index) & (consumer->grid->ring_size - 1));
-		}
+		stats_update(&consumer->stats.ts_err, (int)ts[0] - (int)consumer->gptp_current);
 
-		consumer->stats.ts++;
-		ts++;
-		written++;
+		consumer->stats.ts += ts_n_actual;
+		written = ts_n_actual;
 	}
 
 	stats_update(&consumer->stats.ts_batch, written);
@@ -1055,6 +1112,10 @@ int clock_grid_consumer_attach(struct clock_grid_consumer *consumer, struct cloc
 		consumer->alignment = alignment;
 		consumer->init = 0;
 		consumer->prev_period = grid->nominal_period;
+		consumer->decim_p = 1;
+		consumer->decim_q = 1;
+		consumer->decim_acc = 0;
+		consumer->reset_count = grid->reset_count;
 
 		stats_init(&consumer->stats.ts_err, 31, NULL, NULL);
 		stats_init(&consumer->stats.ts_batch, 31, NULL, NULL);
@@ -1063,6 +1124,90 @@ int clock_grid_consumer_attach(struct clock_grid_consumer *consumer, struct cloc
 	return rc;
 }
 
+/** Sets the consumer decimation.
+ * Only decim_p out of every decim_q grid timestamps are returned by clock_grid_consumer_get_ts(), starting with
+ * the first one, so that a consumer can run at a fraction of the grid frequency.
+ * \return	0 on success, -1 on error
+ * \param consumer	pointer to clock grid consumer context
+ * \param decim_p	decimation numerator
+ * \param decim_q	decimation denominator, must be greater or equal to decim_p
+ */
+int clock_grid_consumer_set_decimation(struct clock_grid_consumer *consumer, unsigned int decim_p, unsigned int decim_q)
+{
+	if (!decim_p || (decim_p > decim_q)) {
+		os_log(LOG_ERR, "consumer(%p) invalid decimation %u/%u\n", consumer, decim_p, decim_q);
+		return -1;
+	}
+
+	consumer->decim_p = decim_p;
+	consumer->decim_q = decim_q;
+	consumer->decim_acc = 0;
+
+	return 0;
+}
+
+/** Moves a consumer to a new grid, without timestamp discontinuity.
+ * All grids are in gPTP time, so the consumer is positioned on the new grid timestamp closest to its next
+ * expected timestamp. The remaining phase difference (less than half a grid period) is absorbed in the consumer
+ * offset, the same way discontinuities caused by the producer are hidden (see ts_get_n()).
+ * \return	0 on success, -1 on error (the consumer is left unchanged)
+ * \param consumer	pointer to clock grid consumer context
+ * \param grid		pointer to the new grid, with the same nominal frequency as the current one
+ */
+int clock_grid_consumer_switch(struct clock_grid_consumer *consumer, struct clock_grid *grid)
+{
+	struct clock_grid *grid_prev = consumer->grid;
+	unsigned int start_count = clock_grid_start_count(grid);
+	u32 start_index, next_ts, ts;
+	unsigned int n;
+
+	if (((u64)grid->nominal_freq_p * grid_prev->nominal_freq_q) != ((u64)grid->nominal_freq_q * grid_prev->nominal_freq_p)) {
+		os_log(LOG_ERR, "consumer(%p) grid(%p) frequency mismatch with grid(%p)\n", consumer, grid, grid_prev);
+		return -1;
+	}
+
+	if (consumer->init && !start_count) {
+		os_log(LOG_ERR, "consumer(%p) grid(%p) has no timestamps\n", consumer, grid);
+		return -1;
+	}
+
+	if (clock_grid_ref(grid) < 0)
+		return -1;
+
+	consumer->grid = grid;
+	consumer->reset_count = grid->reset_count;
+	clock_grid_unref(grid_prev);
+
+	if (!consumer->init) {
+		/* Consumer will be positioned on its next update */
+		consumer->read_index = 0;
+		consumer->count = 0;
+		return 0;
+	}
+
+	next_ts = consumer->prev_ts + consumer->prev_period;
+	start_index = (clock_grid_write_index(grid) - start_count) & (grid->ring_size - 1);
+
+	for (n = 0; n < (start_count - 1); n++) {
+		ts = grid->ts[(start_index + n) & (grid->ring_size - 1)];
+
+		if ((int)(ts - next_ts) >= -(int)(grid->nominal_period / 2))
+			break;
+	}
+
+	consumer->read_index = (start_index + n) & (grid->ring_size - 1);
+	consumer->count = grid->count - (start_count - n);
+
+	ts = ts_peek(consumer);
+	consumer->offset += next_ts - ts;
+	consumer->prev_ts = ts - consumer->prev_period;
+
+	os_log(LOG_INFO, "consumer(%p) switched from grid(%p) to grid(%p), phase %d ns\n",
+	       consumer, grid_prev, grid, (int)(ts - next_ts));
+
+	return 0;
+}
+
 void clock_grid_consumer_detach(struct clock_grid_consumer *consumer)
 {
 	if (consumer->grid) {
@@ -1095,7 +1240,8 @@ void clock_producer_stream_rx(struct clock_grid *grid, struct timestamp *ts, uns
 		if (rec->state == RUNNING_LOCKED) {
 			if (do_stitch && period_error(grid->nominal_period, ts[0].ts_nsec + producer->stitch_ts_offset - rec->last_ts)) {
 				producer->stitch_ts_offset = grid->nominal_period - (ts[0].ts_nsec - rec->last_ts);
-				clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
+				if (&grid->domain->source->grid == grid)
+					clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
 				os_log(LOG_DEBUG, "stitch offset %d\n", producer->stitch_ts_offset);
 			}
 
@@ -1107,13 +1253,16 @@ void clock_producer_stream_rx(struct clock_grid *grid, struct timestamp *ts, uns
 
 		media_clock_rec(rec, ts, *ts_n);
 
-		grid->write_index = *rec->write_idx;
-		grid->count = rec->nb_ts_total;
+		clock_grid_publish(grid, *rec->write_idx, rec->nb_ts_total);
+
+		if (rec->state == RUNNING_LOCKED) {
+			/* Only the domain source updates the domain state (not a source pending a hitless switch) */
+			if (&grid->domain->source->grid == grid)
+				clock_domain_set_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
+		} else {
+			if (&grid->domain->source->grid == grid)
+				clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
 
-		if (rec->state == RUNNING_LOCKED)
-			clock_domain_set_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
-		else {
-			clock_domain_clear_state(grid->domain, CLOCK_DOMAIN_STATE_LOCKED);
 			producer->stitch_ts_offset = 0;
 		}
 	}
@@ -14,6 +14,7 @@
 #define _MEDIA_CLOCK_H_
 
 #include "os/media_clock.h"
+#include "common/filter.h"
 #include "clock_domain.h"
 
 typedef enum  {
@@ -37,6 +38,7 @@ struct media_clock_rec {
 	unsigned int clean_idx;
 	u32 delay;
 	u32 period_mean;
+	struct filter_q period_filter;	/* period_mean filter, Q16 */
 	u32 period_min;
 	u32 period_max;
 	u32 period_first;
@@ -83,6 +85,8 @@ int clock_grid_consumer_get_ts(struct clock_grid_consumer *consumer, u32 *ts, un
 
 int clock_grid_consumer_attach(struct clock_grid_consumer *consumer, struct clock_grid *grid, unsigned int offset, unsigned int alignment);
 void clock_grid_consumer_detach(struct clock_grid_consumer *consumer);
+int clock_grid_consumer_switch(struct clock_grid_consumer *consumer, struct clock_grid *grid);
+int clock_grid_consumer_set_decimation(struct clock_grid_consumer *consumer, unsigned int decim_p, unsigned int decim_q);
 void clock_grid_consumer_exit(struct clock_grid_consumer *consumer);
 
 struct timestamp {
@@ -99,6 +103,7 @@ struct timestamp {
 #define MCR_CLEAN_BATCH	 	32 		// 2^x
 
 #define MCR_NB_MEAS		100
+#define MCR_PERIOD_FILTER_COEF	(FILTER_Q_ONE / 2)	/* Q16 */
 
 #define MCR_FLAGS_IN_USE	(1 << 0)
 #define MCR_FLAGS_RUNNING	(1 << 1)
@@ -210,6 +210,91 @@ void avtp_latency_stats(struct stream_listener *stream, struct avtp_rx_desc *des
 	stats_update(&stream->stats.avb_delay, stream->gptp_current - desc->desc.ts);
 
 	stats_update(&stream->stats.avtp_delay, desc->avtp_timestamp - stream->gptp_current);
+	hist_update(&stream->avtp_delay_hist, desc->avtp_timestamp - stream->gptp_current);
+}
+
+/** Updates the talker launch time handoff statistics
+ * \return none
+ * \param stream	pointer to talker stream context
+ * \param launch	requested launch time (gPTP time, ns)
+ * \param handoff	time the packet was handed to the network layer (gPTP time, ns)
+ */
+void stream_talker_launch_stats(struct stream_talker *stream, u32 launch, u32 handoff)
+{
+	s32 lead = launch - handoff;
+
+	stats_update(&stream->stats.launch_lead, lead);
+
+	if (!stream->launch_ts_enabled)
+		hist_update(&stream->launch_hist, lead);
+}
+
+/** Reads the hardware transmit timestamps of the talker stream
+ * The timestamp of the sampled frame is matched by the frame identifier, others (if any) are dropped.
+ * \return none
+ * \param stream	pointer to talker stream context
+ */
+static void stream_talker_launch_ts_read(struct stream_talker *stream)
+{
+	uint64_t ts;
+	unsigned int id;
+	s32 lead;
+
+	while (net_tx_ts_get(&stream->tx, &ts, &id) > 0) {
+		if (stream->launch_ts_pending && (id == stream->launch_ts_id)) {
+			lead = stream->launch_ts_launch - (u32)ts;
+
+			stats_update(&stream->stats.launch_tx_lead, lead);
+			hist_update(&stream->launch_hist, lead);
+
+			stream->launch_ts_pending = false;
+		}
+	}
+}
+
+/** Requests the hardware transmit timestamp of a sampled frame
+ * Only one frame is sampled at a time, the timestamp of the previous one is read here (one sampling period later)
+ * and the frame counted as lost if it has none.
+ * \return none
+ * \param stream	pointer to talker stream context
+ * \param desc		pointer to the sampled frame descriptor, with a launch time
+ */
+void stream_talker_launch_ts_request(struct stream_talker *stream, struct net_tx_desc *desc)
+{
+	u32 id;
+
+	stream_talker_launch_ts_read(stream);
+
+	if (stream->launch_ts_pending)
+		stream->stats.launch_ts_lost++;
+
+	os_memcpy(&id, (u8 *)NET_DATA_START(desc) + ((u8 *)stream->avtp_hdr - stream->header_template), sizeof(id));
+
+	desc->flags |= NET_TX_FLAGS_HW_TS;
+	desc->priv = ntohl(id);
+
+	stream->launch_ts_id = desc->priv;
+	stream->launch_ts_launch = desc->ts;
+	stream->launch_ts_pending = true;
+}
+
+/** Collects the frames dropped by the network stack because of launch time errors
+ * Called from the statistics timer and on transmit socket error events, never from the transmit path.
+ * \return none
+ * \param stream	pointer to talker stream context
+ */
+void stream_talker_launch_errors(struct stream_talker *stream)
+{
+	unsigned int missed, invalid;
+
+	/* The transmit timestamps share the socket error queue with the launch time errors */
+	if (stream->launch_ts_enabled)
+		stream_talker_launch_ts_read(stream);
+
+	net_tx_launch_errors(&stream->tx, &missed, &invalid);
+
+	stream->stats.launch_missed += missed + invalid;
+	stream->stats.tx_err += missed + invalid;
 }
 
 void stream_talker_stats_print(struct ipc_avtp_talker_stats *msg)
@@ -217,6 +302,8 @@ void stream_talker_stats_print(struct ipc_avtp_talker_stats *msg)
 	struct talker_stats *stats = &msg->stats;
 
 	stats_compute(&stats->sched_intvl);
+	stats_compute(&stats->launch_lead);
+	stats_compute(&stats->launch_tx_lead);
 
 	os_log(LOG_INFO, "stream_id(%016"PRIx64")\n", ntohll(msg->stream_id));
 
@@ -225,6 +312,18 @@ void stream_talker_stats_print(struct ipc_avtp_talker_stats *msg)
 	os_log(LOG_INFO, "tx err: %10u, partial: %10u, media underrun: %10u  clock invalid: %10u sched intvl: % 10d/% 10d/% 10d (ns)\n",
 		stats->tx_err, stats->partial, stats->media_underrun, stats->clock_invalid,
 		stats->sched_intvl.min, stats->sched_intvl.mean, stats->sched_intvl.max);
+	os_log(LOG_INFO, "packed: %10u, concealed: %10u\n", stats->packed, stats->concealed);
+	if (msg->launch_ts_enabled) {
+		os_log(LOG_INFO, "launch-handoff lead % 10d/% 10d/% 10d (ns) missed %10u\n",
+			stats->launch_lead.min, stats->launch_lead.mean, stats->launch_lead.max, stats->launch_missed);
+		os_log(LOG_INFO, "launch-tx lead % 10d/% 10d/% 10d (ns) p0.1/p1/p50 % 10d/% 10d/% 10d (ns) samples %10u lost %10u\n",
+			stats->launch_tx_lead.min, stats->launch_tx_lead.mean, stats->launch_tx_lead.max,
+			msg->launch_pct.p01, msg->launch_pct.p1, msg->launch_pct.p50, msg->launch_pct.total, stats->launch_ts_lost);
+	} else {
+		os_log(LOG_INFO, "launch-handoff lead % 10d/% 10d/% 10d (ns) p0.1/p1/p50 % 10d/% 10d/% 10d (ns) samples %10u missed %10u\n",
+			stats->launch_lead.min, stats->launch_lead.mean, stats->launch_lead.max,
+			msg->launch_pct.p01, msg->launch_pct.p1, msg->launch_pct.p50, msg->launch_pct.total, stats->launch_missed);
+	}
 }
 
 static void stream_talker_stats_dump(struct stream_talker *stream, struct ipc_tx *tx)
@@ -242,8 +341,12 @@ static void stream_talker_stats_dump(struct stream_talker *stream, struct ipc_tx
 
 	msg = (struct ipc_avtp_talker_stats *)&desc->u;
 
+	stream_talker_launch_errors(stream);
+
 	msg->stream_id = stream->id;
 	os_memcpy(&msg->stats, &stream->stats, sizeof(stream->stats));
+	hist_low_percentiles_compute(&stream->launch_hist, &msg->launch_pct);
+	msg->launch_ts_enabled = stream->launch_ts_enabled;
 
 	if (ipc_tx(tx, desc) < 0)
 		goto err_ipc_tx;
@@ -251,6 +354,9 @@ static void stream_talker_stats_dump(struct stream_talker *stream, struct ipc_tx
 	clock_grid_consumer_stats_dump(&stream->consumer, tx);
 
 	stats_reset(&stream->stats.sched_intvl);
+	stats_reset(&stream->stats.launch_lead);
+	stats_reset(&stream->stats.launch_tx_lead);
+	hist_reset(&stream->launch_hist);
 	return;
 
 err_ipc_tx:
@@ -276,11 +382,19 @@ void stream_listener_stats_print(struct ipc_avtp_listener_stats *msg)
 	os_log(LOG_INFO, "mr: %10u, tu: %10u, dropped: %10u, early: %10u, late: %10u, subformat err: %10u\n",
 		stats->mr, stats->tu, stats->media_tx_dropped, stats->early_timestamp, stats->late_timestamp, stats->format_err);
 
+	os_log(LOG_INFO, "duplicate: %10u, reordered: %10u\n", stats->seq_duplicate, stats->seq_reordered);
+
 	os_log(LOG_INFO,"now-rx_ts %4d/%4d/%4d     avtp_ts-now %4d/%4d/%4d (us)     batch %2d/%2d/%2d/%2"PRIu64"\n",
 		stats->avb_delay.min/1000, stats->avb_delay.mean/1000, stats->avb_delay.max/1000,
 		stats->avtp_delay.min/1000, stats->avtp_delay.mean/1000, stats->avtp_delay.max/1000,
 		stats->batch.min, stats->batch.mean, stats->batch.max, stats->batch.variance);
 
+	os_log(LOG_INFO,"avtp_ts-now p50/p99/p99.9 %4d/%4d/%4d (us)\n",
+		msg->avtp_delay_pct.p50/1000, msg->avtp_delay_pct.p99/1000, msg->avtp_delay_pct.p999/1000);
+
+	os_log(LOG_INFO,"avtp_ts-rx_ts p0.1/p1/p50 %4d/%4d/%4d (us) samples %10u\n",
+		msg->margin_pct.p01/1000, msg->margin_pct.p1/1000, msg->margin_pct.p50/1000, msg->margin_pct.total);
+
 	if (msg->clock_rec_enabled)
 		media_clock_rec_stats_print(&msg->clock_stats);
 }
@@ -303,6 +417,8 @@ static void stream_listener_stats_dump(struct stream_listener *stream, struct ip
 
 	msg->stream_id = stream->id;
 	os_memcpy(&msg->stats, &stream->stats, sizeof(stream->stats));
+	hist_percentiles_compute(&stream->avtp_delay_hist, &msg->avtp_delay_pct);
+	hist_low_percentiles_compute(&stream->margin_hist, &msg->margin_pct);
 
 	if (stream->source) {
 		struct clock_grid_producer_stream *producer = &stream->source->grid.producer.u.stream;
@@ -317,6 +433,8 @@ static void stream_listener_stats_dump(struct stream_listener *stream, struct ip
 	stats_reset(&stream->stats.avb_delay);
 	stats_reset(&stream->stats.avtp_delay);
 	stats_reset(&stream->stats.batch);
+	hist_reset(&stream->avtp_delay_hist);
+	hist_reset(&stream->margin_hist);
 
 	if (ipc_tx(tx, desc) < 0)
 		goto err_ipc_tx;
@@ -358,6 +476,7 @@ void stream_stats_dump(struct avtp_port *port, struct ipc_tx *tx)
 static void stream_talker_add(struct avtp_port *port, struct stream_talker *stream)
 {
 	list_add_tail(&port->talker, &stream->common.list);
+	clock_domain_add_talker(stream->domain, stream);
 
 	stream->common.avtp->stream_talker_count++;
 }
@@ -459,17 +578,35 @@ int stream_clock_consumer_enable(struct stream_talker *stream)
 {
 	unsigned int ts_freq_p, ts_freq_q, packet_freq_p, packet_freq_q;
 	unsigned int wake_freq_p, wake_freq_q;
-	unsigned int ps;
+	unsigned int ps, grid_mult = 1;
 
 	if (!(stream->common.flags & STREAM_FLAG_CLOCK_GENERATION))
 		return 0;
 
 	ts_freq_p = stream->sample_rate;
+	ts_freq_q = stream->samples_per_timestamp;
+
+	/* 61883-4 source packet timestamps are not taken from the grid (see avtp_61883_4_net_tx()),
+	 * only one grid timestamp per packet is needed */
+	if ((stream->subtype == AVTP_SUBTYPE_61883_IIDC) && (stream->format.u.s.subtype_u.iec61883.fmt == IEC_61883_CIP_FMT_4))
+		ts_freq_q = stream->frames_per_packet;
 
+	/* CRF talkers run the grid at twice the CRF timestamp frequency (workaround for minimum generator
+	 * frequency), and only consume every other timestamp */
 	if (stream->subtype == AVTP_SUBTYPE_CRF)
-		ts_freq_p *= 2;
+		grid_mult = 2;
 
-	ts_freq_q = stream->samples_per_timestamp;
+	if (stream->domain->source && ts_freq_q) {
+		struct clock_grid *source_grid = &stream->domain->source->grid;
+		u32 source_freq = source_grid->nominal_freq_p / source_grid->nominal_freq_q;
+
+		/* The grid cannot run below the clock source frequency, use the smallest
+		 * multiple of the timestamp frequency above it and decimate back */
+		while (((u64)ts_freq_p * grid_mult) < ((u64)source_freq * ts_freq_q))
+			grid_mult++;
+	}
+
+	ts_freq_p *= grid_mult;
 
 	if (!ts_freq_p || !ts_freq_q) {
 		os_log(LOG_ERR, "talker(%p) invalid ts_freq: %u/%u\n", stream, ts_freq_p, ts_freq_q);
@@ -505,6 +642,10 @@ int stream_clock_consumer_enable(struct stream_talker *stream)
 		ts_freq_p, ts_freq_q, ps, sr_class_prio(stream->class)) < 0)
 		goto err_init;
 
+	/* Only consume the grid timestamps at the requested timestamp frequency */
+	if ((grid_mult > 1) && (clock_grid_consumer_set_decimation(&stream->consumer, 1, grid_mult) < 0))
+		goto err_decimation;
+
 	if (stream->subtype == AVTP_SUBTYPE_CRF) {
 		if (os_timer_create(&stream->subtype_data.crf.t, stream->domain->source->clock_id, 0, crf_os_timer_handler, stream->priv) < 0)
 			goto err_timer_create;
@@ -524,6 +665,7 @@ err_timer_start:
 	os_timer_destroy(&stream->subtype_data.crf.t);
 
 err_timer_create:
+err_decimation:
 err_init_wakeup:
 	clock_domain_exit_consumer(&stream->consumer);
 
@@ -545,6 +687,47 @@ void stream_clock_consumer_disable(struct stream_talker *stream)
 	}
 }
 
+/** Moves the talker wake-up to a new domain source, after a hitless source switch (see clock_domain_switch_source()).
+ * The clock consumer itself is left untouched, only the talker specific wake-up timer (CRF) needs to follow
+ * the source clock.
+ * \return	0 on success, -1 on error (clock consumer is then disabled)
+ * \param stream	pointer to talker stream context
+ */
+int stream_clock_consumer_switch_source(struct stream_talker *stream)
+{
+	unsigned int wake_freq_p, wake_freq_q;
+
+	if (!(stream->common.flags & STREAM_FLAG_CLOCK_GENERATION) || !stream->consumer_enabled)
+		return 0;
+
+	if (stream->subtype != AVTP_SUBTYPE_CRF)
+		return 0;
+
+	wake_freq_p = stream->sample_rate;
+	wake_freq_q = stream->frames_per_packet * stream->tx_batch;
+
+	os_timer_destroy(&stream->subtype_data.crf.t);
+
+	if (os_timer_create(&stream->subtype_data.crf.t, stream->domain->source->clock_id, 0, crf_os_timer_handler, stream->priv) < 0)
+		goto err_timer_create;
+
+	if (os_timer_start(&stream->subtype_data.crf.t, 0, wake_freq_p, wake_freq_q, 0) < 0)
+		goto err_timer_start;
+
+	return 0;
+
+err_timer_start:
+	os_timer_destroy(&stream->subtype_data.crf.t);
+
+err_timer_create:
+	clock_domain_exit_consumer(&stream->consumer);
+	stream->consumer_enabled = false;
+
+	os_log(LOG_ERR, "talker(%p) could not restart wake-up on new source\n", stream);
+
+	return -1;
+}
+
 /** Creates a talker stream context
  *
  * Allocates memory for the stream context and initializes handles to media stack, media clock capture and network layers
@@ -694,6 +877,15 @@ struct stream_talker *stream_talker_create(struct avtp_ctx *avtp, struct avtp_po
 		flags |= MEDIA_FLAG_WAKEUP;
 
 	stats_init(&stream->stats.sched_intvl, 31, NULL, NULL);
+	stats_init(&stream->stats.launch_lead, 31, NULL, NULL);
+	stats_init(&stream->stats.launch_tx_lead, 31, NULL, NULL);
+	hist_reset(&stream->launch_hist);
+	stream->launch_sample = 0;
+
+	/* Hardware transmit timestamps of the sampled frames, if supported by the network layer */
+	stream->launch_ts_enabled = CFG_AVTP_TALKER_LAUNCH_SAMPLING && !net_tx_ts_enable(&stream->tx);
+	stream->launch_ts_pending = false;
+
 	if (os_clock_gettime32(stream->clock_gptp, &stream->gptp_current) < 0)
 		stream->stats.gptp_err++;
 
@@ -752,6 +944,7 @@ void stream_talker_destroy(struct stream_talker *stream, struct ipc_tx *tx)
 	net_tx_exit(&stream->tx);
 
 	list_del(&stream->common.list);
+	clock_domain_remove_talker(stream->domain, stream);
 	list_add_tail(&stream->common.avtp->stream_destroyed, &stream->common.list);
 
 	stream->common.avtp->stream_talker_count--;
@@ -766,6 +959,7 @@ void stream_talker_destroy(struct stream_talker *stream, struct ipc_tx *tx)
 static void stream_listener_add(struct avtp_port *port, struct stream_listener *stream)
 {
 	list_add_tail(&port->listener, &stream->common.list);
+	clock_domain_add_listener(stream->domain, stream);
 
 	stream->common.avtp->stream_listener_count++;
 }
@@ -822,6 +1016,27 @@ static unsigned int stream_rx_batch(const struct stream_listener *stream, unsign
 	return rx_batch;
 }
 
+/** Closes the clock source recovered from a listener stream
+ *
+ * If the stream is the pending source of a hitless switch, the switch is cancelled and the domain keeps its current
+ * source. Otherwise the source is closed, which only resets the domain state if it is the domain source.
+ *
+ * \return		none
+ * \param stream	pointer to listener stream
+ */
+static void stream_listener_source_close(struct stream_listener *stream)
+{
+	struct clock_source *source = stream->source;
+
+	if (!source)
+		return;
+
+	if (source->grid.domain && (source->grid.domain->pending_source == source) && (source->grid.domain->pending_data == stream))
+		clock_domain_switch_cancel(source->grid.domain);
+	else
+		clock_source_close(source);
+}
+
 /** Creates a listener stream context
  *
  * Allocates memory for the stream context and initializes handles to media stack, media clock recovery and network layers
@@ -953,6 +1168,8 @@ struct stream_listener *stream_listener_create(struct avtp_ctx *avtp, struct avt
 	stats_init(&stream->stats.avb_delay, 31, NULL, NULL);
 	stats_init(&stream->stats.avtp_delay, 31, NULL, NULL);
 	stats_init(&stream->stats.batch, 31, NULL, NULL);
+	hist_reset(&stream->avtp_delay_hist);
+	hist_reset(&stream->margin_hist);
 
 	stream_listener_add(port, stream);
 
@@ -962,8 +1179,7 @@ struct stream_listener *stream_listener_create(struct avtp_ctx *avtp, struct avt
 	return stream;
 
 err_multi:
-	if (stream->source)
-		clock_source_close(stream->source);
+	stream_listener_source_close(stream);
 
 err_clock_source:
 err_clock_domain:
@@ -1006,10 +1222,10 @@ void stream_listener_destroy(struct stream_listener *stream, struct ipc_tx *tx)
 	if (!(stream->common.flags & STREAM_FLAG_NO_MEDIA))
 		media_tx_exit(&stream->media);
 
-	if (stream->source)
-		clock_source_close(stream->source);
+	stream_listener_source_close(stream);
 
 	list_del(&stream->common.list);
+	clock_domain_remove_listener(stream->domain, stream);
 	list_add_tail(&stream->common.avtp->stream_destroyed, &stream->common.list);
 
 	stream->common.avtp->stream_listener_count--;
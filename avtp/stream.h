@@ -33,6 +33,20 @@
 #define STREAM_FLAG_CUSTOM_TSPEC	(1 << 5)	/* Stream params inherited from the media interface */
 #define STREAM_FLAG_DESTROYED		(1 << 6)	/* Stream is destroyed and waits to be freed */
 
+/* The AVTP sequence number is only 8 bits, so a packet behind the last in order sequence number is either late
+ * (reordered/duplicate) or the first one after a loss of more than 256 - STREAM_SEQ_REORDER_WINDOW packets.
+ * Only packets received less than STREAM_SEQ_REORDER_TIME after the last in order one are considered late,
+ * a backward jump after a longer silence is a loss and the sequence number is resynchronized on it. */
+#define STREAM_SEQ_REORDER_WINDOW	16	/* Packets up to this distance behind the last in order sequence number can be late (lost otherwise) */
+#define STREAM_SEQ_REORDER_TIME		1000000	/* Maximum time (ns) between the last in order packet and a late packet */
+
+typedef enum {
+	STREAM_SEQ_IN_ORDER,
+	STREAM_SEQ_LOST,
+	STREAM_SEQ_DUPLICATE,
+	STREAM_SEQ_REORDERED
+} stream_seq_t;
+
 /** Common stream context
  *
  * Common fields to Listener and Talker streams
@@ -53,6 +67,7 @@ struct stream_listener {
 	struct stream_common common;			/* Must be placed at the start of the structure */
 
 	struct clock_domain *domain;
+	struct list_head domain_list;			/* Entry in the clock domain listener list */
 	struct clock_source *source;
 
 	u64 id;						/**< AVTP stream_id, stored as Big Endian */
@@ -77,6 +92,8 @@ struct stream_listener {
 
 	unsigned int subtype;
 	u8 sequence_num;
+	u32 sequence_ts;	/* receive time of the last in order packet */
+	u32 sequence_mask;	/* received packets, bit n set for sequence_num - n (n < STREAM_SEQ_REORDER_WINDOW) */
 	unsigned int mr;
 	unsigned int pkt_received;
 	u32 gptp_current;	/* gptp snapshot taken at the start of the stream batch processing */
@@ -109,7 +126,16 @@ struct stream_listener {
 			unsigned int state;
 			unsigned int period_nominal;
 			unsigned int period_err;
-			unsigned int period;
+			unsigned int period;		/* period estimate, rounded to the ns */
+			u64 period_q32;			/* period estimate, in ns, Q32.32 fixed point */
+			u32 ts_last_frac;		/* fractional part of ts_last (Q0.32), for generated timestamps */
+			u32 ts_index;			/* index of ts_last, in periods */
+			struct {
+				u32 x[CFG_AVTP_CRF_PERIOD_WINDOW];	/* timestamp index, in periods */
+				u64 y[CFG_AVTP_CRF_PERIOD_WINDOW];	/* unwrapped timestamp, in ns */
+				unsigned int n;
+				unsigned int write;
+			} window;			/* last received timestamps, for the period least-squares fit */
 			unsigned int timestamp;
 			struct timer timer;
 			unsigned int free_wheeling_to_locked_delay;
@@ -121,6 +147,8 @@ struct stream_listener {
 		unsigned int media_tx;
 		unsigned int clock_tx;
 		unsigned int pkt_lost;
+		unsigned int seq_duplicate;
+		unsigned int seq_reordered;
 		unsigned int mr;
 		unsigned int tu;
 		unsigned int subtype_err;
@@ -135,6 +163,9 @@ struct stream_listener {
 		struct stats avtp_delay;
 		struct stats batch;
 	} stats;
+
+	struct hist avtp_delay_hist;
+	struct hist margin_hist;	/* presentation time margin (avtp_ts - rx_ts), sampled for every packet */
 };
 
 /** Talker stream context
@@ -146,6 +177,7 @@ struct stream_talker {
 	struct stream_common common;			/* Must be placed at the start of the structure */
 
 	struct clock_domain *domain;
+	struct list_head domain_list;			/* Entry in the clock domain talker list */
 	unsigned int locked_count;
 
 	u64 id;
@@ -196,6 +228,22 @@ struct stream_talker {
 		struct {
 			unsigned int syt_interval_ln2;
 			struct iec_61883_hdr *iec_hdr;
+
+			/* 61883-4 source packet timestamping, driven by the transport stream PCRs */
+			struct iec_61883_4_pcr {
+				bool valid;		/* set if pcr_last/ts_last are a valid anchor */
+				bool pid_locked;	/* set if pid is the PCR_PID the timestamps are derived from */
+				u16 pid;		/* PCR_PID, locked on the first PID seen carrying a PCR */
+				u64 pcr_last;		/* last PCR, in ns */
+				u32 ts_last;		/* timestamp of the source packet carrying the last PCR */
+				unsigned int sp_count;	/* source packets since the last PCR */
+				u32 sp_period;		/* source packet interval between the last two PCRs, in ns (0 if unknown) */
+			} pcr;
+
+			/* 61883-6 underrun concealment */
+			unsigned int conceal;	/* one of AVTP_61883_6_CONCEAL_* */
+			bool last_frame_valid;	/* set if last_frame holds the last frame transmitted */
+			u8 last_frame[CFG_AVTP_61883_6_MAX_CHANNELS * 4];
 		} iec61883;
 
 		struct {
@@ -217,6 +265,10 @@ struct stream_talker {
 			u32 h264_timestamp;
 			u8 nalu_header;
 		} cvf_h264;
+
+		struct {
+			unsigned int pack_max;	/* maximum packed PDU payload size, 0 if packing is disabled */
+		} acf;
 	} subtype_data;
 
 	unsigned int latency;
@@ -237,14 +289,29 @@ struct stream_talker {
 		unsigned int partial;
 		unsigned int clock_invalid;
 		unsigned int gptp_err;
+		unsigned int packed;
+		unsigned int concealed;
+		unsigned int launch_missed;	/* frames dropped by the network stack, launch time missed or invalid */
 
 		struct stats sched_intvl;
+		struct stats launch_lead;	/* requested launch time - network layer handoff time */
+		struct stats launch_tx_lead;	/* requested launch time - hardware transmit time */
+		unsigned int launch_ts_lost;	/* sampled frames without hardware transmit timestamp */
 	} stats;
+
+	unsigned int launch_sample;
+	bool launch_ts_enabled;		/* hardware transmit timestamps enabled on the transmit context */
+	bool launch_ts_pending;
+	u32 launch_ts_id;		/* sampled frame identifier (first 32 bits of the AVTP header) */
+	u32 launch_ts_launch;		/* sampled frame requested launch time */
+	struct hist launch_hist;	/* launch time lead (requested launch time - hardware transmit time if enabled, else network layer handoff time), sampled */
 };
 
 struct ipc_avtp_listener_stats {
 	avb_u64 stream_id;
 	struct listener_stats stats;
+	struct hist_percentiles avtp_delay_pct;
+	struct hist_low_percentiles margin_pct;
 	unsigned int clock_rec_enabled;
 
 	struct ipc_avtp_clock_rec_stats clock_stats;
@@ -253,6 +320,8 @@ struct ipc_avtp_listener_stats {
 struct ipc_avtp_talker_stats {
 	avb_u64 stream_id;
 	struct talker_stats stats;
+	struct hist_low_percentiles launch_pct;
+	unsigned int launch_ts_enabled;	/* launch_pct from hardware transmit timestamps, else from the network layer handoff time */
 };
 
 #define stream_destroy(stream, ipc_tx) \
@@ -267,6 +336,9 @@ struct stream_listener *stream_listener_find(struct avtp_port *port, void *strea
 struct stream_talker *stream_talker_find(struct avtp_port *port, void *stream_id);
 
 void avtp_latency_stats(struct stream_listener *stream, struct avtp_rx_desc *desc);
+void stream_talker_launch_stats(struct stream_talker *stream, u32 launch, u32 handoff);
+void stream_talker_launch_ts_request(struct stream_talker *stream, struct net_tx_desc *desc);
+void stream_talker_launch_errors(struct stream_talker *stream);
 
 struct stream_listener *stream_listener_create(struct avtp_ctx *avtp, struct avtp_port *port, struct ipc_avtp_connect *params);
 void stream_listener_destroy(struct stream_listener *stream, struct ipc_tx *tx);
@@ -285,6 +357,7 @@ void stream_free_all(struct avtp_ctx *avtp);
 
 int stream_clock_consumer_enable(struct stream_talker *stream);
 void stream_clock_consumer_disable(struct stream_talker *stream);
+int stream_clock_consumer_switch_source(struct stream_talker *stream);
 
 unsigned int avtp_stream_presentation_offset(struct stream_talker *stream);
 
@@ -311,8 +384,24 @@ static inline void stream_net_tx_handler(struct stream_talker *stream)
 
 static inline int stream_net_tx(struct stream_talker *stream, struct media_rx_desc **desc, unsigned int n)
 {
+	unsigned int sample = 0;
+	u32 launch = 0, now;
 	int rc;
 
+	/* Sample the launch time of the first packet (the most time critical), descriptors are no longer available after transmit */
+	if (CFG_AVTP_TALKER_LAUNCH_SAMPLING && n && (desc[0]->net.flags & NET_TX_FLAGS_TS)) {
+		if (!stream->launch_sample) {
+			stream->launch_sample = CFG_AVTP_TALKER_LAUNCH_SAMPLING;
+			launch = desc[0]->net.ts;
+			sample = 1;
+
+			if (stream->launch_ts_enabled)
+				stream_talker_launch_ts_request(stream, &desc[0]->net);
+		}
+
+		stream->launch_sample--;
+	}
+
 	/* Send packets */
 	rc = net_tx_multi(&stream->tx, (struct net_tx_desc **)desc, n);
 	if (rc < (int)n) {
@@ -327,6 +416,13 @@ static inline int stream_net_tx(struct stream_talker *stream, struct media_rx_de
 
 	stream->stats.tx += rc;
 
+	if (sample) {
+		if (os_clock_gettime32(stream->clock_gptp, &now) < 0)
+			stream->stats.gptp_err++;
+		else
+			stream_talker_launch_stats(stream, launch, now);
+	}
+
 	return 0;
 }
 
@@ -360,6 +456,66 @@ static inline unsigned int stream_domain_phase_change(struct stream_talker *stre
 	return 0;
 }
 
+/** Classifies a received packet based on its AVTP sequence number
+ * Only in order packets (possibly after a gap) update the listener sequence number, so that a late (reordered)
+ * or duplicate packet does not make the following packet look lost. Late packets are only detected within
+ * STREAM_SEQ_REORDER_WINDOW sequence numbers and STREAM_SEQ_REORDER_TIME (see above), and should be dropped by the caller:
+ * the packets following them have already been passed on. A reordered packet was counted lost by the gap it left,
+ * so it is removed from pkt_lost (a second copy of it is a duplicate).
+ * \return STREAM_SEQ_IN_ORDER, STREAM_SEQ_LOST (packets missing before this one, counted in pkt_lost), STREAM_SEQ_DUPLICATE or STREAM_SEQ_REORDERED
+ * \param stream		pointer to listener stream context
+ * \param sequence_num	received packet sequence number
+ * \param rx_ts		received packet receive time (ns)
+ */
+static inline stream_seq_t stream_listener_seq_check(struct stream_listener *stream, u8 sequence_num, u32 rx_ts)
+{
+	u8 gap, behind;
+	stream_seq_t rc = STREAM_SEQ_IN_ORDER;
+	u32 mask = 0xffffffff;	/* packets before the first one received are not counted lost */
+
+	if (likely(stream->pkt_received)) {
+		gap = sequence_num - (u8)(stream->sequence_num + 1);
+
+		if (unlikely(gap)) {
+			behind = stream->sequence_num - sequence_num;
+
+			if ((behind < STREAM_SEQ_REORDER_WINDOW) && ((rx_ts - stream->sequence_ts) < STREAM_SEQ_REORDER_TIME)) {
+				if (stream->sequence_mask & (1U << behind)) {
+					stream->stats.seq_duplicate++;
+					return STREAM_SEQ_DUPLICATE;
+				} else {
+					stream->sequence_mask |= 1U << behind;
+					stream->stats.pkt_lost--;
+					stream->stats.seq_reordered++;
+					return STREAM_SEQ_REORDERED;
+				}
+			}
+
+			stream->stats.pkt_lost += gap;
+			rc = STREAM_SEQ_LOST;
+		}
+
+		if (gap < STREAM_SEQ_REORDER_WINDOW - 1)
+			mask = stream->sequence_mask << (gap + 1);
+		else
+			mask = 0;
+	}
+
+	stream->sequence_mask = mask | 1;
+	stream->sequence_num = sequence_num;
+	stream->sequence_ts = rx_ts;
+	stream->pkt_received++;
+
+	return rc;
+}
+
+/* Presentation time margin, for every packet with a valid (and certain) timestamp, whatever the stream format */
+static inline void stream_listener_margin_update(struct stream_listener *stream, avb_u32 rx_ts, avb_u32 avtp_ts)
+{
+	hist_update(&stream->margin_hist, avtp_ts - rx_ts);
+}
+
+/* Late/early timestamp counters, the presentation time semantics (and tsamples) are format specific */
 static inline void stream_listener_check_timestamps(struct stream_listener *stream, avb_u32 rx_ts, avb_u32 avtp_ts, unsigned int tsamples)
 {
 	if (is_avtp_ts_late(rx_ts, avtp_ts, tsamples))
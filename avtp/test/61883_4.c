@@ -0,0 +1,298 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief 61883-4 talker source packet timestamps test
+ @details
+ A 61883-4 talker (avtp_61883_4_net_tx()) transmits a generated variable bitrate MPEG2 transport stream of
+ TEST_SP_N source packets, without media stack timestamps, against the simulated services of talker.c.
+ The program clock reference PID carries a PCR every 20 to 40 ms, with TEST_MIN_SP_PER_PCR to TEST_MAX_SP_PER_PCR
+ source packets in between (the bitrate changes at each PCR, gradually or by a step to the maximum). A second program, starting after the first PCR, carries PCRs on
+ another PID with an unrelated time base, which the talker must ignore.
+ The source packet header (SPH) timestamps of the transmitted packets must:
+ - never go backwards,
+ - follow the PCRs once two of them have been seen: the timestamp of a packet carrying a PCR is the
+   timestamp of the first PCR packet plus the PCR difference, unless that would go backwards (the bitrate
+   increased, the timestamp is then held),
+ - be evenly spaced between two PCRs, by the source packet interval measured over the previous two PCRs,
+   shortened by the lead of a held timestamp over the PCR time base (up to half the PCR interval),
+ - never lead the PCR time base by more than TEST_MAX_LEAD.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/61883_iidc.h"
+
+#include "avtp/61883_iidc.h"
+
+#include "talker.h"
+
+#define TEST_SP_N		100000
+#define TEST_MIN_SP_PER_PCR	20
+#define TEST_MAX_SP_PER_PCR	400
+#define TEST_FRAMES_PER_PACKET	7
+#define TEST_TX_BATCH		2
+#define TEST_PCR_PID		0x100
+#define TEST_ES_PID		0x101
+#define TEST_OTHER_PCR_PID	0x200
+#define TEST_MAX_LEAD		(MPEG2TS_PCR_MAX_INTERVAL / 2)
+#define TEST_PCR_BASE		(0x123456789ULL * 300)
+
+struct test_sp {
+	u16 pid;
+	bool pcr;
+	u64 pcr27;	/* PCR, in 27 MHz ticks */
+};
+
+static struct stream_talker stream;
+static struct test_sp sp[TEST_SP_N];
+static u32 sph[TEST_SP_N];
+static unsigned int sp_read, sp_sent;
+
+/* PCR to ns conversion, as done by the talker */
+static u64 test_pcr_ns(u64 pcr27)
+{
+	return (pcr27 * 1000) / (MPEG2TS_PCR_FREQUENCY / 1000000);
+}
+
+static void test_stream_generate(void)
+{
+	u64 pcr27 = TEST_PCR_BASE;
+	unsigned int n = 0, k = 0, rate = TEST_MAX_SP_PER_PCR / 2, i;
+
+	while (n < TEST_SP_N) {
+		/* source packets before the next PCR, the first one comes first. The bitrate changes by up to
+		 * -25%/+33% at each PCR, with an occasional step to the maximum */
+		if (n) {
+			if (!(rand() % 100))
+				rate = TEST_MAX_SP_PER_PCR;
+			else
+				rate = (rate * (75 + rand() % 59)) / 100;
+
+			if (rate < TEST_MIN_SP_PER_PCR)
+				rate = TEST_MIN_SP_PER_PCR;
+			else if (rate > TEST_MAX_SP_PER_PCR)
+				rate = TEST_MAX_SP_PER_PCR;
+
+			k = rate;
+		}
+
+		for (i = 0; (i < k) && (n < TEST_SP_N); i++, n++) {
+			if (!(rand() % 50)) {
+				sp[n].pid = TEST_OTHER_PCR_PID;
+				sp[n].pcr = true;
+				sp[n].pcr27 = ((u64)rand() << 16) ^ rand();
+			} else {
+				sp[n].pid = (rand() % 4) ? TEST_ES_PID : TEST_PCR_PID;
+				sp[n].pcr = false;
+			}
+		}
+
+		if (n == TEST_SP_N)
+			break;
+
+		/* 20 to 40 ms */
+		if (n)
+			pcr27 += (MPEG2TS_PCR_FREQUENCY / 50) + rand() % (MPEG2TS_PCR_FREQUENCY / 50);
+
+		sp[n].pid = TEST_PCR_PID;
+		sp[n].pcr = true;
+		sp[n].pcr27 = pcr27;
+		n++;
+	}
+}
+
+static void test_tsp_write(u8 *tsp, struct test_sp *sp)
+{
+	u64 base = sp->pcr27 / 300;
+	u16 ext = sp->pcr27 % 300;
+
+	memset(tsp, 0xff, IEC_61883_4_SP_PAYLOAD_SIZE);
+
+	tsp[0] = MPEG2TS_SYNC_BYTE;
+	tsp[1] = (sp->pid >> 8) & 0x1f;
+	tsp[2] = sp->pid & 0xff;
+
+	if (sp->pcr) {
+		tsp[3] = 0x30;	/* adaptation field and payload */
+		tsp[4] = IEC_61883_4_SP_PAYLOAD_SIZE - 5;
+		tsp[5] = 0x10;	/* PCR_flag */
+		tsp[6] = base >> 25;
+		tsp[7] = base >> 17;
+		tsp[8] = base >> 9;
+		tsp[9] = base >> 1;
+		tsp[10] = ((base & 0x1) << 7) | 0x7e | ((ext >> 8) & 0x1);
+		tsp[11] = ext & 0xff;
+	} else {
+		tsp[3] = 0x10;	/* payload only */
+	}
+}
+
+static int test_media_rx(struct stream_talker *stream, struct media_rx_desc *desc)
+{
+	u8 *payload = NET_DATA_START(&desc->net);
+	unsigned int j;
+
+	if (sp_read + stream->frames_per_packet > TEST_SP_N)
+		return -1;
+
+	for (j = 0; j < stream->frames_per_packet; j++)
+		test_tsp_write(payload + j * IEC_61883_4_SP_SIZE + (IEC_61883_4_SP_SIZE - IEC_61883_4_SP_PAYLOAD_SIZE), &sp[sp_read++]);
+
+	return 0;
+}
+
+static void test_net_tx(struct stream_talker *stream, void *buf, unsigned int len)
+{
+	u8 *payload = (u8 *)buf + stream->header_len;
+	unsigned int j;
+
+	for (j = 0; j < (len - stream->header_len) / IEC_61883_4_SP_SIZE; j++)
+		sph[sp_sent++] = ntohl(*(u32 *)(payload + j * IEC_61883_4_SP_SIZE));
+}
+
+static struct test_talker_ops test_ops = {
+	.media_rx = test_media_rx,
+	.net_tx = test_net_tx,
+};
+
+static int test_stream_init(void)
+{
+	struct ipc_avtp_connect ipc;
+	unsigned int hdr_len = 0;
+	u64 stream_id = 1;
+
+	memset(&stream, 0, sizeof(stream));
+	memset(&ipc, 0, sizeof(ipc));
+
+	stream.format.u.s.subtype = AVTP_SUBTYPE_61883_IIDC;
+	stream.format.u.s.subtype_u.iec61883.sf = IEC_61883_SF_61883;
+	stream.format.u.s.subtype_u.iec61883.fmt = IEC_61883_CIP_FMT_4;
+	copy_64(&stream.id, &stream_id);
+
+	if (talker_stream_61883_iidc_check(&stream, &stream.format, &ipc) < 0)
+		return -1;
+
+	stream.frames_per_packet = TEST_FRAMES_PER_PACKET;
+	stream.payload_size = TEST_FRAMES_PER_PACKET * IEC_61883_4_SP_SIZE;
+	stream.tx_batch = TEST_TX_BATCH;
+	stream.avtp_hdr = (struct avtp_data_hdr *)stream.header_template;
+
+	stream.init(&stream, &hdr_len);
+
+	stream.header_len = hdr_len;
+
+	test_talker_init(&stream, &test_ops);
+
+	return 0;
+}
+
+static int test_check(void)
+{
+	unsigned int n, prev_pcr = 0, pcr_n = 0, held = 0, errors = 0;
+	u32 expected, anchor_ts = 0, period = 0, interval, lead, max_lead = 0;
+	u64 anchor_pcr = 0;
+
+	for (n = 0; n < sp_sent; n++) {
+		if (n && ((s32)(sph[n] - sph[n - 1]) < 0)) {
+			printf("source packet %u: timestamp %u goes backwards from %u\n", n, sph[n], sph[n - 1]);
+			errors++;
+		}
+
+		if (sp[n].pcr && (sp[n].pid == TEST_PCR_PID)) {
+			/* the first PCR packet anchors the PCR time base */
+			if (!pcr_n) {
+				anchor_ts = sph[n];
+				anchor_pcr = test_pcr_ns(sp[n].pcr27);
+			} else {
+				interval = test_pcr_ns(sp[n].pcr27) - test_pcr_ns(sp[prev_pcr].pcr27);
+				expected = anchor_ts + (u32)(test_pcr_ns(sp[n].pcr27) - anchor_pcr);
+				lead = 0;
+
+				/* a timestamp held back leads the PCR time base */
+				if ((s32)(expected - sph[n - 1]) < 0) {
+					lead = sph[n - 1] - expected;
+					expected = sph[n - 1];
+					held++;
+
+					if (lead > max_lead)
+						max_lead = lead;
+				}
+
+				if (sph[n] != expected) {
+					printf("source packet %u (PCR %u): timestamp %u, expected %u\n", n, pcr_n, sph[n], expected);
+					errors++;
+				}
+
+				if (lead > interval / 2)
+					lead = interval / 2;
+
+				period = (interval - lead) / (n - prev_pcr);
+			}
+
+			prev_pcr = n;
+			pcr_n++;
+		} else if (pcr_n >= 2) {
+			if ((sph[n] - sph[n - 1]) != period) {
+				printf("source packet %u: spacing %u, expected %u\n", n, sph[n] - sph[n - 1], period);
+				errors++;
+			}
+		}
+
+		if (errors > 10)
+			break;
+	}
+
+	printf("%u source packets, %u PCRs, %u timestamps held back, maximum lead over the PCR time base %u ns\n",
+		sp_sent, pcr_n, held, max_lead);
+
+	/* both the PCR locked and held back cases must be covered */
+	if (!held || (held == pcr_n - 1))
+		errors++;
+
+	if (max_lead > TEST_MAX_LEAD) {
+		printf("lead over the PCR time base above %u ns\n", TEST_MAX_LEAD);
+		errors++;
+	}
+
+	return errors ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	srand(1);
+
+	test_stream_generate();
+
+	if (test_stream_init() < 0) {
+		printf("61883-4 talker initialization failed\n");
+		goto fail;
+	}
+
+	while (sp_read + stream.frames_per_packet <= TEST_SP_N)
+		stream.net_tx(&stream);
+
+	if (test_check() < 0)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief 61883-6 talker underrun concealment test
+ @details
+ A 61883-6 AM824 talker (48 kHz, 2 channels, SR class A: 6 frames per packet, SYT interval 8) transmits
+ TEST_PACKET_N packets against the simulated services of talker.c, for each concealment mode. The media stack
+ underruns on a scripted schedule: a partial packet (0 to 5 frames), ending the transmit batch, followed by 0 to
+ 3 wake-ups without any data.
+ With concealment (silence or repeat), the transmitted packets must:
+ - always be full, the missing frames padded with silence (MBLA label, zero sample) or with a copy of the last
+   frame (of the partial packet, or of the previous packet if it has none),
+ - keep the DBC continuous (incremented by 6 for each packet),
+ - carry a timestamp (SYT) exactly when they hold a frame with DBC multiple of 8, with consecutive clock grid
+   timestamps, none skipped.
+ Without concealment, partial packets are sent short and the stream restarts: the DBC restarts from 0 and the
+ timestamps from the next packet.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/61883_iidc.h"
+
+#include "avtp/61883_iidc.h"
+
+#include "talker.h"
+
+#define TEST_PACKET_N		20000
+#define TEST_CHANNELS		2
+#define TEST_TX_BATCH		2
+#define TEST_UNDERRUN_PERMIL	20
+#define TEST_MAX_GAP		3
+#define TEST_SYT_INTERVAL	8
+
+struct test_packet {
+	unsigned int frames;	/* media frames in the packet */
+	u32 first_frame;	/* media frame number of the first frame */
+};
+
+static struct stream_talker stream;
+static unsigned int conceal;
+static unsigned int stride, fpp;
+
+/* Media stack */
+static struct test_packet packets[TEST_PACKET_N];
+static unsigned int packet_read;
+static u32 frame_read;
+static bool blocked;		/* no more data in the current wake-up */
+static unsigned int gap;	/* wake-ups left without data */
+
+/* Transmitted packets checks */
+static unsigned int packet_sent;
+static u32 stream_frames;	/* frames since the stream (re)start */
+static u32 ts_next;
+static bool ts_valid;
+static u8 last_frame[TEST_CHANNELS * 4];
+static unsigned int underruns, concealed, restarts;
+static unsigned int errors;
+
+static u32 test_sample(u32 frame, unsigned int channel)
+{
+	return htonl((IEC_61883_6_AM824_LABEL_MBLA << 24) | ((frame * TEST_CHANNELS + channel) & 0xffffff));
+}
+
+static void test_script(void)
+{
+	unsigned int n;
+
+	for (n = 0; n < TEST_PACKET_N; n++) {
+		if ((n > 8) && ((rand() % 1000) < TEST_UNDERRUN_PERMIL))
+			packets[n].frames = rand() % fpp;
+		else
+			packets[n].frames = fpp;
+	}
+}
+
+static int test_media_rx(struct stream_talker *stream, struct media_rx_desc *desc)
+{
+	struct test_packet *p = &packets[packet_read];
+	u32 *data = NET_DATA_START(&desc->net);
+	unsigned int i, j;
+
+	if (blocked || (packet_read == TEST_PACKET_N))
+		return -1;
+
+	p->first_frame = frame_read;
+
+	for (i = 0; i < p->frames; i++, frame_read++)
+		for (j = 0; j < TEST_CHANNELS; j++)
+			data[i * TEST_CHANNELS + j] = test_sample(frame_read, j);
+
+	desc->net.len = p->frames * stride;
+
+	/* The media stack underruns, the partial packet is the last one until the next wake-ups */
+	if (p->frames < fpp) {
+		desc->net.flags |= NET_TX_FLAGS_PARTIAL;
+		blocked = true;
+		gap = rand() % (TEST_MAX_GAP + 1);
+	}
+
+	packet_read++;
+
+	return 0;
+}
+
+static void test_error(const char *msg, u32 val, u32 expected)
+{
+	printf("packet %u: %s %u, expected %u\n", packet_sent, msg, val, expected);
+	errors++;
+}
+
+static void test_net_tx(struct stream_talker *stream, void *buf, unsigned int len)
+{
+	struct avtp_data_hdr *hdr = buf;
+	struct iec_61883_hdr *iec_hdr = (struct iec_61883_hdr *)(hdr + 1);
+	struct test_packet *p = &packets[packet_sent];
+	u8 *data = (u8 *)buf + stream->header_len;
+	unsigned int frames, i, j;
+	bool syt;
+	u8 *frame;
+
+	frames = (ntohs(hdr->stream_data_length) - sizeof(struct iec_61883_hdr)) / stride;
+
+	if (len != stream->header_len + frames * stride)
+		test_error("frame length", len, stream->header_len + frames * stride);
+
+	if (conceal != AVTP_61883_6_CONCEAL_NONE) {
+		if (frames != fpp)
+			test_error("frames", frames, fpp);
+	} else {
+		if (frames != p->frames)
+			test_error("frames", frames, p->frames);
+	}
+
+	/* Data block count */
+	if (iec_hdr->dbc != (u8)stream_frames)
+		test_error("DBC", iec_hdr->dbc, (u8)stream_frames);
+
+	/* One SYT for each frame with a DBC multiple of the SYT interval */
+	syt = ((stream_frames + TEST_SYT_INTERVAL - 1) / TEST_SYT_INTERVAL) * TEST_SYT_INTERVAL < stream_frames + frames;
+
+	if (hdr->tv != syt)
+		test_error("timestamp valid", hdr->tv, syt);
+
+	if (hdr->tv) {
+		if (ts_valid && (ntohl(hdr->avtp_timestamp) != ts_next))
+			test_error("timestamp", ntohl(hdr->avtp_timestamp), ts_next);
+
+		ts_next = ntohl(hdr->avtp_timestamp) + TEST_TALKER_GRID_PERIOD;
+		ts_valid = true;
+	}
+
+	/* Media frames, followed by the concealed ones */
+	for (i = 0; i < frames; i++) {
+		frame = data + i * stride;
+
+		for (j = 0; j < TEST_CHANNELS; j++) {
+			u32 sample = ((u32 *)frame)[j], expected;
+
+			if (i < p->frames)
+				expected = test_sample(p->first_frame + i, j);
+			else if (conceal == AVTP_61883_6_CONCEAL_REPEAT)
+				expected = ((u32 *)last_frame)[j];
+			else
+				expected = htonl(IEC_61883_6_AM824_LABEL_MBLA << 24);
+
+			if (sample != expected) {
+				test_error("sample", ntohl(sample), ntohl(expected));
+				break;
+			}
+		}
+
+		if (i < p->frames)
+			memcpy(last_frame, frame, stride);
+	}
+
+	if (p->frames < fpp) {
+		underruns++;
+
+		if (conceal != AVTP_61883_6_CONCEAL_NONE) {
+			concealed += fpp - p->frames;
+		} else {
+			/* The stream restarts, from DBC 0, with timestamps not following the previous ones */
+			stream_frames = 0;
+			ts_valid = false;
+			restarts++;
+			packet_sent++;
+			return;
+		}
+	}
+
+	stream_frames += frames;
+	packet_sent++;
+}
+
+static struct test_talker_ops test_ops = {
+	.media_rx = test_media_rx,
+	.net_tx = test_net_tx,
+};
+
+static int test_stream_init(unsigned int mode)
+{
+	struct avdecc_format_iec61883_6_t *iec61883_6;
+	struct ipc_avtp_connect ipc;
+	unsigned int hdr_len = 0;
+	u64 stream_id = 1;
+
+	memset(&stream, 0, sizeof(stream));
+	memset(&ipc, 0, sizeof(ipc));
+
+	stream.class = SR_CLASS_A;
+	stream.format.u.s.subtype = AVTP_SUBTYPE_61883_IIDC;
+	stream.format.u.s.subtype_u.iec61883.sf = IEC_61883_SF_61883;
+	stream.format.u.s.subtype_u.iec61883.fmt = IEC_61883_CIP_FMT_6;
+
+	iec61883_6 = &stream.format.u.s.subtype_u.iec61883.format_u.iec61883_6;
+	iec61883_6->fdf_u.fdf.evt = IEC_61883_6_FDF_EVT_AM824;
+	iec61883_6->fdf_u.fdf.sfc = IEC_61883_6_FDF_SFC_48000;
+	iec61883_6->dbs = TEST_CHANNELS;
+	iec61883_6->nb = 1;
+	iec61883_6->label_mbla_cnt = TEST_CHANNELS;
+
+	copy_64(&stream.id, &stream_id);
+
+	if (mode == AVTP_61883_6_CONCEAL_SILENCE)
+		ipc.flags = IPC_AVTP_FLAGS_CONCEAL_SILENCE;
+	else if (mode == AVTP_61883_6_CONCEAL_REPEAT)
+		ipc.flags = IPC_AVTP_FLAGS_CONCEAL_REPEAT;
+
+	if (talker_stream_61883_iidc_check(&stream, &stream.format, &ipc) < 0)
+		return -1;
+
+	stride = avdecc_fmt_sample_stride(&stream.format);
+	fpp = avdecc_fmt_samples_per_packet(&stream.format, stream.class);
+
+	stream.frames_per_packet = fpp;
+	stream.payload_size = fpp * stride;
+	stream.tx_batch = TEST_TX_BATCH;
+	stream.avtp_hdr = (struct avtp_data_hdr *)stream.header_template;
+
+	stream.init(&stream, &hdr_len);
+
+	stream.header_len = hdr_len;
+
+	if (stream.subtype_data.iec61883.syt_interval_ln2 != 3)
+		return -1;
+
+	test_talker_init(&stream, &test_ops);
+
+	return 0;
+}
+
+static int test_run(unsigned int mode, const char *name)
+{
+	unsigned int errors_prev = errors;
+
+	conceal = mode;
+
+	if (test_stream_init(mode) < 0) {
+		printf("%s: talker initialization failed\n", name);
+		errors++;
+		return -1;
+	}
+
+	srand(1);
+	test_script();
+
+	packet_read = 0;
+	frame_read = 0;
+	blocked = false;
+	gap = 0;
+
+	packet_sent = 0;
+	stream_frames = 0;
+	ts_valid = false;
+	underruns = 0;
+	concealed = 0;
+	restarts = 0;
+
+	while ((packet_sent < TEST_PACKET_N) && (errors - errors_prev < 10)) {
+		if (gap) {
+			gap--;
+		} else {
+			blocked = false;
+		}
+
+		stream.net_tx(&stream);
+	}
+
+	if (conceal != AVTP_61883_6_CONCEAL_NONE) {
+		if (stream.stats.concealed != concealed)
+			test_error("concealed counter", stream.stats.concealed, concealed);
+
+		if (stream.stats.partial)
+			test_error("partial counter", stream.stats.partial, 0);
+	} else {
+		if (stream.stats.partial != restarts)
+			test_error("partial counter", stream.stats.partial, restarts);
+	}
+
+	printf("%-8s: %u packets, %u underruns, %u frames concealed, %u restarts\n",
+		name, packet_sent, underruns, concealed, restarts);
+
+	if (!underruns)
+		errors++;
+
+	return (errors == errors_prev) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	test_run(AVTP_61883_6_CONCEAL_SILENCE, "silence");
+	test_run(AVTP_61883_6_CONCEAL_REPEAT, "repeat");
+	test_run(AVTP_61883_6_CONCEAL_NONE, "none");
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
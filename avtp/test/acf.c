@@ -0,0 +1,395 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief ACF talker message packing test
+ @details
+ TSCF and NTSCF talkers transmit CAN ACF messages, against the simulated services of talker.c. Each message carries
+ a sequence number, the transmitted PDUs are parsed back and must hold all the messages, in order, with the stream
+ data length matching the messages they hold. The packing boundaries are checked for each case, as the number of
+ messages in each PDU (and, for TSCF, the PDU presentation time):
+ - a PDU is filled up to the stream max_frame_size, included,
+ - messages are never packed across transmit batches,
+ - TSCF messages are only packed if their presentation times are within CFG_AVTP_ACF_PACK_DEADLINE of the earliest
+   one in the PDU, which is the PDU presentation time,
+ - without packing, each message is sent in its own PDU.
+ With -b, the test runs a 1 kHz x 64 CAN signals TSCF workload, with and without packing, and reports the messages
+ and frames per second (in stream time) and the host throughput.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "common/types.h"
+#include "common/log.h"
+
+#include "genavb/acf.h"
+
+#include "avtp/acf.h"
+
+#include "talker.h"
+
+#define TEST_CAN_PAYLOAD	8
+#define TEST_MSG_SIZE		(2 + sizeof(struct acf_can_hdr) + TEST_CAN_PAYLOAD)
+#define TEST_MAX_MSG		64
+#define TEST_MAX_PDU		64
+#define TEST_TS_BASE		1000000
+#define TEST_DEADLINE		CFG_AVTP_ACF_PACK_DEADLINE
+#define TEST_TRANSIT		2000000
+
+#define TEST_BENCH_SIGNALS	64
+#define TEST_BENCH_RATE		1000
+#define TEST_BENCH_DURATION	10	/* s, in stream time */
+
+struct test_msg {
+	bool ts_valid;
+	u32 ts;
+};
+
+struct test_case {
+	const char *name;
+	u8 subtype;
+	bool packing;
+	unsigned int max_frame_size;
+	unsigned int tx_batch;
+	unsigned int msg_n;
+	struct test_msg msg[TEST_MAX_MSG];
+	unsigned int pdu_n;	/* expected PDUs */
+	unsigned int pdu_msg_n[TEST_MAX_PDU];	/* expected messages in each PDU */
+	u32 pdu_ts[TEST_MAX_PDU];	/* expected PDU presentation time, 0 if invalid */
+};
+
+static const struct test_case cases[] = {
+	{
+		.name = "NTSCF exact fit", .subtype = AVTP_SUBTYPE_NTSCF, .packing = true,
+		.max_frame_size = 4 * TEST_MSG_SIZE, .tx_batch = 10, .msg_n = 10,
+		.pdu_n = 3, .pdu_msg_n = { 4, 4, 2 },
+	},
+	{
+		.name = "NTSCF one byte short", .subtype = AVTP_SUBTYPE_NTSCF, .packing = true,
+		.max_frame_size = 4 * TEST_MSG_SIZE - 1, .tx_batch = 10, .msg_n = 10,
+		.pdu_n = 4, .pdu_msg_n = { 3, 3, 3, 1 },
+	},
+	{
+		.name = "NTSCF single message per frame", .subtype = AVTP_SUBTYPE_NTSCF, .packing = true,
+		.max_frame_size = 2 * TEST_MSG_SIZE - 1, .tx_batch = 4, .msg_n = 4,
+		.pdu_n = 4, .pdu_msg_n = { 1, 1, 1, 1 },
+	},
+	{
+		.name = "NTSCF transmit batch", .subtype = AVTP_SUBTYPE_NTSCF, .packing = true,
+		.max_frame_size = 1400, .tx_batch = 8, .msg_n = 20,
+		.pdu_n = 3, .pdu_msg_n = { 8, 8, 4 },
+	},
+	{
+		.name = "NTSCF no packing", .subtype = AVTP_SUBTYPE_NTSCF, .packing = false,
+		.max_frame_size = 1400, .tx_batch = 5, .msg_n = 5,
+		.pdu_n = 5, .pdu_msg_n = { 1, 1, 1, 1, 1 },
+	},
+	{
+		.name = "TSCF deadline", .subtype = AVTP_SUBTYPE_TSCF, .packing = true,
+		.max_frame_size = 1400, .tx_batch = 8, .msg_n = 8,
+		.msg = {
+			{ true, TEST_TS_BASE + 1000 },
+			{ true, TEST_TS_BASE },				/* earlier, becomes the PDU presentation time */
+			{ true, TEST_TS_BASE + TEST_DEADLINE },		/* spread at the deadline */
+			{ true, TEST_TS_BASE + TEST_DEADLINE + 1 },	/* spread above the deadline */
+			{ false, 0 },					/* no presentation time, always fits */
+			{ true, TEST_TS_BASE + 2 * TEST_DEADLINE + 2 },	/* spread above the deadline */
+			{ false, 0 },
+			{ true, TEST_TS_BASE + 3 * TEST_DEADLINE },	/* presentation time taken by the PDU */
+		},
+		.pdu_n = 3, .pdu_msg_n = { 3, 2, 3 }, .pdu_ts = { TEST_TS_BASE, TEST_TS_BASE + TEST_DEADLINE + 1, TEST_TS_BASE + 2 * TEST_DEADLINE + 2 },
+	},
+	{
+		.name = "TSCF late presentation time", .subtype = AVTP_SUBTYPE_TSCF, .packing = true,
+		.max_frame_size = 1400, .tx_batch = 3, .msg_n = 3,
+		.msg = {
+			{ false, 0 },
+			{ true, TEST_TS_BASE + TEST_DEADLINE },
+			{ true, TEST_TS_BASE },
+		},
+		.pdu_n = 1, .pdu_msg_n = { 3 }, .pdu_ts = { TEST_TS_BASE },
+	},
+	{
+		.name = "TSCF no packing", .subtype = AVTP_SUBTYPE_TSCF, .packing = false,
+		.max_frame_size = 1400, .tx_batch = 3, .msg_n = 3,
+		.msg = {
+			{ true, TEST_TS_BASE },
+			{ false, 0 },
+			{ true, TEST_TS_BASE + 1 },
+		},
+		.pdu_n = 3, .pdu_msg_n = { 1, 1, 1 }, .pdu_ts = { TEST_TS_BASE, 0, TEST_TS_BASE + 1 },
+	},
+};
+
+static struct stream_talker stream;
+static const struct test_case *tc;
+static unsigned int msg_read, msg_limit;	/* messages handed to the talker, and available in the media interface */
+static unsigned int msg_sent, pdu_sent;
+static u32 bench_ts;
+static unsigned int errors;
+
+static int test_media_rx(struct stream_talker *stream, struct media_rx_desc *desc)
+{
+	u8 *msg = NET_DATA_START(&desc->net);
+	struct acf_can_hdr *can = (struct acf_can_hdr *)(msg + 2);
+	unsigned int len = TEST_MSG_SIZE / 4;
+
+	if (msg_read == msg_limit)
+		return -1;
+
+	memset(msg, 0, TEST_MSG_SIZE);
+
+	msg[0] = (ACF_MSG_TYPE_CAN << 1) | ((len >> 8) & 0x1);
+	msg[1] = len & 0xff;
+	can->can_identifier = msg_read % TEST_BENCH_SIGNALS;
+	*(u32 *)(msg + 2 + sizeof(*can)) = htonl(msg_read);
+
+	desc->net.len = TEST_MSG_SIZE;
+
+	if (tc) {
+		desc->ts_n = tc->msg[msg_read].ts_valid ? 1 : 0;
+		desc->avtp_ts[0].val = tc->msg[msg_read].ts;
+	} else {
+		desc->ts_n = 1;
+		desc->avtp_ts[0].val = bench_ts;
+	}
+
+	msg_read++;
+
+	return 0;
+}
+
+static void test_error(const char *fmt, unsigned int pdu, unsigned int val, unsigned int expected)
+{
+	printf("%s: PDU %u, ", tc->name, pdu);
+	printf(fmt, val, expected);
+	printf("\n");
+
+	errors++;
+}
+
+static void test_net_tx(struct stream_talker *stream, void *buf, unsigned int len)
+{
+	struct avtp_data_hdr *hdr = buf;
+	u8 *msg = (u8 *)buf + stream->header_len;
+	unsigned int data_len, offset = 0, msg_n = 0;
+	u32 ts = 0;
+
+	if (stream->subtype == AVTP_SUBTYPE_TSCF) {
+		data_len = ntohs(hdr->stream_data_length);
+
+		if (hdr->tv)
+			ts = ntohl(hdr->avtp_timestamp);
+	} else {
+		data_len = NTSCF_DATA_LENGTH((struct avtp_ntscf_hdr *)buf);
+	}
+
+	if (len != stream->header_len + data_len)
+		test_error("frame length %u, expected %u", pdu_sent, len, stream->header_len + data_len);
+
+	if (data_len > stream->payload_size)
+		test_error("data length %u above %u", pdu_sent, data_len, stream->payload_size);
+
+	/* Walk the ACF messages */
+	while (offset < data_len) {
+		unsigned int msg_len = (((msg[offset] & 0x1) << 8) | msg[offset + 1]) * 4;
+		u32 seq = ntohl(*(u32 *)(msg + offset + 2 + sizeof(struct acf_can_hdr)));
+
+		if (seq != msg_sent)
+			test_error("message sequence %u, expected %u", pdu_sent, seq, msg_sent);
+
+		offset += msg_len;
+		msg_sent++;
+		msg_n++;
+	}
+
+	if (tc) {
+		if (pdu_sent >= tc->pdu_n) {
+			printf("%s: unexpected PDU %u\n", tc->name, pdu_sent);
+			errors++;
+		} else {
+			if (msg_n != tc->pdu_msg_n[pdu_sent])
+				test_error("%u messages, expected %u", pdu_sent, msg_n, tc->pdu_msg_n[pdu_sent]);
+
+			if ((stream->subtype == AVTP_SUBTYPE_TSCF) && (ts != tc->pdu_ts[pdu_sent]))
+				test_error("presentation time %u, expected %u", pdu_sent, ts, tc->pdu_ts[pdu_sent]);
+		}
+	}
+
+	pdu_sent++;
+}
+
+static struct test_talker_ops test_ops = {
+	.media_rx = test_media_rx,
+	.net_tx = test_net_tx,
+};
+
+static int test_stream_init(u8 subtype, bool packing, unsigned int max_frame_size, unsigned int tx_batch)
+{
+	struct ipc_avtp_connect ipc;
+	unsigned int hdr_len = 0;
+	u64 stream_id = 1;
+	int rc;
+
+	memset(&stream, 0, sizeof(stream));
+	memset(&ipc, 0, sizeof(ipc));
+
+	stream.class = SR_CLASS_A;
+	stream.subtype = subtype;
+	stream.max_transit_time = TEST_TRANSIT;
+	copy_64(&stream.id, &stream_id);
+
+	ipc.talker.max_frame_size = max_frame_size;
+	ipc.talker.max_interval_frames = 1;
+	ipc.flags = packing ? IPC_AVTP_FLAGS_ACF_PACKING : 0;
+
+	if (subtype == AVTP_SUBTYPE_TSCF)
+		rc = talker_stream_acf_tscf_check(&stream, &stream.format, &ipc);
+	else
+		rc = talker_acf_ntscf_check(&stream, &ipc);
+
+	if (rc < 0)
+		return -1;
+
+	stream.payload_size = max_frame_size;
+	stream.tx_batch = tx_batch;
+	stream.avtp_hdr = (struct avtp_data_hdr *)stream.header_template;
+
+	stream.init(&stream, &hdr_len);
+
+	stream.header_len = hdr_len;
+
+	test_talker_init(&stream, &test_ops);
+
+	msg_read = 0;
+	msg_sent = 0;
+	pdu_sent = 0;
+
+	return 0;
+}
+
+static int test_case_run(const struct test_case *c)
+{
+	unsigned int errors_prev = errors;
+
+	tc = c;
+
+	if (test_stream_init(c->subtype, c->packing, c->max_frame_size, c->tx_batch) < 0) {
+		printf("%s: talker initialization failed\n", c->name);
+		return -1;
+	}
+
+	msg_limit = c->msg_n;
+
+	while (msg_read < msg_limit)
+		stream.net_tx(&stream);
+
+	if (msg_sent != c->msg_n)
+		test_error("%u messages sent, expected %u", pdu_sent, msg_sent, c->msg_n);
+
+	if (pdu_sent != c->pdu_n)
+		test_error("%u PDUs sent, expected %u", pdu_sent, pdu_sent, c->pdu_n);
+
+	if (stream.stats.packed != (msg_sent - pdu_sent))
+		test_error("packed counter %u, expected %u", pdu_sent, stream.stats.packed, msg_sent - pdu_sent);
+
+	if (errors == errors_prev)
+		printf("%-32s: %u messages in %u PDUs\n", c->name, msg_sent, pdu_sent);
+
+	return (errors == errors_prev) ? 0 : -1;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* 1 kHz x 64 CAN signals: every ms, all the signals are read from the media interface, in transmit batches */
+static void test_bench(bool packing)
+{
+	unsigned int period, n;
+	double start, duration;
+
+	tc = NULL;
+
+	if (test_stream_init(AVTP_SUBTYPE_TSCF, packing, avtp_mtu(AVTP_SUBTYPE_TSCF), NET_TX_BATCH) < 0) {
+		printf("talker initialization failed\n");
+		errors++;
+		return;
+	}
+
+	msg_limit = 0;
+	bench_ts = TEST_TS_BASE;
+
+	start = test_time();
+
+	for (period = 0; period < TEST_BENCH_DURATION * TEST_BENCH_RATE; period++) {
+		msg_limit += TEST_BENCH_SIGNALS;
+		stream.gptp_current = bench_ts - TEST_TRANSIT;
+
+		for (n = 0; (n < TEST_BENCH_SIGNALS) && (msg_read < msg_limit); n += NET_TX_BATCH)
+			stream.net_tx(&stream);
+
+		bench_ts += NSECS_PER_SEC / TEST_BENCH_RATE;
+	}
+
+	duration = test_time() - start;
+
+	printf("packing %-3s: %u messages/s, %u frames/s (%.1f messages/frame), host %.1f Mmessages/s\n",
+		packing ? "on" : "off", msg_sent / TEST_BENCH_DURATION, pdu_sent / TEST_BENCH_DURATION,
+		(double)msg_sent / pdu_sent, msg_sent / duration / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		test_case_run(&cases[i]);
+
+	if (bench) {
+		test_bench(false);
+		test_bench(true);
+	}
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
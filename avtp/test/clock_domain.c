@@ -0,0 +1,270 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Clock domain stream index test
+ @details
+ TEST_STREAM_N talker and TEST_STREAM_N listener streams are connected to, and disconnected from, TEST_DOMAIN_N
+ clock domains in a seeded random sequence of TEST_STEP_N steps, the domain stream index being updated as on stream
+ connect (clock_domain_add_talker()/clock_domain_add_listener()) and disconnect (clock_domain_remove_talker()/
+ clock_domain_remove_listener()).
+ After each step, and once all streams are disconnected, each domain talker and listener counts, lists and
+ clock_domain_has_stream() must match the connected streams of the domain.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/log.h"
+
+#include "os/clock.h"
+#include "os/timer.h"
+
+#include "avtp/avtp.h"
+#include "avtp/clock_domain.h"
+#include "avtp/stream.h"
+
+#define TEST_DOMAIN_N		4
+#define TEST_STREAM_N		64
+#define TEST_STEP_N		100000
+
+static struct clock_domain domains[TEST_DOMAIN_N];
+static struct stream_talker talkers[TEST_STREAM_N];
+static struct stream_listener listeners[TEST_STREAM_N];
+static bool talker_connected[TEST_STREAM_N];
+static bool listener_connected[TEST_STREAM_N];
+static unsigned int step;
+static unsigned int errors;
+
+/* Services referenced by the clock domain object, not used by the test */
+int os_clock_gettime64(os_clock_id_t id, u64 *ns)
+{
+	*ns = 0;
+
+	return 0;
+}
+
+int os_clock_gettime32(os_clock_id_t id, u32 *ns)
+{
+	*ns = 0;
+
+	return 0;
+}
+
+unsigned int avtp_to_clock(unsigned int port_id)
+{
+	return OS_CLOCK_GPTP_EP_0_0;
+}
+
+int clock_source_init(struct clock_source *source, clock_grid_producer_type_t type, int id, unsigned long priv)
+{
+	return 0;
+}
+
+int clock_source_ready(struct clock_source *source)
+{
+	return 1;
+}
+
+void clock_source_exit(struct clock_source *source)
+{
+}
+
+int clock_source_open(struct clock_source *source, void *data)
+{
+	return 0;
+}
+
+void clock_source_close(struct clock_source *source)
+{
+}
+
+void clock_source_release(struct clock_source *source)
+{
+}
+
+int os_timer_start(struct os_timer *t, u64 value, u64 interval_p, u64 interval_q, unsigned int flags)
+{
+	return 0;
+}
+
+void os_timer_stop(struct os_timer *t)
+{
+}
+
+int stream_clock_consumer_enable(struct stream_talker *stream)
+{
+	return 0;
+}
+
+void stream_clock_consumer_disable(struct stream_talker *stream)
+{
+}
+
+int stream_clock_consumer_switch_source(struct stream_talker *stream)
+{
+	return 0;
+}
+
+struct stream_listener *stream_listener_find(struct avtp_port *port, void *stream_id)
+{
+	return NULL;
+}
+
+static void test_error(struct clock_domain *domain, const char *msg, unsigned int val, unsigned int expected)
+{
+	printf("step %u domain %u: %s %u, expected %u\n", step, domain->id, msg, val, expected);
+	errors++;
+}
+
+static void test_domain_check(struct clock_domain *domain)
+{
+	struct list_head *entry;
+	unsigned int talker_n = 0, listener_n = 0, n;
+	int i;
+
+	for (i = 0; i < TEST_STREAM_N; i++) {
+		if (talker_connected[i] && (talkers[i].domain == domain))
+			talker_n++;
+
+		if (listener_connected[i] && (listeners[i].domain == domain))
+			listener_n++;
+	}
+
+	if (domain->talker_count != talker_n)
+		test_error(domain, "talker count", domain->talker_count, talker_n);
+
+	if (domain->listener_count != listener_n)
+		test_error(domain, "listener count", domain->listener_count, listener_n);
+
+	if (clock_domain_has_stream(domain) != (talker_n || listener_n))
+		test_error(domain, "has stream", clock_domain_has_stream(domain), talker_n || listener_n);
+
+	/* Lists hold exactly the connected streams of the domain */
+	n = 0;
+	for (entry = list_first(&domain->talkers); entry != &domain->talkers; entry = list_next(entry), n++) {
+		struct stream_talker *stream = container_of(entry, struct stream_talker, domain_list);
+
+		if ((stream->domain != domain) || !talker_connected[stream - talkers])
+			test_error(domain, "talker list entry", stream - talkers, 0);
+
+		if (n > TEST_STREAM_N)
+			break;
+	}
+
+	if (n != talker_n)
+		test_error(domain, "talker list length", n, talker_n);
+
+	n = 0;
+	for (entry = list_first(&domain->listeners); entry != &domain->listeners; entry = list_next(entry), n++) {
+		struct stream_listener *stream = container_of(entry, struct stream_listener, domain_list);
+
+		if ((stream->domain != domain) || !listener_connected[stream - listeners])
+			test_error(domain, "listener list entry", stream - listeners, 0);
+
+		if (n > TEST_STREAM_N)
+			break;
+	}
+
+	if (n != listener_n)
+		test_error(domain, "listener list length", n, listener_n);
+}
+
+static void test_check(void)
+{
+	int i;
+
+	for (i = 0; i < TEST_DOMAIN_N; i++)
+		test_domain_check(&domains[i]);
+}
+
+/* Connects an idle stream to a random domain, or disconnects a connected one */
+static void test_step(void)
+{
+	unsigned int i = rand() % TEST_STREAM_N;
+	struct clock_domain *domain = &domains[rand() % TEST_DOMAIN_N];
+
+	if (rand() % 2) {
+		if (!talker_connected[i]) {
+			talkers[i].domain = domain;
+			clock_domain_add_talker(domain, &talkers[i]);
+		} else {
+			clock_domain_remove_talker(talkers[i].domain, &talkers[i]);
+		}
+
+		talker_connected[i] = !talker_connected[i];
+	} else {
+		if (!listener_connected[i]) {
+			listeners[i].domain = domain;
+			clock_domain_add_listener(domain, &listeners[i]);
+		} else {
+			clock_domain_remove_listener(listeners[i].domain, &listeners[i]);
+		}
+
+		listener_connected[i] = !listener_connected[i];
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int max_streams = 0, streams;
+	int i;
+
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	srand(1);
+
+	for (i = 0; i < TEST_DOMAIN_N; i++)
+		clock_domain_init(&domains[i], i, 0);
+
+	for (step = 0; step < TEST_STEP_N; step++) {
+		test_step();
+		test_check();
+
+		streams = 0;
+		for (i = 0; i < TEST_DOMAIN_N; i++)
+			streams += domains[i].talker_count + domains[i].listener_count;
+
+		if (streams > max_streams)
+			max_streams = streams;
+
+		if (errors > 10)
+			goto fail;
+	}
+
+	/* Disconnect all streams */
+	for (i = 0; i < TEST_STREAM_N; i++) {
+		if (talker_connected[i]) {
+			clock_domain_remove_talker(talkers[i].domain, &talkers[i]);
+			talker_connected[i] = false;
+		}
+
+		if (listener_connected[i]) {
+			clock_domain_remove_listener(listeners[i].domain, &listeners[i]);
+			listener_connected[i] = false;
+		}
+	}
+
+	test_check();
+
+	printf("%u steps, up to %u streams connected\n", TEST_STEP_N, max_streams);
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Clock grid single producer/multiple consumers stress test
+ @details
+ One producer thread writes timestamps to a grid ring and publishes them in random sized batches, while several
+ consumer threads (some of them decimated) read them concurrently with clock_grid_consumer_get_ts(). The producer
+ never gets further than the grid valid window ahead of the slowest consumer, so every consumer must read the
+ exact timestamp sequence written by the producer, without reset or offset adjustment.
+ With -b, the test is run for longer with 1, 2 and 4 consumers and the timestamp throughput is reported.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "common/log.h"
+#include "common/ipc.h"
+
+#include "avtp/clock_grid.h"
+#include "avtp/media_clock.h"
+
+#define TEST_MAX_CONSUMERS	4
+#define TEST_TS_N		(4 * 1000 * 1000)
+#define TEST_BENCH_TS_N		(50 * 1000 * 1000)
+#define TEST_PRODUCER_BATCH	16
+#define TEST_CONSUMER_BATCH	24
+#define TEST_FREQ		48000
+#define TEST_TS_BASE		1000
+
+struct test_consumer {
+	struct clock_grid_consumer consumer;
+	pthread_t thread;
+	unsigned int decim;
+	u32 progress;		/* grid count read so far, shared with the producer */
+	unsigned int started;	/* shared with the producer */
+	u32 next_ts;
+	unsigned int ts_n;
+	unsigned int errors;
+};
+
+static struct clock_grid grid;
+static u32 ring[MCG_TS_SIZE];
+static struct test_consumer consumers[TEST_MAX_CONSUMERS];
+static unsigned int consumers_n;
+static unsigned int total_ts_n;
+
+/* Grid producer, only the domain scheduler (clock_domain_grids_update()) calls it */
+static void test_ts_update(struct clock_grid *grid, unsigned int requested, unsigned int *reset)
+{
+	*reset = 0;
+}
+
+/* Writes n new timestamps to the ring and publishes them, as the grid producers do (see ts_put()) */
+static void test_produce(unsigned int n)
+{
+	u32 write_index = grid.write_index;
+	u32 count = grid.count;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		grid.ts[write_index] = TEST_TS_BASE + (count + i) * grid.nominal_period;
+		write_index = (write_index + 1) & (grid.ring_size - 1);
+	}
+
+	clock_grid_publish(&grid, write_index, count + n);
+	clock_grid_update_valid_count(&grid);
+}
+
+static u32 test_max_lag(void)
+{
+	u32 lag, max = 0;
+	int i;
+
+	for (i = 0; i < consumers_n; i++) {
+		lag = grid.count - __atomic_load_n(&consumers[i].progress, __ATOMIC_ACQUIRE);
+		if (lag > max)
+			max = lag;
+	}
+
+	return max;
+}
+
+static void *producer_thread(void *arg)
+{
+	unsigned int seed = 1;
+	unsigned int started;
+	unsigned int n;
+	int i;
+
+	/* Prefill the consumers start window and wait for all of them to lock on the grid */
+	test_produce(grid.max_start_count);
+
+	do {
+		started = 0;
+		for (i = 0; i < consumers_n; i++)
+			started += __atomic_load_n(&consumers[i].started, __ATOMIC_ACQUIRE);
+
+		sched_yield();
+	} while (started < consumers_n);
+
+	while (grid.count < total_ts_n) {
+		n = 1 + rand_r(&seed) % TEST_PRODUCER_BATCH;
+		if (n > total_ts_n - grid.count)
+			n = total_ts_n - grid.count;
+
+		/* Stay within the grid valid window of the slowest consumer */
+		while (test_max_lag() + n > grid.max_valid_count)
+			sched_yield();
+
+		test_produce(n);
+	}
+
+	return NULL;
+}
+
+static void *consumer_thread(void *arg)
+{
+	struct test_consumer *c = arg;
+	u32 ts[TEST_CONSUMER_BATCH];
+	unsigned int flags;
+	int n, i;
+
+	while (c->consumer.count < total_ts_n) {
+		flags = 0;
+
+		n = clock_grid_consumer_get_ts(&c->consumer, ts, TEST_CONSUMER_BATCH, &flags, 0);
+
+		for (i = 0; i < n; i++) {
+			if (c->ts_n && (ts[i] != c->next_ts))
+				c->errors++;
+
+			c->next_ts = ts[i] + c->decim * grid.nominal_period;
+			c->ts_n++;
+		}
+
+		if (flags & MCG_FLAGS_RESET)
+			c->errors++;
+
+		if (n) {
+			__atomic_store_n(&c->progress, c->consumer.count, __ATOMIC_RELEASE);
+			__atomic_store_n(&c->started, 1, __ATOMIC_RELEASE);
+		} else {
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int test_run(unsigned int n, unsigned int ts_n, double *duration)
+{
+	pthread_t producer;
+	double start;
+	int rc = 0;
+	int i;
+
+	memset(&grid, 0, sizeof(grid));
+	memset(consumers, 0, sizeof(consumers));
+
+	grid.flags = CLOCK_GRID_FLAGS_STATIC;
+
+	if (clock_grid_init(&grid, GRID_PRODUCER_HW, ring, MCG_TS_SIZE, TEST_FREQ, 1, test_ts_update) < 0)
+		return -1;
+
+	consumers_n = n;
+	total_ts_n = ts_n;
+
+	for (i = 0; i < consumers_n; i++) {
+		struct test_consumer *c = &consumers[i];
+
+		c->decim = 1 + (i & 1);
+
+		if (clock_grid_consumer_attach(&c->consumer, &grid, 0, 0) < 0)
+			return -1;
+
+		if (clock_grid_consumer_set_decimation(&c->consumer, 1, c->decim) < 0)
+			return -1;
+	}
+
+	start = test_time();
+
+	for (i = 0; i < consumers_n; i++)
+		pthread_create(&consumers[i].thread, NULL, consumer_thread, &consumers[i]);
+
+	pthread_create(&producer, NULL, producer_thread, NULL);
+
+	pthread_join(producer, NULL);
+
+	for (i = 0; i < consumers_n; i++)
+		pthread_join(consumers[i].thread, NULL);
+
+	*duration = test_time() - start;
+
+	for (i = 0; i < consumers_n; i++) {
+		struct test_consumer *c = &consumers[i];
+
+		if (c->errors || c->consumer.stats.err_reset || c->consumer.offset) {
+			printf("consumer %d (decimation 1/%u): %u timestamps, %u errors, %u resets, offset %u\n",
+				i, c->decim, c->ts_n, c->errors, c->consumer.stats.err_reset, c->consumer.offset);
+			rc = -1;
+		}
+
+		clock_grid_consumer_exit(&c->consumer);
+	}
+
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	unsigned int n;
+	double duration;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (!bench) {
+		if (test_run(TEST_MAX_CONSUMERS, TEST_TS_N, &duration) < 0) {
+			printf("FAIL\n");
+			return 1;
+		}
+
+		printf("PASS\n");
+		return 0;
+	}
+
+	for (n = 1; n <= TEST_MAX_CONSUMERS; n *= 2) {
+		if (test_run(n, TEST_BENCH_TS_N, &duration) < 0) {
+			printf("FAIL\n");
+			return 1;
+		}
+
+		printf("%u consumer(s): %u timestamps in %.3f s, %.1f Mts/s\n", n, TEST_BENCH_TS_N, duration, TEST_BENCH_TS_N / duration / 1e6);
+	}
+
+	return 0;
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Clock domain hitless source switch test
+ @details
+ A clock domain runs on a simulated source grid, with talker consumers at the source frequency and at twice
+ the source frequency, attached through clock_domain_init_consumer(). A second source, with a different phase
+ and a small frequency offset, is then set as the domain pending source (as clock_domain_switch_source() does)
+ and a third consumer, at the source frequency, is attached while the switch is pending. The domain scheduler
+ (clock_domain_sched()) runs on a simulated gPTP time, and completes the switch once the new source is locked.
+ All consumers must keep reading timestamps every scheduler period, without reset, and the spacing between
+ consecutive timestamps must never differ from the grid period by more than one grid period.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/log.h"
+#include "common/ipc.h"
+
+#include "os/clock.h"
+#include "os/stdlib.h"
+#include "os/timer.h"
+
+#include "avtp/avtp.h"
+#include "avtp/clock_domain.h"
+#include "avtp/media_clock.h"
+#include "avtp/stream.h"
+
+#define TEST_FREQ		8000
+#define TEST_STEP		(1 * NSECS_PER_MS)	/* domain scheduler period */
+#define TEST_LEAD		(4 * NSECS_PER_MS)	/* source timestamps generated ahead of time */
+#define TEST_SWITCH_TIME	(200 * NSECS_PER_MS)
+#define TEST_DURATION		(500 * NSECS_PER_MS)
+#define TEST_B_PHASE		(NSECS_PER_SEC / TEST_FREQ * 2 / 5)
+#define TEST_B_PPM		20
+#define TEST_T0			(1000 * NSECS_PER_MS)
+
+struct test_source {
+	struct clock_source source;
+	u32 ring[MCG_TS_SIZE];
+	u64 start;		/* first timestamp, in ns */
+	u64 k;			/* timestamps generated */
+	unsigned int ppm;
+};
+
+struct test_consumer {
+	struct clock_grid_consumer consumer;
+	unsigned int freq;
+	u64 start;		/* time the consumer is attached */
+	bool init;
+	u32 prev_ts;
+	u32 max_err;
+	unsigned int ts_n;
+	unsigned int errors;
+};
+
+static u64 sim_now;
+static struct clock_domain domain;
+static struct test_source sources[2];
+static struct test_consumer consumers[3] = {
+	{ .freq = TEST_FREQ, .start = 0 },
+	{ .freq = 2 * TEST_FREQ, .start = 0 },
+	{ .freq = TEST_FREQ, .start = TEST_SWITCH_TIME },
+};
+
+/* Simulated gPTP time */
+int os_clock_gettime64(os_clock_id_t id, u64 *ns)
+{
+	*ns = sim_now;
+
+	return 0;
+}
+
+int os_clock_gettime32(os_clock_id_t id, u32 *ns)
+{
+	*ns = (u32)sim_now;
+
+	return 0;
+}
+
+unsigned int avtp_to_clock(unsigned int port_id)
+{
+	return OS_CLOCK_GPTP_EP_0_0;
+}
+
+/* Clock sources, the grids are set up by the test */
+int clock_source_init(struct clock_source *source, clock_grid_producer_type_t type, int id, unsigned long priv)
+{
+	return 0;
+}
+
+int clock_source_ready(struct clock_source *source)
+{
+	return 1;
+}
+
+void clock_source_exit(struct clock_source *source)
+{
+}
+
+int clock_source_open(struct clock_source *source, void *data)
+{
+	return 0;
+}
+
+void clock_source_close(struct clock_source *source)
+{
+}
+
+void clock_source_release(struct clock_source *source)
+{
+}
+
+int os_timer_start(struct os_timer *t, u64 value, u64 interval_p, u64 interval_q, unsigned int flags)
+{
+	return 0;
+}
+
+void os_timer_stop(struct os_timer *t)
+{
+}
+
+/* Streams, the domain has no talker or listener stream */
+int stream_clock_consumer_enable(struct stream_talker *stream)
+{
+	return 0;
+}
+
+void stream_clock_consumer_disable(struct stream_talker *stream)
+{
+}
+
+int stream_clock_consumer_switch_source(struct stream_talker *stream)
+{
+	return 0;
+}
+
+struct stream_listener *stream_listener_find(struct avtp_port *port, void *stream_id)
+{
+	return NULL;
+}
+
+/* Source grid producer, generates timestamps up to TEST_LEAD ahead of the simulated time */
+static void test_source_ts_update(struct clock_grid *grid, unsigned int requested, unsigned int *reset)
+{
+	struct test_source *s = container_of(grid, struct test_source, source.grid);
+	u64 period_ppb = (u64)grid->nominal_period * (1000000000ULL + s->ppm * 1000ULL);
+	u64 ts;
+
+	*reset = 0;
+
+	while (1) {
+		ts = s->start + (s->k * period_ppb) / 1000000000ULL;
+		if (ts > sim_now + TEST_LEAD)
+			break;
+
+		grid->ts[grid->write_index] = (u32)ts;
+		clock_grid_publish(grid, (grid->write_index + 1) & (grid->ring_size - 1), grid->count + 1);
+		s->k++;
+	}
+}
+
+static int test_source_init(struct test_source *s, u64 start, unsigned int ppm)
+{
+	struct clock_grid *grid = &s->source.grid;
+
+	memset(s, 0, sizeof(*s));
+
+	s->start = start;
+	s->ppm = ppm;
+
+	grid->flags = CLOCK_GRID_FLAGS_STATIC;
+	grid->producer.type = GRID_PRODUCER_PTP;
+
+	return clock_grid_init(grid, GRID_PRODUCER_PTP, s->ring, MCG_TS_SIZE, TEST_FREQ, 1, test_source_ts_update);
+}
+
+static void test_consumer_read(struct test_consumer *c, unsigned int n)
+{
+	u32 period = NSECS_PER_SEC / c->freq;
+	u32 ts[64];
+	unsigned int flags = 0;
+	u32 err;
+	int rc, i;
+
+	rc = clock_grid_consumer_get_ts(&c->consumer, ts, n, &flags, 0);
+	if (rc != n) {
+		printf("consumer %u Hz: %d timestamps out of %u at %llu ms\n", c->freq, rc, n, (unsigned long long)(sim_now / NSECS_PER_MS));
+		c->errors++;
+	}
+
+	if (c->init && (flags & MCG_FLAGS_RESET)) {
+		printf("consumer %u Hz: reset at %llu ms\n", c->freq, (unsigned long long)(sim_now / NSECS_PER_MS));
+		c->errors++;
+	}
+
+	for (i = 0; i < rc; i++) {
+		if (c->init) {
+			err = os_abs((int)(ts[i] - c->prev_ts) - (int)period);
+			if (err > c->max_err)
+				c->max_err = err;
+
+			if (err > period) {
+				printf("consumer %u Hz: spacing %u ns at %llu ms\n", c->freq, ts[i] - c->prev_ts, (unsigned long long)(sim_now / NSECS_PER_MS));
+				c->errors++;
+			}
+		}
+
+		c->prev_ts = ts[i];
+		c->init = true;
+		c->ts_n++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct test_consumer *c;
+	unsigned int switched = 0, errors = 0;
+	int i;
+
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	memset(&domain, 0, sizeof(domain));
+	list_head_init(&domain.grids);
+
+	for (i = 0; i < CFG_SR_CLASS_MAX; i++)
+		list_head_init(&domain.sched_streams[i]);
+
+	list_head_init(&domain.talkers);
+	list_head_init(&domain.listeners);
+
+	sim_now = TEST_T0;
+
+	if (test_source_init(&sources[0], TEST_T0, 0) < 0)
+		goto fail;
+
+	if (clock_domain_set_source(&domain, &sources[0].source, NULL) < 0)
+		goto fail;
+
+	clock_domain_grids_update(&domain);
+
+	for (sim_now = TEST_T0; sim_now < TEST_T0 + TEST_DURATION; sim_now += TEST_STEP) {
+		if (sim_now == TEST_T0 + TEST_SWITCH_TIME) {
+			/* Pending source, as set up by clock_domain_switch_source() */
+			if (test_source_init(&sources[1], sim_now + TEST_B_PHASE, TEST_B_PPM) < 0)
+				goto fail;
+
+			clock_domain_add_grid(&domain, &sources[1].source.grid);
+			domain.pending_source = &sources[1].source;
+			domain.pending_time = sim_now;
+		}
+
+		for (i = 0; i < 3; i++) {
+			c = &consumers[i];
+
+			if (sim_now == TEST_T0 + c->start)
+				if (clock_domain_init_consumer(&domain, &c->consumer, 0, c->freq, 1, 0, 0) < 0)
+					goto fail;
+		}
+
+		clock_domain_sched(&domain, 0);
+
+		if (!switched && (domain.source == &sources[1].source)) {
+			printf("switched to the new source at %llu ms\n", (unsigned long long)((sim_now - TEST_T0) / NSECS_PER_MS));
+			switched = 1;
+		}
+
+		for (i = 0; i < 3; i++) {
+			c = &consumers[i];
+
+			if (sim_now >= TEST_T0 + c->start)
+				test_consumer_read(c, (u64)c->freq * TEST_STEP / NSECS_PER_SEC);
+
+			if (c->errors > 10)
+				goto fail;
+		}
+	}
+
+	if (!switched) {
+		printf("no switch to the new source\n");
+		goto fail;
+	}
+
+	for (i = 0; i < 3; i++) {
+		c = &consumers[i];
+
+		printf("consumer %u Hz: %u timestamps, maximum spacing error %u ns\n", c->freq, c->ts_n, c->max_err);
+		errors += c->errors;
+	}
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief CRF listener period tracking and holdover test
+ @details
+ A CRF listener (48 kHz base frequency, timestamp interval 160, 6 timestamps per PDU: a 3333333.333 ns nominal
+ period) receives the PDUs of a talker running TEST_PPM away from nominal, with a seeded +/- TEST_JITTER ns jitter on
+ each timestamp, for TEST_LOCKED_TIME. The PDUs then stop and the listener free-wheels for TEST_HOLDOVER_TIME, on
+ its own timer (called by the test at each expiration, on a simulated gPTP time).
+ The phase error of the timestamps handed to the clock source grid, against the talker time base (without jitter),
+ must stay below TEST_MAX_PHASE_ERR over the whole holdover. An integer period (the talker period rounded to the
+ ns) would drift by ~360 us over the hour.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/log.h"
+#include "common/timer.h"
+
+#include "os/clock.h"
+#include "os/stdlib.h"
+
+#include "avtp/avtp.h"
+#include "avtp/clock_domain.h"
+#include "avtp/crf.h"
+#include "avtp/media_clock.h"
+#include "avtp/stream.h"
+
+#define TEST_BASE_FREQ		48000
+#define TEST_TS_INTERVAL	160
+#define TEST_TS_PER_PDU		6
+#define TEST_PPM		25
+#define TEST_JITTER		5
+#define TEST_TRANSIT_TIME	(2 * NSECS_PER_MS)
+#define TEST_LOCKED_TIME	(10ULL * NSECS_PER_SEC)
+#define TEST_HOLDOVER_TIME	(3600ULL * NSECS_PER_SEC)
+#define TEST_MAX_PHASE_ERR	50000
+#define TEST_T0			(1000ULL * NSECS_PER_SEC)
+#define TEST_DESC_SIZE		256
+
+static u64 sim_now;
+static struct stream_listener stream;
+static struct avtp_ctx avtp;
+static struct clock_domain domain;
+static struct clock_source source;
+
+/* Talker time base, in ns (Q32.32) */
+static u64 period_q32;
+static u64 ts_k;		/* timestamps handed to the clock source grid */
+static bool holdover;
+static s64 max_err, last_err;
+static unsigned int errors;
+
+static u8 desc_buf[TEST_DESC_SIZE] __attribute__ ((aligned (64)));
+
+/* Simulated gPTP time */
+int os_clock_gettime64(os_clock_id_t id, u64 *ns)
+{
+	*ns = sim_now;
+
+	return 0;
+}
+
+int os_clock_gettime32(os_clock_id_t id, u32 *ns)
+{
+	*ns = (u32)sim_now;
+
+	return 0;
+}
+
+/* Single timer, expired by the test */
+static struct timer *test_timer;
+static u64 test_timer_expiry;
+
+int timer_init(struct timer_ctx *tctx, struct timer *t, unsigned int flags, unsigned int ms)
+{
+	return 0;
+}
+
+int timer_start(struct timer *t, unsigned int ms)
+{
+	test_timer = t;
+	test_timer_expiry = sim_now + (u64)ms * NSECS_PER_MS;
+
+	return 0;
+}
+
+void timer_stop(struct timer *t)
+{
+	test_timer = NULL;
+}
+
+int timer_is_running(struct timer *t)
+{
+	return test_timer == t;
+}
+
+int timer_destroy(struct timer *t)
+{
+	return 0;
+}
+
+/* Talker side of the CRF object, not used by the test */
+unsigned int avtp_stream_presentation_offset(struct stream_talker *stream)
+{
+	return 0;
+}
+
+void stream_talker_launch_stats(struct stream_talker *stream, u32 launch, u32 handoff)
+{
+}
+
+void stream_talker_launch_ts_request(struct stream_talker *stream, struct net_tx_desc *desc)
+{
+}
+
+int clock_grid_consumer_get_ts(struct clock_grid_consumer *consumer, u32 *ts, unsigned int ts_n, unsigned int *flags, unsigned int alignment_ts)
+{
+	return -1;
+}
+
+void clock_domain_grids_update(struct clock_domain *domain)
+{
+}
+
+int net_tx_alloc_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n, unsigned int size)
+{
+	return -1;
+}
+
+int net_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n)
+{
+	return -1;
+}
+
+void clock_domain_set_state(struct clock_domain *domain, clock_domain_state_t state)
+{
+}
+
+void clock_domain_clear_state(struct clock_domain *domain, clock_domain_state_t state)
+{
+}
+
+void avtp_latency_stats(struct stream_listener *stream, struct avtp_rx_desc *desc)
+{
+}
+
+void net_free_multi(void **buf, unsigned int n)
+{
+}
+
+void net_rx_free(struct net_rx_desc *desc)
+{
+}
+
+static u64 test_talker_ts(u64 k)
+{
+	return TEST_T0 + (k * (period_q32 >> 32)) + ((k * (period_q32 & 0xffffffff)) >> 32);
+}
+
+/* Clock source grid, checks the timestamps produced by the listener against the talker time base */
+void clock_producer_stream_rx(struct clock_grid *grid, struct timestamp *ts, unsigned *ts_n, unsigned int do_stitch)
+{
+	s64 err;
+	int i;
+
+	for (i = 0; i < *ts_n; i++, ts_k++) {
+		err = (s32)(ts[i].ts_nsec - (u32)test_talker_ts(ts_k));
+
+		if (!holdover) {
+			if (os_abs(err) > TEST_JITTER) {
+				printf("timestamp %llu: locked phase error %lld ns\n", (unsigned long long)ts_k, (long long)err);
+				errors++;
+			}
+
+			continue;
+		}
+
+		if (os_abs(err) > max_err)
+			max_err = os_abs(err);
+
+		last_err = err;
+	}
+}
+
+static void test_pdu_rx(unsigned int seq, u64 k)
+{
+	struct avtp_rx_desc *desc = (struct avtp_rx_desc *)desc_buf;
+	struct avtp_crf_hdr *hdr;
+	u32 *data;
+	u64 ts;
+	int j;
+
+	memset(desc_buf, 0, sizeof(desc_buf));
+
+	desc->desc.l3_offset = 128;
+	hdr = (struct avtp_crf_hdr *)(desc_buf + desc->desc.l3_offset);
+
+	hdr->subtype = AVTP_SUBTYPE_CRF;
+	hdr->sv = 1;
+	hdr->sequence_num = seq;
+	hdr->type = CRF_TYPE_AUDIO_SAMPLE;
+	hdr->pull = CRF_PULL_1_1;
+	CRF_BASE_FREQUENCY_SET(hdr, TEST_BASE_FREQ);
+	hdr->crf_data_length = htons(TEST_TS_PER_PDU * 8);
+	hdr->timestamp_interval = htons(TEST_TS_INTERVAL);
+
+	data = (u32 *)(hdr + 1);
+
+	for (j = 0; j < TEST_TS_PER_PDU; j++) {
+		ts = test_talker_ts(k + j) + (rand() % (2 * TEST_JITTER + 1)) - TEST_JITTER;
+
+		data[2 * j] = htonl(ts >> 32);
+		data[2 * j + 1] = htonl((u32)ts);
+	}
+
+	/* received half the transit time before the first timestamp */
+	sim_now = test_talker_ts(k) - TEST_TRANSIT_TIME / 2;
+	desc->desc.ts = (u32)sim_now;
+	stream.gptp_current = (u32)sim_now;
+
+	stream.net_rx(&stream, &desc, 1);
+}
+
+static int test_stream_init(void)
+{
+	struct avdecc_format *format = &stream.format;
+	u64 nominal_ps;
+
+	memset(&stream, 0, sizeof(stream));
+
+	stream.class = SR_CLASS_A;
+	stream.common.avtp = &avtp;
+	stream.max_transit_time = TEST_TRANSIT_TIME;
+
+	format->u.s.subtype = AVTP_SUBTYPE_CRF;
+	format->u.s.subtype_u.crf.type = CRF_TYPE_AUDIO_SAMPLE;
+	format->u.s.subtype_u.crf.pull = CRF_PULL_1_1;
+	format->u.s.subtype_u.crf.timestamps_per_pdu = TEST_TS_PER_PDU;
+	AVDECC_FMT_CRF_BASE_FREQUENCY_SET(format, TEST_BASE_FREQ);
+	AVDECC_FMT_CRF_TIMESTAMP_INTERVAL_SET(format, TEST_TS_INTERVAL);
+
+	if (listener_crf_check(&stream, format, 0) < 0)
+		return -1;
+
+	if (stream.init(&stream) < 0)
+		return -1;
+
+	/* The listener hands its timestamps over to the domain source grid */
+	domain.source = &source;
+	source.grid.domain = &domain;
+	stream.source = &source;
+
+	/* Talker period, TEST_PPM away from nominal, in ns Q32.32 */
+	nominal_ps = (NSECS_PER_SEC * 1000ULL * TEST_TS_INTERVAL) / TEST_BASE_FREQ;
+	period_q32 = ((nominal_ps + (nominal_ps * TEST_PPM) / 1000000) << 32) / 1000;
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	u64 k = 0, holdover_end;
+	unsigned int seq = 0, timeouts = 0;
+
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	srand(1);
+
+	if (test_stream_init() < 0) {
+		printf("CRF listener initialization failed\n");
+		goto fail;
+	}
+
+	/* Locked on the received PDUs */
+	while (test_talker_ts(k) < TEST_T0 + TEST_LOCKED_TIME) {
+		test_pdu_rx(seq++, k);
+		k += TEST_TS_PER_PDU;
+
+		if (errors > 10)
+			goto fail;
+	}
+
+	printf("locked: %llu timestamps, period %u ns (%llu.%03llu ns fitted, talker %llu.%03llu ns)\n",
+		(unsigned long long)ts_k, stream.subtype_data.crf.period,
+		(unsigned long long)(stream.subtype_data.crf.period_q32 >> 32),
+		(unsigned long long)(((stream.subtype_data.crf.period_q32 & 0xffffffff) * 1000) >> 32),
+		(unsigned long long)(period_q32 >> 32), (unsigned long long)(((period_q32 & 0xffffffff) * 1000) >> 32));
+
+	/* PDUs lost, free-wheeling on the listener timer */
+	holdover = true;
+	holdover_end = sim_now + TEST_HOLDOVER_TIME;
+
+	while (test_timer && (test_timer_expiry < holdover_end)) {
+		sim_now = test_timer_expiry;
+		test_timer->func(test_timer->data);
+		timeouts++;
+	}
+
+	printf("holdover: %u timeouts, %llu timestamps, maximum phase error %lld ns, final phase error %lld ns\n",
+		timeouts, (unsigned long long)ts_k, (long long)max_err, (long long)last_err);
+
+	if ((u64)timeouts * TEST_TS_PER_PDU * (period_q32 >> 32) < TEST_HOLDOVER_TIME - NSECS_PER_SEC) {
+		printf("holdover shorter than %llu s\n", (unsigned long long)(TEST_HOLDOVER_TIME / NSECS_PER_SEC));
+		errors++;
+	}
+
+	if (max_err > TEST_MAX_PHASE_ERR) {
+		printf("phase error above %u ns\n", TEST_MAX_PHASE_ERR);
+		errors++;
+	}
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief avtp unit tests, stubbed ipc and media clock recovery services
+ @details
+ The media clock objects of the avtp library reference the ipc and the media clock recovery HW services,
+ which are not available (nor needed) in the unit tests.
+*/
+
+#include "common/ipc.h"
+
+#include "os/media_clock.h"
+
+struct ipc_desc *ipc_alloc(struct ipc_tx const *tx, unsigned int size)
+{
+	return NULL;
+}
+
+void ipc_free(void const *ipc, struct ipc_desc *desc)
+{
+}
+
+int ipc_tx(struct ipc_tx const *tx, struct ipc_desc *desc)
+{
+	return -1;
+}
+
+int os_media_clock_rec_init(struct os_media_clock_rec *rec, int domain_id)
+{
+	return -1;
+}
+
+void os_media_clock_rec_exit(struct os_media_clock_rec *rec)
+{
+}
+
+int os_media_clock_rec_start(struct os_media_clock_rec *rec, u32 ts_0, u32 ts_1)
+{
+	return -1;
+}
+
+int os_media_clock_rec_stop(struct os_media_clock_rec *rec)
+{
+	return -1;
+}
+
+int os_media_clock_rec_reset(struct os_media_clock_rec *rec)
+{
+	return -1;
+}
+
+os_media_clock_rec_state_t os_media_clock_rec_clean(struct os_media_clock_rec *rec, unsigned int *nb_clean)
+{
+	*nb_clean = 0;
+
+	return OS_MCR_ERROR;
+}
+
+int os_media_clock_rec_set_ts_freq(struct os_media_clock_rec *rec, unsigned int ts_freq_p, unsigned int ts_freq_q)
+{
+	return -1;
+}
+
+int os_media_clock_rec_set_ext_ts(struct os_media_clock_rec *rec)
+{
+	return -1;
+}
+
+int os_media_clock_rec_set_ptp_sync(struct os_media_clock_rec *rec)
+{
+	return -1;
+}
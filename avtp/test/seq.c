@@ -0,0 +1,328 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Listener sequence number classifier test
+ @details
+ Scripted sequences, across the 8 bit sequence number wraparound, check the classification of each packet
+ (stream_listener_seq_check()) and the lost, duplicate and reordered counters: in order packets, losses,
+ reordered and duplicate packets, a reordered packet followed by its duplicate, and the resynchronization on a
+ backward jump after a long silence.
+ A seeded random sequence of TEST_RANDOM_N packets (class A rate), in blocks of 4 packets with one lost, duplicate,
+ swapped or late (by 3 packets) packet in some blocks, must then be counted exactly.
+ With -b, the classifier throughput is reported for receive batches of NET_RX_BATCH packets, in order and with the
+ random sequence.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "common/log.h"
+
+#include "avtp/stream.h"
+
+#define TEST_PERIOD		125000	/* class A packet period, ns */
+#define TEST_RANDOM_N		1000000
+#define TEST_EVENT_PERMIL	50	/* blocks with a lost, duplicate or reordered packet */
+#define TEST_BENCH_N		(20 * TEST_RANDOM_N)
+
+struct test_packet {
+	u8 seq;
+	u32 ts;
+	stream_seq_t rc;	/* expected classification */
+};
+
+struct test_case {
+	const char *name;
+	unsigned int n;
+	struct test_packet packets[16];
+	unsigned int lost;
+	unsigned int duplicate;
+	unsigned int reordered;
+};
+
+#define P(s, t, r)	{ .seq = (s), .ts = (t) * TEST_PERIOD, .rc = STREAM_SEQ_##r }
+
+static const struct test_case cases[] = {
+	{
+		.name = "in order wraparound",
+		.n = 6,
+		.packets = { P(253, 0, IN_ORDER), P(254, 1, IN_ORDER), P(255, 2, IN_ORDER), P(0, 3, IN_ORDER), P(1, 4, IN_ORDER), P(2, 5, IN_ORDER) },
+	},
+	{
+		.name = "loss across wraparound",
+		.n = 3,
+		.packets = { P(250, 0, IN_ORDER), P(3, 9, LOST), P(4, 10, IN_ORDER) },
+		.lost = 8,
+	},
+	{
+		.name = "reordered",
+		.n = 3,
+		.packets = { P(1, 0, IN_ORDER), P(3, 2, LOST), P(2, 2, REORDERED) },
+		.reordered = 1,
+	},
+	{
+		.name = "reordered across wraparound",
+		.n = 5,
+		.packets = { P(254, 0, IN_ORDER), P(0, 2, LOST), P(255, 2, REORDERED), P(1, 3, IN_ORDER), P(2, 4, IN_ORDER) },
+		.reordered = 1,
+	},
+	{
+		.name = "late across wraparound",
+		.n = 6,
+		.packets = { P(253, 0, IN_ORDER), P(255, 2, LOST), P(0, 3, IN_ORDER), P(1, 4, IN_ORDER), P(254, 4, REORDERED), P(2, 5, IN_ORDER) },
+		.reordered = 1,
+	},
+	{
+		.name = "duplicate across wraparound",
+		.n = 5,
+		.packets = { P(255, 0, IN_ORDER), P(0, 1, IN_ORDER), P(0, 1, DUPLICATE), P(255, 1, DUPLICATE), P(1, 2, IN_ORDER) },
+		.duplicate = 2,
+	},
+	{
+		.name = "reordered and duplicate",
+		.n = 5,
+		.packets = { P(255, 0, IN_ORDER), P(1, 2, LOST), P(0, 2, REORDERED), P(0, 2, DUPLICATE), P(2, 3, IN_ORDER) },
+		.duplicate = 1,
+		.reordered = 1,
+	},
+	{
+		.name = "before the first packet",
+		.n = 3,
+		.packets = { P(0, 0, IN_ORDER), P(255, 0, DUPLICATE), P(1, 1, IN_ORDER) },
+		.duplicate = 1,
+	},
+	{
+		.name = "resync after silence",
+		.n = 4,
+		.packets = { P(5, 0, IN_ORDER), P(250, 400, LOST), P(251, 401, IN_ORDER), P(252, 402, IN_ORDER) },
+		.lost = 244,
+	},
+};
+
+static struct stream_listener stream;
+static unsigned int errors;
+
+/* Random sequence */
+static struct test_packet packets[TEST_RANDOM_N + 4];
+static unsigned int packet_n;
+static unsigned int lost, duplicate, reordered;
+
+static void test_stream_init(void)
+{
+	memset(&stream, 0, sizeof(stream));
+}
+
+static int test_case_run(const struct test_case *c)
+{
+	const struct test_packet *p;
+	unsigned int errors_prev = errors;
+	stream_seq_t rc;
+	int i;
+
+	test_stream_init();
+
+	for (i = 0; i < c->n; i++) {
+		p = &c->packets[i];
+
+		rc = stream_listener_seq_check(&stream, p->seq, p->ts);
+		if (rc != p->rc) {
+			printf("%s: packet %u (seq %u): %u, expected %u\n", c->name, i, p->seq, rc, p->rc);
+			errors++;
+		}
+	}
+
+	if ((stream.stats.pkt_lost != c->lost) || (stream.stats.seq_duplicate != c->duplicate) || (stream.stats.seq_reordered != c->reordered)) {
+		printf("%s: lost/duplicate/reordered %u/%u/%u, expected %u/%u/%u\n", c->name,
+			stream.stats.pkt_lost, stream.stats.seq_duplicate, stream.stats.seq_reordered,
+			c->lost, c->duplicate, c->reordered);
+		errors++;
+	}
+
+	if (errors == errors_prev)
+		printf("%-32s: %u packets\n", c->name, c->n);
+
+	return (errors == errors_prev) ? 0 : -1;
+}
+
+static void test_packet_add(u32 k)
+{
+	packets[packet_n].seq = k;
+	packets[packet_n].ts = packet_n * TEST_PERIOD;
+	packet_n++;
+}
+
+/* Blocks of 4 packets, the first block and the last one without event */
+static void test_random_script(void)
+{
+	u32 k;
+
+	packet_n = 0;
+	lost = 0;
+	duplicate = 0;
+	reordered = 0;
+
+	for (k = 0; packet_n < TEST_RANDOM_N; k += 4) {
+		if (!k || (packet_n + 8 > TEST_RANDOM_N) || ((rand() % 1000) >= TEST_EVENT_PERMIL)) {
+			test_packet_add(k);
+			test_packet_add(k + 1);
+			test_packet_add(k + 2);
+			test_packet_add(k + 3);
+			continue;
+		}
+
+		switch (rand() % 4) {
+		case 0:
+			/* lost */
+			test_packet_add(k);
+			test_packet_add(k + 2);
+			test_packet_add(k + 3);
+			lost++;
+			break;
+
+		case 1:
+			/* duplicate */
+			test_packet_add(k);
+			test_packet_add(k + 1);
+			test_packet_add(k + 1);
+			test_packet_add(k + 2);
+			test_packet_add(k + 3);
+			duplicate++;
+			break;
+
+		case 2:
+			/* swapped */
+			test_packet_add(k);
+			test_packet_add(k + 2);
+			test_packet_add(k + 1);
+			test_packet_add(k + 3);
+			reordered++;
+			break;
+
+		case 3:
+		default:
+			/* late by 3 packets */
+			test_packet_add(k + 1);
+			test_packet_add(k + 2);
+			test_packet_add(k + 3);
+			test_packet_add(k);
+			reordered++;
+			break;
+		}
+	}
+}
+
+static void test_random_run(void)
+{
+	unsigned int i;
+
+	test_stream_init();
+
+	for (i = 0; i < packet_n; i++)
+		stream_listener_seq_check(&stream, packets[i].seq, packets[i].ts);
+
+	if ((stream.stats.pkt_lost != lost) || (stream.stats.seq_duplicate != duplicate) || (stream.stats.seq_reordered != reordered)) {
+		printf("random: lost/duplicate/reordered %u/%u/%u, expected %u/%u/%u\n",
+			stream.stats.pkt_lost, stream.stats.seq_duplicate, stream.stats.seq_reordered,
+			lost, duplicate, reordered);
+		errors++;
+	} else {
+		printf("%-32s: %u packets, %u lost, %u duplicate, %u reordered\n", "random", packet_n, lost, duplicate, reordered);
+	}
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* Receive batches of NET_RX_BATCH packets, as in the listener receive path */
+static void test_bench(const char *name, bool events)
+{
+	unsigned int i, j, n, in_order = 0;
+	double start, duration;
+
+	if (!events) {
+		for (i = 0; i < TEST_RANDOM_N; i++) {
+			packets[i].seq = i;
+			packets[i].ts = i * TEST_PERIOD;
+		}
+
+		packet_n = TEST_RANDOM_N;
+	} else {
+		test_random_script();
+	}
+
+	test_stream_init();
+
+	start = test_time();
+
+	for (n = 0; n < TEST_BENCH_N / packet_n; n++) {
+		for (i = 0; i < packet_n; i += NET_RX_BATCH)
+			for (j = i; (j < i + NET_RX_BATCH) && (j < packet_n); j++)
+				if (stream_listener_seq_check(&stream, packets[j].seq, packets[j].ts + n * packet_n * TEST_PERIOD) == STREAM_SEQ_IN_ORDER)
+					in_order++;
+	}
+
+	duration = test_time() - start;
+
+	printf("%-10s: %u packets (%u in order), batch %u, %.1f Mpackets/s\n", name, n * packet_n, in_order, NET_RX_BATCH,
+		n * packet_n / duration / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	log_level_set(avtp_COMPONENT_ID, LOG_ERR);
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		test_case_run(&cases[i]);
+
+	srand(1);
+	test_random_script();
+	test_random_run();
+
+	if (bench) {
+		test_bench("in order", false);
+		test_bench("random", true);
+	}
+
+	if (errors)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief avtp unit tests, stubbed clock domain services
+ @details
+ Defining these symbols in the test keeps the linker from pulling the rest of the avtp library (and, through it,
+ the network and media stacks) when only the clock grid objects are under test. The ipc and media clock
+ recovery services are stubbed in os_stubs.c.
+*/
+
+#include "os/clock.h"
+
+#include "avtp/avtp.h"
+#include "avtp/clock_domain.h"
+
+unsigned int avtp_to_clock(unsigned int port_id)
+{
+	return OS_CLOCK_SYSTEM_MONOTONIC;
+}
+
+void clock_domain_add_grid(struct clock_domain *domain, struct clock_grid *grid)
+{
+}
+
+void clock_domain_remove_grid(struct clock_grid *grid)
+{
+}
+
+void clock_domain_set_state(struct clock_domain *domain, clock_domain_state_t state)
+{
+}
+
+void clock_domain_clear_state(struct clock_domain *domain, clock_domain_state_t state)
+{
+}
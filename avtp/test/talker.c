@@ -0,0 +1,201 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief avtp unit tests, simulated media stack, clock grid and network for talker streams
+ @details
+ Defining these symbols in the test keeps the linker from pulling the stream and avtp objects of the library
+ (and, through them, the rest of the stack) when only a talker format handler is under test.
+*/
+
+#include <string.h>
+
+#include "common/log.h"
+#include "common/net.h"
+
+#include "genavb/media.h"
+
+#include "os/media.h"
+#include "os/net.h"
+
+#include "avtp/avtp.h"
+#include "avtp/media_clock.h"
+
+#include "talker.h"
+
+static struct test_talker_ops *talker_ops;
+static struct stream_talker *talker;
+static u32 grid_ts;
+static bool grid_started;
+
+static u8 desc_buf[TEST_TALKER_MAX_DESC][TEST_TALKER_DESC_SIZE] __attribute__ ((aligned (64)));
+static bool desc_used[TEST_TALKER_MAX_DESC];
+
+void test_talker_init(struct stream_talker *stream, struct test_talker_ops *ops)
+{
+	talker = stream;
+	talker_ops = ops;
+	grid_ts = 0;
+	grid_started = false;
+
+	memset(desc_used, 0, sizeof(desc_used));
+}
+
+static struct media_rx_desc *test_desc_alloc(struct stream_talker *stream)
+{
+	struct media_rx_desc *desc;
+	int i;
+
+	for (i = 0; i < TEST_TALKER_MAX_DESC; i++) {
+		if (desc_used[i])
+			continue;
+
+		desc_used[i] = true;
+		desc = (struct media_rx_desc *)desc_buf[i];
+
+		memset(desc, 0, sizeof(*desc));
+		desc->net.l2_offset = NET_DATA_OFFSET + stream->header_len;
+		desc->net.len = stream->payload_size;
+
+		return desc;
+	}
+
+	return NULL;
+}
+
+static void test_desc_free(void *desc)
+{
+	desc_used[((u8 *)desc - &desc_buf[0][0]) / TEST_TALKER_DESC_SIZE] = false;
+}
+
+static int test_media_fill(struct stream_talker *stream, struct media_rx_desc **media_desc_array, unsigned int n_max)
+{
+	struct media_rx_desc *desc;
+	int n = 0;
+
+	while (n < n_max) {
+		desc = test_desc_alloc(stream);
+		if (!desc)
+			break;
+
+		if (talker_ops->media_rx(stream, desc) < 0) {
+			test_desc_free(desc);
+			break;
+		}
+
+		media_desc_array[n++] = desc;
+	}
+
+	return n;
+}
+
+/* Media stack, one descriptor per packet slot until the test media handler underruns */
+int stream_media_rx(struct stream_talker *stream, struct media_rx_desc **media_desc_array, u32 *ts, unsigned int *flags, unsigned int *alignment_ts)
+{
+	int n;
+
+	n = test_media_fill(stream, media_desc_array, stream->tx_batch);
+
+	stream->stats.media_rx += n;
+
+	if (!stream->media_count && n) {
+		*flags |= MCG_FLAGS_DO_ALIGN;
+		*alignment_ts = stream->gptp_current;
+	}
+
+	return n;
+}
+
+/* Media interface, for the talkers reading it directly (ACF) */
+int media_rx(struct media_rx *media, struct media_rx_desc **desc, unsigned int n)
+{
+	return test_media_fill(talker, desc, n);
+}
+
+int stream_tx_flow_control(struct stream_talker *stream, unsigned int *tx_batch)
+{
+	return 0;
+}
+
+/* Clock grid, constant period */
+int clock_grid_consumer_get_ts(struct clock_grid_consumer *consumer, u32 *ts, unsigned int ts_n, unsigned int *flags, unsigned int alignment_ts)
+{
+	unsigned int i;
+
+	if (!grid_started) {
+		*flags |= MCG_FLAGS_RESET;
+		grid_started = true;
+	}
+
+	for (i = 0; i < ts_n; i++) {
+		ts[i] = grid_ts;
+		grid_ts += TEST_TALKER_GRID_PERIOD;
+	}
+
+	return ts_n;
+}
+
+/* Network */
+int net_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		talker_ops->net_tx(talker, NET_DATA_START(desc[i]), desc[i]->len);
+		test_desc_free(desc[i]);
+	}
+
+	return n;
+}
+
+void net_tx_free(struct net_tx_desc *buf)
+{
+	test_desc_free(buf);
+}
+
+void net_free_multi(void **buf, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		test_desc_free(buf[i]);
+}
+
+void net_rx_free(struct net_rx_desc *desc)
+{
+}
+
+int media_tx(struct media_tx *media, struct media_desc **desc, unsigned int n)
+{
+	return -1;
+}
+
+unsigned int avtp_data_header_init(struct avtp_data_hdr *avtp_data, u8 subtype, void *stream_id)
+{
+	/* the stream data length and protocol specific header, set by the format handler, are kept */
+	avtp_data->subtype = subtype;
+	avtp_data->sv = 1;
+	avtp_data->mr = 0;
+	avtp_data->tv = 0;
+	avtp_data->sequence_num = 0;
+	avtp_data->tu = 0;
+	copy_64(&avtp_data->stream_id, stream_id);
+
+	return sizeof(struct avtp_data_hdr);
+}
+
+void avtp_latency_stats(struct stream_listener *stream, struct avtp_rx_desc *desc)
+{
+}
+
+void stream_talker_launch_stats(struct stream_talker *stream, u32 launch, u32 handoff)
+{
+}
+
+void stream_talker_launch_ts_request(struct stream_talker *stream, struct net_tx_desc *desc)
+{
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief avtp unit tests, simulated media stack, clock grid and network for talker streams
+ @details
+ Stubs the services used by the talker transmit handlers (stream->net_tx()), so that a single talker object
+ of the avtp library can be run without the rest of the stack:
+ - the media stack (or the media interface, for ACF talkers) hands over the descriptors filled by the test
+   media handler,
+ - the clock grid returns consecutive timestamps TEST_TALKER_GRID_PERIOD apart, flagged with
+   MCG_FLAGS_RESET on the first read,
+ - the network passes each transmitted descriptor to the test transmit handler, then frees it.
+*/
+
+#ifndef _AVTP_TEST_TALKER_H_
+#define _AVTP_TEST_TALKER_H_
+
+#include "common/types.h"
+#include "genavb/media.h"
+
+#include "avtp/stream.h"
+
+#define TEST_TALKER_MAX_DESC		(2 * NET_TX_BATCH)
+#define TEST_TALKER_DESC_SIZE		2048
+#define TEST_TALKER_GRID_PERIOD		125000
+
+struct test_talker_ops {
+	/* fills the payload (and media timestamps) of a descriptor, returns 0 on success, -1 on underrun */
+	int (*media_rx)(struct stream_talker *stream, struct media_rx_desc *desc);
+
+	/* called for each transmitted packet, buf points to the packet start (header included) */
+	void (*net_tx)(struct stream_talker *stream, void *buf, unsigned int len);
+};
+
+void test_talker_init(struct stream_talker *stream, struct test_talker_ops *ops);
+
+#endif /* _AVTP_TEST_TALKER_H_ */
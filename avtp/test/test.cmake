@@ -0,0 +1,9 @@
+# avtp unit tests, the avtp library objects under test are linked against stubbed stack services (see stubs.c and os_stubs.c)
+genavb_add_test(NAME avtp-clock-grid COMPONENT avtp SRCS clock_grid.c stubs.c os_stubs.c LIBS avtp common)
+genavb_add_test(NAME avtp-61883-4 COMPONENT avtp SRCS 61883_4.c talker.c ../../common/avdecc.c ../../public/sr_class.c LIBS avtp common)
+genavb_add_test(NAME avtp-clock-switch COMPONENT avtp SRCS clock_switch.c os_stubs.c LIBS avtp common NO_CLOCK)
+genavb_add_test(NAME avtp-acf COMPONENT avtp SRCS acf.c talker.c ../../common/avdecc.c ../../public/sr_class.c LIBS avtp common)
+genavb_add_test(NAME avtp-61883-6 COMPONENT avtp SRCS 61883_6.c talker.c ../../common/avdecc.c ../../public/sr_class.c LIBS avtp common)
+genavb_add_test(NAME avtp-crf COMPONENT avtp SRCS crf.c ../../common/avdecc.c ../../public/sr_class.c LIBS avtp common NO_CLOCK)
+genavb_add_test(NAME avtp-clock-domain COMPONENT avtp SRCS clock_domain.c os_stubs.c LIBS avtp common NO_CLOCK)
+genavb_add_test(NAME avtp-seq COMPONENT avtp SRCS seq.c LIBS avtp common)
@@ -44,3 +44,7 @@ genavb_target_add_srcs(TARGET genavb
 
 genavb_link_libraries(TARGET ${avb} LIB common)
 genavb_link_libraries(TARGET ${tsn} LIB common)
+
+if(BUILD_TESTS)
+  include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+endif()
@@ -34,6 +34,16 @@ static const double filter_exp_decay_coef[6] = {
 	0.0307667655, //1-exp(-1/32)
 };
 
+/** Same as filter_exp_decay_coef, in Q16 */
+static const s32 filter_q_exp_decay_coef[6] = {
+	41427, //1-exp(-1/1)
+	25786, //1-exp(-1/2)
+	14497, //1-exp(-1/4)
+	7701, //1-exp(-1/8)
+	3971, //1-exp(-1/16)
+	2016, //1-exp(-1/32)
+};
+
 
 /** Identity  filter reset function.
  * @params: pointer to filter parameters
@@ -259,3 +269,238 @@ int filter_fir_init(struct filter *f, u32 size, double *filter_taps)
 
 	return 0;
 }
+
+
+/** Fixed-point identity filter processing function.
+ * @params: pointer to filter parameters
+ * @val: sampling value to filter
+ *
+ */
+static s64 filter_q_identity_filter(union filter_q_params *params, s64 val)
+{
+	return val;
+}
+
+
+/** Fixed-point identity filter initialization function.
+ * @params: pointer to filter
+ *
+ */
+int filter_q_identity_init(struct filter_q *f)
+{
+	f->reset = NULL;
+	f->close = NULL;
+	f->filter = filter_q_identity_filter;
+
+	return 0;
+}
+
+
+/** Fixed-point mean filter reset function.
+ * @params: pointer to filter parameters
+ *
+ */
+static void filter_q_mean_reset(union filter_q_params *params)
+{
+	params->mean.count = 0;
+	params->mean.sum = 0;
+	params->mean.position = 0;
+	os_memset(params->mean.array, 0, params->mean.array_size*sizeof(s64));
+}
+
+
+/** Fixed-point mean filter close function.
+ * @params: pointer to filter parameters
+ *
+ */
+static void filter_q_mean_close(union filter_q_params *params)
+{
+	os_free(params->mean.array);
+}
+
+
+/** Fixed-point mean filter processing function.
+ * The sum of the samples in the window is maintained, so that only one division is done per sample.
+ * @params: pointer to  filter parameters
+ * @val: sampling value to filter
+ */
+static s64 filter_q_mean_filter(union filter_q_params *params, s64 val)
+{
+	params->mean.sum += val - params->mean.array[params->mean.position];
+	if (params->mean.count < params->mean.array_size)
+		params->mean.count++;
+
+	params->mean.array[params->mean.position] = val;
+	params->mean.position++;
+	if (params->mean.position == params->mean.array_size)
+		params->mean.position = 0;
+
+	return params->mean.sum / (s64)params->mean.count;
+}
+
+/** Fixed-point mean filter initialization function.
+ * @params: pointer to  filter parameters
+ * @size: max numbers of samples the mean value is computed over
+ *
+ */
+int filter_q_mean_init(struct filter_q *f, u32 size)
+{
+	int rc = 0;
+
+	f->params.mean.array_size = size;
+	f->params.mean.array = os_malloc(size*sizeof(s64));
+	if (!f->params.mean.array) {
+		rc = -1;
+		goto err_malloc;
+	}
+
+	f->reset = filter_q_mean_reset;
+	f->close = filter_q_mean_close;
+	f->filter = filter_q_mean_filter;
+
+	f->reset(&f->params);
+
+err_malloc:
+	return rc;
+}
+
+
+/** Fixed-point exponential decay filter reset function.
+ * @params: pointer to filter parameters
+ *
+ */
+static void filter_q_exp_decay_reset(union filter_q_params *params)
+{
+	params->exp_decay.mean = 0;
+	params->exp_decay.count = 1;
+}
+
+
+/** Fixed-point exponential decay filter processing function.
+ * @params: pointer to filter parameters
+ * @val: sampling value to filter
+ *
+ */
+static s64 filter_q_exp_decay_filter(union filter_q_params *params, s64 val)
+{
+	s64 diff = val - params->exp_decay.mean;
+
+	if (params->exp_decay.count <= params->exp_decay.m_factor) {
+		params->exp_decay.mean += diff / params->exp_decay.count;
+	} else {
+		/* diff * coef may not fit in 63 bits, multiply the integer and fractional parts separately.
+		 * Both parts have the sign of diff, so the result is the same as (diff * coef) / FILTER_Q_ONE.
+		 */
+		params->exp_decay.mean += (diff / FILTER_Q_ONE) * params->exp_decay.coef +
+					  ((diff % FILTER_Q_ONE) * params->exp_decay.coef) / FILTER_Q_ONE;
+	}
+
+	params->exp_decay.count++;
+
+	return params->exp_decay.mean;
+}
+
+
+/** Fixed-point exponential decay filter initialization function.
+ * @params: pointer to filter
+ * @coef: weigth of the sampling value added to the filter (Q16)
+ *
+ */
+int filter_q_exp_decay_init(struct filter_q *f, s32 coef)
+{
+	int i;
+
+	if ((coef > FILTER_Q_ONE) || (coef <= 0)) {
+		os_log(LOG_ERR, "Invalid coefficient value (%d), defaulting to 1.\n", coef);
+		f->params.exp_decay.coef = FILTER_Q_ONE;
+	} else {
+		f->params.exp_decay.coef = coef;
+	}
+
+	f->params.exp_decay.m_factor = FILTER_EXP_DECAY_M_MAX;
+	for (i = 0; i < 6; i++)
+		if (coef > filter_q_exp_decay_coef[i]) {
+			f->params.exp_decay.m_factor = 1 << i;
+			break;
+		}
+
+	os_log(LOG_INFO, "Filter parameters -> M = %d   Coef = %d/%d\n", f->params.exp_decay.m_factor, coef, FILTER_Q_ONE);
+
+	f->reset = filter_q_exp_decay_reset;
+	f->close = NULL;
+	f->filter = filter_q_exp_decay_filter;
+
+	f->reset(&f->params);
+
+	return 0;
+}
+
+
+static void filter_q_fir_reset(union filter_q_params *params)
+{
+	params->fir.count = 0;
+	params->fir.position = 0;
+	os_memset(params->fir.array, 0, params->fir.array_size*sizeof(s64));
+}
+
+static void filter_q_fir_close(union filter_q_params *params)
+{
+	os_free(params->fir.array);
+}
+
+static s64 filter_q_fir_filter(union filter_q_params *params, s64 val)
+{
+	s64 result = 0;
+	u32 i, pos;
+
+	/* Update the array of samples with the new value */
+	params->fir.array[params->fir.position] = val;
+
+	/* Not enough samples yet, return unfiltered value */
+	if (params->fir.count < params->fir.array_size) {
+		params->fir.count++;
+		result = val;
+	} else {
+		pos = params->fir.position;
+		for (i = 0; i < params->fir.array_size; i ++) {
+			result += params->fir.taps_array[i] * params->fir.array[pos];
+			pos = pos == 0? params->fir.array_size - 1:pos - 1;
+		}
+
+		result /= params->fir.taps_sum;
+	}
+
+	params->fir.position++;
+	if (params->fir.position == params->fir.array_size)
+		params->fir.position = 0;
+
+	return result;
+}
+
+int filter_q_fir_init(struct filter_q *f, u32 size, const s32 *filter_taps)
+{
+	u32 i;
+
+	f->params.fir.array_size = size;
+	f->params.fir.taps_array = filter_taps;
+	f->params.fir.taps_sum = 0;
+	for (i = 0; i < size; i++) {
+		f->params.fir.taps_sum += filter_taps[i];
+	}
+
+	if (!f->params.fir.taps_sum)
+		return -1;
+
+	f->params.fir.array = os_malloc(size*sizeof(s64));
+
+	if (!f->params.fir.array)
+		return -1;
+
+	f->reset = filter_q_fir_reset;
+	f->close = filter_q_fir_close;
+	f->filter = filter_q_fir_filter;
+
+	f->reset(&f->params);
+
+	return 0;
+}
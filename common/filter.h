@@ -87,4 +87,104 @@ int filter_mean_init(struct filter *f, u32 size);
 int filter_exp_decay_init(struct filter *f, double coef);
 int filter_fir_init(struct filter *f, u32 size, double *filter_taps);
 
+/* Fixed-point filters
+ * Same filters as above, operating on signed Q47.16 samples (FILTER_Q_FRAC_BITS fractional bits).
+ * Coefficients and FIR taps are Q16 (FILTER_Q_ONE is 1.0).
+ * For the FIR filter, |sample| * |tap| must fit in 63 bits (e.g. samples up to 2^30 with taps up to 1.0).
+ * For the exponential decay filter, the difference between a sample and the current mean must fit in
+ * Q47.16 (63 bits).
+ */
+#define FILTER_Q_FRAC_BITS	16
+#define FILTER_Q_ONE		(1 << FILTER_Q_FRAC_BITS)
+
+union filter_q_params {
+	struct {
+		s64 *array;
+		s64 sum;
+		u32 array_size;
+		u32 position;
+		u32 count;
+	} mean;
+
+	struct {
+		s64 mean;
+		s32 coef;
+		int m_factor;
+		int count;
+	} exp_decay;
+
+	struct {
+		s64 *array;
+		u32 array_size;
+		u32 position;
+		u32 count;
+		const s32 *taps_array;
+		s64 taps_sum;
+	} fir;
+};
+
+struct filter_q {
+	void (*reset)(union filter_q_params *params);
+	void (*close)(union filter_q_params *params);
+	s64 (*filter)(union filter_q_params *params, s64 val);
+
+	union filter_q_params params;
+};
+
+/** Convert an integer value to a Q47.16 sample.
+ * @val: integer value
+ *
+ */
+static inline s64 filter_q_from_int(s64 val)
+{
+	return val * FILTER_Q_ONE;
+}
+
+/** Convert a Q47.16 sample to the nearest integer value.
+ * @val: Q47.16 value
+ *
+ */
+static inline s64 filter_q_to_int(s64 val)
+{
+	if (val >= 0)
+		return (val + (FILTER_Q_ONE / 2)) / FILTER_Q_ONE;
+	else
+		return (val - (FILTER_Q_ONE / 2)) / FILTER_Q_ONE;
+}
+
+/** Call fixed-point filter reset function.
+ * @f: pointer to the filter to reset
+ *
+ */
+static inline void filter_q_reset(struct filter_q *f)
+{
+	if (f->reset)
+		f->reset(&f->params);
+}
+
+/** Call fixed-point filter close function.
+ * @f: pointer to the filter to close
+ *
+ */
+static inline void filter_q_close(struct filter_q *f)
+{
+	if (f->close)
+		f->close(&f->params);
+}
+
+/** Call fixed-point filter processing function.
+ * @f: pointer to the filter to process
+ * @val: sampling value to filter (Q47.16)
+ *
+ */
+static inline s64 filter_q(struct filter_q *f, s64 val)
+{
+	return f->filter(&f->params, val);
+}
+
+int filter_q_identity_init(struct filter_q *f);
+int filter_q_mean_init(struct filter_q *f, u32 size);
+int filter_q_exp_decay_init(struct filter_q *f, s32 coef);
+int filter_q_fir_init(struct filter_q *f, u32 size, const s32 *filter_taps);
+
 #endif /* _COMMON_FILTER_H_ */
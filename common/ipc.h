@@ -369,6 +369,9 @@ struct ipc_avtp_talker_counters {
 
 #define IPC_AVTP_FLAGS_MCR	GENAVB_STREAM_FLAGS_MCR
 #define IPC_AVTP_FLAGS_MAX_TRANSIT_TIME_VALID	GENAVB_STREAM_FLAGS_MAX_TRANSIT_TIME_VALID
+#define IPC_AVTP_FLAGS_ACF_PACKING	GENAVB_STREAM_FLAGS_ACF_PACKING
+#define IPC_AVTP_FLAGS_CONCEAL_SILENCE	GENAVB_STREAM_FLAGS_CONCEAL_SILENCE
+#define IPC_AVTP_FLAGS_CONCEAL_REPEAT	GENAVB_STREAM_FLAGS_CONCEAL_REPEAT
 
 struct ipc_mac_service_get_status {
 	u16 port_id;
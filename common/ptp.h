@@ -1442,7 +1442,7 @@ struct ptp_md_entity_pdelay_req_sm {
 	*/
 	u64 prev_pdelay_response_event_ingress_timestamp;	// in nanoseconds
 	u64 prev_corrected_responder_event_timestamp;	// in nanoseconds
-	struct filter pdelay_filter;
+	struct filter_q pdelay_filter;
 
 	unsigned int prev_rate_ratio_local_clk_phase_discont;
 	unsigned int prev_pdelay_local_clk_phase_discont;
@@ -11,6 +11,8 @@
  @details
 */
 
+#include "os/string.h"
+
 #include "stats.h"
 #include "common/log.h"
 
@@ -107,3 +109,105 @@ void stats_compute(struct stats *s)
 	s->min = s->current_min;
 	s->max = s->current_max;
 }
+
+void hist_reset(struct hist *h)
+{
+	os_memset(h, 0, sizeof(*h));
+}
+
+/** Merge a histogram into another one.
+ * @dst: histogram to be updated
+ * @src: histogram to be added
+ */
+void hist_merge(struct hist *dst, const struct hist *src)
+{
+	int i;
+
+	for (i = 0; i < HIST_BUCKETS; i++)
+		dst->count[i] += src->count[i];
+
+	dst->total += src->total;
+}
+
+/** Take a snapshot of a histogram and restart recording.
+ * @h: histogram being recorded
+ * @snapshot: copy of the histogram content
+ */
+void hist_snapshot(struct hist *h, struct hist *snapshot)
+{
+	os_memcpy(snapshot, h, sizeof(*h));
+
+	hist_reset(h);
+}
+
+/* Highest value (in s32 order) counted in a given bucket */
+static s32 hist_bucket_value(unsigned int index)
+{
+	unsigned int half_index, group, sub;
+	u32 low, high;
+
+	if (index >= HIST_HALF_BUCKETS)
+		half_index = index - HIST_HALF_BUCKETS;
+	else
+		half_index = HIST_HALF_BUCKETS - 1 - index;
+
+	group = half_index >> HIST_SUB_BITS;
+	sub = half_index & (HIST_SUB_BUCKETS - 1);
+
+	if (!group) {
+		low = sub;
+		high = sub;
+	} else {
+		low = (HIST_SUB_BUCKETS + sub) << (group - 1);
+		high = low + ((1U << (group - 1)) - 1);
+	}
+
+	if (index >= HIST_HALF_BUCKETS)
+		return (s32)high;
+	else
+		return (s32)~low;
+}
+
+/** Compute a percentile from histogram content.
+ * @h: histogram
+ * @ppm: requested percentile, in parts per million (e.g 990000 for p99)
+ *
+ * Returns the highest value of the bucket containing the requested percentile, 0 if the histogram is empty.
+ */
+s32 hist_percentile(const struct hist *h, unsigned int ppm)
+{
+	u64 target;
+	u32 cumulated = 0;
+	int i;
+
+	if (!h->total)
+		return 0;
+
+	target = ((u64)h->total * ppm + 999999) / 1000000;
+	if (!target)
+		target = 1;
+
+	for (i = 0; i < HIST_BUCKETS; i++) {
+		cumulated += h->count[i];
+		if (cumulated >= target)
+			return hist_bucket_value(i);
+	}
+
+	return hist_bucket_value(HIST_BUCKETS - 1);
+}
+
+void hist_percentiles_compute(const struct hist *h, struct hist_percentiles *p)
+{
+	p->total = h->total;
+	p->p50 = hist_percentile(h, HIST_PPM_P50);
+	p->p99 = hist_percentile(h, HIST_PPM_P99);
+	p->p999 = hist_percentile(h, HIST_PPM_P999);
+}
+
+void hist_low_percentiles_compute(const struct hist *h, struct hist_low_percentiles *p)
+{
+	p->total = h->total;
+	p->p01 = hist_percentile(h, HIST_PPM_P01);
+	p->p1 = hist_percentile(h, HIST_PPM_P1);
+	p->p50 = hist_percentile(h, HIST_PPM_P50);
+}
@@ -15,6 +15,7 @@
 #define _COMMON_STATS_H_
 
 #include "common/types.h"
+#include "os/config.h"
 
 struct stats {
 	u32 log2_size;
@@ -40,11 +41,102 @@ struct stats {
 	void (*func)(struct stats *s);
 };
 
+/* Log-linear histogram (HDR style).
+ * Absolute values below 2^HIST_SUB_BITS are counted in unit buckets, larger values are counted in
+ * 2^HIST_SUB_BITS linear buckets per power of 2, giving a relative precision of 1/2^HIST_SUB_BITS
+ * up to 2^HIST_MAX_BITS. Larger absolute values are counted in the last bucket. Negative and positive
+ * values use separate halves of the bucket array.
+ * By default the full s32 range is covered with 1/8 precision (480 buckets), targets can trade range
+ * and precision for memory with HIST_CFG_MAX_BITS and HIST_CFG_SUB_BITS (see osal/config.h).
+ */
+#ifdef HIST_CFG_SUB_BITS
+#define HIST_SUB_BITS		HIST_CFG_SUB_BITS
+#else
+#define HIST_SUB_BITS		3
+#endif
+
+#ifdef HIST_CFG_MAX_BITS
+#define HIST_MAX_BITS		HIST_CFG_MAX_BITS
+#else
+#define HIST_MAX_BITS		32
+#endif
+
+#define HIST_SUB_BUCKETS	(1 << HIST_SUB_BITS)
+#define HIST_HALF_BUCKETS	((HIST_MAX_BITS + 1 - HIST_SUB_BITS) * HIST_SUB_BUCKETS)
+#define HIST_BUCKETS		(2 * HIST_HALF_BUCKETS)
+
+#define HIST_PPM_P01		1000
+#define HIST_PPM_P1		10000
+#define HIST_PPM_P50		500000
+#define HIST_PPM_P99		990000
+#define HIST_PPM_P999		999000
+
+struct hist {
+	u32 total;
+	u32 count[HIST_BUCKETS];
+};
+
+/* Compact histogram summary, suitable for IPC stats messages */
+struct hist_percentiles {
+	u32 total;
+	s32 p50;
+	s32 p99;
+	s32 p999;
+};
+
+/* Compact histogram low tail summary, suitable for IPC stats messages */
+struct hist_low_percentiles {
+	u32 total;
+	s32 p01;
+	s32 p1;
+	s32 p50;
+};
+
 void stats_reset(struct stats *s);
 void stats_print(struct stats *s);
 void stats_update(struct stats *s, s32 val);
 void stats_compute(struct stats *s);
 
+void hist_reset(struct hist *h);
+void hist_merge(struct hist *dst, const struct hist *src);
+void hist_snapshot(struct hist *h, struct hist *snapshot);
+s32 hist_percentile(const struct hist *h, unsigned int ppm);
+void hist_percentiles_compute(const struct hist *h, struct hist_percentiles *p);
+void hist_low_percentiles_compute(const struct hist *h, struct hist_low_percentiles *p);
+
+static inline unsigned int hist_index(u32 val)
+{
+	unsigned int msb;
+
+#if HIST_MAX_BITS < 32
+	if (val >= (1U << HIST_MAX_BITS))
+		val = (1U << HIST_MAX_BITS) - 1;
+#endif
+
+	if (val < HIST_SUB_BUCKETS)
+		return val;
+
+	msb = 31 - __builtin_clz(val);
+
+	return ((msb - HIST_SUB_BITS + 1) << HIST_SUB_BITS) + ((val >> (msb - HIST_SUB_BITS)) - HIST_SUB_BUCKETS);
+}
+
+/** Add a sample to a histogram.
+ * @h:		handler for the histogram
+ * @val:	sample to be added
+ *
+ * Constant time and allocation free, can be called from real-time context.
+ */
+static inline void hist_update(struct hist *h, s32 val)
+{
+	if (val >= 0)
+		h->count[HIST_HALF_BUCKETS + hist_index(val)]++;
+	else
+		h->count[HIST_HALF_BUCKETS - 1 - hist_index(~(u32)val)]++;
+
+	h->total++;
+}
+
 
 /** Initialize a stats structure.
  * @s: 			Pointer to structure to be initialized
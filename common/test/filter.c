@@ -0,0 +1,267 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Fixed-point filters test
+ @details
+ Each fixed-point (Q47.16) filter is fed with the same long random input as its double reference, and the
+ outputs are compared at every sample. The inputs are slow random walks (in the nanosecond range of a link
+ delay or a media clock period) with noise and rare large outliers (up to 2^33 ns, beyond which the
+ exponential decay product no longer fits in 63 bits), rounded to Q16 so that both filters see the
+ same samples. Coefficients and taps are exactly representable in Q16, so the remaining error only comes from the
+ fixed-point divisions (truncated to 1 LSB), which gives the following bounds (in LSB, 1/65536):
+ - mean: 1 LSB, a single division of the exact window sum.
+ - FIR: 1 LSB, a single division of the exact weighted sum.
+ - exponential decay: 1 LSB per step during the first m_factor steps, then the error e of the mean decays as
+   e * (1 - coef) + 1 LSB per step, i.e it stays below m_factor + 1/coef LSB.
+ With -b, the cost per sample of the double and fixed-point filters is reported.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "common/filter.h"
+
+#define TEST_SAMPLES		(1000 * 1000)
+#define TEST_BENCH_SAMPLES	(10 * 1000 * 1000)
+#define TEST_FIR_TAPS		16
+#define TEST_LSB		(1.0 / FILTER_Q_ONE)
+
+static double samples[TEST_BENCH_SAMPLES];
+static s64 samples_q[TEST_BENCH_SAMPLES];
+
+static s32 fir_taps_q[TEST_FIR_TAPS];
+static double fir_taps[TEST_FIR_TAPS];
+
+static double test_magnitude;
+
+static unsigned int seed = 1;
+
+static double test_uniform(void)
+{
+	return (rand_r(&seed) + 1.0) / (RAND_MAX + 2.0);
+}
+
+/* Random walk around base, with gaussian noise and rare outliers up to +/-outlier */
+static void test_input(unsigned int n, double base, double noise, double outlier)
+{
+	double walk = base;
+	unsigned int i;
+	int k;
+
+	for (i = 0; i < n; i++) {
+		double v = 0;
+
+		walk += (test_uniform() - 0.5) * noise / 100;
+
+		for (k = 0; k < 12; k++)
+			v += test_uniform();
+
+		v = walk + (v - 6) * noise;
+
+		if (!(rand_r(&seed) % 10000))
+			v = (test_uniform() - 0.5) * 2 * outlier;
+
+		samples_q[i] = llround(v * FILTER_Q_ONE);
+		samples[i] = (double)samples_q[i] / FILTER_Q_ONE;
+	}
+
+	test_magnitude = fabs(base) + outlier;
+}
+
+static int test_compare(const char *name, struct filter *f, struct filter_q *fq, unsigned int n, double bound)
+{
+	double max_err = 0;
+	unsigned int i;
+
+	filter_reset(f);
+	filter_q_reset(fq);
+
+	for (i = 0; i < n; i++) {
+		double ref = filter(f, samples[i]);
+		double val = (double)filter_q(fq, samples_q[i]) / FILTER_Q_ONE;
+		/* Allow for the double rounding errors, relative to the magnitude of the values */
+		double err = fabs(val - ref) - 1e-15 * test_magnitude;
+
+		if (err > max_err)
+			max_err = err;
+	}
+
+	printf("%-24s max error %8.3f LSB (bound %6.1f)\n", name, max_err / TEST_LSB, bound);
+
+	return (max_err <= bound * TEST_LSB) ? 0 : -1;
+}
+
+static int test_filters(unsigned int n)
+{
+	static const unsigned int mean_sizes[] = {1, 16, 128};
+	struct filter f;
+	struct filter_q fq;
+	char name[32];
+	unsigned int i;
+	int rc = 0;
+
+	/* Link delay like input, outliers include the invalid link delays (offset by 2^32) of the gPTP pdelay filter */
+	test_input(n, 500.0, 10.0, 8589934592.0);
+
+	for (i = 0; i < sizeof(mean_sizes) / sizeof(mean_sizes[0]); i++) {
+		filter_mean_init(&f, mean_sizes[i]);
+		filter_q_mean_init(&fq, mean_sizes[i]);
+
+		snprintf(name, sizeof(name), "mean(%u)", mean_sizes[i]);
+
+		if (test_compare(name, &f, &fq, n, 1.0) < 0)
+			rc = -1;
+
+		filter_close(&f);
+		filter_q_close(&fq);
+	}
+
+	/* Coefficients from 1 down to 1/64 (the gPTP pdelay filter), and an arbitrary Q16 one */
+	for (i = 0; i <= 7; i++) {
+		s32 coef = (i < 7) ? (FILTER_Q_ONE >> i) : 5000;
+
+		filter_exp_decay_init(&f, (double)coef / FILTER_Q_ONE);
+		filter_q_exp_decay_init(&fq, coef);
+
+		snprintf(name, sizeof(name), "exp_decay(%d/%d)", coef, FILTER_Q_ONE);
+
+		if (test_compare(name, &f, &fq, n, fq.params.exp_decay.m_factor + (double)FILTER_Q_ONE / coef) < 0)
+			rc = -1;
+	}
+
+	/* Media clock period like input, smaller outliers so that the FIR products fit in 63 bits */
+	test_input(n, 20833.0, 50.0, 1073741824.0);
+
+	for (i = 0; i < TEST_FIR_TAPS; i++) {
+		fir_taps_q[i] = 1 + rand_r(&seed) % FILTER_Q_ONE;
+		fir_taps[i] = fir_taps_q[i];
+	}
+
+	filter_fir_init(&f, TEST_FIR_TAPS, fir_taps);
+	filter_q_fir_init(&fq, TEST_FIR_TAPS, fir_taps_q);
+
+	if (test_compare("fir(16)", &f, &fq, n, 1.0) < 0)
+		rc = -1;
+
+	filter_close(&f);
+	filter_q_close(&fq);
+
+	return rc;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static u64 test_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static void test_bench_one(const char *name, struct filter *f, struct filter_q *fq)
+{
+	volatile double sink;
+	volatile s64 sink_q;
+	double start;
+	u64 cycles;
+	unsigned int i;
+
+	filter_reset(f);
+	start = test_time();
+	cycles = test_cycles();
+
+	for (i = 0; i < TEST_BENCH_SAMPLES; i++)
+		sink = filter(f, samples[i]);
+
+	cycles = test_cycles() - cycles;
+	printf("%-16s double: %6.2f ns/sample %6.1f cycles/sample\n", name,
+		(test_time() - start) * 1e9 / TEST_BENCH_SAMPLES, (double)cycles / TEST_BENCH_SAMPLES);
+
+	filter_q_reset(fq);
+	start = test_time();
+	cycles = test_cycles();
+
+	for (i = 0; i < TEST_BENCH_SAMPLES; i++)
+		sink_q = filter_q(fq, samples_q[i]);
+
+	cycles = test_cycles() - cycles;
+	printf("%-16s Q16:    %6.2f ns/sample %6.1f cycles/sample\n", name,
+		(test_time() - start) * 1e9 / TEST_BENCH_SAMPLES, (double)cycles / TEST_BENCH_SAMPLES);
+
+	(void)sink;
+	(void)sink_q;
+}
+
+static void test_bench(void)
+{
+	struct filter f;
+	struct filter_q fq;
+
+	test_input(TEST_BENCH_SAMPLES, 20833.0, 50.0, 1073741824.0);
+
+	filter_mean_init(&f, 128);
+	filter_q_mean_init(&fq, 128);
+	test_bench_one("mean(128)", &f, &fq);
+	filter_close(&f);
+	filter_q_close(&fq);
+
+	filter_exp_decay_init(&f, 1.0 / 64);
+	filter_q_exp_decay_init(&fq, FILTER_Q_ONE / 64);
+	test_bench_one("exp_decay(1/64)", &f, &fq);
+
+	filter_fir_init(&f, TEST_FIR_TAPS, fir_taps);
+	filter_q_fir_init(&fq, TEST_FIR_TAPS, fir_taps_q);
+	test_bench_one("fir(16)", &f, &fq);
+	filter_close(&f);
+	filter_q_close(&fq);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (test_filters(TEST_SAMPLES) < 0) {
+		printf("FAIL\n");
+		return 1;
+	}
+
+	if (bench)
+		test_bench();
+
+	printf("PASS\n");
+
+	return 0;
+}
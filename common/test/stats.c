@@ -0,0 +1,228 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Statistics histogram percentile accuracy test
+ @details
+ Random sample sets, from several distributions, are recorded in a histogram and every percentile returned by
+ hist_percentile() is compared to the exact (nearest rank) percentile of the sorted samples: it must belong to the
+ same bucket, i.e not be lower and not exceed it by more than the histogram relative precision. Samples beyond the
+ histogram range must saturate to the last bucket of their sign. Merged histograms must match the histogram of the union of the
+ sample sets.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "common/stats.h"
+
+#define TEST_SETS	200
+#define TEST_MAX_N	20000
+#define TEST_SEED	1
+
+enum test_distribution {
+	TEST_UNIFORM_SMALL,
+	TEST_NORMAL,
+	TEST_EXPONENTIAL,
+	TEST_LOG_UNIFORM,
+	TEST_CONSTANT,
+	TEST_DISTRIBUTIONS
+};
+
+static const unsigned int test_ppm[] = {1, HIST_PPM_P01, HIST_PPM_P1, HIST_PPM_P50, HIST_PPM_P99, HIST_PPM_P999, 1000000};
+
+static s32 samples[2 * TEST_MAX_N];
+static s32 sorted[2 * TEST_MAX_N];
+static unsigned int seed = TEST_SEED;
+
+static double test_uniform(void)
+{
+	return (rand_r(&seed) + 1.0) / (RAND_MAX + 2.0);
+}
+
+static s32 test_sample(enum test_distribution d, s32 constant)
+{
+	double v = 0;
+	int i;
+
+	switch (d) {
+	case TEST_UNIFORM_SMALL:
+		return (s32)(test_uniform() * 41) - 20;
+
+	case TEST_NORMAL:
+		for (i = 0; i < 12; i++)
+			v += test_uniform();
+
+		return (s32)((v - 6) * 20000) + 500000;
+
+	case TEST_EXPONENTIAL:
+		return (s32)(-log(test_uniform()) * 100000);
+
+	case TEST_LOG_UNIFORM:
+		/* Full s32 range, both signs */
+		v = exp(test_uniform() * log(2147483647.0));
+
+		return (rand_r(&seed) & 1) ? (s32)v : -(s32)v;
+
+	case TEST_CONSTANT:
+	default:
+		return constant;
+	}
+}
+
+static int test_cmp(const void *a, const void *b)
+{
+	s32 x = *(const s32 *)a, y = *(const s32 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static s32 test_exact_percentile(const s32 *sorted, unsigned int n, unsigned int ppm)
+{
+	u64 target = ((u64)n * ppm + 999999) / 1000000;
+
+	if (!target)
+		target = 1;
+
+	return sorted[target - 1];
+}
+
+/* Checks that v, returned by the histogram, is in the same bucket as the exact percentile e */
+static int test_check(s32 v, s32 e)
+{
+	s64 abs_e = llabs((s64)e);
+	s64 abs_v = llabs((s64)v);
+
+	/* Out of range, saturated to the last bucket (of the same sign) */
+	if (abs_e >= ((s64)1 << HIST_MAX_BITS))
+		return (((v < 0) == (e < 0)) && (abs_v >= ((s64)1 << HIST_MAX_BITS) - ((s64)1 << (HIST_MAX_BITS - HIST_SUB_BITS)))
+			&& (abs_v <= ((s64)1 << HIST_MAX_BITS))) ? 0 : -1;
+
+	if (v < e)
+		return -1;
+
+	return ((s64)v - e <= (abs_e >> HIST_SUB_BITS)) ? 0 : -1;
+}
+
+static int test_hist(const struct hist *h, const s32 *values, unsigned int n, const char *name)
+{
+	unsigned int i;
+	int rc = 0;
+
+	memcpy(sorted, values, n * sizeof(s32));
+	qsort(sorted, n, sizeof(s32), test_cmp);
+
+	if (h->total != n) {
+		printf("%s: total %u, expected %u\n", name, h->total, n);
+		return -1;
+	}
+
+	for (i = 0; i < sizeof(test_ppm) / sizeof(test_ppm[0]); i++) {
+		s32 v = hist_percentile(h, test_ppm[i]);
+		s32 e = test_exact_percentile(sorted, n, test_ppm[i]);
+
+		if (test_check(v, e) < 0) {
+			printf("%s: n %u, percentile %u ppm: histogram %d, exact %d\n", name, n, test_ppm[i], v, e);
+			rc = -1;
+		}
+	}
+
+	return rc;
+}
+
+static int test_set(enum test_distribution d)
+{
+	static struct hist h1, h2, merged, snapshot;
+	unsigned int n1 = 1 + rand_r(&seed) % TEST_MAX_N;
+	unsigned int n2 = 1 + rand_r(&seed) % TEST_MAX_N;
+	s32 constant = test_sample(TEST_LOG_UNIFORM, 0);
+	unsigned int i;
+	int rc = 0;
+
+	hist_reset(&h1);
+	hist_reset(&h2);
+
+	for (i = 0; i < n1; i++) {
+		samples[i] = test_sample(d, constant);
+		hist_update(&h1, samples[i]);
+	}
+
+	for (i = 0; i < n2; i++) {
+		samples[n1 + i] = test_sample(d, constant);
+		hist_update(&h2, samples[n1 + i]);
+	}
+
+	if (test_hist(&h1, samples, n1, "single") < 0)
+		rc = -1;
+
+	hist_reset(&merged);
+	hist_merge(&merged, &h1);
+	hist_merge(&merged, &h2);
+
+	if (test_hist(&merged, samples, n1 + n2, "merged") < 0)
+		rc = -1;
+
+	hist_snapshot(&h2, &snapshot);
+
+	if (test_hist(&snapshot, &samples[n1], n2, "snapshot") < 0)
+		rc = -1;
+
+	if (h2.total || hist_percentile(&h2, HIST_PPM_P50)) {
+		printf("snapshot: histogram not reset\n");
+		rc = -1;
+	}
+
+	return rc;
+}
+
+static int test_edges(void)
+{
+	static const s32 edges[] = {0, 1, -1, HIST_SUB_BUCKETS - 1, HIST_SUB_BUCKETS, -HIST_SUB_BUCKETS, -HIST_SUB_BUCKETS - 1,
+				    1000, -1000, 0x7fffffff, (s32)0x80000000, 1 << 23, (1 << 24) - 1, 1 << 24, -(1 << 24)};
+	static struct hist h;
+	unsigned int i, j;
+	int rc = 0;
+
+	for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+		hist_reset(&h);
+		hist_update(&h, edges[i]);
+
+		for (j = 0; j < sizeof(test_ppm) / sizeof(test_ppm[0]); j++) {
+			if (test_check(hist_percentile(&h, test_ppm[j]), edges[i]) < 0) {
+				printf("edge %d: histogram %d\n", edges[i], hist_percentile(&h, test_ppm[j]));
+				rc = -1;
+				break;
+			}
+		}
+	}
+
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int rc = 0;
+
+	printf("histogram: %u buckets (%u bytes), precision 1/%u, range +/-2^%u\n",
+		HIST_BUCKETS, (unsigned int)sizeof(struct hist), HIST_SUB_BUCKETS, HIST_MAX_BITS);
+
+	if (test_edges() < 0)
+		rc = -1;
+
+	for (i = 0; i < TEST_SETS; i++)
+		if (test_set(i % TEST_DISTRIBUTIONS) < 0)
+			rc = -1;
+
+	printf("%s\n", rc ? "FAIL" : "PASS");
+
+	return rc ? 1 : 0;
+}
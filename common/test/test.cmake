@@ -0,0 +1,8 @@
+# common unit tests
+genavb_add_test(NAME common-stats COMPONENT common SRCS stats.c LIBS common)
+
+# Same test with the reduced histogram used by the RTOS targets (see rtos/osal/config.h)
+genavb_add_test(NAME common-stats-small COMPONENT common SRCS stats.c ../stats.c LIBS common)
+target_compile_definitions(common-stats-small PRIVATE HIST_CFG_SUB_BITS=2 HIST_CFG_MAX_BITS=24)
+
+genavb_add_test(NAME common-filter COMPONENT common SRCS filter.c LIBS common)
@@ -18,6 +18,9 @@
 
 //#define CFG_LOG_OFFSET 1
 
+/* cross-check every incremental best master selection against a full one */
+//#define CFG_GPTP_BMCA_CHECK 1
+
 
 #define gptp_CFG_LOG	CFG_LOG
 
@@ -103,6 +106,11 @@
 #define CFG_GPTP_NEIGH_THRESH_MIN_DEFAULT	(0)
 #define CFG_GPTP_NEIGH_THRESH_MAX_DEFAULT	(10000000)
 
+/* neighbor rate ratio estimation window, in number of pdelay exchanges (2 is the two-point method from 802.1AS) */
+#define CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT	(2)
+#define CFG_GPTP_RATE_RATIO_WINDOW_MIN		(2)
+#define CFG_GPTP_RATE_RATIO_WINDOW_MAX		(16)
+
 
 /* Reverse sync feature default values */
 #define CFG_GPTP_RSYNC_INTERVAL_DEFAULT		(112)
@@ -141,6 +149,13 @@
 
 #define CFG_GPTP_DEFAULT_FORCE_2011_STRING	"no"
 
+/* per domain instance threads default settings */
+#define CFG_GPTP_DOMAIN_THREADS_DEFAULT		(0)
+#define CFG_GPTP_DOMAIN_THREADS_MIN_DEFAULT	(0)
+#define CFG_GPTP_DOMAIN_THREADS_MAX_DEFAULT	(1)
+
+#define CFG_GPTP_INSTANCE_EVENT_QUEUE_SIZE	64 /* must be a power of 2 */
+
 #define CFG_GPTP_DEFAULT_RX_DELAY_COMP 	(0)
 #define CFG_GPTP_DEFAULT_TX_DELAY_COMP 	(0)
 #define CFG_GPTP_DEFAULT_DELAY_COMP_MIN (-1000000)
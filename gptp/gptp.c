@@ -185,6 +185,25 @@ u8 *get_port_identity_clock_id(struct gptp_port *port)
 	return identity->clock_identity;
 }
 
+/*
+Copy the link delay state of a common port, updated by the main gPTP thread, for an instance running in its own thread
+*/
+static ptp_double gptp_link_state_read(struct gptp_port *port, struct gptp_port_common *c)
+{
+	ptp_double neighbor_rate_ratio;
+	u32 seq;
+
+	do {
+		seq = gptp_link_read_begin(c);
+
+		port->link_mean_link_delay = c->params.mean_link_delay;
+		port->link_delay_asymmetry = c->params.delay_asymmetry;
+		neighbor_rate_ratio = c->params.neighbor_rate_ratio;
+	} while (gptp_link_read_retry(c, seq));
+
+	return neighbor_rate_ratio;
+}
+
 /*
 Retrieve either the per instance specific mean delay or the cmlds's link port one associated to the port
 */
@@ -197,6 +216,11 @@ struct ptp_u_scaled_ns *get_mean_link_delay(struct gptp_port *port)
 	else
 		c = port->instance->gptp->instances[0]->ports[port->port_id].c;
 
+	if (port->instance->threaded) {
+		gptp_link_state_read(port, c);
+		return &port->link_mean_link_delay;
+	}
+
 	return &c->params.mean_link_delay;
 }
 
@@ -212,6 +236,9 @@ ptp_double get_neighbor_rate_ratio(struct gptp_port *port)
 	else
 		c = port->instance->gptp->instances[0]->ports[port->port_id].c;
 
+	if (port->instance->threaded)
+		return gptp_link_state_read(port, c);
+
 	return c->params.neighbor_rate_ratio;
 }
 
@@ -228,6 +255,11 @@ struct ptp_scaled_ns *get_delay_asymmetry(struct gptp_port *port)
 	else
 		c = port->instance->gptp->instances[0]->ports[port->port_id].c;
 
+	if (port->instance->threaded) {
+		gptp_link_state_read(port, c);
+		return &port->link_delay_asymmetry;
+	}
+
 	return &c->params.delay_asymmetry;
 }
 
@@ -262,6 +294,39 @@ static const char * gptp_msgtype2string(u8 msg_type)
 	}
 }
 
+/* Instances running in their own thread are locked by the main gPTP thread before accessing their state */
+static void gptp_instance_lock(struct gptp_instance *instance)
+{
+	struct gptp_domain_threads *threads = instance->gptp->threads;
+
+	if (instance->threaded)
+		threads->lock(threads, instance->index);
+}
+
+static void gptp_instance_unlock(struct gptp_instance *instance)
+{
+	struct gptp_domain_threads *threads = instance->gptp->threads;
+
+	if (instance->threaded)
+		threads->unlock(threads, instance->index);
+}
+
+static void gptp_instances_lock(struct gptp_ctx *gptp)
+{
+	int i;
+
+	for (i = 0; i < gptp->domain_max; i++)
+		gptp_instance_lock(gptp->instances[i]);
+}
+
+static void gptp_instances_unlock(struct gptp_ctx *gptp)
+{
+	int i;
+
+	for (i = gptp->domain_max - 1; i >= 0; i--)
+		gptp_instance_unlock(gptp->instances[i]);
+}
+
 /* GPTP GM status
  * Propagates gm_id and path_trace info for a given domain
  */
@@ -356,8 +421,12 @@ static void gptp_ipc_managed_get(struct gptp_ctx *gptp, struct ipc_tx *ipc, unsi
 	desc = ipc_alloc(ipc, GENAVB_MAX_MANAGED_SIZE);
 	if (desc) {
 
+		gptp_instances_lock(gptp);
+
 		desc->len = gptp_managed_objects_get(&gptp->module, in, in_end, desc->u.data, desc->u.data + GENAVB_MAX_MANAGED_SIZE);
 
+		gptp_instances_unlock(gptp);
+
 		desc->dst = ipc_dst;
 		desc->type = GENAVB_MSG_MANAGED_GET_RESPONSE;
 
@@ -380,8 +449,12 @@ static void gptp_ipc_managed_set(struct gptp_ctx *gptp, struct ipc_tx *ipc, unsi
 	desc = ipc_alloc(ipc, GENAVB_MAX_MANAGED_SIZE);
 	if (desc) {
 
+		gptp_instances_lock(gptp);
+
 		desc->len = gptp_managed_objects_set(&gptp->module, in, in_end, desc->u.data, desc->u.data + GENAVB_MAX_MANAGED_SIZE);
 
+		gptp_instances_unlock(gptp);
+
 		desc->dst = ipc_dst;
 		desc->type = GENAVB_MSG_MANAGED_SET_RESPONSE;
 
@@ -441,9 +514,11 @@ static void gptp_ipc_rx_media_stack(struct ipc_rx const *rx, struct ipc_desc *de
 	case GENAVB_MSG_GM_GET_STATUS:
 		os_log(LOG_INFO, "GENAVB_MSG_GM_GET_STATUS\n");
 		instance = instance_from_domain(gptp, desc->u.gm_get_status.domain);
-		if (instance)
+		if (instance) {
+			gptp_instance_lock(instance);
 			gptp_ipc_gm_status(instance, ipc_tx, desc->src);
-		else
+			gptp_instance_unlock(instance);
+		} else
 			//FIXME log per time-aware system error counter
 			gptp_ipc_error_response(gptp, ipc_tx, desc->src, desc->type, desc->len, GENAVB_ERR_PTP_DOMAIN_INVALID);
 
@@ -477,6 +552,8 @@ void gptp_gm_indication(struct gptp_instance *instance, struct ptp_priority_vect
 
 	dump_priority_vector(gm_vector, instance->index, instance->domain.domain_number, "grand master", LOG_INFO);
 
+	instance->stats.num_gm_changes++;
+
 	os_memcpy(&instance->gm_info.vector, gm_vector, sizeof(struct ptp_priority_vector));
 
 	os_memcpy(&instance->cfg.gm_id, &gm_vector->u.s.root_system_identity.u.s.clock_identity, sizeof(struct ptp_clock_identity));
@@ -700,6 +777,45 @@ static void gptp_rsync_timer_handler(void *data)
 	gptp_rsync_send_sync(port);
 }
 
+/** Hands an event over to an instance running in its own thread. Called from the main gPTP thread only.
+* \return	0 on success, -1 if the instance event queue is full
+* \param instance	pointer to the gptp instance
+* \param event	pointer to the event to queue
+*/
+static int gptp_instance_post_event(struct gptp_instance *instance, struct gptp_instance_event *event)
+{
+	struct gptp_domain_threads *threads = instance->gptp->threads;
+	struct gptp_instance_queue *queue = &instance->queue;
+	unsigned int write = queue->write;
+
+	if ((write - __atomic_load_n(&queue->read, __ATOMIC_ACQUIRE)) >= CFG_GPTP_INSTANCE_EVENT_QUEUE_SIZE) {
+		instance->stats.num_event_queue_full++;
+		return -1;
+	}
+
+	queue->event[write & (CFG_GPTP_INSTANCE_EVENT_QUEUE_SIZE - 1)] = *event;
+
+	__atomic_store_n(&queue->write, write + 1, __ATOMIC_RELEASE);
+
+	threads->notify(threads, instance->index);
+
+	return 0;
+}
+
+static void gptp_instance_sync_latency_update(struct gptp_instance *instance, u64 rx_time)
+{
+	u64 now;
+	s32 latency;
+
+	if (os_clock_gettime64(instance->gptp->clock_monotonic, &now) < 0)
+		return;
+
+	latency = (s32)(now - rx_time);
+
+	stats_update(&instance->stats.sync_latency, latency);
+	hist_update(&instance->stats.sync_latency_hist, latency);
+}
+
 /** Transmitted packet timestamp handler. Called by platform specific code upon tx timestamp notification
 * \return	none
 * \param tx	pointer to the network transmit context
@@ -734,32 +850,9 @@ static void cmlds_hwts_handler(struct gptp_net_port *net_port, uint64_t ts, u8 t
 	}
 }
 
-/** Transmitted packet timestamp handler. Called by platform specific code upon tx timestamp notification
-* \return	none
-* \param tx	pointer to the network transmit context
-* \param ts	64bit timestamp in ns
-* \param ts_info	32bits timestamp information (bit0-7: ptp message type, bit8-15 ptp domain, bit16-31: timestamp identifier)
-*/
-static void gptp_instance_hwts_handler(struct gptp_net_port *net_port, uint64_t ts, u8 type, u8 domain_number)
+static void gptp_instance_hwts_handle(struct gptp_instance *instance, struct gptp_port *port, uint64_t ts, u8 type)
 {
-	struct gptp_ctx *gptp = container_of(net_port, struct gptp_ctx, net_ports[net_port->port_id]);
-	struct gptp_instance *instance;
-	struct gptp_port *port;
-
-	instance = instance_from_domain(gptp, domain_number);
-	if (!instance) {
-		os_log(LOG_ERR, " Unknown domain(%u) for message type (%u)\n", domain_number, type);
-		net_port->stats.num_err_domain_unknown++;
-		goto err;
-	}
-
-	os_log(LOG_DEBUG, "Port(%d) domain(%u, %u): ts %"PRIu64", type %u %s\n", net_port->port_id, instance->index, instance->domain.domain_number, ts, type, gptp_msgtype2string(type));
-
-	port = net_port_to_gptp(net_port, instance->index);
-	if (!port) {
-		os_log(LOG_ERR, "Can not retrieve gptp_port from net_port(%d) \n", net_port->port_id);
-		goto err;
-	}
+	struct gptp_ctx *gptp = instance->gptp;
 
 	switch (type) {
 	case PTP_MSG_TYPE_PDELAY_REQ:
@@ -787,9 +880,49 @@ static void gptp_instance_hwts_handler(struct gptp_net_port *net_port, uint64_t
 		break;
 
 	default:
-		os_log(LOG_ERR, "Port(%u): Unknown message type (%u)\n", net_port->port_id, type);
+		os_log(LOG_ERR, "Port(%u): Unknown message type (%u)\n", port->port_id, type);
 		break;
 	}
+}
+
+/** Transmitted packet timestamp handler. Called by platform specific code upon tx timestamp notification
+* \return	none
+* \param tx	pointer to the network transmit context
+* \param ts	64bit timestamp in ns
+* \param ts_info	32bits timestamp information (bit0-7: ptp message type, bit8-15 ptp domain, bit16-31: timestamp identifier)
+*/
+static void gptp_instance_hwts_handler(struct gptp_net_port *net_port, uint64_t ts, u8 type, u8 domain_number)
+{
+	struct gptp_ctx *gptp = container_of(net_port, struct gptp_ctx, net_ports[net_port->port_id]);
+	struct gptp_instance *instance;
+	struct gptp_port *port;
+	struct gptp_instance_event event;
+
+	instance = instance_from_domain(gptp, domain_number);
+	if (!instance) {
+		os_log(LOG_ERR, " Unknown domain(%u) for message type (%u)\n", domain_number, type);
+		net_port->stats.num_err_domain_unknown++;
+		goto err;
+	}
+
+	os_log(LOG_DEBUG, "Port(%d) domain(%u, %u): ts %"PRIu64", type %u %s\n", net_port->port_id, instance->index, instance->domain.domain_number, ts, type, gptp_msgtype2string(type));
+
+	port = net_port_to_gptp(net_port, instance->index);
+	if (!port) {
+		os_log(LOG_ERR, "Can not retrieve gptp_port from net_port(%d) \n", net_port->port_id);
+		goto err;
+	}
+
+	if (instance->threaded) {
+		event.type = GPTP_INSTANCE_EVENT_HWTS;
+		event.port = port;
+		event.ts = ts;
+		event.msg_type = type;
+
+		gptp_instance_post_event(instance, &event);
+	} else {
+		gptp_instance_hwts_handle(instance, port, ts, type);
+	}
 
 err:
 	return;
@@ -1388,23 +1521,10 @@ static void cmlds_net_rx(struct gptp_ctx *gptp, struct gptp_net_port *net_port,
 	}
 }
 
-static void gptp_instance_net_rx(struct gptp_ctx *gptp, struct gptp_net_port *net_port, struct net_rx_desc *desc)
+static void gptp_instance_net_rx_handle(struct gptp_instance *instance, struct gptp_port *port, struct net_rx_desc *desc, u64 rx_time)
 {
 	void *data = (char *)desc + desc->l3_offset;
 	struct ptp_hdr *header = (struct ptp_hdr *)data;
-	struct gptp_instance *instance;
-	struct gptp_port *port;
-
-	instance = instance_from_domain(gptp, header->domain_number);
-	if (!instance) {
-		net_port->stats.num_err_domain_unknown++;
-		return;
-	}
-
-	port = net_port_to_gptp(net_port, instance->index);
-	if (!port) {
-		return;
-	}
 
 	os_log(LOG_DEBUG, "Port(%u) domain(%u, %u): %s desc port %d, len %d, ts %"PRIu64"\n", port->port_id, instance->index, header->domain_number, gptp_msgtype2string(header->msg_type), desc->port, desc->len, desc->ts64);
 
@@ -1435,6 +1555,7 @@ static void gptp_instance_net_rx(struct gptp_ctx *gptp, struct gptp_net_port *ne
 
 	case PTP_MSG_TYPE_SYNC:
 		gptp_handle_sync(instance, port, data, desc->ts64);
+		gptp_instance_sync_latency_update(instance, rx_time);
 		break;
 
 	case PTP_MSG_TYPE_FOLLOW_UP:
@@ -1456,6 +1577,62 @@ static void gptp_instance_net_rx(struct gptp_ctx *gptp, struct gptp_net_port *ne
 }
 
 
+/** Dispatches a received packet to its domain instance
+* \return	1 if the packet was handed over to the instance thread (and will be freed by it), 0 otherwise
+* \param gptp	pointer to the main gptp context
+* \param net_port	pointer to the network port the packet was received on
+* \param desc	pointer to the received packet descriptor
+*/
+static int gptp_instance_net_rx(struct gptp_ctx *gptp, struct gptp_net_port *net_port, struct net_rx_desc *desc)
+{
+	void *data = (char *)desc + desc->l3_offset;
+	struct ptp_hdr *header = (struct ptp_hdr *)data;
+	struct gptp_instance *instance;
+	struct gptp_port *port;
+	struct gptp_instance_event event;
+	u64 rx_time = 0;
+
+	instance = instance_from_domain(gptp, header->domain_number);
+	if (!instance) {
+		net_port->stats.num_err_domain_unknown++;
+		return 0;
+	}
+
+	port = net_port_to_gptp(net_port, instance->index);
+	if (!port) {
+		return 0;
+	}
+
+	if (header->msg_type == PTP_MSG_TYPE_SYNC)
+		os_clock_gettime64(gptp->clock_monotonic, &rx_time);
+
+	if (instance->threaded) {
+		event.type = GPTP_INSTANCE_EVENT_NET_RX;
+		event.port = port;
+		event.desc = desc;
+		event.rx_time = rx_time;
+
+		if (gptp_instance_post_event(instance, &event) < 0)
+			return 0;
+
+		return 1;
+	}
+
+	gptp_instance_net_rx_handle(instance, port, desc, rx_time);
+
+	return 0;
+}
+
+static void gptp_rx_cost_update(struct gptp_ctx *gptp, u8 msg_type, u64 start)
+{
+	u64 now;
+
+	if (os_clock_gettime64(gptp->clock_monotonic, &now) < 0)
+		return;
+
+	stats_update(&gptp->rx_cost[msg_type & (GPTP_RX_COST_MSG_TYPES - 1)], (s32)(now - start));
+}
+
 /** Decode and handle PTPv2 packets received from the network
 * \return	none
 * \param rx	pointer to the network receive context
@@ -1467,8 +1644,14 @@ static void gptp_net_rx(struct net_rx *rx, struct net_rx_desc *desc)
 	struct gptp_ctx *gptp = container_of(net_port, struct gptp_ctx, net_ports[net_port->port_id]);
 	void *data = (char *)desc + desc->l3_offset;
 	struct ptp_hdr *header = (struct ptp_hdr *)data;
+	u8 msg_type = header->msg_type;
+	u64 start = 0;
+	int handed_over = 0;
 	bool is_cmlds;
 
+	if (gptp->cfg.statsInterval)
+		os_clock_gettime64(gptp->clock_monotonic, &start);
+
 	if (desc->ethertype != ETHERTYPE_PTP) {
 		net_port->stats.num_rx_err_etype++;
 		goto err;
@@ -1494,13 +1677,72 @@ static void gptp_net_rx(struct net_rx *rx, struct net_rx_desc *desc)
 	if (is_cmlds)
 		cmlds_net_rx(gptp, net_port, desc);
 	else
-		gptp_instance_net_rx(gptp, net_port, desc);
+		handed_over = gptp_instance_net_rx(gptp, net_port, desc);
+
+	if (gptp->cfg.statsInterval)
+		gptp_rx_cost_update(gptp, msg_type, start);
+
+	/* the instance thread frees the descriptor */
+	if (handed_over)
+		return;
 
 err:
 	net_rx_free(desc);
 }
 
 
+/** Checks if a domain instance runs in its own thread
+* \return	true if the instance runs in its own thread, false otherwise
+* \param gptp_ctx	pointer to the main gptp context
+* \param instance_index	index of the domain instance
+*/
+bool gptp_instance_is_threaded(void *gptp_ctx, unsigned int instance_index)
+{
+	struct gptp_ctx *gptp = (struct gptp_ctx *)gptp_ctx;
+
+	if (instance_index >= gptp->domain_max)
+		return false;
+
+	return gptp->instances[instance_index]->threaded;
+}
+
+/** Processes the events handed over to a domain instance running in its own thread.
+* Called by platform specific code, from the instance thread, with the instance lock held.
+* \return	none
+* \param gptp_ctx	pointer to the main gptp context
+* \param instance_index	index of the domain instance
+*/
+void gptp_instance_process(void *gptp_ctx, unsigned int instance_index)
+{
+	struct gptp_ctx *gptp = (struct gptp_ctx *)gptp_ctx;
+	struct gptp_instance *instance = gptp->instances[instance_index];
+	struct gptp_instance_queue *queue = &instance->queue;
+	struct gptp_instance_event *event;
+	unsigned int read = queue->read;
+
+	while (read != __atomic_load_n(&queue->write, __ATOMIC_ACQUIRE)) {
+		event = &queue->event[read & (CFG_GPTP_INSTANCE_EVENT_QUEUE_SIZE - 1)];
+
+		switch (event->type) {
+		case GPTP_INSTANCE_EVENT_NET_RX:
+			gptp_instance_net_rx_handle(instance, event->port, event->desc, event->rx_time);
+			net_rx_free(event->desc);
+			break;
+
+		case GPTP_INSTANCE_EVENT_HWTS:
+			gptp_instance_hwts_handle(instance, event->port, event->ts, event->msg_type);
+			break;
+
+		default:
+			break;
+		}
+
+		read++;
+		__atomic_store_n(&queue->read, read, __ATOMIC_RELEASE);
+	}
+}
+
+
 static int gptp_port_common_init_timers(struct gptp_port_common *port)
 {
 	/* pdelay request transmit timer only required if pdelay 'silent' mode is not used */
@@ -1530,18 +1772,18 @@ __init static int gptp_port_init_timers(struct gptp_port *port, unsigned int por
 		/* announce always sent every announce_interval */
 		port->announce_transmit_sm.transmit_timer.func = gptp_announce_transmit_timer_handler;
 		port->announce_transmit_sm.transmit_timer.data = port;
-		if (timer_create(gptp->timer_ctx, &port->announce_transmit_sm.transmit_timer, TIMER_TYPE_SYS, 0) < 0)
+		if (timer_create(port->instance->timer_ctx, &port->announce_transmit_sm.transmit_timer, TIMER_TYPE_SYS, 0) < 0)
 			goto err_announce;
 	}
 
 	port->port_sync.sync_send_sm.sync_transmit_timer.func = gptp_port_sync_sync_transmit_timer_handler;
 	port->port_sync.sync_send_sm.sync_transmit_timer.data = port;
-	if (timer_create(gptp->timer_ctx, &port->port_sync.sync_send_sm.sync_transmit_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(port->instance->timer_ctx, &port->port_sync.sync_send_sm.sync_transmit_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_sync;
 
 	port->port_sync.sync_send_sm.sync_receipt_timeout_timer.func = gptp_port_sync_sync_receipt_timeout_handler;
 	port->port_sync.sync_send_sm.sync_receipt_timeout_timer.data = port;
-	if (timer_create(gptp->timer_ctx, &port->port_sync.sync_send_sm.sync_receipt_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(port->instance->timer_ctx, &port->port_sync.sync_send_sm.sync_receipt_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_sync_timeout;
 
 	/*
@@ -1551,32 +1793,32 @@ __init static int gptp_port_init_timers(struct gptp_port *port, unsigned int por
 	/* sync follow up receipt timeout */
 	port->follow_up_receive_timeout_timer.func = gptp_follow_up_receive_timeout_timer_handler;
 	port->follow_up_receive_timeout_timer.data = port;
-	if (timer_create(gptp->timer_ctx, &port->follow_up_receive_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(port->instance->timer_ctx, &port->follow_up_receive_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_follow_up;
 
 	/* sync receipt timeout */
 	port->sync_receive_timeout_timer.func = gptp_sync_receive_timeout_timer_handler;
 	port->sync_receive_timeout_timer.data = port;
-	if (timer_create(gptp->timer_ctx, &port->sync_receive_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(port->instance->timer_ctx, &port->sync_receive_timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_sync_receive;
 
 	/* announce receipt timeout */
 	port->port_sync.announce_receive_sm.timeout_timer.func = gptp_announce_receive_timeout_timer_handler;
 	port->port_sync.announce_receive_sm.timeout_timer.data = port;
-	if (timer_create(gptp->timer_ctx, &port->port_sync.announce_receive_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(port->instance->timer_ctx, &port->port_sync.announce_receive_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_announce_receive;
 
 	if (!gptp->force_2011) {
 		/* gptp capable receipt timeout */
 		port->gptp_capable_receive_sm.timeout_timer.func = gptp_capable_receive_timeout_timer_handler;
 		port->gptp_capable_receive_sm.timeout_timer.data = port;
-		if (timer_create(gptp->timer_ctx, &port->gptp_capable_receive_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+		if (timer_create(port->instance->timer_ctx, &port->gptp_capable_receive_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 			goto err_gptp_capable_receive;
 
 		/* gptp capable transmit timeout */
 		port->gptp_capable_transmit_sm.timeout_timer.func = gptp_capable_transmit_timeout_timer_handler;
 		port->gptp_capable_transmit_sm.timeout_timer.data = port;
-		if (timer_create(gptp->timer_ctx, &port->gptp_capable_transmit_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
+		if (timer_create(port->instance->timer_ctx, &port->gptp_capable_transmit_sm.timeout_timer, TIMER_TYPE_SYS, 0) < 0)
 			goto err_gptp_capable_transmit;
 	}
 
@@ -1584,7 +1826,7 @@ __init static int gptp_port_init_timers(struct gptp_port *port, unsigned int por
 	if (gptp->cfg.rsync) {
 		port->rsync_timer.func = gptp_rsync_timer_handler;
 		port->rsync_timer.data = port;
-		if (timer_create(gptp->timer_ctx, &port->rsync_timer, TIMER_TYPE_SYS, 0) < 0)
+		if (timer_create(port->instance->timer_ctx, &port->rsync_timer, TIMER_TYPE_SYS, 0) < 0)
 			goto err_sync_reverse;
 	}
 
@@ -1658,11 +1900,9 @@ static void gptp_stats_exit_timers(struct gptp_ctx *gptp)
 
 __init static int gptp_instance_init_timers(struct gptp_instance *instance)
 {
-	struct gptp_ctx *gptp = instance->gptp;
-
 	instance->clock_master_sync_send_timer.func = gptp_clock_master_sync_send_timer_handler;
 	instance->clock_master_sync_send_timer.data = instance;
-	if (timer_create(gptp->timer_ctx, &instance->clock_master_sync_send_timer, TIMER_TYPE_SYS, 0) < 0)
+	if (timer_create(instance->timer_ctx, &instance->clock_master_sync_send_timer, TIMER_TYPE_SYS, 0) < 0)
 		goto err_clock_master;
 
 	return 0;
@@ -1799,6 +2039,7 @@ static void gptp_port_common_set_config_parameters(struct gptp_port_common *port
 	port->identity.port_number = port->port_id + 1;
 
 	stats_init(&port->pdelay_stats, 31, "Pdelay (ns)", NULL);
+	hist_reset(&port->pdelay_hist);
 
 	port->md.globals.allowedLostResponses = cfg->port_cfg[port->port_id].allowedLostResponses;
 	port->md.globals.allowedFaults = cfg->port_cfg[port->port_id].allowedFaults;
@@ -1821,6 +2062,10 @@ static void gptp_port_common_set_config_parameters(struct gptp_port_common *port
 	port->cfg.neighborPropDelay_mode = cfg->neighborPropDelay_mode;
 	port->cfg.initial_neighborPropDelay = cfg->initial_neighborPropDelay[port->port_id];
 	port->cfg.neighborPropDelay_sensitivity = cfg->neighborPropDelay_sensitivity;
+
+	port->rate_ratio.window = cfg->neighborRateRatioWindow;
+	if ((port->rate_ratio.window < CFG_GPTP_RATE_RATIO_WINDOW_MIN) || (port->rate_ratio.window > CFG_GPTP_RATE_RATIO_WINDOW_MAX))
+		port->rate_ratio.window = CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT;
 }
 
 /** Apply gPTP profile parameters to a given gptp port
@@ -2001,7 +2246,11 @@ static void gptp_dump_instance_port_counters(struct gptp_instance *instance, str
 	"\tPortStatAdjustOnSync %u\n"
 	"\tPortStatMdSyncRcvSmReset %u\n"
 	"\tPortStatNumSynchronizationLoss %u\n"
-	"\tPortStatNumNotAsCapable %u\n",
+	"\tPortStatNumNotAsCapable %u\n"
+	"\tBmcaRuns %u\n"
+	"\tBmcaIncrementalRuns %u\n"
+	"\tBmcaRoleChanges %u\n"
+	"\tGrandMasterChanges %u\n",
 	port->port_id,
 	instance->index,
 	instance->domain.domain_number,
@@ -2022,10 +2271,38 @@ static void gptp_dump_instance_port_counters(struct gptp_instance *instance, str
 	instance_stats->num_adjust_on_sync,
 	stats->num_md_sync_rcv_sm_reset,
 	instance_stats->num_synchro_loss,
-	stats->num_not_as_capable
+	stats->num_not_as_capable,
+	instance_stats->num_bmca_runs,
+	instance_stats->num_bmca_incremental_runs,
+	instance_stats->num_role_changes,
+	instance_stats->num_gm_changes
 	);
 }
 
+static void gptp_dump_instance_sync_latency(struct gptp_instance *instance)
+{
+	struct stats *sync_latency = &instance->stats.sync_latency;
+	struct hist_percentiles sync_latency_pct;
+
+	if (!sync_latency->current_count)
+		return;
+
+	stats_compute(sync_latency);
+	hist_percentiles_compute(&instance->stats.sync_latency_hist, &sync_latency_pct);
+
+	os_log(LOG_INFO_RAW, "domain(%u, %u) %s: Sync latency (ns): min %6d avg %6d max %6d variance %5"PRId64"\n",
+		instance->index, instance->domain.domain_number, instance->threaded ? "threaded" : "main",
+		sync_latency->min, sync_latency->mean, sync_latency->max, sync_latency->variance);
+
+	os_log(LOG_INFO_RAW, "domain(%u, %u) %s: Sync latency (ns): p50 %6d p99 %6d p99.9 %6d samples %u event queue full %u\n",
+		instance->index, instance->domain.domain_number, instance->threaded ? "threaded" : "main",
+		sync_latency_pct.p50, sync_latency_pct.p99, sync_latency_pct.p999, sync_latency_pct.total, instance->stats.num_event_queue_full);
+
+	stats_reset(sync_latency);
+	hist_reset(&instance->stats.sync_latency_hist);
+}
+
+
 
 static void gptp_dump_port_counters(struct gptp_port_common *port, const char *prefix)
 {
@@ -2040,7 +2317,8 @@ static void gptp_dump_port_counters(struct gptp_port_common *port, const char *p
 		"\tPortStatTxPdelayRequest %u\n"
 		"\tPortStatTxPdelayResponse %u\n"
 		"\tPortStatTxPdelayResponseFollowUp %u\n"
-		"\tPortStatMdPdelayReqSmReset %u\n",
+		"\tPortStatMdPdelayReqSmReset %u\n"
+		"\tPortStatRateRatioOutliers %u\n",
 		prefix,
 		port->port_id,
 		stats->peer_clock_id,
@@ -2051,24 +2329,29 @@ static void gptp_dump_port_counters(struct gptp_port_common *port, const char *p
 		stats->num_tx_pdelayreq,
 		stats->num_tx_pdelayresp,
 		stats->num_tx_pdelayrespfup,
-		stats->num_md_pdelay_req_sm_reset
+		stats->num_md_pdelay_req_sm_reset,
+		stats->num_rate_ratio_outliers
 	);
 }
 
 static void gptp_dump_pdelay_stats(struct gptp_port_common *c, const char *prefix)
 {
 	struct stats *pdelay_stats;
+	struct hist_percentiles pdelay_pct;
 	ptp_double delay_double;
 
 	pdelay_stats = &c->pdelay_stats;
 
 	stats_compute(pdelay_stats);
+	hist_percentiles_compute(&c->pdelay_hist, &pdelay_pct);
 	u_scaled_ns_to_ptp_double(&delay_double, &c->params.mean_link_delay);
 
 	os_log(LOG_INFO_RAW, "%s(%d): Propagation delay (ns): %4.2f			min %6d avg %6d max %6d variance %5"PRId64"\n", prefix, c->port_id, delay_double, pdelay_stats->min, pdelay_stats->mean, pdelay_stats->max, pdelay_stats->variance);
+	os_log(LOG_INFO_RAW, "%s(%d): Propagation delay (ns) percentiles:	p50 %6d p99 %6d p99.9 %6d samples %u\n", prefix, c->port_id, pdelay_pct.p50, pdelay_pct.p99, pdelay_pct.p999, pdelay_pct.total);
 	os_log(LOG_INFO_RAW, "%s(%d): NeighborRateRatio     : %10.9f\n", prefix, c->port_id, c->params.neighbor_rate_ratio);
 
 	stats_reset(pdelay_stats);
+	hist_reset(&c->pdelay_hist);
 }
 
 static void gptp_dump_cmlds_counters(struct gptp_ctx *gptp)
@@ -2122,6 +2405,26 @@ static void gptp_dump_net_counters(struct gptp_ctx *gptp)
 	}
 }
 
+static void gptp_dump_rx_cost(struct gptp_ctx *gptp)
+{
+	struct stats *rx_cost;
+	int msg_type;
+
+	for (msg_type = 0; msg_type < GPTP_RX_COST_MSG_TYPES; msg_type++) {
+		rx_cost = &gptp->rx_cost[msg_type];
+
+		if (!rx_cost->current_count)
+			continue;
+
+		stats_compute(rx_cost);
+
+		os_log(LOG_INFO_RAW, "Rx %-22s processing (ns): min %6d avg %6d max %6d variance %5"PRId64" count %u\n",
+			gptp_msgtype2string(msg_type), rx_cost->min, rx_cost->mean, rx_cost->max, rx_cost->variance, rx_cost->current_count);
+
+		stats_reset(rx_cost);
+	}
+}
+
 const char *gptp_port_role2string(ptp_port_role_t port_role)
 {
 	switch (port_role) {
@@ -2158,6 +2461,8 @@ void gptp_stats_dump(void *data)
 
 	gptp_dump_net_counters(gptp);
 
+	gptp_dump_rx_cost(gptp);
+
 	gptp_dump_cmlds_counters(gptp);
 
 	for (instance_index = 0; instance_index < gptp->domain_max; instance_index++) {
@@ -2166,6 +2471,10 @@ void gptp_stats_dump(void *data)
 		if (!instance->params.instance_enable)
 			continue;
 
+		gptp_instance_lock(instance);
+
+		gptp_dump_instance_sync_latency(instance);
+
 		for (i = 0; i < instance->numberPorts; i++) {
 			port = &instance->ports[i];
 
@@ -2194,6 +2503,8 @@ void gptp_stats_dump(void *data)
 			if ((instance->domain.domain_number == PTP_DOMAIN_0) && (!is_common_p2p(port)))
 				gptp_dump_port_counters(port->c, "Port");
 		}
+
+		gptp_instance_unlock(instance);
 	}
 }
 
@@ -2267,8 +2578,10 @@ void gptp_as_capable_across_domains_down(struct gptp_port_common *port)
 				if (!gptp->instances[i]->params.instance_enable)
 					continue;
 
+				gptp_instance_lock(gptp->instances[i]);
 				gptp_update_as_capable(&gptp->instances[i]->ports[port->port_id]);
 				gptp->instances[i]->ports[port->port_id].stats.num_not_as_capable++;
+				gptp_instance_unlock(gptp->instances[i]);
 			}
 
 			/* pdelay stats and as not capable counters are updated only
@@ -2293,7 +2606,9 @@ void gptp_as_capable_across_domains_up(struct gptp_port_common *port)
 			if (!gptp->instances[i]->params.instance_enable)
 				continue;
 
+			gptp_instance_lock(gptp->instances[i]);
 			gptp_update_as_capable(&gptp->instances[i]->ports[port->port_id]);
+			gptp_instance_unlock(gptp->instances[i]);
 		}
 	}
 }
@@ -2375,8 +2690,11 @@ static void gptp_link_down(struct gptp_net_port *net_port)
 
 	for (i = 0; i < gptp->domain_max; i++) {
 		port = net_port_to_gptp(net_port, i);
-		if (port && port->instance->params.instance_enable)
+		if (port && port->instance->params.instance_enable) {
+			gptp_instance_lock(port->instance);
 			gptp_port_update_fsm(port);
+			gptp_instance_unlock(port->instance);
+		}
 	}
 
 	for (i = 0; i < gptp->cmlds.number_link_ports; i++) {
@@ -2405,8 +2723,11 @@ static void gptp_link_up(struct gptp_net_port *net_port)
 
 	for (i = 0; i < gptp->domain_max; i++) {
 		port = net_port_to_gptp(net_port, i);
-		if (port && port->instance->params.instance_enable)
+		if (port && port->instance->params.instance_enable) {
+			gptp_instance_lock(port->instance);
 			gptp_port_update_fsm(port);
+			gptp_instance_unlock(port->instance);
+		}
 	}
 
 	for (i = 0; i < gptp->cmlds.number_link_ports; i++) {
@@ -2614,6 +2935,9 @@ static int gptp_instance_init(struct gptp_ctx *gptp, int instance_index, struct
 	instance->gptp = gptp;
 
 	instance->index = (u8)instance_index;
+
+	stats_init(&instance->stats.sync_latency, 31, "Sync latency (ns)", NULL);
+	hist_reset(&instance->stats.sync_latency_hist);
 	instance->domain.domain_number = (u8)domain;
 	instance->domain.u.s.major_sdo_id = PTP_DOMAIN_MAJOR_SDOID;
 	instance->domain.u.s.minor_sdo_id = PTP_DOMAIN_MINOR_SDOID;
@@ -2837,10 +3161,11 @@ static void gptp_set_config_parameters(struct gptp_ctx *gptp, struct fgptp_confi
 	gptp->force_2011 = cfg->force_2011;
 }
 
-__init static struct gptp_ctx *gptp_alloc(unsigned int domains, unsigned int ports, unsigned int timer_n)
+__init static struct gptp_ctx *gptp_alloc(unsigned int domains, unsigned int ports, unsigned int timer_n, unsigned int threaded_domains, unsigned int instance_timer_n)
 {
 	struct gptp_ctx *gptp;
 	u8 *instance;
+	u8 *instance_timers;
 	unsigned int gptp_ctx_size;
 	unsigned int instance_size;
 	unsigned int size;
@@ -2848,7 +3173,7 @@ __init static struct gptp_ctx *gptp_alloc(unsigned int domains, unsigned int por
 
 	gptp_ctx_size = sizeof(struct gptp_ctx) + ports * sizeof(struct gptp_net_port);
 	instance_size = sizeof(struct gptp_instance) + ports * sizeof(struct gptp_port);
-	size = gptp_ctx_size + domains * instance_size + timer_pool_size(timer_n);
+	size = gptp_ctx_size + domains * instance_size + timer_pool_size(timer_n) + threaded_domains * timer_pool_size(instance_timer_n);
 
 	gptp = os_malloc(size);
 	if (!gptp)
@@ -2863,6 +3188,18 @@ __init static struct gptp_ctx *gptp_alloc(unsigned int domains, unsigned int por
 
 	gptp->timer_ctx = (struct timer_ctx *)(instance + domains * instance_size);
 
+	/* instances running in their own thread (the last threaded_domains ones) have a dedicated timer pool */
+	instance_timers = (u8 *)gptp->timer_ctx + timer_pool_size(timer_n);
+
+	for (i = 0; i < domains; i++) {
+		if (i < (domains - threaded_domains)) {
+			gptp->instances[i]->timer_ctx = gptp->timer_ctx;
+		} else {
+			gptp->instances[i]->timer_ctx = (struct timer_ctx *)instance_timers;
+			instance_timers += timer_pool_size(instance_timer_n);
+		}
+	}
+
 	gptp->domain_max = domains;
 	gptp->port_max = ports;
 
@@ -2878,13 +3215,25 @@ err:
 * \param priv	platform dependent code private data
 */
 __init void *gptp_init(struct fgptp_config *cfg, unsigned long priv)
+{
+	return gptp_init_domain_threads(cfg, priv, NULL);
+}
+
+/** Initialize the gptp application, with domain instances other than domain 0 possibly running in their own thread
+* \return	pointer to the main gptp context if success, NULL on failure
+* \param cfg	pointer to the config to be applied
+* \param priv	platform dependent code private data
+* \param threads	platform services for the instance threads, NULL if not supported. Only used if cfg->domain_threads is set.
+*/
+__init void *gptp_init_domain_threads(struct fgptp_config *cfg, unsigned long priv, struct gptp_domain_threads *threads)
 {
 	struct gptp_ctx *gptp;
 	struct gptp_net_port *net_port;
 	struct gptp_port *port;
 	u32 local_time;
 	int i, instance_index;
-	unsigned int timer_n;
+	unsigned int timer_n, instance_timer_n;
+	unsigned int threaded_domains = 0;
 	unsigned int ipc_tx, ipc_tx_sync, ipc_rx;
 	unsigned int ipc_tx_mac_service, ipc_rx_mac_service;
 
@@ -2893,13 +3242,24 @@ __init void *gptp_init(struct fgptp_config *cfg, unsigned long priv)
 	if (gptp_check_config(cfg))
 		goto err_config;
 
-	timer_n = CFG_GPTP_MAX_TIMERS_PER_DOMAIN_AND_PORT * cfg->domain_max * cfg->port_max + (CFG_GPTP_MAX_TIMERS_PER_CMLDS_AND_PORT * cfg->port_max);
-	gptp = gptp_alloc(cfg->domain_max, cfg->port_max, timer_n);
+	/* domain 0 (and CMLDS) always run in the main gPTP thread */
+	if (threads && cfg->domain_threads && (cfg->domain_max > 1))
+		threaded_domains = cfg->domain_max - 1;
+
+	instance_timer_n = CFG_GPTP_MAX_TIMERS_PER_DOMAIN_AND_PORT * cfg->port_max;
+	timer_n = CFG_GPTP_MAX_TIMERS_PER_DOMAIN_AND_PORT * (cfg->domain_max - threaded_domains) * cfg->port_max + (CFG_GPTP_MAX_TIMERS_PER_CMLDS_AND_PORT * cfg->port_max);
+	gptp = gptp_alloc(cfg->domain_max, cfg->port_max, timer_n, threaded_domains, instance_timer_n);
 	if (!gptp)
 		goto err_malloc;
 
 	gptp_set_config_parameters(gptp, cfg);
 
+	for (i = 0; i < GPTP_RX_COST_MSG_TYPES; i++)
+		stats_init(&gptp->rx_cost[i], 31, NULL, NULL);
+
+	if (threaded_domains)
+		gptp->threads = threads;
+
 	if (!cfg->is_bridge) {
 		if (cfg->logical_port_list[0] == CFG_ENDPOINT_0_LOGICAL_PORT) {
 			ipc_tx = IPC_GPTP_MEDIA_STACK;
@@ -2933,6 +3293,20 @@ __init void *gptp_init(struct fgptp_config *cfg, unsigned long priv)
 	if (timer_pool_init(gptp->timer_ctx, timer_n, priv) < 0)
 		goto err_timer_pool_init;
 
+	for (i = 0; i < gptp->domain_max; i++) {
+		struct gptp_instance *instance = gptp->instances[i];
+
+		if (instance->timer_ctx == gptp->timer_ctx)
+			continue;
+
+		if (timer_pool_init(instance->timer_ctx, instance_timer_n, threads->priv[i]) < 0)
+			goto err_instance_timer_pool_init;
+
+		instance->threaded = true;
+
+		os_log(LOG_INIT, "domain instance(%u) runs in its own thread\n", i);
+	}
+
 	if (ipc_tx_init(&gptp->ipc_tx, ipc_tx) < 0)
 		goto err_ipc_tx;
 
@@ -3087,6 +3461,12 @@ err_ipc_tx_sync:
 	ipc_tx_exit(&gptp->ipc_tx);
 
 err_ipc_tx:
+err_instance_timer_pool_init:
+	for (i = 0; i < gptp->domain_max; i++) {
+		if (gptp->instances[i]->threaded)
+			timer_pool_exit(gptp->instances[i]->timer_ctx);
+	}
+
 	timer_pool_exit(gptp->timer_ctx);
 
 err_timer_pool_init:
@@ -3137,6 +3517,11 @@ __exit int gptp_exit(void *gptp_ctx)
 
 	ipc_tx_exit(&gptp->ipc_tx_sync);
 
+	for (i = 0; i < gptp->domain_max; i++) {
+		if (gptp->instances[i]->threaded)
+			timer_pool_exit(gptp->instances[i]->timer_ctx);
+	}
+
 	timer_pool_exit(gptp->timer_ctx);
 
 	os_free(gptp);
@@ -60,10 +60,58 @@ struct gptp_net_port_stats {
 	u32 num_hwts_handler;
 };
 
+#define GPTP_RX_COST_MSG_TYPES	16 /* PTP messageType is a 4 bits field */
+
 struct gptp_instance_stats {
 	/* per instance statistics */
 	u32 num_adjust_on_sync;
 	u32 num_synchro_loss;
+	u32 num_event_queue_full;
+	u32 num_bmca_runs;	/* port role selections (updtRolesTree) */
+	u32 num_bmca_incremental_runs;	/* selections which only re-evaluated the ports with reselect set */
+	u32 num_role_changes;
+	u32 num_gm_changes;
+
+	/* time from sync reception by the network layer to the end of its processing by the instance */
+	struct stats sync_latency;
+	struct hist sync_latency_hist;
+};
+
+/**
+ * Grandmaster selection state kept across port role selections (see updt_roles_tree()),
+ * so that only the ports with reselect set need to be compared against the current best vector
+ */
+struct gptp_bmca_cache {
+	bool valid;
+	int best_port;	/* index of the port the gmPriorityVector is derived from, -1 for the systemPriorityVector */
+	struct ptp_priority_vector system_priority;	/* systemPriorityVector the selection was made with */
+	struct ptp_priority_vector gm_path_priority[CFG_GPTP_MAX_NUM_PORT];
+};
+
+typedef enum {
+	GPTP_INSTANCE_EVENT_NET_RX,
+	GPTP_INSTANCE_EVENT_HWTS,
+} gptp_instance_event_type_t;
+
+/**
+ * Event handed over by the main gPTP thread to a domain instance running in its own thread
+ */
+struct gptp_instance_event {
+	gptp_instance_event_type_t type;
+	struct gptp_port *port;
+	struct net_rx_desc *desc;	/* received frame (GPTP_INSTANCE_EVENT_NET_RX), freed by the instance thread */
+	u64 ts;				/* transmit timestamp (GPTP_INSTANCE_EVENT_HWTS) */
+	u64 rx_time;			/* monotonic time at which the event was queued */
+	u8 msg_type;
+};
+
+/**
+ * Single producer (main gPTP thread), single consumer (instance thread) event queue
+ */
+struct gptp_instance_queue {
+	unsigned int read;
+	unsigned int write;
+	struct gptp_instance_event event[CFG_GPTP_INSTANCE_EVENT_QUEUE_SIZE];
 };
 
 struct gptp_instance_port_stats {
@@ -104,6 +152,19 @@ struct gptp_port_stats {
 	u32 num_tx_pdelayrespfup;
 
 	u32 num_md_pdelay_req_sm_reset;
+	u32 num_rate_ratio_outliers;
+};
+
+/**
+ * Neighbor rate ratio estimator: least-squares fit of the responder event timestamps (t3)
+ * against the local pdelay response ingress timestamps (t4), over a sliding window of pdelay exchanges.
+ */
+struct gptp_rate_ratio_estimator {
+	u64 t3[CFG_GPTP_RATE_RATIO_WINDOW_MAX];	/* corrected responder event timestamps, in ns */
+	u64 t4[CFG_GPTP_RATE_RATIO_WINDOW_MAX];	/* pdelay response event ingress timestamps, in ns */
+	unsigned int window;			/* number of samples used for the estimation */
+	unsigned int position;			/* next sample to write */
+	unsigned int count;			/* number of valid samples */
 };
 
 /* Per common port parameters */
@@ -155,10 +216,17 @@ struct gptp_port_common {
 	/* static pdelay feature */
 	struct gptp_pdelay_info pdelay_info;
 
+	struct gptp_rate_ratio_estimator rate_ratio;
+
 	struct gptp_port_stats stats;
 	struct stats pdelay_stats;
+	struct hist pdelay_hist;
 
 	struct ptp_signaling_pdu signaling_rx;
+
+	/* sequence counter protecting the link delay state (mean link delay, neighbor rate ratio,
+	 * asCapableAcrossDomains) read by domain instances running in their own thread. Odd while being updated. */
+	u32 link_seq;
 };
 
 
@@ -274,6 +342,10 @@ struct gptp_port {
 	/* control ratio/pdelay calculation on GM side via signaling messages */
 	unsigned int ratio_last_num_tx_pdelayresp;
 
+	/* consistent copy of the link delay state, used when the instance runs in its own thread */
+	struct ptp_u_scaled_ns link_mean_link_delay;
+	struct ptp_scaled_ns link_delay_asymmetry;
+
 	struct gptp_instance_port_stats stats;
 };
 
@@ -300,7 +372,12 @@ struct gptp_instance {
 	/* contains all per instance user configurable parameters */
 	struct gptp_instance_config cfg;
 
-	struct timer_ctx timer_ctx;
+	/* timer service used by the instance, the main gPTP one or a dedicated one if the instance runs in its own thread */
+	struct timer_ctx *timer_ctx;
+
+	/* set if the instance runs in its own thread (see gptp_init_domain_threads()) */
+	bool threaded;
+	struct gptp_instance_queue queue;
 
 	/* the time-aware system the instance belongs to */
 	struct gptp_ctx *gptp;
@@ -328,6 +405,9 @@ struct gptp_instance {
 	/* per instance global variables */
 	struct ptp_instance_params params;
 
+	/* best master selection cache */
+	struct gptp_bmca_cache bmca;
+
 	/* managed objects without specific storage */
 	u8 numberPorts;	/* 14.2.2 */
 	bool gmCapable; /* 14.2.8 */
@@ -414,6 +494,9 @@ struct gptp_ctx {
 	/* contains all user configurable parameters */
 	struct gptp_global_config cfg;
 
+	/* per message type received packet processing time, in ns (only measured if statistics are enabled) */
+	struct stats rx_cost[GPTP_RX_COST_MSG_TYPES];
+
 	unsigned int domain_max;
 	struct gptp_instance *instances[CFG_MAX_GPTP_DOMAINS];
 
@@ -438,6 +521,9 @@ struct gptp_ctx {
 
 	struct timer stats_timer;
 
+	/* platform services for domain instances running in their own thread, NULL if all instances run in the main gPTP thread */
+	struct gptp_domain_threads *threads;
+
 	void (*sync_indication)(struct gptp_sync_info *info);
 	void (*gm_indication)(struct gptp_gm_info *info);
 	void (*pdelay_indication)(struct gptp_pdelay_info *info);
@@ -492,6 +578,37 @@ bool get_port_asymmetry(struct gptp_port *port);
 struct gptp_net_port *net_port_from_gptp(struct gptp_port *port);
 struct gptp_net_port *net_port_from_gptp_common(struct gptp_port_common *port_common);
 
+/** Marks the beginning of an update of the link delay state of a common port.
+ * Only called from the main gPTP thread (domain 0 or CMLDS processing).
+ */
+static inline void gptp_link_write_begin(struct gptp_port_common *c)
+{
+	__atomic_store_n(&c->link_seq, c->link_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void gptp_link_write_end(struct gptp_port_common *c)
+{
+	__atomic_store_n(&c->link_seq, c->link_seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline u32 gptp_link_read_begin(struct gptp_port_common *c)
+{
+	return __atomic_load_n(&c->link_seq, __ATOMIC_ACQUIRE);
+}
+
+/** Checks if a read of the link delay state must be retried.
+ * \return	true if an update happened during the read, false otherwise
+ * \param c	common port being read
+ * \param seq	value returned by gptp_link_read_begin()
+ */
+static inline bool gptp_link_read_retry(struct gptp_port_common *c, u32 seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return (seq & 1) || (seq != __atomic_load_n(&c->link_seq, __ATOMIC_RELAXED));
+}
+
 
 
 #endif /* _GPTP_H_ */
@@ -56,7 +56,25 @@ struct gptp_gm_info {
 	u8 domain;
 };
 
+/**
+ * Platform services used to run domain instances in their own thread.
+ * Domain 0 and CMLDS always run in the main gPTP thread. Frames and transmit timestamps for the other
+ * domains are handed over to the instance thread, which is woken up with notify() and then calls
+ * gptp_instance_process(). The instance thread must hold the instance lock while processing events
+ * and timers of the instance, the main gPTP thread takes it before accessing the instance state.
+ */
+struct gptp_domain_threads {
+	unsigned long priv[CFG_MAX_GPTP_DOMAINS];	/* platform dependent data for the timer service of each instance thread */
+
+	void (*lock)(struct gptp_domain_threads *threads, unsigned int instance_index);
+	void (*unlock)(struct gptp_domain_threads *threads, unsigned int instance_index);
+	void (*notify)(struct gptp_domain_threads *threads, unsigned int instance_index);
+};
+
 void *gptp_init(struct fgptp_config *cfg, unsigned long priv);
+void *gptp_init_domain_threads(struct fgptp_config *cfg, unsigned long priv, struct gptp_domain_threads *threads);
+bool gptp_instance_is_threaded(void *gptp_ctx, unsigned int instance_index);
+void gptp_instance_process(void *gptp_ctx, unsigned int instance_index);
 int gptp_exit(void *gptp_ctx);
 void gptp_stats_dump(void *gptp_ctx);
 
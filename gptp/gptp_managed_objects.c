@@ -149,15 +149,31 @@ static void ptp_port_common_handler(void *data, struct leaf *l, enum node_operat
 	uintptr_t object_base;
 	unsigned int object_size;
 
+	/* Common port only exists on domain 0 ports */
+	if (!port->c)
+		return;
+
+	object_base = (uintptr_t)port->c + (uintptr_t)l->val;
+	object_size = leaf_object_size[l->type];
+
 	switch (operation) {
 	case NODE_GET:
-		object_base = (uintptr_t)port->c + (uintptr_t)l->val;
-		object_size = leaf_object_size[l->type];
+		if (l->type == LEAF_BOOL)
+			buf[0] = *((bool *)object_base);
+		else
+			os_memcpy(buf, (void *)object_base, object_size);
+		break;
+
+	case NODE_SET:
+		/* Threaded domain instances read the link state (e.g. delay asymmetry) under the common port sequence counter */
+		gptp_link_write_begin(port->c);
 
 		if (l->type == LEAF_BOOL)
-			buf[0] = *((bool *)(object_base + l->val));
+			*((bool *)object_base) = buf[0];
 		else
-			os_memcpy(buf, (object_base + l->val), object_size);
+			os_memcpy((void *)object_base, buf, object_size);
+
+		gptp_link_write_end(port->c);
 		break;
 
 	default:
@@ -1 +1,7 @@
 genavb_target_add_srcs(TARGET ${tsn} SRCS main.c)
+
+option(BUILD_GPTP_REPLAY "Build the gPTP offline replay tool" OFF)
+
+if(BUILD_GPTP_REPLAY OR BUILD_TESTS)
+  include(${CMAKE_CURRENT_LIST_DIR}/../test/test.cmake)
+endif()
@@ -20,12 +20,14 @@
 #include <errno.h>
 #include <pthread.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "common/types.h"
 
 #include "linux/tsn.h"
 #include "linux/cfgfile.h"
 #include "linux/log.h"
+#include "linux/epoll.h"
 
 #include "common/net.h"
 #include "common/timer.h"
@@ -44,9 +46,22 @@
 #define NVRAM_PDELAY_DATA_PER_ENTRY	2
 static ptp_double pdelay_array[CFG_GPTP_MAX_NUM_PORT];
 
+struct gptp_domain_thread {
+	struct gptp_linux_ctx *gptp_linux;
+	unsigned int instance_index;
+	pthread_t thread;
+	pthread_mutex_t lock;						/* held while the instance state is accessed */
+	int epoll_fd;							/* instance timers and events */
+	int event_fd;							/* wakes up the thread when events are handed over */
+	struct linux_epoll_data event_data;
+	bool started;
+};
+
 struct gptp_linux_ctx {
 	struct gptp_ctx *gptp;
 	char nvram_file[256];						/* path to the vram file */
+	struct gptp_domain_threads threads;
+	struct gptp_domain_thread thread[CFG_MAX_GPTP_DOMAINS];
 };
 
 /*******************************************************************************
@@ -231,13 +246,217 @@ static void pdelay_indication_handler(struct gptp_pdelay_info *info)
 }
 
 
+static void gptp_domain_thread_lock(struct gptp_domain_threads *threads, unsigned int instance_index)
+{
+	struct gptp_linux_ctx *gptp_linux = container_of(threads, struct gptp_linux_ctx, threads);
+
+	pthread_mutex_lock(&gptp_linux->thread[instance_index].lock);
+}
+
+static void gptp_domain_thread_unlock(struct gptp_domain_threads *threads, unsigned int instance_index)
+{
+	struct gptp_linux_ctx *gptp_linux = container_of(threads, struct gptp_linux_ctx, threads);
+
+	pthread_mutex_unlock(&gptp_linux->thread[instance_index].lock);
+}
+
+static void gptp_domain_thread_notify(struct gptp_domain_threads *threads, unsigned int instance_index)
+{
+	struct gptp_linux_ctx *gptp_linux = container_of(threads, struct gptp_linux_ctx, threads);
+	uint64_t val = 1;
+
+	if (write(gptp_linux->thread[instance_index].event_fd, &val, sizeof(val)) < 0)
+		os_log(LOG_ERR, "domain instance(%u) write(): %s\n", instance_index, strerror(errno));
+}
+
+static void *gptp_domain_thread_main(void *arg)
+{
+	struct gptp_domain_thread *thread = arg;
+	struct epoll_event event[EPOLL_MAX_EVENTS];
+	struct linux_epoll_data *epoll_data;
+	uint64_t val;
+	int ready, i;
+
+	while (1) {
+		ready = epoll_wait(thread->epoll_fd, event, EPOLL_MAX_EVENTS, -1);
+		if (ready < 0) {
+			if (errno == EINTR)
+				continue;
+
+			os_log(LOG_ERR, "domain instance(%u) epoll_wait(): %s\n", thread->instance_index, strerror(errno));
+			break;
+		}
+
+		/* the lock must not be held if the thread is cancelled */
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+		pthread_mutex_lock(&thread->lock);
+
+		for (i = 0; i < ready; i++) {
+			if (!(event[i].events & (EPOLLIN | EPOLLERR)))
+				continue;
+
+			epoll_data = (struct linux_epoll_data *)event[i].data.ptr;
+
+			switch (epoll_data->type) {
+			case EPOLL_TYPE_TIMER:
+				os_timer_process((struct os_timer *)epoll_data->ptr);
+				break;
+
+			case EPOLL_TYPE_EVENT:
+				if (read(thread->event_fd, &val, sizeof(val)) < 0)
+					break;
+
+				gptp_instance_process(thread->gptp_linux->gptp, thread->instance_index);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		pthread_mutex_unlock(&thread->lock);
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	}
+
+	return (void *)0;
+}
+
+static int gptp_domain_threads_init(struct gptp_linux_ctx *gptp_linux)
+{
+	struct gptp_domain_thread *thread;
+	int i;
+
+	gptp_linux->threads.lock = gptp_domain_thread_lock;
+	gptp_linux->threads.unlock = gptp_domain_thread_unlock;
+	gptp_linux->threads.notify = gptp_domain_thread_notify;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		thread = &gptp_linux->thread[i];
+
+		thread->gptp_linux = gptp_linux;
+		thread->instance_index = i;
+
+		pthread_mutex_init(&thread->lock, NULL);
+
+		thread->epoll_fd = epoll_create(1);
+		if (thread->epoll_fd < 0) {
+			os_log(LOG_CRIT, "epoll_create(): %s\n", strerror(errno));
+			goto err_epoll_create;
+		}
+
+		thread->event_fd = eventfd(0, EFD_NONBLOCK);
+		if (thread->event_fd < 0) {
+			os_log(LOG_CRIT, "eventfd(): %s\n", strerror(errno));
+			goto err_eventfd;
+		}
+
+		if (epoll_ctl_add(thread->epoll_fd, thread->event_fd, EPOLL_TYPE_EVENT, thread, &thread->event_data, EPOLLIN) < 0)
+			goto err_epoll_ctl;
+
+		gptp_linux->threads.priv[i] = thread->epoll_fd;
+
+		continue;
+
+	err_epoll_ctl:
+		close(thread->event_fd);
+
+	err_eventfd:
+		close(thread->epoll_fd);
+
+	err_epoll_create:
+		pthread_mutex_destroy(&thread->lock);
+		goto err;
+	}
+
+	return 0;
+
+err:
+	for (i--; i >= 0; i--) {
+		thread = &gptp_linux->thread[i];
+
+		close(thread->event_fd);
+		close(thread->epoll_fd);
+		pthread_mutex_destroy(&thread->lock);
+	}
+
+	return -1;
+}
+
+static void gptp_domain_threads_exit(struct gptp_linux_ctx *gptp_linux)
+{
+	struct gptp_domain_thread *thread;
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		thread = &gptp_linux->thread[i];
+
+		close(thread->event_fd);
+		close(thread->epoll_fd);
+		pthread_mutex_destroy(&thread->lock);
+	}
+}
+
+static void gptp_domain_threads_start(struct gptp_linux_ctx *gptp_linux)
+{
+	struct gptp_domain_thread *thread;
+	struct sched_param param = {
+		.sched_priority = GPTP_CFG_PRIORITY,
+	};
+	pthread_attr_t attr;
+	int i, rc;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	pthread_attr_setschedparam(&attr, &param);
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		thread = &gptp_linux->thread[i];
+
+		if (!gptp_instance_is_threaded(gptp_linux->gptp, i))
+			continue;
+
+		rc = pthread_create(&thread->thread, &attr, gptp_domain_thread_main, thread);
+		if (rc) {
+			os_log(LOG_ERR, "domain instance(%u) pthread_create(), %s\n", i, strerror(rc));
+			continue;
+		}
+
+		thread->started = true;
+	}
+
+	pthread_attr_destroy(&attr);
+}
+
+static void gptp_domain_threads_stop(struct gptp_linux_ctx *gptp_linux)
+{
+	struct gptp_domain_thread *thread;
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		thread = &gptp_linux->thread[i];
+
+		if (!thread->started)
+			continue;
+
+		pthread_cancel(thread->thread);
+		pthread_join(thread->thread, NULL);
+
+		thread->started = false;
+	}
+}
+
 static void gptp_thread_cleanup(void *arg)
 {
 	struct gptp_linux_ctx *gptp_linux = arg;
 	struct gptp_ctx *gptp = gptp_linux->gptp;
 
+	gptp_domain_threads_stop(gptp_linux);
+
 	gptp_exit(gptp);
 
+	gptp_domain_threads_exit(gptp_linux);
+
 	nvram_update(gptp_linux);
 
 	os_log(LOG_INIT, "done\n");
@@ -291,15 +510,20 @@ void *gptp_thread_main(void *arg)
 	cfg->gm_indication = gm_indication_handler;
 	cfg->pdelay_indication = pdelay_indication_handler;
 
+	if (gptp_domain_threads_init(&gptp_linux) < 0)
+		goto err_domain_threads_init;
+
 	/*
 	* Intialize gptp stack and apply configuration
 	*/
-	gptp = gptp_init(cfg, epoll_fd);
+	gptp = gptp_init_domain_threads(cfg, epoll_fd, &gptp_linux.threads);
 	if (!gptp)
 		goto err_gptp_init;
 
 	gptp_linux.gptp = gptp;
 
+	gptp_domain_threads_start(&gptp_linux);
+
 	pthread_cleanup_push(gptp_thread_cleanup, &gptp_linux);
 
 	os_log(LOG_INIT, "started\n");
@@ -362,6 +586,9 @@ void *gptp_thread_main(void *arg)
 	return (void *)0;
 
 err_gptp_init:
+	gptp_domain_threads_exit(&gptp_linux);
+
+err_domain_threads_init:
 	close(epoll_fd);
 
 err_epoll_create:
@@ -148,7 +148,9 @@ static void get_static_rate_ratio(struct gptp_port_common *port)
 {
 	struct ptp_port_params *params = &port->params;
 
+	gptp_link_write_begin(port);
 	params->neighbor_rate_ratio = 1.00;
+	gptp_link_write_end(port);
 }
 
 
@@ -156,7 +158,9 @@ static void get_static_pdelay(struct gptp_port_common *port)
 {
 	struct ptp_port_params *params = &port->params;
 
+	gptp_link_write_begin(port);
 	ptp_double_to_u_scaled_ns(&params->mean_link_delay, port->cfg.initial_neighborPropDelay);
+	gptp_link_write_end(port);
 	os_log(LOG_DEBUG, "Port(%u) static PDelay %4.2f ns\n", port->port_id, port->cfg.initial_neighborPropDelay);
 }
 
@@ -625,7 +629,141 @@ static bool md_pdelay_req_is_resp_fup_valid(struct ptp_md_entity_pdelay_req_sm *
 * MDPdelayReqSM state machine and functions
 */
 
+static void md_rate_ratio_reset(struct gptp_rate_ratio_estimator *est)
+{
+	est->position = 0;
+	est->count = 0;
+}
+
+static void md_rate_ratio_add(struct gptp_rate_ratio_estimator *est, u64 t3, u64 t4)
+{
+	est->t3[est->position] = t3;
+	est->t4[est->position] = t4;
+
+	est->position = (est->position + 1) % est->window;
+
+	if (est->count < est->window)
+		est->count++;
+}
+
+/** Least-squares fit of (t3 - t4) against t4, over the samples of the window not rejected.
+ * Timestamps are taken relative to the oldest sample, and the fit is done on the t3 - t4 difference
+ * (a few ppm of the elapsed time) to keep full double precision on the slope.
+ * \return		0 on success, -1 if less than two samples are usable
+ * \param est		pointer to the estimator
+ * \param rejected	per sample (oldest first) rejection flags, may be NULL
+ * \param slope	computed slope (rate ratio - 1)
+ * \param offset	computed offset, in ns
+ */
+static int md_rate_ratio_fit(struct gptp_rate_ratio_estimator *est, const bool *rejected, ptp_double *slope, ptp_double *offset)
+{
+	unsigned int oldest = (est->position + est->window - est->count) % est->window;
+	unsigned int i, j, n = 0;
+	ptp_double x, y, mx, my, sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+	for (i = 0; i < est->count; i++) {
+		if (rejected && rejected[i])
+			continue;
+
+		j = (oldest + i) % est->window;
+		x = (ptp_double)(est->t4[j] - est->t4[oldest]);
+		y = (ptp_double)(s64)((est->t3[j] - est->t3[oldest]) - (est->t4[j] - est->t4[oldest]));
+
+		sx += x;
+		sy += y;
+		n++;
+	}
+
+	if (n < 2)
+		return -1;
+
+	mx = sx / n;
+	my = sy / n;
+
+	for (i = 0; i < est->count; i++) {
+		if (rejected && rejected[i])
+			continue;
+
+		j = (oldest + i) % est->window;
+		x = (ptp_double)(est->t4[j] - est->t4[oldest]) - mx;
+		y = (ptp_double)(s64)((est->t3[j] - est->t3[oldest]) - (est->t4[j] - est->t4[oldest])) - my;
+
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	if (sxx <= 0)
+		return -1;
+
+	*slope = sxy / sxx;
+	*offset = my - *slope * mx;
+
+	return 0;
+}
+
+/** Estimates the neighbor rate ratio over the estimator window, rejecting outliers based on
+ * the median absolute deviation of the residuals of a first fit.
+ * \return		0 on success, -1 if no estimation could be done
+ * \param port		pointer to the common port
+ * \param rate_ratio	estimated rate ratio
+ */
+static int md_rate_ratio_estimate(struct gptp_port_common *port, ptp_double *rate_ratio)
+{
+	struct gptp_rate_ratio_estimator *est = &port->rate_ratio;
+	unsigned int oldest = (est->position + est->window - est->count) % est->window;
+	ptp_double residual[CFG_GPTP_RATE_RATIO_WINDOW_MAX], sorted[CFG_GPTP_RATE_RATIO_WINDOW_MAX];
+	bool rejected[CFG_GPTP_RATE_RATIO_WINDOW_MAX];
+	ptp_double slope, offset, x, y, tmp, threshold;
+	unsigned int i, j, k, n_rejected = 0;
+
+	if (md_rate_ratio_fit(est, NULL, &slope, &offset) < 0)
+		return -1;
+
+	if (est->count < RATE_RATIO_OUTLIER_MIN_SAMPLES)
+		goto out;
+
+	for (i = 0; i < est->count; i++) {
+		j = (oldest + i) % est->window;
+		x = (ptp_double)(est->t4[j] - est->t4[oldest]);
+		y = (ptp_double)(s64)((est->t3[j] - est->t3[oldest]) - (est->t4[j] - est->t4[oldest]));
+
+		residual[i] = os_fabs(y - (slope * x + offset));
+
+		/* insertion sort, to get the median */
+		for (k = i; (k > 0) && (sorted[k - 1] > residual[i]); k--)
+			sorted[k] = sorted[k - 1];
+
+		sorted[k] = residual[i];
+	}
+
+	threshold = RATE_RATIO_OUTLIER_MAD_FACTOR * sorted[est->count / 2] / 0.6745;
+	if (threshold < RATE_RATIO_OUTLIER_MIN_NS)
+		threshold = RATE_RATIO_OUTLIER_MIN_NS;
+
+	for (i = 0; i < est->count; i++) {
+		rejected[i] = (residual[i] > threshold);
+		if (rejected[i])
+			n_rejected++;
+	}
+
+	if (n_rejected) {
+		/* only account for the latest sample, each sample is checked once on arrival */
+		if (rejected[est->count - 1])
+			port->stats.num_rate_ratio_outliers++;
+
+		if (md_rate_ratio_fit(est, rejected, &tmp, &offset) == 0)
+			slope = tmp;
+	}
+
+out:
+	*rate_ratio = 1.0 + slope;
+
+	return 0;
+}
+
 /** Computes the rate ratio between this node and the remote end of the link (IEEE 802.1AS-2020 section 11.2.19.3.3)
+ * The ratio is a least-squares estimation over the last port->rate_ratio.window pdelay exchanges (the
+ * standard two-point computation if the window is 2).
  */
 
 #define MAX_RATE_RATIO_DEVIATION	0.01
@@ -636,6 +774,7 @@ static int md_pdelay_req_compute_pdelay_rate_ratio(struct gptp_port_common *port
 	struct gptp_ctx *gptp = port->gptp;
 	u64 corrected_responder_event_timestamp, pdelay_response_event_ingress_timestamp;
 	int phase_discont = 0;
+	bool restart = true;
 
 	os_log(LOG_DEBUG, "Port(%u)\n", port->port_id);
 
@@ -664,11 +803,15 @@ static int md_pdelay_req_compute_pdelay_rate_ratio(struct gptp_port_common *port
 		if ((pdelay_response_event_ingress_timestamp > sm->prev_pdelay_response_event_ingress_timestamp)
 		&& (corrected_responder_event_timestamp > sm->prev_corrected_responder_event_timestamp)) {
 
+			md_rate_ratio_add(&port->rate_ratio, corrected_responder_event_timestamp, pdelay_response_event_ingress_timestamp);
+			restart = false;
+
 			/*
-			 * r = (t3 - t3') / (t4 - t4')
+			 * r = (t3 - t3') / (t4 - t4'), least-squares over the window
 			 */
-			*rate_ratio = ((ptp_double)corrected_responder_event_timestamp - sm->prev_corrected_responder_event_timestamp)
-					/ (pdelay_response_event_ingress_timestamp - sm->prev_pdelay_response_event_ingress_timestamp);
+			if (md_rate_ratio_estimate(port, rate_ratio) < 0)
+				*rate_ratio = ((ptp_double)corrected_responder_event_timestamp - sm->prev_corrected_responder_event_timestamp)
+						/ (pdelay_response_event_ingress_timestamp - sm->prev_pdelay_response_event_ingress_timestamp);
 
 			if (os_fabs(1 - *rate_ratio) > MAX_RATE_RATIO_DEVIATION) {
 				os_log(LOG_ERR, "Port(%u): NeighborRateRatio %1.16f ignored\n", port->port_id, *rate_ratio);
@@ -687,6 +830,13 @@ static int md_pdelay_req_compute_pdelay_rate_ratio(struct gptp_port_common *port
 	os_log(LOG_DEBUG, "Port(%u): NeighborRateRatio %1.16f (%f ppb)\n", port->port_id, *rate_ratio, (*rate_ratio - 1)*1000000000);
 
 exit:
+	/* Start a new estimation window from the current timings (first exchange, phase discontinuity
+	 * or non monotonic timestamps) */
+	if (restart) {
+		md_rate_ratio_reset(&port->rate_ratio);
+		md_rate_ratio_add(&port->rate_ratio, corrected_responder_event_timestamp, pdelay_response_event_ingress_timestamp);
+	}
+
 	/*
 	 * Save timings.
 	 * t3' = sm->prev_pdelay_response_event_ingress_timestamp
@@ -736,6 +886,7 @@ static void md_pdelay_req_compute_prop_time(struct gptp_port_common *port, ptp_d
 		raw_delay = (r*(t4 - t1) - (t3 - t2)) / 2;
 
 		stats_update(&port->pdelay_stats, (s32)raw_delay);
+		hist_update(&port->pdelay_hist, (s32)raw_delay);
 
 		/* AVnu test gPTP.com 15.6.g
 		 * (t4 - t1) < (t3 - t2)
@@ -759,7 +910,7 @@ static void md_pdelay_req_compute_prop_time(struct gptp_port_common *port, ptp_d
 			}
 		}
 
-		delay = filter(&sm->pdelay_filter, raw_delay);
+		delay = (ptp_double)filter_q(&sm->pdelay_filter, (s64)(raw_delay * FILTER_Q_ONE)) / FILTER_Q_ONE;
 		ptp_double_to_u_scaled_ns(d, delay);
 		os_log(LOG_DEBUG, "Port(%u): PDelay %4.2f ns (%4.2f ns)\n", port->port_id, delay, raw_delay);
 
@@ -847,7 +998,9 @@ static void md_pdelay_req_sm_initial_send(struct gptp_port_common *port)
 
 	sm->rcvdPdelayResp = false;
 	sm->rcvdPdelayRespFollowUp = false;
+	gptp_link_write_begin(port);
 	params->neighbor_rate_ratio = 1.0;
+	gptp_link_write_end(port);
 	sm->rcvdMDTimestampReceive = false;
 	sm->lostResponses = 0;
 	sm->detectedFaults = 0;
@@ -857,7 +1010,7 @@ static void md_pdelay_req_sm_initial_send(struct gptp_port_common *port)
 	/* Non standard */
 	sm->prev_corrected_responder_event_timestamp = PTP_TS_UNSET_U64_VALUE;
 	sm->neighborRateRatioValid = false;
-	filter_exp_decay_init(&sm->pdelay_filter, PDELAY_EXP_FILTER_DECAY);
+	filter_q_exp_decay_init(&sm->pdelay_filter, PDELAY_EXP_FILTER_DECAY);
 
 	sm->pdelayReqSequenceId = sequence_id_random();
 	sm->txPdelayReqPtr = md_set_pdelay_req(port);
@@ -923,6 +1076,9 @@ static void md_pdelay_req_sm_waiting_interval(struct gptp_port_common*port)
 	sm->lostResponses = 0;
 	sm->multipleResponses = 0;
 
+	/* link delay state is read by domain instances possibly running in their own thread */
+	gptp_link_write_begin(port);
+
 	if (params->compute_neighbor_rate_ratio) {
 		/*
 		 * Skip propagation delay computation without having neighborRateRatioValid being false.
@@ -942,6 +1098,8 @@ static void md_pdelay_req_sm_waiting_interval(struct gptp_port_common*port)
 	if (params->compute_mean_link_delay && (!phase_discont))
 		md_pdelay_req_compute_prop_time(port, params->neighbor_rate_ratio, &params->mean_link_delay);
 
+	gptp_link_write_end(port);
+
 	globals->isMeasuringDelay = true;
 	os_memcpy(&cid_src, &sm->rcvdPdelayRespPtr->header.source_port_id.clock_identity, sizeof(struct ptp_clock_identity));
 	os_memcpy(&cid_req, &port->identity.clock_identity, sizeof(struct ptp_clock_identity));
@@ -955,7 +1113,7 @@ static void md_pdelay_req_sm_waiting_interval(struct gptp_port_common*port)
 		sm->detectedFaults = 0;
 
 	} else if (cid_src != cid_req) {
-		filter_reset(&sm->pdelay_filter);
+		filter_q_reset(&sm->pdelay_filter);
 		gptp_as_capable_across_domains_down(port);
 		globals->isMeasuringDelay = false;
 		sm->detectedFaults = 0;
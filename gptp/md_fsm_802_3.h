@@ -19,9 +19,15 @@
 #include "config.h"
 #include "gptp.h"
 
-#define PDELAY_EXP_FILTER_DECAY (1.0 / (1 << 6))
+#define PDELAY_EXP_FILTER_DECAY (FILTER_Q_ONE >> 6)	/* Q16 */
 #define PDELAY_MEAN_FILTER_WINDOW 128
 
+/* neighbor rate ratio estimation outliers rejection: samples whose residual exceeds
+ * max(RATE_RATIO_OUTLIER_MAD_FACTOR * MAD / 0.6745, RATE_RATIO_OUTLIER_MIN_NS) are ignored */
+#define RATE_RATIO_OUTLIER_MAD_FACTOR	4.0
+#define RATE_RATIO_OUTLIER_MIN_NS	20.0
+#define RATE_RATIO_OUTLIER_MIN_SAMPLES	4
+
 #define PICS_AVNU_PTP_5_MULT_RESPONSES_MAX	3
 #define PICS_AVNU_PTP_5_PDELAY_REQ_DELAY_MS	(300 * MS_PER_S)
 
@@ -73,6 +73,8 @@ const struct fgptp_config gptp_default_config = {
 
 	.statsInterval = CFG_GPTP_STATS_INTERVAL_DEFAULT,
 
+	.neighborRateRatioWindow = CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT,
+
 	.neighborPropDelay_mode = CFG_GPTP_PDELAY_MODE_STANDARD,
 
 	.initial_neighborPropDelay = {
@@ -190,6 +192,8 @@ __init static void process_section_general(struct fgptp_config *cfg, int instanc
 	cfg->rsync_interval = check_bounds_unsigned_int(cfg->rsync_interval, CFG_GPTP_RSYNC_INTERVAL_MIN_DEFAULT, CFG_GPTP_RSYNC_INTERVAL_MAX_DEFAULT);
 
 	cfg->statsInterval = check_bounds_unsigned_int(cfg->statsInterval, CFG_GPTP_STATS_INTERVAL_MIN_DEFAULT, CFG_GPTP_STATS_INTERVAL_MAX_DEFAULT);
+
+	cfg->neighborRateRatioWindow = check_bounds_unsigned_int(cfg->neighborRateRatioWindow, CFG_GPTP_RATE_RATIO_WINDOW_MIN, CFG_GPTP_RATE_RATIO_WINDOW_MAX);
 }
 
 
@@ -65,6 +65,8 @@ static void updt_role_disabled_tree(struct gptp_instance *instance)
 	os_memcpy(&instance->params.path_trace[0], &instance->params.this_clock.identity[0], sizeof(struct ptp_clock_identity));
 	instance->params.num_ptlv = 1;
 
+	instance->bmca.valid = false;
+
 	gptp_ipc_gm_status(instance, &instance->gptp->ipc_tx, IPC_DST_ALL);
 }
 
@@ -91,33 +93,143 @@ static void set_selected_tree(struct gptp_instance *instance)
 	}
 }
 
+/* gmPathPriorityVector of a port (see 10.3.5), only meaningful if the port has a
+ * portPriorityVector and no announce/sync receipt timeout occured (infoIs == Received)
+ */
+static void gm_path_priority_update(struct gptp_instance *instance, int i)
+{
+	struct gptp_port *port = &instance->ports[i];
+	struct ptp_priority_vector *gm_path_priority = &instance->bmca.gm_path_priority[i];
+
+	os_memcpy(gm_path_priority, &port->params.port_priority, sizeof(struct ptp_priority_vector));
+	gm_path_priority->u.s.steps_removed = htons(ntohs(gm_path_priority->u.s.steps_removed) + 1);
+	gm_path_priority->u.s.port_number = htons(get_port_identity_number(port));
+	os_log(LOG_DEBUG, "(a) port %d - steps %d port_number %d info_is %d\n", i, ntohs(gm_path_priority->u.s.steps_removed), ntohs(gm_path_priority->u.s.port_number), port->params.info_is);
+}
+
+/* Returns true if the gmPathPriorityVector of the port can be selected as gmPriorityVector */
+static bool gm_path_priority_eligible(struct gptp_instance *instance, int i)
+{
+	if (instance->ports[i].params.info_is != SPANNING_TREE_RECEIVED)
+		return false;
+
+	/* clockIdentity of the master port not equal to thisClock */
+	return os_memcmp(&instance->bmca.gm_path_priority[i].u.s.root_system_identity.u.s.clock_identity, &instance->params.this_clock, sizeof(struct ptp_clock_identity)) != 0;
+}
+
+/* Full gmPriorityVector selection, returns the index of the best port or -1 for the systemPriorityVector.
+ * Ports are scanned in order, and a port only replaces the current best if strictly better, so on equal
+ * system identities the systemPriorityVector, then the lowest port index, wins.
+ */
+static int gm_priority_select_full(struct gptp_instance *instance)
+{
+	struct ptp_priority_vector *best_vector = &instance->params.system_priority;
+	int best_port = -1;
+	int i;
+
+	for (i = 0; i < instance->numberPorts; i++) {
+		if (!gm_path_priority_eligible(instance, i))
+			continue;
+
+		dump_priority_vector(&instance->bmca.gm_path_priority[i], instance->index, instance->domain.domain_number, "(b) gm path priority vector", LOG_DEBUG);
+
+		if (compare_system_identity(best_vector, &instance->bmca.gm_path_priority[i]) == BMCA_VECTOR_B_BETTER) {
+			best_vector = &instance->bmca.gm_path_priority[i];
+			best_port = i;
+			os_log(LOG_DEBUG, "(b) port %d - gm priority is better\n", best_port);
+		}
+	}
+
+	return best_port;
+}
+
+/* Incremental gmPriorityVector selection, only comparing the ports with reselect set against the previous
+ * best vector. Every port which did not change was already not better than the previous best, so the result
+ * is the same as gm_priority_select_full() as long as neither the previous best port nor the
+ * systemPriorityVector changed. Returns false if a full selection is required.
+ */
+static bool gm_priority_select_incremental(struct gptp_instance *instance, u16 reselect, int *best_port)
+{
+	struct gptp_bmca_cache *bmca = &instance->bmca;
+	struct ptp_priority_vector *best_vector;
+	bmca_vector_cmp_t cmp;
+	int best = bmca->best_port;
+	int i;
+
+	if (!bmca->valid)
+		return false;
+
+	if (os_memcmp(&bmca->system_priority, &instance->params.system_priority, sizeof(struct ptp_priority_vector)))
+		return false;
+
+	if (best >= 0) {
+		if (reselect & (1 << get_port_identity_number(&instance->ports[best])))
+			return false;
+
+		if (!gm_path_priority_eligible(instance, best))
+			return false;
+
+		best_vector = &bmca->gm_path_priority[best];
+	} else {
+		best_vector = &instance->params.system_priority;
+	}
+
+	for (i = 0; i < instance->numberPorts; i++) {
+		if (!(reselect & (1 << get_port_identity_number(&instance->ports[i]))))
+			continue;
+
+		if (!gm_path_priority_eligible(instance, i))
+			continue;
+
+		dump_priority_vector(&bmca->gm_path_priority[i], instance->index, instance->domain.domain_number, "(b) gm path priority vector", LOG_DEBUG);
+
+		cmp = compare_system_identity(best_vector, &bmca->gm_path_priority[i]);
+
+		/* same tie break as the full selection */
+		if ((cmp == BMCA_VECTOR_B_BETTER) || ((cmp == BMCA_VECTOR_A_B_SAME) && (best >= 0) && (i < best))) {
+			best_vector = &bmca->gm_path_priority[i];
+			best = i;
+			os_log(LOG_DEBUG, "(b) port %d - gm priority is better\n", best);
+		}
+	}
+
+	*best_port = best;
+
+	return true;
+}
+
 /* updtRolesTree - 10.3.12.1.4
  *
+ * \param reselect	reselect array (see 10.3.8.1) as it was before clearReselectTree
  */
-static void updt_roles_tree(struct gptp_instance *instance)
+static void updt_roles_tree(struct gptp_instance *instance, u16 reselect)
 {
 	int i, j;
 	int best_vector_port = 0;
 	struct ptp_priority_vector *best_vector;
 	struct gptp_port *port;
 	ptp_port_role_t previous_port_role;
-	struct ptp_priority_vector gm_path_priority[CFG_GPTP_MAX_NUM_PORT] = {0};
 	bool prev_is_grandmaster;
+#ifdef CFG_GPTP_BMCA_CHECK
+	int full_best_vector_port;
+#endif
+
+	instance->stats.num_bmca_runs++;
 
 	/*
 	a) Computes the gmPathPriorityVector for each port that has a portPriorityVector and for which neither
 	announce receipt timeout nor, if gmPresent is TRUE, sync receipt timeout have occurred,
 	*/
+	/* The portPriorityVector only changes along with the port reselect variable, so the vectors of the
+	other ports are still valid from the previous selection. */
 	for (i = 0; i < instance->numberPorts; i++) {
 		port = &instance->ports[i];
 		/* not aged means no announce nor sync receipt timeout occured */
-		if (port->params.info_is == SPANNING_TREE_RECEIVED){
-			/* (see 10.3.5) */
-			os_memcpy(&gm_path_priority[i], &port->params.port_priority, sizeof(struct ptp_priority_vector));
-			gm_path_priority[i].u.s.steps_removed = htons(ntohs(gm_path_priority[i].u.s.steps_removed) + 1);
-			gm_path_priority[i].u.s.port_number = htons(get_port_identity_number(port));
-			os_log(LOG_DEBUG, "(a) port %d - steps %d port_number %d info_is %d\n", i, ntohs(gm_path_priority[i].u.s.steps_removed), ntohs(gm_path_priority[i].u.s.port_number), port->params.info_is);
-		}
+		if (port->params.info_is != SPANNING_TREE_RECEIVED)
+			continue;
+
+		if (!instance->bmca.valid || (reselect & (1 << get_port_identity_number(port))))
+			gm_path_priority_update(instance, i);
 	}
 
 	/*
@@ -127,21 +239,29 @@ static void updt_roles_tree(struct gptp_instance *instance)
 	which the clockIdentity of the master port is not equal to thisClock (see 10.2.3.22),
 	*/
 	os_memcpy(&instance->params.last_gm_priority, &instance->params.gm_priority, sizeof(struct ptp_priority_vector));
-	best_vector = &instance->params.system_priority;
-	for (i = 0; i < instance->numberPorts; i++) {
-		port = &instance->ports[i];
-		if (port->params.info_is == SPANNING_TREE_RECEIVED) {
-			dump_priority_vector(&gm_path_priority[i], instance->index, instance->domain.domain_number, "(b) gm path priority vector", LOG_DEBUG);
-			if (os_memcmp(&gm_path_priority[i].u.s.root_system_identity.u.s.clock_identity, &instance->params.this_clock, sizeof(struct ptp_clock_identity))){
-				if (compare_system_identity(best_vector, &gm_path_priority[i]) == BMCA_VECTOR_B_BETTER) {
-					best_vector = &gm_path_priority[i];
-					best_vector_port = i;
-					os_log(LOG_DEBUG, "(b) port %d - gm priority is better\n", best_vector_port);
-				}
-			}
-		}
+
+	if (gm_priority_select_incremental(instance, reselect, &best_vector_port)) {
+		instance->stats.num_bmca_incremental_runs++;
+
+#ifdef CFG_GPTP_BMCA_CHECK
+		full_best_vector_port = gm_priority_select_full(instance);
+		if (full_best_vector_port != best_vector_port)
+			os_log(LOG_ERR, "domain(%u, %u) incremental selection port %d differs from full selection port %d\n",
+				instance->index, instance->domain.domain_number, best_vector_port, full_best_vector_port);
+#endif
+	} else {
+		best_vector_port = gm_priority_select_full(instance);
 	}
 
+	instance->bmca.best_port = best_vector_port;
+	os_memcpy(&instance->bmca.system_priority, &instance->params.system_priority, sizeof(struct ptp_priority_vector));
+	instance->bmca.valid = true;
+
+	if (best_vector_port >= 0)
+		best_vector = &instance->bmca.gm_path_priority[best_vector_port];
+	else
+		best_vector = &instance->params.system_priority;
+
 	os_memcpy(&instance->params.gm_priority, best_vector, sizeof(struct ptp_priority_vector));
 
 	/*
@@ -311,6 +431,7 @@ static void updt_roles_tree(struct gptp_instance *instance)
 		}
 
 		if (previous_port_role != instance->params.selected_role[j]) {
+			instance->stats.num_role_changes++;
 			os_log(LOG_INFO, "Port(%u): role changed from %s to %s (%s)\n", port->port_id, port_role2string[previous_port_role], port_role2string[instance->params.selected_role[j]], spanning_tree2string[port->params.info_is]);
 		}
 	}
@@ -384,9 +505,11 @@ static void port_state_selection_sm_init_bridge(struct gptp_instance *instance)
 
 static void port_state_selection_sm_selection(struct gptp_instance *instance)
 {
+	u16 reselect = instance->params.reselect;
+
 	clear_reselect_tree(instance);
 
-	updt_roles_tree(instance);
+	updt_roles_tree(instance, reselect);
 
 	set_selected_tree(instance);
 
@@ -51,12 +51,14 @@ void target_clkadj_dump_stats(struct target_clkadj_params *target_clkadj_params)
 {
 	struct stats *freq_stats;
 	struct stats *diff_stats;
+	struct hist_percentiles diff_pct;
 
 	freq_stats = &target_clkadj_params->freq_stats;
 	diff_stats = &target_clkadj_params->diff_stats;
 
 	stats_compute(freq_stats);
 	stats_compute(diff_stats);
+	hist_percentiles_compute(&target_clkadj_params->diff_hist, &diff_pct);
 
 	os_log(LOG_INFO_RAW, "domain(%u, %u) Correction applied to target clock (ppb): min %6d avg %6d max %6d variance %5"PRIu64"\n",
 		target_clkadj_params->instance_index, target_clkadj_params->domain, freq_stats->min, freq_stats->mean, freq_stats->max, freq_stats->variance);
@@ -64,8 +66,12 @@ void target_clkadj_dump_stats(struct target_clkadj_params *target_clkadj_params)
 	os_log(LOG_INFO_RAW, "domain(%u, %u) Offset between GM and target clock (ns):  min %6d avg %6d max %6d variance %5"PRIu64"\n",
 		target_clkadj_params->instance_index, target_clkadj_params->domain, diff_stats->min, diff_stats->mean, diff_stats->max, diff_stats->variance);
 
+	os_log(LOG_INFO_RAW, "domain(%u, %u) Offset between GM and target clock (ns):  p50 %6d p99 %6d p99.9 %6d samples %u\n",
+		target_clkadj_params->instance_index, target_clkadj_params->domain, diff_pct.p50, diff_pct.p99, diff_pct.p999, diff_pct.total);
+
 	stats_reset(freq_stats);
 	stats_reset(diff_stats);
+	hist_reset(&target_clkadj_params->diff_hist);
 }
 
 
@@ -201,6 +207,7 @@ start:
 
 		stats_init(&target_clkadj_params->freq_stats, 31, NULL, NULL);
 		stats_init(&target_clkadj_params->diff_stats, 31, NULL, NULL);
+		hist_reset(&target_clkadj_params->diff_hist);
 
 		target_clkadj_params->state = TARGET_PLL_LOCKING;
 
@@ -296,6 +303,7 @@ start:
 
 	stats_update(&target_clkadj_params->freq_stats, ppb);
 	stats_update(&target_clkadj_params->diff_stats, err_ns);
+	hist_update(&target_clkadj_params->diff_hist, err_ns);
 
 exit:
 	target_clkadj_params->freq_change = freq_change;
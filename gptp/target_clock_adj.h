@@ -54,6 +54,7 @@ struct target_clkadj_params {
 
 	struct stats freq_stats;
 	struct stats diff_stats;
+	struct hist diff_hist;
 };
 
 
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP incremental best master selection test
+ @details
+ The gPTP stack runs as a standard profile bridge with CFG_MAX_NUM_PORT ports against the simulated
+ services of the replay tool (see mock.c). The test drives the port state selection state machine of
+ domain 0 directly, the simulated time never moving forward. For TEST_STEPS steps, a random topology
+ change is applied: a random subset of ports gets a new spanning tree information (received from one of
+ TEST_GRANDMASTERS grandmasters through a random number of hops, received from this time-aware system,
+ aged, disabled or mine) and has its reselect flag set, and the systemPriorityVector sometimes changes.
+ The roles are then selected (incrementally when possible), and selected again with the selection cache
+ invalidated and all the ports reselected, which forces a full recomputation. Both selections must
+ produce the same gmPriorityVector, masterStepsRemoved, gmPresent and port roles.
+ The ports are flagged with a static grandmaster, so that the port announce state machines run at the
+ end of each selection (setSelectedTree) leave the spanning tree information of the test untouched.
+ A small grandmaster pool is used so that several ports often lead to the same grandmaster, exercising
+ the tie break between ports.
+ With -b, the test also reports the average processing time of an incremental and of a full selection,
+ when one port which does not lead to the grandmaster receives a new Announce message.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/ptp.h"
+
+#include "gptp/gptp.h"
+#include "gptp/gptp_entry.h"
+#include "gptp/site_fsm.h"
+
+#include "mock.h"
+
+#define TEST_STEPS		100000
+#define TEST_BENCH_RUNS		1000000
+#define TEST_GRANDMASTERS	4
+#define TEST_PORTS		CFG_MAX_NUM_PORT
+#define TEST_START_TIME		(1000 * (u64)NSECS_PER_SEC)
+
+struct test_selection {
+	struct ptp_priority_vector gm_priority;
+	u16 master_steps_removed;
+	bool gm_present;
+	ptp_port_role_t selected_role[CFG_GPTP_MAX_NUM_PORT + 1];
+};
+
+static struct fgptp_config cfg;
+static struct ptp_system_identity grandmaster[TEST_GRANDMASTERS];
+
+static void test_config_init(void)
+{
+	int i, j;
+
+	memset(&cfg, 0, sizeof(cfg));
+
+	cfg.log_level = LOG_ERR;
+	cfg.is_bridge = 1;
+	cfg.profile = CFG_GPTP_PROFILE_STANDARD;
+	cfg.domain_max = CFG_MAX_GPTP_DOMAINS;
+	cfg.port_max = TEST_PORTS;
+	cfg.clock_local = OS_CLOCK_LOCAL_BR_0;
+	cfg.gm_id = htonll(CFG_GPTP_DEFAULT_GM_ID);
+	cfg.neighborPropDelayThreshold = CFG_GPTP_NEIGH_THRESH_DEFAULT;
+	cfg.neighborRateRatioWindow = CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT;
+	cfg.neighborPropDelay_mode = CFG_GPTP_PDELAY_MODE_STATIC;
+	cfg.neighborPropDelay_sensitivity = CFG_GPTP_DEFAULT_PDELAY_SENSITIVITY;
+
+	for (i = 0; i < TEST_PORTS; i++) {
+		struct fgptp_port_config *port_cfg = &cfg.port_cfg[i];
+
+		cfg.logical_port_list[i] = i;
+		cfg.initial_neighborPropDelay[i] = CFG_GPTP_DEFAULT_PDELAY_VALUE;
+
+		port_cfg->portRole = i ? MASTER_PORT : SLAVE_PORT;
+		port_cfg->ptpPortEnabled = CFG_GPTP_DEFAULT_PTP_ENABLED;
+		port_cfg->initialLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+		port_cfg->initialLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+		port_cfg->initialLogAnnounceInterval = CFG_GPTP_DFLT_LOG_ANNOUNCE_INTERVAL;
+		port_cfg->operLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+		port_cfg->operLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+		port_cfg->allowedLostResponses = CFG_GPTP_DFLT_ALLOWED_LOST_RESP_2020;
+		port_cfg->allowedFaults = CFG_GPTP_DFLT_ALLOWED_FAULTS;
+
+		for (j = 0; j < CFG_MAX_GPTP_DOMAINS; j++)
+			port_cfg->delayMechanism[j] = j ? COMMON_P2P : P2P;
+	}
+
+	/* single domain */
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		struct fgptp_domain_config *domain_cfg = &cfg.domain_cfg[i];
+
+		domain_cfg->domain_number = i ? -1 : 0;
+		domain_cfg->clock_target = OS_CLOCK_GPTP_BR_0_0 + i;
+		domain_cfg->clock_source = domain_cfg->clock_target;
+		domain_cfg->gmCapable = CFG_GPTP_DEFAULT_GM_CAPABLE;
+		domain_cfg->priority1 = CFG_GPTP_DEFAULT_PRIORITY1;
+		domain_cfg->priority2 = CFG_GPTP_DEFAULT_PRIORITY2;
+		domain_cfg->clockClass = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+		domain_cfg->clockAccuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+		domain_cfg->offsetScaledLogVariance = CFG_GPTP_DEFAULT_CLOCK_VARIANCE;
+	}
+}
+
+static void test_random_bytes(void *data, unsigned int len)
+{
+	u8 *p = data;
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		p[i] = rand();
+}
+
+/* Grandmasters with priority1 around the default one, so that this time-aware system is sometimes the best */
+static void test_grandmasters_init(void)
+{
+	static const u8 priority1[] = {246, 248, 250};
+	struct ptp_system_identity *gm;
+	int i;
+
+	for (i = 0; i < TEST_GRANDMASTERS; i++) {
+		gm = &grandmaster[i];
+
+		gm->u.s.priority_1 = priority1[rand() % 3];
+		gm->u.s.clock_quality.clock_class = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+		gm->u.s.clock_quality.clock_accuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+		gm->u.s.clock_quality.offset_scaled_log_variance = htons(CFG_GPTP_DEFAULT_CLOCK_VARIANCE);
+		gm->u.s.priority_2 = CFG_GPTP_DEFAULT_PRIORITY2;
+		test_random_bytes(&gm->u.s.clock_identity, sizeof(struct ptp_clock_identity));
+	}
+}
+
+/* New spanning tree information for a port, as the port information state machine would set it */
+static void test_port_update(struct gptp_instance *instance, struct gptp_port *port)
+{
+	struct ptp_priority_vector *port_priority = &port->params.port_priority;
+	unsigned int r = rand() % 100;
+
+	if (r < 70) {
+		port->params.info_is = SPANNING_TREE_RECEIVED;
+
+		/* received from this time-aware system (loop), not eligible as grandmaster path */
+		if (r < 5)
+			os_memcpy(&port_priority->u.s.root_system_identity, &instance->params.system_priority.u.s.root_system_identity, sizeof(struct ptp_system_identity));
+		else
+			os_memcpy(&port_priority->u.s.root_system_identity, &grandmaster[rand() % TEST_GRANDMASTERS], sizeof(struct ptp_system_identity));
+
+		port->params.message_steps_removed = rand() % 4;
+		port_priority->u.s.steps_removed = htons(port->params.message_steps_removed);
+		test_random_bytes(&port_priority->u.s.source_port_identity.clock_identity, sizeof(struct ptp_clock_identity));
+		port_priority->u.s.source_port_identity.port_number = htons(1 + rand() % TEST_PORTS);
+		port_priority->u.s.port_number = htons(get_port_identity_number(port));
+	} else if (r < 80) {
+		port->params.info_is = SPANNING_TREE_AGED;
+	} else if (r < 90) {
+		port->params.info_is = SPANNING_TREE_DISABLED;
+	} else {
+		port->params.info_is = SPANNING_TREE_MINE;
+		os_memcpy(port_priority, &port->params.master_priority, sizeof(struct ptp_priority_vector));
+	}
+
+	instance->params.reselect |= 1 << get_port_identity_number(port);
+}
+
+static void test_selection_get(struct gptp_instance *instance, struct test_selection *selection)
+{
+	memset(selection, 0, sizeof(*selection));
+
+	os_memcpy(&selection->gm_priority, &instance->params.gm_priority, sizeof(struct ptp_priority_vector));
+	selection->master_steps_removed = instance->params.master_steps_removed;
+	selection->gm_present = instance->params.gm_present;
+	os_memcpy(selection->selected_role, instance->params.selected_role, sizeof(selection->selected_role));
+}
+
+/* Selection with the cache invalidated and all the ports reselected, i.e. a full recomputation */
+static void test_select_full(struct gptp_instance *instance)
+{
+	int i;
+
+	instance->bmca.valid = false;
+
+	for (i = 0; i < instance->numberPorts; i++)
+		instance->params.reselect |= 1 << get_port_identity_number(&instance->ports[i]);
+
+	port_state_selection_sm(instance);
+}
+
+static int test_run(struct gptp_instance *instance)
+{
+	struct test_selection incremental, full;
+	u32 incremental_runs = 0;
+	int step, i;
+
+	for (step = 0; step < TEST_STEPS; step++) {
+		/* systemPriorityVector change (e.g. management update of priority1) */
+		if (!(rand() % 20))
+			instance->params.system_priority.u.s.root_system_identity.u.s.priority_1 = 246 + 2 * (rand() % 3);
+
+		/* at least one port changes */
+		test_port_update(instance, &instance->ports[rand() % instance->numberPorts]);
+
+		for (i = 0; i < instance->numberPorts; i++)
+			if (!(rand() % 4))
+				test_port_update(instance, &instance->ports[i]);
+
+		incremental_runs = instance->stats.num_bmca_incremental_runs;
+
+		port_state_selection_sm(instance);
+
+		incremental_runs = instance->stats.num_bmca_incremental_runs - incremental_runs;
+
+		test_selection_get(instance, &incremental);
+
+		test_select_full(instance);
+
+		test_selection_get(instance, &full);
+
+		if (memcmp(&incremental, &full, sizeof(struct test_selection))) {
+			printf("step %d: %s selection differs from full recomputation, gm port %u/%u, roles:",
+				step, incremental_runs ? "incremental" : "full", ntohs(incremental.gm_priority.u.s.port_number),
+				ntohs(full.gm_priority.u.s.port_number));
+
+			for (i = 0; i < instance->numberPorts + 1; i++)
+				printf(" %d/%d", incremental.selected_role[i], full.selected_role[i]);
+
+			printf("\n");
+
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static u64 test_time_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (u64)now.tv_sec * NSECS_PER_SEC + now.tv_nsec;
+}
+
+/* Announce refresh on a port which does not lead to the grandmaster, the most common selection trigger */
+static void test_bench(struct gptp_instance *instance)
+{
+	struct gptp_port *port;
+	u64 start, incremental_ns, full_ns;
+	int i, j;
+
+	for (i = 0; i < instance->numberPorts; i++) {
+		port = &instance->ports[i];
+
+		port->params.info_is = SPANNING_TREE_RECEIVED;
+		os_memcpy(&port->params.port_priority.u.s.root_system_identity, &grandmaster[i % TEST_GRANDMASTERS], sizeof(struct ptp_system_identity));
+		port->params.port_priority.u.s.root_system_identity.u.s.priority_1 = i ? 250 : 246;
+	}
+
+	test_select_full(instance);
+
+	port = &instance->ports[instance->numberPorts - 1];
+
+	start = test_time_ns();
+
+	for (j = 0; j < TEST_BENCH_RUNS; j++) {
+		instance->params.reselect |= 1 << get_port_identity_number(port);
+		port_state_selection_sm(instance);
+	}
+
+	incremental_ns = test_time_ns() - start;
+
+	start = test_time_ns();
+
+	for (j = 0; j < TEST_BENCH_RUNS; j++) {
+		instance->params.reselect |= 1 << get_port_identity_number(port);
+		instance->bmca.valid = false;
+		port_state_selection_sm(instance);
+	}
+
+	full_ns = test_time_ns() - start;
+
+	printf("%u ports, %u selections: incremental %.1f ns, full %.1f ns per selection\n", instance->numberPorts,
+		TEST_BENCH_RUNS, (double)incremental_ns / TEST_BENCH_RUNS, (double)full_ns / TEST_BENCH_RUNS);
+}
+
+int main(int argc, char *argv[])
+{
+	struct gptp_ctx *gptp;
+	struct gptp_instance *instance;
+	bool bench = false;
+	int opt, i, rc = -1;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = true;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	log_level_set(common_COMPONENT_ID, LOG_CRIT);
+	log_level_set(os_COMPONENT_ID, LOG_ERR);
+
+	mock_time_set(TEST_START_TIME);
+
+	srand(1);
+
+	test_config_init();
+	test_grandmasters_init();
+
+	gptp = gptp_init(&cfg, 0);
+	if (!gptp) {
+		printf("gPTP initialization failed\n");
+		goto fail;
+	}
+
+	instance = gptp->instances[0];
+
+	for (i = 0; i < instance->numberPorts; i++)
+		instance->ports[i].gm_id_static = true;
+
+	rc = test_run(instance);
+	if (!rc) {
+		printf("%u steps, %u selections, %u incremental\n", TEST_STEPS, instance->stats.num_bmca_runs,
+			instance->stats.num_bmca_incremental_runs);
+
+		if (!instance->stats.num_bmca_incremental_runs)
+			rc = -1;
+	}
+
+	if (!rc && bench)
+		test_bench(instance);
+
+	gptp_exit(gptp);
+
+	if (rc < 0)
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,414 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP per domain instance threads test
+ @details
+ The gPTP stack runs as a standard profile endpoint against the simulated services of the replay tool
+ (see mock.c), with all the supported domains enabled. Port 0 is connected to a simulated bridge
+ (see peer.c) relaying a different grandmaster (time offset and frequency) on each domain. The stack
+ runs twice, for TEST_SYNCS Sync intervals of simulated time:
+ - with all the domain instances in the main thread (gptp_init()),
+ - with each domain instance other than domain 0 in its own thread (gptp_init_domain_threads()),
+   the test providing the platform thread services (instance lock and wake up).
+ In both cases, each domain instance must process all the Sync messages of its grandmaster (none lost
+ on the instance event queue) and synchronize to it. The Sync processing latency of each domain (from
+ the dispatch of the frame by the main thread to the end of its processing by the domain instance) is
+ reported, with the monotonic clocks following the host clock for the measurement.
+ The main thread plays the role of the platform event loop: it moves the simulated time to the next
+ timer expiry or link partner message, runs the expired timers with all the instances locked (the
+ simulated timers of the threaded instances are not run by their own thread) and hands the received
+ frames over to the stack. It then waits for the instance threads to process them, before moving the
+ simulated time forward.
+ With -b, the test runs TEST_BENCH_SYNCS Sync intervals instead of TEST_SYNCS.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/ptp.h"
+#include "common/stats.h"
+
+#include "gptp/gptp.h"
+#include "gptp/gptp_entry.h"
+
+#include "mock.h"
+#include "peer.h"
+
+#define TEST_SYNCS		1000
+#define TEST_BENCH_SYNCS	20000
+#define TEST_LOG_SYNC_INTERVAL	(-3)
+#define TEST_START_TIME		(1000 * (u64)NSECS_PER_SEC)
+
+struct test_thread {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	sem_t wake;
+	bool stop;
+	bool started;
+	unsigned int instance_index;
+};
+
+static struct fgptp_config cfg;
+static struct gptp_ctx *gptp;
+static struct gptp_domain_threads domain_threads;
+static struct test_thread threads[CFG_MAX_GPTP_DOMAINS];
+static ptp_port_sync_state_t sync_state[CFG_MAX_GPTP_DOMAINS];
+
+/*
+ * Platform thread services
+ */
+
+static void test_thread_lock(struct gptp_domain_threads *dt, unsigned int instance_index)
+{
+	pthread_mutex_lock(&threads[instance_index].lock);
+}
+
+static void test_thread_unlock(struct gptp_domain_threads *dt, unsigned int instance_index)
+{
+	pthread_mutex_unlock(&threads[instance_index].lock);
+}
+
+static void test_thread_notify(struct gptp_domain_threads *dt, unsigned int instance_index)
+{
+	sem_post(&threads[instance_index].wake);
+}
+
+static void *test_thread_main(void *arg)
+{
+	struct test_thread *thread = arg;
+
+	while (1) {
+		sem_wait(&thread->wake);
+
+		if (__atomic_load_n(&thread->stop, __ATOMIC_ACQUIRE))
+			break;
+
+		pthread_mutex_lock(&thread->lock);
+
+		gptp_instance_process(gptp, thread->instance_index);
+
+		pthread_mutex_unlock(&thread->lock);
+	}
+
+	return NULL;
+}
+
+static void test_threads_init(void)
+{
+	pthread_mutexattr_t attr;
+	int i;
+
+	domain_threads.lock = test_thread_lock;
+	domain_threads.unlock = test_thread_unlock;
+	domain_threads.notify = test_thread_notify;
+
+	/* the main thread runs the timers with the instance locks held, and the stack may lock them again */
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		threads[i].instance_index = i;
+		pthread_mutex_init(&threads[i].lock, &attr);
+		sem_init(&threads[i].wake, 0, 0);
+	}
+
+	pthread_mutexattr_destroy(&attr);
+}
+
+static int test_threads_start(void)
+{
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		if (!gptp_instance_is_threaded(gptp, i))
+			continue;
+
+		threads[i].stop = false;
+
+		if (pthread_create(&threads[i].thread, NULL, test_thread_main, &threads[i]))
+			return -1;
+
+		threads[i].started = true;
+	}
+
+	return 0;
+}
+
+static void test_threads_stop(void)
+{
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		if (!threads[i].started)
+			continue;
+
+		__atomic_store_n(&threads[i].stop, true, __ATOMIC_RELEASE);
+		sem_post(&threads[i].wake);
+		pthread_join(threads[i].thread, NULL);
+
+		threads[i].started = false;
+	}
+}
+
+/* Waits until the instance threads have processed all the events handed over to them */
+static void test_threads_sync(void)
+{
+	struct gptp_instance_queue *queue;
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		if (!threads[i].started)
+			continue;
+
+		queue = &gptp->instances[i]->queue;
+
+		while (__atomic_load_n(&queue->read, __ATOMIC_ACQUIRE) != __atomic_load_n(&queue->write, __ATOMIC_ACQUIRE))
+			sched_yield();
+	}
+}
+
+static void test_timers_process(void)
+{
+	int i;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++)
+		pthread_mutex_lock(&threads[i].lock);
+
+	mock_timer_process();
+
+	for (i = CFG_MAX_GPTP_DOMAINS - 1; i >= 0; i--)
+		pthread_mutex_unlock(&threads[i].lock);
+}
+
+/*
+ * Stack and link partner configuration
+ */
+
+static void sync_indication_handler(struct gptp_sync_info *info)
+{
+	if (info->domain < CFG_MAX_GPTP_DOMAINS)
+		__atomic_store_n(&sync_state[info->domain], info->state, __ATOMIC_RELAXED);
+}
+
+static void test_config_init(unsigned int domain_threads_enabled, u64 start)
+{
+	struct fgptp_port_config *port_cfg = &cfg.port_cfg[0];
+	struct peer_config peer_cfg;
+	int i;
+
+	memset(&cfg, 0, sizeof(cfg));
+
+	cfg.log_level = LOG_ERR;
+	cfg.is_bridge = 0;
+	cfg.profile = CFG_GPTP_PROFILE_STANDARD;
+	cfg.domain_max = CFG_MAX_GPTP_DOMAINS;
+	cfg.port_max = 1;
+	cfg.clock_local = OS_CLOCK_LOCAL_EP_0;
+	cfg.gm_id = htonll(CFG_GPTP_DEFAULT_GM_ID);
+	cfg.neighborPropDelayThreshold = CFG_GPTP_NEIGH_THRESH_DEFAULT;
+	cfg.neighborRateRatioWindow = CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT;
+	cfg.neighborPropDelay_mode = CFG_GPTP_PDELAY_MODE_STATIC;
+	cfg.neighborPropDelay_sensitivity = CFG_GPTP_DEFAULT_PDELAY_SENSITIVITY;
+	cfg.statsInterval = 0; /* no periodic reset of the latency statistics */
+	cfg.domain_threads = domain_threads_enabled;
+	cfg.sync_indication = sync_indication_handler;
+
+	cfg.logical_port_list[0] = 0;
+	cfg.initial_neighborPropDelay[0] = CFG_GPTP_DEFAULT_PDELAY_VALUE;
+
+	port_cfg->portRole = SLAVE_PORT;
+	port_cfg->ptpPortEnabled = CFG_GPTP_DEFAULT_PTP_ENABLED;
+	port_cfg->initialLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+	port_cfg->initialLogSyncInterval = TEST_LOG_SYNC_INTERVAL;
+	port_cfg->initialLogAnnounceInterval = CFG_GPTP_DFLT_LOG_ANNOUNCE_INTERVAL;
+	port_cfg->operLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+	port_cfg->operLogSyncInterval = TEST_LOG_SYNC_INTERVAL;
+	port_cfg->allowedLostResponses = CFG_GPTP_DFLT_ALLOWED_LOST_RESP_2020;
+	port_cfg->allowedFaults = CFG_GPTP_DFLT_ALLOWED_FAULTS;
+
+	memset(&peer_cfg, 0, sizeof(peer_cfg));
+
+	peer_cfg.start = start;
+	peer_cfg.domains = CFG_MAX_GPTP_DOMAINS;
+	peer_cfg.ppb = 10;
+	peer_cfg.pdelay = 500;
+	peer_cfg.resp_time = 100000;
+	peer_cfg.log_sync_interval = TEST_LOG_SYNC_INTERVAL;
+	peer_cfg.log_announce_interval = CFG_GPTP_DFLT_LOG_ANNOUNCE_INTERVAL;
+
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		struct fgptp_domain_config *domain_cfg = &cfg.domain_cfg[i];
+
+		port_cfg->delayMechanism[i] = i ? COMMON_P2P : P2P;
+
+		domain_cfg->domain_number = i;
+		domain_cfg->clock_target = OS_CLOCK_GPTP_EP_0_0 + i;
+		domain_cfg->clock_source = domain_cfg->clock_target;
+		domain_cfg->gmCapable = 0;
+		domain_cfg->priority1 = CFG_GPTP_DEFAULT_PRIORITY1;
+		domain_cfg->priority2 = CFG_GPTP_DEFAULT_PRIORITY2;
+		domain_cfg->clockClass = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+		domain_cfg->clockAccuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+		domain_cfg->offsetScaledLogVariance = CFG_GPTP_DEFAULT_CLOCK_VARIANCE;
+
+		/* each grandmaster has its own time and frequency */
+		peer_cfg.gm[i].offset = (s64)(i + 1) * 3 * NSECS_PER_SEC + 12345 * i;
+		peer_cfg.gm[i].ppb = 20 * (i + 1);
+
+		sync_state[i] = SYNC_STATE_NOT_SYNCHRONIZED;
+	}
+
+	peer_init(&peer_cfg);
+}
+
+/*
+ * Test runs
+ */
+
+static void test_report(const char *mode, unsigned int domain)
+{
+	struct gptp_instance *instance = gptp->instances[domain];
+	struct stats *latency = &instance->stats.sync_latency;
+	struct hist_percentiles pct;
+
+	stats_compute(latency);
+	hist_percentiles_compute(&instance->stats.sync_latency_hist, &pct);
+
+	printf("%-14s domain %u (%s): %u syncs, latency (ns) min %d avg %d max %d p50 %d p99 %d\n", mode, domain,
+		instance->threaded ? "own thread" : "main thread", latency->current_count, latency->min, latency->mean,
+		latency->max, pct.p50, pct.p99);
+}
+
+static int test_run(unsigned int domain_threads_enabled, unsigned int n)
+{
+	const char *mode = domain_threads_enabled ? "domain threads" : "single thread";
+	struct peer_stats *peer_stats;
+	unsigned int d, expected;
+	u64 start, end, next, expiry;
+	int rc = -1;
+
+	/* the link partner starts sending one second after the stack initialization */
+	start = mock_time_get() + NSECS_PER_SEC;
+	end = start + (u64)n * (NSECS_PER_SEC >> -TEST_LOG_SYNC_INTERVAL);
+
+	test_config_init(domain_threads_enabled, start);
+
+	if (domain_threads_enabled)
+		gptp = gptp_init_domain_threads(&cfg, 0, &domain_threads);
+	else
+		gptp = gptp_init(&cfg, 0);
+
+	if (!gptp) {
+		printf("%s: gPTP initialization failed\n", mode);
+		return -1;
+	}
+
+	if (domain_threads_enabled && !gptp_instance_is_threaded(gptp, CFG_MAX_GPTP_DOMAINS - 1)) {
+		printf("%s: domain %u not threaded\n", mode, CFG_MAX_GPTP_DOMAINS - 1);
+		goto exit;
+	}
+
+	if (test_threads_start() < 0) {
+		printf("%s: cannot start the instance threads\n", mode);
+		goto exit;
+	}
+
+	while (!peer_next(&next) && (next < end)) {
+		if (!mock_timer_next(&expiry) && (expiry < next))
+			next = expiry;
+
+		mock_time_set(next);
+
+		test_timers_process();
+
+		peer_process();
+
+		mock_tx_ts_process();
+
+		test_threads_sync();
+	}
+
+	test_threads_stop();
+
+	peer_stats = peer_stats_get();
+	expected = peer_stats->num_sync / CFG_MAX_GPTP_DOMAINS;
+
+	rc = 0;
+
+	for (d = 0; d < CFG_MAX_GPTP_DOMAINS; d++) {
+		struct gptp_instance *instance = gptp->instances[d];
+
+		test_report(mode, d);
+
+		if ((instance->stats.sync_latency.current_count != expected) || instance->stats.num_event_queue_full) {
+			printf("%s domain %u: %u syncs processed, %u events dropped, expected %u and 0\n", mode, d,
+				instance->stats.sync_latency.current_count, instance->stats.num_event_queue_full, expected);
+			rc = -1;
+		}
+
+		if (__atomic_load_n(&sync_state[d], __ATOMIC_RELAXED) != SYNC_STATE_SYNCHRONIZED) {
+			printf("%s domain %u: not synchronized\n", mode, d);
+			rc = -1;
+		}
+	}
+
+exit:
+	test_threads_stop();
+
+	gptp_exit(gptp);
+	gptp = NULL;
+
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int n = TEST_SYNCS;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			n = TEST_BENCH_SYNCS;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	log_level_set(common_COMPONENT_ID, LOG_ERR);
+	log_level_set(os_COMPONENT_ID, LOG_ERR);
+
+	mock_time_set(TEST_START_TIME);
+	mock_clock_host_monotonic(true);
+
+	test_threads_init();
+
+	if ((test_run(0, n) < 0) || (test_run(1, n) < 0))
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
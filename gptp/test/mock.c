@@ -0,0 +1,518 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP replay, simulated OS services
+ @details
+ Clocks are derived from a single simulated raw time (the capture time of the replayed frames).
+ Adjustable clocks follow the frequency and offset corrections applied by the stack, so that
+ timestamps converted to the gPTP time reflect the servo output.
+ Timers expire when the simulated time reaches them, transmitted frames are handed to a hook
+ and their timestamp (the simulated time of transmission) is returned asynchronously, as the
+ hardware would.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/log.h"
+#include "common/ipc.h"
+#include "common/net.h"
+
+#include "os/timer.h"
+#include "os/ipc.h"
+
+#include "mock.h"
+
+struct mock_clock {
+	u64 anchor_raw;	/* raw time of the last frequency change */
+	u64 anchor;	/* clock time at anchor_raw */
+	s32 ppb;
+};
+
+struct mock_timer {
+	struct os_timer *t;
+	bool used;
+	bool armed;
+	u64 expiry;
+	u64 period;
+};
+
+struct mock_tx_ts {
+	struct net_tx *tx;
+	u64 ts;
+	unsigned int priv;
+};
+
+static u64 mock_now;	/* read by the gPTP instance threads (see domain_threads.c), accessed atomically */
+static bool mock_host_monotonic;
+
+static struct mock_clock mock_clocks[OS_CLOCK_MAX];
+
+static struct mock_timer mock_timers[MOCK_MAX_TIMERS];
+
+static struct mock_tx_ts mock_tx_ts[MOCK_MAX_TX_TS];
+static unsigned int mock_tx_ts_read, mock_tx_ts_write;
+
+static struct net_rx *mock_rx[CFG_MAX_NUM_PORT];
+static struct net_tx *mock_tx[CFG_MAX_NUM_PORT];
+
+static u8 mock_local_addr[6] = {0x00, 0x04, 0x9f, 0x00, 0x00, 0x00};
+
+static void (*mock_tx_hook)(unsigned int port_id, struct net_tx_desc *desc);
+
+/*
+ * Time
+ */
+
+void mock_time_set(u64 now)
+{
+	unsigned int i;
+
+	if (!mock_time_get()) {
+		/* first call, all clocks start aligned on the raw time */
+		for (i = 0; i < OS_CLOCK_MAX; i++) {
+			mock_clocks[i].anchor_raw = now;
+			mock_clocks[i].anchor = now;
+		}
+	}
+
+	if (now > mock_time_get())
+		__atomic_store_n(&mock_now, now, __ATOMIC_RELAXED);
+}
+
+u64 mock_time_get(void)
+{
+	return __atomic_load_n(&mock_now, __ATOMIC_RELAXED);
+}
+
+void mock_clock_host_monotonic(bool enable)
+{
+	mock_host_monotonic = enable;
+}
+
+static bool mock_clock_is_monotonic(os_clock_id_t id)
+{
+	return (id == OS_CLOCK_SYSTEM_MONOTONIC) || (id == OS_CLOCK_SYSTEM_MONOTONIC_COARSE) || (id == OS_CLOCK_SYSTEM_MONOTONIC_1);
+}
+
+static u64 mock_clock_from_raw(os_clock_id_t id, u64 raw)
+{
+	struct mock_clock *c = &mock_clocks[id];
+
+	if (mock_clock_is_monotonic(id))
+		return raw;
+
+	return c->anchor + (s64)((double)(s64)(raw - c->anchor_raw) * (1.0 + c->ppb / 1.0e9));
+}
+
+static u64 mock_clock_to_raw(os_clock_id_t id, u64 ns)
+{
+	struct mock_clock *c = &mock_clocks[id];
+
+	if (mock_clock_is_monotonic(id))
+		return ns;
+
+	return c->anchor_raw + (s64)((double)(s64)(ns - c->anchor) / (1.0 + c->ppb / 1.0e9));
+}
+
+int os_clock_gettime64(os_clock_id_t id, u64 *ns)
+{
+	struct timespec now;
+
+	if (id >= OS_CLOCK_MAX)
+		return -1;
+
+	if (mock_host_monotonic && mock_clock_is_monotonic(id)) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		*ns = (u64)now.tv_sec * NSECS_PER_SEC + now.tv_nsec;
+
+		return 0;
+	}
+
+	*ns = mock_clock_from_raw(id, mock_time_get());
+
+	return 0;
+}
+
+int os_clock_gettime32(os_clock_id_t id, u32 *ns)
+{
+	u64 ns64;
+
+	if (os_clock_gettime64(id, &ns64) < 0)
+		return -1;
+
+	*ns = (u32)ns64;
+
+	return 0;
+}
+
+int os_clock_convert(os_clock_id_t id_src, u64 ns_src, os_clock_id_t id_dst, u64 *ns_dst)
+{
+	if ((id_src >= OS_CLOCK_MAX) || (id_dst >= OS_CLOCK_MAX))
+		return -1;
+
+	*ns_dst = mock_clock_from_raw(id_dst, mock_clock_to_raw(id_src, ns_src));
+
+	return 0;
+}
+
+int os_clock_setfreq(os_clock_id_t id, s32 ppb)
+{
+	struct mock_clock *c;
+	u64 now;
+
+	if ((id >= OS_CLOCK_MAX) || mock_clock_is_monotonic(id))
+		return -1;
+
+	c = &mock_clocks[id];
+
+	now = mock_time_get();
+	c->anchor = mock_clock_from_raw(id, now);
+	c->anchor_raw = now;
+	c->ppb = ppb;
+
+	return 0;
+}
+
+int os_clock_setoffset(os_clock_id_t id, s64 offset)
+{
+	if ((id >= OS_CLOCK_MAX) || mock_clock_is_monotonic(id))
+		return -1;
+
+	mock_clocks[id].anchor += offset;
+
+	return 0;
+}
+
+unsigned int os_clock_adjust_mode(os_clock_id_t id)
+{
+	/* software clocks, as on Linux */
+	return 0;
+}
+
+/*
+ * Timers
+ */
+
+int os_timer_create(struct os_timer *t, os_clock_id_t id, unsigned int flags, void (*func)(struct os_timer *t, int count), unsigned long priv)
+{
+	int i;
+
+	if (flags)
+		goto err;
+
+	for (i = 0; i < MOCK_MAX_TIMERS; i++) {
+		if (!mock_timers[i].used)
+			break;
+	}
+
+	if (i == MOCK_MAX_TIMERS) {
+		os_log(LOG_ERR, "os_timer(%p), no free timer\n", t);
+		goto err;
+	}
+
+	mock_timers[i].t = t;
+	mock_timers[i].used = true;
+	mock_timers[i].armed = false;
+
+	t->fd = i;
+	t->func = func;
+
+	return 0;
+
+err:
+	return -1;
+}
+
+int os_timer_start(struct os_timer *t, u64 value, u64 interval_p, u64 interval_q, unsigned int flags)
+{
+	struct mock_timer *timer = &mock_timers[t->fd];
+
+	/* same restrictions as the Linux system timers */
+	if (interval_p && (interval_q != 1))
+		return -1;
+
+	if (!value && !interval_p)
+		return -1;
+
+	if (!(flags & OS_TIMER_FLAGS_ABSOLUTE))
+		value += mock_time_get();
+
+	/* For periodic timer, first expiration at the end of the first period */
+	timer->expiry = value + interval_p;
+	timer->period = interval_p;
+	timer->armed = true;
+
+	return 0;
+}
+
+void os_timer_stop(struct os_timer *t)
+{
+	mock_timers[t->fd].armed = false;
+}
+
+void os_timer_destroy(struct os_timer *t)
+{
+	mock_timers[t->fd].used = false;
+	mock_timers[t->fd].armed = false;
+	t->fd = -1;
+}
+
+static struct mock_timer *mock_timer_earliest(void)
+{
+	struct mock_timer *earliest = NULL;
+	int i;
+
+	for (i = 0; i < MOCK_MAX_TIMERS; i++) {
+		if (mock_timers[i].armed && (!earliest || (mock_timers[i].expiry < earliest->expiry)))
+			earliest = &mock_timers[i];
+	}
+
+	return earliest;
+}
+
+/** Returns the earliest pending timer expiration
+ * \return	0 if a timer is armed, -1 otherwise
+ * \param expiry	simulated raw time of the expiration
+ */
+int mock_timer_next(u64 *expiry)
+{
+	struct mock_timer *timer = mock_timer_earliest();
+
+	if (!timer)
+		return -1;
+
+	*expiry = timer->expiry;
+
+	return 0;
+}
+
+/** Runs the handlers of all the timers expired at the current simulated time, earliest first
+ * \return	none
+ */
+void mock_timer_process(void)
+{
+	struct mock_timer *timer;
+	int count;
+
+	while ((timer = mock_timer_earliest()) && (timer->expiry <= mock_time_get())) {
+		count = 1;
+
+		if (timer->period) {
+			while (timer->expiry + timer->period <= mock_time_get()) {
+				timer->expiry += timer->period;
+				count++;
+			}
+
+			timer->expiry += timer->period;
+		} else {
+			timer->armed = false;
+		}
+
+		timer->t->func(timer->t, count);
+	}
+}
+
+/*
+ * Network
+ */
+
+int net_rx_init(struct net_rx *rx, struct net_address *addr, void (*func)(struct net_rx *, struct net_rx_desc *), unsigned long priv)
+{
+	if (addr->port >= CFG_MAX_NUM_PORT)
+		return -1;
+
+	rx->port_id = addr->port;
+	rx->func = func;
+	rx->is_ptp = (addr->ptype == PTYPE_PTP);
+	rx->pool_type = POOL_TYPE_STD;
+
+	mock_rx[addr->port] = rx;
+
+	return 0;
+}
+
+void net_rx_exit(struct net_rx *rx)
+{
+	mock_rx[rx->port_id] = NULL;
+}
+
+struct net_rx *mock_net_rx_get(unsigned int port_id)
+{
+	if (port_id >= CFG_MAX_NUM_PORT)
+		return NULL;
+
+	return mock_rx[port_id];
+}
+
+void net_rx_free(struct net_rx_desc *buf)
+{
+	free(buf);
+}
+
+int net_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return 0;
+}
+
+int net_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return 0;
+}
+
+void mock_local_addr_set(const u8 *addr)
+{
+	os_memcpy(mock_local_addr, addr, 6);
+}
+
+/* Port n uses the base address with n added to its last byte */
+int net_get_local_addr(unsigned int port_id, unsigned char *addr)
+{
+	os_memcpy(addr, mock_local_addr, 6);
+	addr[5] += port_id;
+
+	return 0;
+}
+
+int net_tx_ts_init(struct net_tx *tx, struct net_address *addr, void (*func)(struct net_tx *, uint64_t, unsigned int), unsigned long priv)
+{
+	if (addr->port >= CFG_MAX_NUM_PORT)
+		return -1;
+
+	tx->port_id = addr->port;
+	tx->func_tx_ts = func;
+	tx->pool_type = POOL_TYPE_STD;
+
+	mock_tx[addr->port] = tx;
+
+	return 0;
+}
+
+void net_tx_exit(struct net_tx *tx)
+{
+	mock_tx[tx->port_id] = NULL;
+}
+
+struct net_tx_desc *net_tx_alloc(struct net_tx *tx, unsigned int size)
+{
+	struct net_tx_desc *desc;
+
+	if (size > DEFAULT_NET_DATA_SIZE)
+		return NULL;
+
+	desc = malloc(NET_DATA_OFFSET + size);
+	if (!desc)
+		return NULL;
+
+	desc->flags = 0;
+	desc->len = 0;
+	desc->l2_offset = NET_DATA_OFFSET;
+	desc->pool_type = POOL_TYPE_STD;
+
+	return desc;
+}
+
+void net_tx_free(struct net_tx_desc *buf)
+{
+	free(buf);
+}
+
+void mock_tx_hook_set(void (*func)(unsigned int port_id, struct net_tx_desc *desc))
+{
+	mock_tx_hook = func;
+}
+
+int net_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	struct mock_tx_ts *tx_ts;
+
+	if (desc->flags & NET_TX_FLAGS_HW_TS) {
+		if (mock_tx_ts_write - mock_tx_ts_read >= MOCK_MAX_TX_TS) {
+			os_log(LOG_ERR, "port(%d) tx timestamp queue full\n", tx->port_id);
+			return -1;
+		}
+
+		/* the frame leaves the port as soon as it is sent, timestamps are taken
+		 * with the (never adjusted) local clock, i.e the raw time */
+		tx_ts = &mock_tx_ts[mock_tx_ts_write & (MOCK_MAX_TX_TS - 1)];
+		tx_ts->tx = tx;
+		tx_ts->ts = mock_time_get();
+		tx_ts->priv = desc->priv;
+		mock_tx_ts_write++;
+	}
+
+	if (mock_tx_hook)
+		mock_tx_hook(tx->port_id, desc);
+
+	net_tx_free(desc);
+
+	return 0;
+}
+
+/** Returns the timestamps of the frames transmitted since the last call
+ * \return	none
+ */
+void mock_tx_ts_process(void)
+{
+	struct mock_tx_ts *tx_ts;
+
+	while (mock_tx_ts_read != mock_tx_ts_write) {
+		tx_ts = &mock_tx_ts[mock_tx_ts_read & (MOCK_MAX_TX_TS - 1)];
+		mock_tx_ts_read++;
+
+		if (mock_tx[tx_ts->tx->port_id] == tx_ts->tx)
+			tx_ts->tx->func_tx_ts(tx_ts->tx, tx_ts->ts, tx_ts->priv);
+	}
+}
+
+/*
+ * IPC, nothing is connected: messages sent by the stack are dropped
+ */
+
+int ipc_tx_init(struct ipc_tx *tx, ipc_id_t id)
+{
+	return 0;
+}
+
+void ipc_tx_exit(struct ipc_tx *tx)
+{
+}
+
+int ipc_rx_init(struct ipc_rx *rx, ipc_id_t id, void (*func)(struct ipc_rx const *, struct ipc_desc *), unsigned long priv)
+{
+	return 0;
+}
+
+void ipc_rx_exit(struct ipc_rx *rx)
+{
+}
+
+int ipc_tx_connect(struct ipc_tx *tx, struct ipc_rx *rx)
+{
+	return 0;
+}
+
+struct ipc_desc *ipc_alloc(struct ipc_tx const *tx, unsigned int size)
+{
+	return malloc(sizeof(struct ipc_desc) + size);
+}
+
+void ipc_free(void const *ipc, struct ipc_desc *desc)
+{
+	free(desc);
+}
+
+int ipc_tx(struct ipc_tx const *tx, struct ipc_desc *desc)
+{
+	ipc_free(tx, desc);
+
+	return 0;
+}
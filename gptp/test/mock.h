@@ -0,0 +1,40 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP replay, simulated OS services
+ @details
+ Network, clock, timer and IPC services the gPTP core is linked against when it is run
+ offline. Time is simulated: it only advances when the replay loop moves it forward.
+*/
+
+#ifndef _GPTP_TEST_MOCK_H_
+#define _GPTP_TEST_MOCK_H_
+
+#include "os/sys_types.h"
+#include "os/clock.h"
+#include "os/net.h"
+
+#define MOCK_MAX_TIMERS		512
+#define MOCK_MAX_TX_TS		64
+
+void mock_time_set(u64 now);
+u64 mock_time_get(void);
+
+/* Monotonic clocks follow the host clock instead of the simulated time (latency measurements) */
+void mock_clock_host_monotonic(bool enable);
+
+int mock_timer_next(u64 *expiry);
+void mock_timer_process(void);
+
+void mock_tx_ts_process(void);
+void mock_tx_hook_set(void (*func)(unsigned int port_id, struct net_tx_desc *desc));
+
+struct net_rx *mock_net_rx_get(unsigned int port_id);
+void mock_local_addr_set(const u8 *addr);
+
+#endif /* _GPTP_TEST_MOCK_H_ */
@@ -0,0 +1,396 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP tests, simulated link partner
+ @details
+ The link partner is a bridge (steps removed 1) with its own free running clock, relaying the time of
+ a different grandmaster on each domain. All times are derived from the simulated raw time (the local
+ clock of the stack, see mock.c):
+ - the link partner clock runs cfg->ppb faster than the local clock,
+ - each grandmaster time is offset by gm->offset and runs gm->ppb faster than the local clock,
+ - Sync messages are timestamped (and Follow_Up precise origin timestamps taken) when they leave
+   the link partner, and are received cfg->pdelay later,
+ - Pdelay_Req messages are answered cfg->resp_time after their receipt, with two-step responses.
+ All the event message timestamps (receipt by the stack, Pdelay timestamps of the link partner)
+ have a uniform noise of +/- cfg->jitter, and cfg->outlier_permil of them are off by cfg->outlier. Pdelay_Req messages are transmitted by the main gPTP thread
+ (CMLDS and domain 0 instance), so the transmit hook does not need to be thread safe.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/log.h"
+#include "common/net.h"
+#include "common/ptp.h"
+#include "common/ptp_time_ops.h"
+
+#include "mock.h"
+#include "peer.h"
+
+#define PEER_CLOCK_ID		0x00049ffffe00aa00ULL
+#define PEER_GM_CLOCK_ID	0x00049ffffe00bb00ULL
+#define PEER_GM_PRIORITY1	246
+#define PEER_TIME_SOURCE	0xa0	/* internal oscillator */
+
+struct peer_pdelay_resp {
+	u64 rx_time;	/* local time of receipt of the response by the stack */
+	u64 t2;		/* link partner time of receipt of the request */
+	u64 t3;		/* link partner time of transmission of the response */
+	struct ptp_hdr req_header;
+};
+
+struct peer_domain {
+	u64 next_sync;
+	u64 next_announce;
+	u16 sync_seq;
+	u16 announce_seq;
+	u16 signaling_seq;
+};
+
+static struct peer_config peer_cfg;
+static struct peer_domain peer_domains[CFG_MAX_GPTP_DOMAINS];
+static struct peer_pdelay_resp peer_resp[PEER_MAX_PDELAY_RESP];
+static unsigned int peer_resp_read, peer_resp_write;
+static struct peer_stats peer_stats;
+
+static u64 peer_interval(s8 log_interval)
+{
+	if (log_interval >= 0)
+		return (u64)NSECS_PER_SEC << log_interval;
+	else
+		return (u64)NSECS_PER_SEC >> -log_interval;
+}
+
+static s64 peer_jitter(void)
+{
+	s64 jitter = 0;
+
+	if (peer_cfg.jitter)
+		jitter = (s64)(rand_r(&peer_cfg.seed) % (2 * peer_cfg.jitter + 1)) - peer_cfg.jitter;
+
+	if (peer_cfg.outlier_permil && ((unsigned int)rand_r(&peer_cfg.seed) % 1000 < peer_cfg.outlier_permil))
+		jitter += peer_cfg.outlier;
+
+	return jitter;
+}
+
+static u64 peer_time(u64 local)
+{
+	return local + (s64)((double)(s64)(local - peer_cfg.start) * peer_cfg.ppb / 1.0e9);
+}
+
+u64 peer_gm_time(unsigned int domain, u64 local)
+{
+	struct peer_gm_config *gm = &peer_cfg.gm[domain];
+
+	return local + (s64)((double)(s64)(local - peer_cfg.start) * gm->ppb / 1.0e9) + gm->offset;
+}
+
+static void peer_header(struct ptp_hdr *hdr, u8 msg_type, u8 domain, u16 len, u16 sequence_id, s8 log_interval)
+{
+	u64 clock_id = htonll(PEER_CLOCK_ID);
+
+	memset(hdr, 0, sizeof(*hdr));
+
+	hdr->transport_specific = PTP_DOMAIN_MAJOR_SDOID;
+	hdr->msg_type = msg_type;
+	hdr->version_ptp = PTP_VERSION;
+	hdr->minor_version_ptp = PTP_MINOR_VERSION;
+	hdr->msg_length = htons(len);
+	hdr->domain_number = domain;
+	copy_64(hdr->source_port_id.clock_identity, &clock_id);
+	hdr->source_port_id.port_number = htons(1);
+	hdr->sequence_id = htons(sequence_id);
+	hdr->log_msg_interval = log_interval;
+}
+
+/* Hands a frame over to the stack, as received on port 0 with timestamp ts */
+static void peer_rx(void *pdu, unsigned int pdu_len, u64 ts)
+{
+	struct net_rx *rx = mock_net_rx_get(0);
+	struct net_rx_desc *desc;
+	struct eth_hdr *eth;
+	unsigned int len = sizeof(struct eth_hdr) + pdu_len;
+
+	if (!rx)
+		return;
+
+	desc = malloc(NET_DATA_OFFSET + len);
+	if (!desc)
+		return;
+
+	memset(desc, 0, sizeof(*desc));
+	desc->l2_offset = NET_DATA_OFFSET;
+	desc->l3_offset = NET_DATA_OFFSET + sizeof(struct eth_hdr);
+	desc->len = len;
+	desc->pool_type = POOL_TYPE_STD;
+	desc->port = 0;
+	desc->ethertype = ETHERTYPE_PTP;
+	desc->ts64 = ts;
+	desc->ts = (u32)ts;
+
+	eth = (struct eth_hdr *)NET_DATA_START(desc);
+	memset(eth, 0, sizeof(*eth));
+	eth->type = htons(ETHERTYPE_PTP);
+	memcpy((u8 *)eth + sizeof(struct eth_hdr), pdu, pdu_len);
+
+	rx->func(rx, desc);
+}
+
+static void peer_announce(unsigned int domain)
+{
+	struct peer_domain *d = &peer_domains[domain];
+	struct ptp_announce_pdu announce;
+	u64 gm_id = htonll(PEER_GM_CLOCK_ID + domain);
+	u64 clock_id = htonll(PEER_CLOCK_ID);
+	unsigned int len = sizeof(announce) - (MAX_PTLV_ENTRIES - 2) * sizeof(struct ptp_clock_identity);
+
+	peer_header(&announce.header, PTP_MSG_TYPE_ANNOUNCE, domain, len, d->announce_seq++, peer_cfg.log_announce_interval);
+	announce.header.flags = htons(PTP_FLAG_PTP_TIMESCALE);
+	announce.header.control = PTP_CONTROL_ANNOUNCE;
+
+	memset((u8 *)&announce + sizeof(announce.header), 0, sizeof(announce) - sizeof(announce.header));
+
+	announce.grandmaster_priority1 = PEER_GM_PRIORITY1;
+	announce.grandmaster_clock_quality.clock_class = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+	announce.grandmaster_clock_quality.clock_accuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+	announce.grandmaster_clock_quality.offset_scaled_log_variance = htons(CFG_GPTP_DEFAULT_CLOCK_VARIANCE);
+	announce.grandmaster_priority2 = CFG_GPTP_DEFAULT_PRIORITY2;
+	copy_64(announce.grandmaster_identity.identity, &gm_id);
+	announce.steps_removed = htons(1);
+	announce.time_source = PEER_TIME_SOURCE;
+
+	announce.ptlv.header.tlv_type = htons(PTP_TLV_TYPE_PATH_TRACE);
+	announce.ptlv.header.length_field = htons(2 * sizeof(struct ptp_clock_identity));
+	copy_64(announce.ptlv.path_sequence[0].identity, &gm_id);
+	copy_64(announce.ptlv.path_sequence[1].identity, &clock_id);
+
+	peer_rx(&announce, len, mock_time_get());
+
+	peer_stats.num_announce++;
+}
+
+/* gPTP capable TLV, required by the stack on all domains other than domain 0 (802.1AS-2020 - 10.6.4.4) */
+static void peer_gptp_capable(unsigned int domain)
+{
+	struct peer_domain *d = &peer_domains[domain];
+	struct ptp_signaling_pdu msg;
+
+	peer_header(&msg.header, PTP_MSG_TYPE_SIGNALING, domain, sizeof(msg), d->signaling_seq++, PTP_LOG_MSG_SIGNALING);
+	memset(&msg.target_port_identity, 0xff, sizeof(struct ptp_port_identity));
+
+	msg.tlv_type = htons(PTP_TLV_TYPE_ORGANIZATION_EXTENSION_DO_NOT_PROPAGATE);
+	msg.length_field = htons(12);
+	msg.organization_id[0] = 0x00;
+	msg.organization_id[1] = 0x80;
+	msg.organization_id[2] = 0xc2;
+	msg.organization_sub_type[0] = 0x00;
+	msg.organization_sub_type[1] = 0x00;
+	msg.organization_sub_type[2] = PTP_TLV_SUBTYPE_GPTP_CAPABLE_MESSAGE;
+	memset(&msg.u.ctlv, 0, sizeof(msg.u.ctlv));
+	msg.u.ctlv.log_gptp_capable_message_interval = peer_cfg.log_announce_interval;
+
+	peer_rx(&msg, sizeof(msg), mock_time_get());
+}
+
+static void peer_sync(unsigned int domain)
+{
+	struct peer_domain *d = &peer_domains[domain];
+	struct peer_gm_config *gm = &peer_cfg.gm[domain];
+	struct ptp_sync_pdu sync;
+	struct ptp_follow_up_pdu fup;
+	u64 rx_time = mock_time_get();
+	u64 tx_time = rx_time - peer_cfg.pdelay;
+	double rate_ratio;
+
+	peer_header(&sync.header, PTP_MSG_TYPE_SYNC, domain, sizeof(sync), d->sync_seq, peer_cfg.log_sync_interval);
+	sync.header.flags = htons((PTP_FLAG_TWO_STEP << 8));
+	sync.header.control = PTP_CONTROL_SYNC;
+	memset(&sync.timestamp, 0, sizeof(sync.timestamp));
+
+	peer_rx(&sync, sizeof(sync), rx_time + peer_jitter());
+
+	peer_header(&fup.header, PTP_MSG_TYPE_FOLLOW_UP, domain, sizeof(fup), d->sync_seq, peer_cfg.log_sync_interval);
+	fup.header.control = PTP_CONTROL_FOLLOW_UP;
+
+	/* grandmaster time when the Sync left the link partner (zero correction) */
+	u64_to_pdu_ptp_timestamp(&fup.precise_origin_timestamp, peer_gm_time(domain, tx_time));
+
+	/* grandmaster frequency relative to the link partner one */
+	rate_ratio = (1.0 + gm->ppb / 1.0e9) / (1.0 + peer_cfg.ppb / 1.0e9);
+
+	memset(&fup.tlv, 0, sizeof(fup.tlv));
+	fup.tlv.tlv_type = htons(PTP_TLV_TYPE_ORGANIZATION_EXTENSION);
+	fup.tlv.length_field = htons(sizeof(struct ptp_follow_up_tlv) - sizeof(struct ptp_tlv_header));
+	fup.tlv.organization_id[0] = 0x00;
+	fup.tlv.organization_id[1] = 0x80;
+	fup.tlv.organization_id[2] = 0xc2;
+	fup.tlv.organization_sub_type[2] = 0x01;
+	fup.tlv.cumulative_scaled_rate_offset = htonl((s32)((rate_ratio - 1.0) * (double)(1ULL << 41)));
+
+	peer_rx(&fup, sizeof(fup), rx_time);
+
+	d->sync_seq++;
+
+	peer_stats.num_sync++;
+}
+
+static void peer_pdelay_resp(struct peer_pdelay_resp *resp)
+{
+	struct ptp_pdelay_resp_pdu msg;
+	struct ptp_pdelay_resp_follow_up_pdu fup;
+	struct ptp_hdr *req = &resp->req_header;
+	u64 rx_ts = resp->rx_time + peer_jitter();
+
+	/* same transport (CMLDS or domain), domain and sequence ID as the request */
+	peer_header(&msg.header, PTP_MSG_TYPE_PDELAY_RESP, req->domain_number, sizeof(msg), ntohs(req->sequence_id), PTP_LOG_MSG_PDELAY_RESP);
+	msg.header.transport_specific = req->transport_specific;
+	msg.header.flags = htons((PTP_FLAG_TWO_STEP << 8));
+	msg.header.control = PTP_CONTROL_PDELAY_RESP;
+	u64_to_pdu_ptp_timestamp(&msg.request_receipt_timestamp, resp->t2);
+	memcpy(&msg.requesting_port_identity, &req->source_port_id, sizeof(struct ptp_port_identity));
+
+	peer_rx(&msg, sizeof(msg), rx_ts);
+
+	peer_header(&fup.header, PTP_MSG_TYPE_PDELAY_RESP_FUP, req->domain_number, sizeof(fup), ntohs(req->sequence_id), PTP_LOG_MSG_PDELAY_RESP);
+	fup.header.transport_specific = req->transport_specific;
+	fup.header.control = PTP_CONTROL_PDELAY_RESP_FUP;
+	u64_to_pdu_ptp_timestamp(&fup.response_origin_timestamp, resp->t3);
+	memcpy(&fup.requesting_port_identity, &req->source_port_id, sizeof(struct ptp_port_identity));
+
+	peer_rx(&fup, sizeof(fup), resp->rx_time);
+
+	peer_stats.num_pdelay_resp++;
+	peer_stats.pdelay_t3 = resp->t3;
+	peer_stats.pdelay_t4 = rx_ts;
+}
+
+/* Transmit hook, the frame leaves the local port at the current simulated time (see net_tx()) */
+static void peer_tx(unsigned int port_id, struct net_tx_desc *desc)
+{
+	struct ptp_hdr *hdr = (struct ptp_hdr *)((u8 *)NET_DATA_START(desc) + sizeof(struct eth_hdr));
+	struct peer_pdelay_resp *resp;
+	u64 req_rx_time, resp_tx_time;
+
+	if (port_id || (hdr->msg_type != PTP_MSG_TYPE_PDELAY_REQ))
+		return;
+
+	peer_stats.num_pdelay_req++;
+
+	if ((peer_resp_write - peer_resp_read) >= PEER_MAX_PDELAY_RESP)
+		return;
+
+	resp = &peer_resp[peer_resp_write & (PEER_MAX_PDELAY_RESP - 1)];
+
+	req_rx_time = mock_time_get() + peer_cfg.pdelay;
+	resp_tx_time = req_rx_time + peer_cfg.resp_time;
+
+	resp->t2 = peer_time(req_rx_time) + peer_jitter();
+	resp->t3 = peer_time(resp_tx_time) + peer_jitter();
+	resp->rx_time = resp_tx_time + peer_cfg.pdelay;
+	memcpy(&resp->req_header, hdr, sizeof(struct ptp_hdr));
+
+	peer_resp_write++;
+}
+
+/** Returns the simulated time of the next message sent by the link partner
+ * \return	0 on success, -1 if there is no message to send
+ * \param expiry	pointer to the time of the next message
+ */
+int peer_next(u64 *expiry)
+{
+	unsigned int i;
+	u64 next = peer_cfg.start;
+	bool found = false;
+
+	if (peer_resp_read != peer_resp_write) {
+		next = peer_resp[peer_resp_read & (PEER_MAX_PDELAY_RESP - 1)].rx_time;
+		found = true;
+	}
+
+	for (i = 0; i < peer_cfg.domains; i++) {
+		if (!found || (peer_domains[i].next_sync < next))
+			next = peer_domains[i].next_sync;
+
+		if (peer_domains[i].next_announce < next)
+			next = peer_domains[i].next_announce;
+
+		found = true;
+	}
+
+	if (!found)
+		return -1;
+
+	*expiry = next;
+
+	return 0;
+}
+
+/** Sends the link partner messages due at the current simulated time
+ * \return	none
+ */
+void peer_process(void)
+{
+	u64 now = mock_time_get();
+	struct peer_pdelay_resp *resp;
+	unsigned int i;
+
+	while (peer_resp_read != peer_resp_write) {
+		resp = &peer_resp[peer_resp_read & (PEER_MAX_PDELAY_RESP - 1)];
+
+		if (resp->rx_time > now)
+			break;
+
+		peer_pdelay_resp(resp);
+		peer_resp_read++;
+	}
+
+	for (i = 0; i < peer_cfg.domains; i++) {
+		struct peer_domain *d = &peer_domains[i];
+
+		if (d->next_announce <= now) {
+			peer_announce(i);
+			peer_gptp_capable(i);
+			d->next_announce += peer_interval(peer_cfg.log_announce_interval);
+		}
+
+		if (d->next_sync <= now) {
+			peer_sync(i);
+			d->next_sync += peer_interval(peer_cfg.log_sync_interval);
+		}
+	}
+}
+
+struct peer_stats *peer_stats_get(void)
+{
+	return &peer_stats;
+}
+
+void peer_init(struct peer_config *cfg)
+{
+	unsigned int i;
+
+	peer_cfg = *cfg;
+
+	if (peer_cfg.domains > CFG_MAX_GPTP_DOMAINS)
+		peer_cfg.domains = CFG_MAX_GPTP_DOMAINS;
+
+	memset(peer_domains, 0, sizeof(peer_domains));
+	memset(&peer_stats, 0, sizeof(peer_stats));
+	peer_resp_read = peer_resp_write = 0;
+
+	/* messages of the different domains a few microseconds apart */
+	for (i = 0; i < peer_cfg.domains; i++) {
+		peer_domains[i].next_sync = peer_cfg.start + i * 10000;
+		peer_domains[i].next_announce = peer_cfg.start + i * 10000 + 5000;
+	}
+
+	mock_tx_hook_set(peer_tx);
+}
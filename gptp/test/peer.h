@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP tests, simulated link partner
+ @details
+ Time-aware bridge connected to port 0 of the gPTP stack under test, on top of the simulated services
+ (see mock.h). It relays the time of one grandmaster per domain (Announce, Sync and Follow_Up messages)
+ and answers the Pdelay_Req messages of the stack (instance specific peer delay and CMLDS).
+*/
+
+#ifndef _GPTP_TEST_PEER_H_
+#define _GPTP_TEST_PEER_H_
+
+#include "common/types.h"
+#include "gptp/config.h"
+
+#define PEER_MAX_PDELAY_RESP	8
+
+struct peer_gm_config {
+	s64 offset;		/* grandmaster time - local time, at the start time */
+	s32 ppb;		/* grandmaster frequency offset from the local clock */
+};
+
+struct peer_config {
+	u64 start;		/* simulated time of the first Sync/Announce messages */
+	unsigned int domains;	/* domains 0 to domains - 1 have a grandmaster */
+	s32 ppb;		/* link partner frequency offset from the local clock */
+	u32 pdelay;		/* link propagation delay, in ns */
+	u32 jitter;		/* amplitude of the uniform timestamp noise (+/-), in ns */
+	u32 outlier;		/* timestamp error of outliers, in ns */
+	unsigned int outlier_permil;	/* outlier probability, per thousand timestamps */
+	u32 resp_time;		/* Pdelay_Req receipt to Pdelay_Resp transmission, in ns */
+	s8 log_sync_interval;
+	s8 log_announce_interval;
+	unsigned int seed;
+	struct peer_gm_config gm[CFG_MAX_GPTP_DOMAINS];
+};
+
+struct peer_stats {
+	unsigned int num_sync;
+	unsigned int num_announce;
+	unsigned int num_pdelay_req;
+	unsigned int num_pdelay_resp;
+	u64 pdelay_t3;		/* timestamps of the last Pdelay exchange, as seen by the stack */
+	u64 pdelay_t4;
+};
+
+void peer_init(struct peer_config *cfg);
+u64 peer_gm_time(unsigned int domain, u64 local);
+int peer_next(u64 *expiry);
+void peer_process(void);
+struct peer_stats *peer_stats_get(void);
+
+#endif /* _GPTP_TEST_PEER_H_ */
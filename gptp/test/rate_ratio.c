@@ -0,0 +1,240 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP neighbor rate ratio estimation test
+ @details
+ The gPTP stack runs as a standard profile endpoint against the simulated services of the replay tool
+ (see mock.c), port 0 being connected to a simulated link partner (see peer.c) whose clock runs
+ TEST_PEER_PPB faster than the local one. The link partner timestamps have a uniform noise of
+ +/- TEST_JITTER ns, and TEST_OUTLIER_PERMIL per thousand of them are off by TEST_OUTLIER ns.
+ For each estimator window, the neighbor rate ratio is sampled after each of the TEST_EXCHANGES Pdelay
+ exchanges (the first window worth of exchanges being ignored), and compared to the real one:
+ - with a window of 2, the estimation must be the standard two-point ratio of the last two (t3, t4)
+   timestamp pairs,
+ - with the largest window, the standard deviation of the error must be less than a quarter of the
+   two-point one, its mean below TEST_MAX_MEAN_PPB, and the outliers must have been detected.
+ The mean and standard deviation of the error are reported for each window.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/ptp.h"
+
+#include "gptp/gptp.h"
+#include "gptp/gptp_entry.h"
+
+#include "mock.h"
+#include "peer.h"
+
+#define TEST_EXCHANGES		1000
+#define TEST_PEER_PPB		50
+#define TEST_JITTER		8
+#define TEST_OUTLIER		500
+#define TEST_OUTLIER_PERMIL	10
+#define TEST_MAX_MEAN_PPB	5.0
+#define TEST_START_TIME		(1000 * (u64)NSECS_PER_SEC)
+
+struct test_result {
+	unsigned int window;
+	unsigned int n;
+	double mean;
+	double std;
+	unsigned int outliers;
+	unsigned int two_point_errors;
+};
+
+static struct fgptp_config cfg;
+
+static void test_config_init(unsigned int window, u64 start)
+{
+	struct fgptp_port_config *port_cfg = &cfg.port_cfg[0];
+	struct peer_config peer_cfg;
+	int i;
+
+	memset(&cfg, 0, sizeof(cfg));
+
+	cfg.log_level = LOG_ERR;
+	cfg.is_bridge = 0;
+	cfg.profile = CFG_GPTP_PROFILE_STANDARD;
+	cfg.domain_max = CFG_MAX_GPTP_DOMAINS;
+	cfg.port_max = 1;
+	cfg.clock_local = OS_CLOCK_LOCAL_EP_0;
+	cfg.gm_id = htonll(CFG_GPTP_DEFAULT_GM_ID);
+	cfg.neighborPropDelayThreshold = CFG_GPTP_NEIGH_THRESH_DEFAULT;
+	cfg.neighborRateRatioWindow = window;
+	cfg.neighborPropDelay_mode = CFG_GPTP_PDELAY_MODE_STATIC;
+	cfg.neighborPropDelay_sensitivity = CFG_GPTP_DEFAULT_PDELAY_SENSITIVITY;
+
+	cfg.logical_port_list[0] = 0;
+	cfg.initial_neighborPropDelay[0] = CFG_GPTP_DEFAULT_PDELAY_VALUE;
+
+	port_cfg->portRole = SLAVE_PORT;
+	port_cfg->ptpPortEnabled = CFG_GPTP_DEFAULT_PTP_ENABLED;
+	port_cfg->initialLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+	port_cfg->initialLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+	port_cfg->initialLogAnnounceInterval = CFG_GPTP_DFLT_LOG_ANNOUNCE_INTERVAL;
+	port_cfg->operLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+	port_cfg->operLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+	port_cfg->allowedLostResponses = CFG_GPTP_DFLT_ALLOWED_LOST_RESP_2020;
+	port_cfg->allowedFaults = CFG_GPTP_DFLT_ALLOWED_FAULTS;
+
+	/* single domain */
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		struct fgptp_domain_config *domain_cfg = &cfg.domain_cfg[i];
+
+		port_cfg->delayMechanism[i] = i ? COMMON_P2P : P2P;
+
+		domain_cfg->domain_number = i ? -1 : 0;
+		domain_cfg->clock_target = OS_CLOCK_GPTP_EP_0_0 + i;
+		domain_cfg->clock_source = domain_cfg->clock_target;
+		domain_cfg->gmCapable = CFG_GPTP_DEFAULT_GM_CAPABLE;
+		domain_cfg->priority1 = CFG_GPTP_DEFAULT_PRIORITY1;
+		domain_cfg->priority2 = CFG_GPTP_DEFAULT_PRIORITY2;
+		domain_cfg->clockClass = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+		domain_cfg->clockAccuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+		domain_cfg->offsetScaledLogVariance = CFG_GPTP_DEFAULT_CLOCK_VARIANCE;
+	}
+
+	/* link partner only answering Pdelay_Req messages, with the same trace for all the windows */
+	memset(&peer_cfg, 0, sizeof(peer_cfg));
+
+	peer_cfg.start = start;
+	peer_cfg.ppb = TEST_PEER_PPB;
+	peer_cfg.pdelay = 100;
+	peer_cfg.jitter = TEST_JITTER;
+	peer_cfg.outlier = TEST_OUTLIER;
+	peer_cfg.outlier_permil = TEST_OUTLIER_PERMIL;
+	peer_cfg.resp_time = 100000;
+	peer_cfg.seed = 1;
+
+	peer_init(&peer_cfg);
+}
+
+static int test_run(unsigned int window, struct test_result *result)
+{
+	struct gptp_ctx *gptp;
+	struct gptp_port_common *c;
+	struct peer_stats *peer_stats = peer_stats_get();
+	double ratio, expected_ratio, error, sum = 0, sum2 = 0;
+	u64 start = mock_time_get(), next, t;
+	u64 prev_t3 = 0, prev_t4 = 0;
+	unsigned int exchanges = 0;
+
+	test_config_init(window, start);
+
+	gptp = gptp_init(&cfg, 0);
+	if (!gptp) {
+		printf("window %u: gPTP initialization failed\n", window);
+		return -1;
+	}
+
+	c = gptp->instances[0]->ports[0].c;
+
+	/* the link partner clock runs TEST_PEER_PPB faster */
+	expected_ratio = 1.0 + TEST_PEER_PPB / 1.0e9;
+
+	memset(result, 0, sizeof(*result));
+	result->window = window;
+
+	while (exchanges < TEST_EXCHANGES) {
+		next = mock_time_get() + NSECS_PER_SEC;
+
+		if (!peer_next(&t) && (t < next))
+			next = t;
+
+		if (!mock_timer_next(&t) && (t < next))
+			next = t;
+
+		mock_time_set(next);
+
+		mock_timer_process();
+
+		peer_process();
+
+		mock_tx_ts_process();
+
+		if (peer_stats->num_pdelay_resp == exchanges)
+			continue;
+
+		exchanges = peer_stats->num_pdelay_resp;
+
+		if ((window == 2) && prev_t3) {
+			ratio = (double)(s64)(peer_stats->pdelay_t3 - prev_t3) / (double)(s64)(peer_stats->pdelay_t4 - prev_t4);
+
+			if (fabs(c->params.neighbor_rate_ratio - ratio) > 1e-12)
+				result->two_point_errors++;
+		}
+
+		prev_t3 = peer_stats->pdelay_t3;
+		prev_t4 = peer_stats->pdelay_t4;
+
+		if (exchanges <= window)
+			continue;
+
+		error = (c->params.neighbor_rate_ratio - expected_ratio) * 1e9;
+		sum += error;
+		sum2 += error * error;
+		result->n++;
+	}
+
+	result->mean = sum / result->n;
+	result->std = sqrt(sum2 / result->n - result->mean * result->mean);
+	result->outliers = c->stats.num_rate_ratio_outliers;
+
+	printf("window %2u: %u exchanges, rate ratio error (ppb) mean %6.2f std %6.2f, %u outliers rejected\n",
+		window, result->n, result->mean, result->std, result->outliers);
+
+	gptp_exit(gptp);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int windows[] = {2, 8, CFG_GPTP_RATE_RATIO_WINDOW_MAX};
+	struct test_result results[3];
+	struct test_result *two_point = &results[0], *largest = &results[2];
+	int i;
+
+	log_level_set(common_COMPONENT_ID, LOG_CRIT);
+	log_level_set(os_COMPONENT_ID, LOG_ERR);
+
+	mock_time_set(TEST_START_TIME);
+
+	for (i = 0; i < 3; i++)
+		if (test_run(windows[i], &results[i]) < 0)
+			goto fail;
+
+	if (two_point->two_point_errors) {
+		printf("window 2: %u estimations differ from the two-point ratio\n", two_point->two_point_errors);
+		goto fail;
+	}
+
+	if ((largest->std >= two_point->std / 4) || (fabs(largest->mean) > TEST_MAX_MEAN_PPB) || !largest->outliers) {
+		printf("window %u: std %.2f ppb (two-point %.2f ppb), mean %.2f ppb, %u outliers\n", largest->window,
+			largest->std, two_point->std, largest->mean, largest->outliers);
+		goto fail;
+	}
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
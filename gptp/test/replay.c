@@ -0,0 +1,769 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief gPTP offline replay
+ @details
+ Runs the gPTP stack against packet captures (one pcap file per port) instead of live network
+ interfaces. The capture time of each frame is used as its receive hardware timestamp and as the
+ simulated time, so a replay is deterministic and runs as fast as the stack can process the frames.
+ The stack output (BMCA role changes, grandmaster changes, synchronization state and the periodic
+ statistics, including the offset to the grandmaster) is logged as usual, the CPU time spent to
+ process each received message type is measured and reported at the end of the replay.
+
+ Frames transmitted by the stack are timestamped at the current simulated time and can be saved
+ to a pcap file. Nothing answers them, so the peer delay can't be measured from a capture: use
+ the automotive profile (static neighborPropDelay) to analyze the synchronization of a slave port.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "common/types.h"
+#include "common/log.h"
+#include "common/net.h"
+#include "common/ptp.h"
+#include "common/stats.h"
+
+#include "gptp/gptp_entry.h"
+
+#include "mock.h"
+
+#define PCAP_MAGIC_US		0xa1b2c3d4
+#define PCAP_MAGIC_NS		0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET	1
+
+#define REPLAY_MSG_TYPES	16 /* PTP messageType is a 4 bits field */
+
+struct pcap_file_hdr {
+	u32 magic;
+	u16 version_major;
+	u16 version_minor;
+	s32 thiszone;
+	u32 sigfigs;
+	u32 snaplen;
+	u32 linktype;
+};
+
+struct pcap_rec_hdr {
+	u32 ts_sec;
+	u32 ts_frac;
+	u32 incl_len;
+	u32 orig_len;
+};
+
+struct replay_port {
+	const char *file_name;
+	FILE *f;
+	bool swapped;
+	bool nsec;
+
+	/* next frame to replay */
+	bool pending;
+	u64 ts;
+	unsigned int len;
+	u8 frame[DEFAULT_NET_DATA_SIZE];
+
+	unsigned int num_frames;
+	unsigned int num_rx;
+	unsigned int num_skipped;
+};
+
+struct replay_ctx {
+	struct fgptp_config cfg;
+	os_clock_id_t clock_log;
+
+	unsigned int port_max;
+	struct replay_port port[CFG_MAX_NUM_PORT];
+
+	FILE *tx_file;
+
+	u64 start_time;
+	unsigned int num_gm_changes;
+	unsigned int num_sync_changes;
+	unsigned int num_tx[REPLAY_MSG_TYPES];
+	struct stats rx_cost[REPLAY_MSG_TYPES];
+};
+
+static struct replay_ctx replay;
+
+static const char *replay_msg_type_str[REPLAY_MSG_TYPES] = {
+	[PTP_MSG_TYPE_SYNC] = "Sync",
+	[PTP_MSG_TYPE_DELAY_REQ] = "Delay_Req",
+	[PTP_MSG_TYPE_PDELAY_REQ] = "Pdelay_Req",
+	[PTP_MSG_TYPE_PDELAY_RESP] = "Pdelay_Resp",
+	[PTP_MSG_TYPE_FOLLOW_UP] = "Follow_Up",
+	[PTP_MSG_TYPE_DELAY_RESP] = "Delay_Resp",
+	[PTP_MSG_TYPE_PDELAY_RESP_FUP] = "Pdelay_Resp_Follow_Up",
+	[PTP_MSG_TYPE_ANNOUNCE] = "Announce",
+	[PTP_MSG_TYPE_SIGNALING] = "Signaling",
+	[PTP_MSG_TYPE_MANAGEMENT] = "Management",
+};
+
+static const char *msg_type2string(unsigned int msg_type)
+{
+	if (replay_msg_type_str[msg_type])
+		return replay_msg_type_str[msg_type];
+
+	return "Unknown";
+}
+
+static void print_usage(void)
+{
+	printf("\nUsage:\n gptp-replay [options] <port 0 pcap file> [<port 1 pcap file> ...]\n");
+	printf("\nOptions:\n"
+		"\t-p <profile>                 gPTP profile: standard or automotive (default: %s)\n"
+		"\t-r <role>[,<role>...]        automotive profile, static role of each port: master, slave or disabled (default: slave for port 0, master for the others)\n"
+		"\t-g <gm id>                   automotive profile, static grandmaster clock identity (default: 0x%"PRIx64")\n"
+		"\t-d <pdelay>                  automotive profile, static neighborPropDelay in ns (default: %u)\n"
+		"\t-s <interval>                statistics interval in seconds, 0 to disable (default: %u)\n"
+		"\t-l <level>                   gPTP log level: crit, err, init, info or dbg (default: %s)\n"
+		"\t-m <mac address>             local MAC address of port 0, frames captured from this address are not replayed (default: 00:04:9f:00:00:00)\n"
+		"\t-w <pcap file>               save the frames transmitted by the stack\n"
+		"\t-h                           print this help text\n",
+		CFG_GPTP_DEFAULT_PROFILE_NAME, (u64)CFG_GPTP_DEFAULT_GM_ID, CFG_GPTP_DEFAULT_PDELAY_VALUE,
+		CFG_GPTP_STATS_INTERVAL_DEFAULT, CFG_GPTP_DEFAULT_LOG_LEVEL);
+}
+
+/*
+ * Packet captures
+ */
+
+static u32 pcap_u32(struct replay_port *port, u32 val)
+{
+	return port->swapped ? __builtin_bswap32(val) : val;
+}
+
+static int pcap_open(struct replay_port *port)
+{
+	struct pcap_file_hdr hdr;
+
+	port->f = fopen(port->file_name, "r");
+	if (!port->f) {
+		printf("cannot open %s: %s\n", port->file_name, strerror(errno));
+		goto err_open;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, port->f) != 1) {
+		printf("%s: cannot read pcap header\n", port->file_name);
+		goto err;
+	}
+
+	switch (hdr.magic) {
+	case PCAP_MAGIC_US:
+	case PCAP_MAGIC_NS:
+		port->swapped = false;
+		break;
+
+	case __builtin_bswap32(PCAP_MAGIC_US):
+	case __builtin_bswap32(PCAP_MAGIC_NS):
+		port->swapped = true;
+		break;
+
+	default:
+		printf("%s: not a pcap file (magic 0x%08x)\n", port->file_name, hdr.magic);
+		goto err;
+	}
+
+	port->nsec = (pcap_u32(port, hdr.magic) == PCAP_MAGIC_NS);
+
+	if (pcap_u32(port, hdr.linktype) != PCAP_LINKTYPE_ETHERNET) {
+		printf("%s: unsupported link type %u\n", port->file_name, pcap_u32(port, hdr.linktype));
+		goto err;
+	}
+
+	return 0;
+
+err:
+	fclose(port->f);
+	port->f = NULL;
+
+err_open:
+	return -1;
+}
+
+/* Reads the next frame of the capture, frames larger than the network buffers are skipped */
+static void pcap_read(struct replay_port *port)
+{
+	struct pcap_rec_hdr rec;
+	u32 len;
+
+	port->pending = false;
+
+	while (fread(&rec, sizeof(rec), 1, port->f) == 1) {
+		len = pcap_u32(port, rec.incl_len);
+
+		if (len > DEFAULT_NET_DATA_SIZE) {
+			if (fseek(port->f, len, SEEK_CUR) < 0)
+				break;
+
+			port->num_frames++;
+			port->num_skipped++;
+			continue;
+		}
+
+		if (fread(port->frame, len, 1, port->f) != 1)
+			break;
+
+		port->ts = (u64)pcap_u32(port, rec.ts_sec) * NSECS_PER_SEC;
+		if (port->nsec)
+			port->ts += pcap_u32(port, rec.ts_frac);
+		else
+			port->ts += (u64)pcap_u32(port, rec.ts_frac) * 1000;
+
+		port->len = len;
+		port->pending = true;
+		port->num_frames++;
+
+		break;
+	}
+}
+
+static int pcap_write_open(const char *file_name)
+{
+	struct pcap_file_hdr hdr = {
+		.magic = PCAP_MAGIC_NS,
+		.version_major = 2,
+		.version_minor = 4,
+		.snaplen = DEFAULT_NET_DATA_SIZE,
+		.linktype = PCAP_LINKTYPE_ETHERNET,
+	};
+
+	replay.tx_file = fopen(file_name, "w");
+	if (!replay.tx_file) {
+		printf("cannot open %s: %s\n", file_name, strerror(errno));
+		return -1;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, replay.tx_file) != 1) {
+		printf("%s: cannot write pcap header\n", file_name);
+		fclose(replay.tx_file);
+		replay.tx_file = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void pcap_write(unsigned int port_id, u8 *frame, unsigned int len)
+{
+	struct eth_hdr *eth = (struct eth_hdr *)frame;
+	struct pcap_rec_hdr rec;
+	u64 now = mock_time_get();
+
+	/* the source address is normally added by the network layer */
+	net_get_local_addr(port_id, eth->src);
+
+	rec.ts_sec = now / NSECS_PER_SEC;
+	rec.ts_frac = now % NSECS_PER_SEC;
+	rec.incl_len = len;
+	rec.orig_len = len;
+
+	if ((fwrite(&rec, sizeof(rec), 1, replay.tx_file) != 1) || (fwrite(frame, len, 1, replay.tx_file) != 1))
+		os_log(LOG_ERR, "cannot write transmitted frame\n");
+}
+
+/*
+ * Stack interface
+ */
+
+static void replay_tx(unsigned int port_id, struct net_tx_desc *desc)
+{
+	u8 *frame = NET_DATA_START(desc);
+	struct ptp_hdr *hdr = (struct ptp_hdr *)(frame + sizeof(struct eth_hdr));
+
+	replay.num_tx[hdr->msg_type]++;
+
+	if (replay.tx_file)
+		pcap_write(port_id, frame, desc->len);
+}
+
+static void replay_net_rx(struct replay_port *port, unsigned int port_id)
+{
+	struct net_rx *rx = mock_net_rx_get(port_id);
+	struct net_rx_desc *desc;
+	struct eth_hdr *eth = (struct eth_hdr *)port->frame;
+	struct vlanhdr *vlan;
+	struct ptp_hdr *hdr;
+	struct timespec start, end;
+	unsigned int l3_offset;
+	u16 ethertype, vid;
+	u8 local_addr[6];
+
+	if (!rx)
+		goto skip;
+
+	if (port->len < sizeof(struct eth_hdr) + sizeof(struct vlanhdr))
+		goto skip;
+
+	/* frames sent by the capturing host itself */
+	net_get_local_addr(port_id, local_addr);
+	if (!memcmp(eth->src, local_addr, 6))
+		goto skip;
+
+	if (eth->type == htons(ETHERTYPE_VLAN)) {
+		vlan = (struct vlanhdr *)(eth + 1);
+		ethertype = ntohs(vlan->type);
+		vid = VLAN_VID(vlan);
+		l3_offset = sizeof(struct eth_hdr) + sizeof(struct vlanhdr);
+	} else {
+		ethertype = ntohs(eth->type);
+		vid = 0;
+		l3_offset = sizeof(struct eth_hdr);
+	}
+
+	if ((ethertype != ETHERTYPE_PTP) || (l3_offset + sizeof(struct ptp_hdr) > port->len))
+		goto skip;
+
+	desc = malloc(NET_DATA_OFFSET + port->len);
+	if (!desc)
+		goto skip;
+
+	memset(desc, 0, sizeof(*desc));
+	desc->l2_offset = NET_DATA_OFFSET;
+	desc->l3_offset = NET_DATA_OFFSET + l3_offset;
+	desc->len = port->len;
+	desc->pool_type = POOL_TYPE_STD;
+	desc->port = port_id;
+	desc->ethertype = ethertype;
+	desc->vid = vid;
+	desc->ts64 = port->ts;
+	desc->ts = (u32)port->ts;
+	memcpy(NET_DATA_START(desc), port->frame, port->len);
+
+	hdr = (struct ptp_hdr *)(port->frame + l3_offset);
+
+	port->num_rx++;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	rx->func(rx, desc);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	stats_update(&replay.rx_cost[hdr->msg_type], (end.tv_sec - start.tv_sec) * NSECS_PER_SEC + (end.tv_nsec - start.tv_nsec));
+
+	return;
+
+skip:
+	port->num_skipped++;
+}
+
+static void sync_indication_handler(struct gptp_sync_info *info)
+{
+	replay.num_sync_changes++;
+
+	os_log(LOG_INFO, "port(%u) domain(%u) %s\n", info->port_id, info->domain, PTP_SYNC_STATE(info->state));
+}
+
+static void gm_indication_handler(struct gptp_gm_info *info)
+{
+	replay.num_gm_changes++;
+}
+
+static void pdelay_indication_handler(struct gptp_pdelay_info *info)
+{
+	os_log(LOG_INFO, "port(%u) computed PDelay (ns) is %.2f\n", info->port_id, info->pdelay);
+}
+
+/*
+ * Configuration, same defaults as the gPTP configuration files
+ */
+
+static void replay_config_init(struct fgptp_config *cfg, unsigned int port_max)
+{
+	int i, j;
+
+	memset(cfg, 0, sizeof(*cfg));
+
+	cfg->log_level = LOG_INFO;
+	cfg->is_bridge = (port_max > 1);
+	cfg->profile = CFG_GPTP_PROFILE_STANDARD;
+	cfg->domain_max = CFG_MAX_GPTP_DOMAINS;
+	cfg->port_max = port_max;
+	cfg->management_enabled = 0;
+	cfg->clock_local = cfg->is_bridge ? OS_CLOCK_LOCAL_BR_0 : OS_CLOCK_LOCAL_EP_0;
+
+	cfg->gm_id = htonll(CFG_GPTP_DEFAULT_GM_ID);
+	cfg->neighborPropDelayThreshold = CFG_GPTP_NEIGH_THRESH_DEFAULT;
+	cfg->rsync = CFG_GPTP_RSYNC_ENABLE_DEFAULT;
+	cfg->rsync_interval = CFG_GPTP_RSYNC_INTERVAL_DEFAULT;
+	cfg->statsInterval = CFG_GPTP_STATS_INTERVAL_DEFAULT;
+	cfg->neighborRateRatioWindow = CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT;
+
+	cfg->neighborPropDelay_mode = CFG_GPTP_PDELAY_MODE_STATIC;
+	cfg->neighborPropDelay_sensitivity = CFG_GPTP_DEFAULT_PDELAY_SENSITIVITY;
+
+	cfg->sync_indication = sync_indication_handler;
+	cfg->gm_indication = gm_indication_handler;
+	cfg->pdelay_indication = pdelay_indication_handler;
+
+	for (i = 0; i < port_max; i++) {
+		struct fgptp_port_config *port_cfg = &cfg->port_cfg[i];
+
+		cfg->logical_port_list[i] = i;
+		cfg->initial_neighborPropDelay[i] = CFG_GPTP_DEFAULT_PDELAY_VALUE;
+
+		port_cfg->portRole = i ? MASTER_PORT : SLAVE_PORT;
+		port_cfg->ptpPortEnabled = CFG_GPTP_DEFAULT_PTP_ENABLED;
+		port_cfg->rxDelayCompensation = CFG_GPTP_DEFAULT_RX_DELAY_COMP;
+		port_cfg->txDelayCompensation = CFG_GPTP_DEFAULT_TX_DELAY_COMP;
+		port_cfg->initialLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+		port_cfg->initialLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+		port_cfg->initialLogAnnounceInterval = CFG_GPTP_DFLT_LOG_ANNOUNCE_INTERVAL;
+		port_cfg->operLogPdelayReqInterval = CFG_GPTP_DFLT_LOG_PDELAY_REQ_INTERVAL;
+		port_cfg->operLogSyncInterval = CFG_GPTP_DFLT_LOG_SYNC_INTERVAL;
+		port_cfg->allowedLostResponses = CFG_GPTP_DFLT_ALLOWED_LOST_RESP_2020;
+		port_cfg->allowedFaults = CFG_GPTP_DFLT_ALLOWED_FAULTS;
+
+		for (j = 0; j < CFG_MAX_GPTP_DOMAINS; j++)
+			port_cfg->delayMechanism[j] = j ? COMMON_P2P : P2P;
+	}
+
+	/* single domain */
+	for (i = 0; i < CFG_MAX_GPTP_DOMAINS; i++) {
+		struct fgptp_domain_config *domain_cfg = &cfg->domain_cfg[i];
+
+		domain_cfg->domain_number = i ? -1 : 0;
+		domain_cfg->clock_target = (cfg->is_bridge ? OS_CLOCK_GPTP_BR_0_0 : OS_CLOCK_GPTP_EP_0_0) + i;
+		domain_cfg->clock_source = domain_cfg->clock_target;
+		domain_cfg->gmCapable = CFG_GPTP_DEFAULT_GM_CAPABLE;
+		domain_cfg->priority1 = CFG_GPTP_DEFAULT_PRIORITY1;
+		domain_cfg->priority2 = CFG_GPTP_DEFAULT_PRIORITY2;
+		domain_cfg->clockClass = CFG_GPTP_DEFAULT_CLOCK_CLASS;
+		domain_cfg->clockAccuracy = CFG_GPTP_DEFAULT_CLOCK_ACCURACY;
+		domain_cfg->offsetScaledLogVariance = CFG_GPTP_DEFAULT_CLOCK_VARIANCE;
+	}
+}
+
+static int replay_config_roles(struct fgptp_config *cfg, char *roles)
+{
+	char *role, *saveptr;
+	int i = 0;
+
+	for (role = strtok_r(roles, ",", &saveptr); role; role = strtok_r(NULL, ",", &saveptr)) {
+		if (i >= CFG_MAX_NUM_PORT)
+			return -1;
+
+		if (!strcasecmp(role, "master"))
+			cfg->port_cfg[i].portRole = MASTER_PORT;
+		else if (!strcasecmp(role, "slave"))
+			cfg->port_cfg[i].portRole = SLAVE_PORT;
+		else if (!strcasecmp(role, "disabled"))
+			cfg->port_cfg[i].portRole = DISABLED_PORT;
+		else
+			return -1;
+
+		i++;
+	}
+
+	return 0;
+}
+
+static int log_string2level(const char *s)
+{
+	int level;
+
+	for (level = LOG_CRIT; level <= LOG_DEBUG; level++) {
+		if (!strcasecmp(s, log_lvl_string[level]))
+			return level;
+	}
+
+	return -1;
+}
+
+static int parse_mac(const char *s, u8 *mac)
+{
+	unsigned int b[6];
+	int i;
+
+	if (sscanf(s, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6)
+		return -1;
+
+	for (i = 0; i < 6; i++) {
+		if (b[i] > 0xff)
+			return -1;
+
+		mac[i] = b[i];
+	}
+
+	return 0;
+}
+
+/*
+ * Replay
+ */
+
+/* Returns the port with the earliest pending frame, -1 at the end of the captures */
+static int replay_next_port(void)
+{
+	int i, next = -1;
+
+	for (i = 0; i < replay.port_max; i++) {
+		if (replay.port[i].pending && ((next < 0) || (replay.port[i].ts < replay.port[next].ts)))
+			next = i;
+	}
+
+	return next;
+}
+
+/* Advances the simulated time from event to event (frame reception or timer expiration) until the end of the captures */
+static void replay_run(void)
+{
+	struct replay_port *port;
+	int port_id;
+	u64 expiry;
+
+	while (1) {
+		/* transmit timestamps are reported after the transmit call returns */
+		mock_tx_ts_process();
+
+		port_id = replay_next_port();
+		if (port_id < 0)
+			break;
+
+		port = &replay.port[port_id];
+
+		if (!mock_timer_next(&expiry) && (expiry <= port->ts)) {
+			mock_time_set(expiry);
+			log_update_time(replay.clock_log);
+
+			mock_timer_process();
+		} else {
+			mock_time_set(port->ts);
+			log_update_time(replay.clock_log);
+
+			replay_net_rx(port, port_id);
+
+			pcap_read(port);
+		}
+	}
+}
+
+static void replay_report(void)
+{
+	struct replay_port *port;
+	struct stats *rx_cost;
+	u64 duration = mock_time_get() - replay.start_time;
+	int i;
+
+	os_log(LOG_INFO_RAW, "\nReplayed %"PRIu64".%03"PRIu64" s of capture, grandmaster changes: %u, synchronization state changes: %u\n",
+		duration / NSECS_PER_SEC, (duration % NSECS_PER_SEC) / NSECS_PER_MS, replay.num_gm_changes, replay.num_sync_changes);
+
+	for (i = 0; i < replay.port_max; i++) {
+		port = &replay.port[i];
+
+		os_log(LOG_INFO_RAW, "Port(%u): %s frames %u, replayed %u, skipped %u\n",
+			i, port->file_name, port->num_frames, port->num_rx, port->num_skipped);
+	}
+
+	os_log(LOG_INFO_RAW, "Receive processing cost (ns):\n");
+
+	for (i = 0; i < REPLAY_MSG_TYPES; i++) {
+		rx_cost = &replay.rx_cost[i];
+
+		if (!rx_cost->current_count)
+			continue;
+
+		stats_compute(rx_cost);
+
+		os_log(LOG_INFO_RAW, "%-24s min %8d avg %8d max %8d variance %8"PRIu64" count %u\n",
+			msg_type2string(i), rx_cost->min, rx_cost->mean, rx_cost->max, rx_cost->variance, rx_cost->current_count);
+	}
+
+	os_log(LOG_INFO_RAW, "Transmitted:\n");
+
+	for (i = 0; i < REPLAY_MSG_TYPES; i++) {
+		if (replay.num_tx[i])
+			os_log(LOG_INFO_RAW, "%-24s %u\n", msg_type2string(i), replay.num_tx[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct fgptp_config *cfg = &replay.cfg;
+	char *profile = CFG_GPTP_DEFAULT_PROFILE_NAME;
+	char *roles = NULL, *tx_file_name = NULL;
+	const char *log_level = CFG_GPTP_DEFAULT_LOG_LEVEL;
+	unsigned long long gm_id = CFG_GPTP_DEFAULT_GM_ID;
+	unsigned long pdelay = CFG_GPTP_DEFAULT_PDELAY_VALUE;
+	unsigned long stats_interval = CFG_GPTP_STATS_INTERVAL_DEFAULT;
+	u8 local_addr[6];
+	bool local_addr_set = false;
+	int port_id;
+	void *gptp;
+	int option, level;
+	int i, rc = 1;
+
+	while ((option = getopt(argc, argv, "p:r:g:d:s:l:m:w:h")) != -1) {
+		switch (option) {
+		case 'p':
+			profile = optarg;
+			break;
+
+		case 'r':
+			roles = optarg;
+			break;
+
+		case 'g':
+			gm_id = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'd':
+			pdelay = strtoul(optarg, NULL, 0);
+			break;
+
+		case 's':
+			stats_interval = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'l':
+			log_level = optarg;
+			break;
+
+		case 'm':
+			if (parse_mac(optarg, local_addr) < 0) {
+				printf("invalid -m %s option\n", optarg);
+				goto exit;
+			}
+
+			local_addr_set = true;
+			break;
+
+		case 'w':
+			tx_file_name = optarg;
+			break;
+
+		case 'h':
+		default:
+			print_usage();
+			goto exit;
+		}
+	}
+
+	replay.port_max = argc - optind;
+	if (!replay.port_max || (replay.port_max > CFG_MAX_NUM_PORT)) {
+		print_usage();
+		goto exit;
+	}
+
+	replay_config_init(cfg, replay.port_max);
+
+	if (!strcmp(profile, "automotive")) {
+		cfg->profile = CFG_GPTP_PROFILE_AUTOMOTIVE;
+	} else if (!strcmp(profile, "standard")) {
+		cfg->profile = CFG_GPTP_PROFILE_STANDARD;
+		cfg->gm_id = 0; /* will be determined by BMCA */
+	} else {
+		printf("invalid -p %s option\n", profile);
+		goto exit;
+	}
+
+	if (roles && (replay_config_roles(cfg, roles) < 0)) {
+		printf("invalid -r %s option\n", roles);
+		goto exit;
+	}
+
+	if (cfg->profile == CFG_GPTP_PROFILE_AUTOMOTIVE)
+		cfg->gm_id = htonll(gm_id);
+
+	if (pdelay > CFG_GPTP_DEFAULT_PDELAY_VALUE_MAX) {
+		printf("invalid -d %lu option\n", pdelay);
+		goto exit;
+	}
+
+	for (i = 0; i < replay.port_max; i++)
+		cfg->initial_neighborPropDelay[i] = pdelay;
+
+	if (stats_interval > CFG_GPTP_STATS_INTERVAL_MAX_DEFAULT) {
+		printf("invalid -s %lu option\n", stats_interval);
+		goto exit;
+	}
+
+	cfg->statsInterval = stats_interval;
+
+	level = log_string2level(log_level);
+	if (level < 0) {
+		printf("invalid -l %s option\n", log_level);
+		goto exit;
+	}
+
+	cfg->log_level = level;
+	log_level_set(common_COMPONENT_ID, level);
+	log_level_set(os_COMPONENT_ID, LOG_INFO);
+
+	if (local_addr_set)
+		mock_local_addr_set(local_addr);
+
+	for (i = 0; i < replay.port_max; i++) {
+		replay.port[i].file_name = argv[optind + i];
+
+		if (pcap_open(&replay.port[i]) < 0)
+			goto err_pcap;
+
+		pcap_read(&replay.port[i]);
+	}
+
+	if (tx_file_name && (pcap_write_open(tx_file_name) < 0))
+		goto err_pcap;
+
+	for (i = 0; i < REPLAY_MSG_TYPES; i++)
+		stats_init(&replay.rx_cost[i], 31, NULL, NULL);
+
+	mock_tx_hook_set(replay_tx);
+
+	/* the simulated time starts with the first captured frame */
+	port_id = replay_next_port();
+	if (port_id < 0) {
+		printf("no frame to replay\n");
+		goto err_empty;
+	}
+
+	replay.start_time = replay.port[port_id].ts;
+	mock_time_set(replay.start_time);
+
+	replay.clock_log = cfg->domain_cfg[0].clock_target;
+	log_update_time(replay.clock_log);
+
+	gptp = gptp_init(cfg, 0);
+	if (!gptp) {
+		printf("gptp_init() failed\n");
+		goto err_init;
+	}
+
+	replay_run();
+
+	gptp_stats_dump(gptp);
+
+	replay_report();
+
+	gptp_exit(gptp);
+
+	rc = 0;
+
+err_init:
+err_empty:
+	if (replay.tx_file)
+		fclose(replay.tx_file);
+
+err_pcap:
+	for (i = 0; i < replay.port_max; i++) {
+		if (replay.port[i].f)
+			fclose(replay.port[i].f);
+	}
+
+exit:
+	return rc;
+}
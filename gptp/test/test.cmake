@@ -0,0 +1,25 @@
+if(BUILD_GPTP_REPLAY)
+  # Offline gPTP replay, the gPTP core linked against simulated network/clock/timer services
+  add_executable(gptp-replay
+    ${CMAKE_CURRENT_LIST_DIR}/replay.c
+    ${CMAKE_CURRENT_LIST_DIR}/mock.c
+    ${TOPDIR}/linux/log.c
+    ${TOPDIR}/linux/stdlib.c
+    ${TOPDIR}/linux/string.c
+    )
+
+  genavb_add_os_component_defines(gptp-replay)
+
+  target_compile_options(gptp-replay PRIVATE -include ${TOPDIR}/gptp/config.h)
+
+  target_link_libraries(gptp-replay PRIVATE gptp common m)
+
+  set_target_properties(gptp-replay PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/bin)
+endif()
+
+if(BUILD_TESTS)
+  # gPTP unit tests, the gPTP core runs against the simulated services of the replay tool (see mock.c)
+  genavb_add_test(NAME gptp-domain-threads COMPONENT gptp SRCS domain_threads.c mock.c peer.c LIBS gptp common NO_CLOCK)
+  genavb_add_test(NAME gptp-rate-ratio COMPONENT gptp SRCS rate_ratio.c mock.c peer.c LIBS gptp common m NO_CLOCK)
+  genavb_add_test(NAME gptp-bmca COMPONENT gptp SRCS bmca.c mock.c LIBS gptp common NO_CLOCK)
+endif()
@@ -46,6 +46,9 @@
 #define HSR_NULL_ENTRY_ID	(0xFFFFFFFF)
 #define HSR_SI_MAX_ENTRIES	384
 
+/* Each node owns at least one stream identification entry, so no more nodes can be learned by default */
+#define HSR_NODE_MAX_DEFAULT	HSR_SI_MAX_ENTRIES
+
 #define STREAM_VID(streamid)	(NETC_INTERNAL_VID_BASE + streamid)
 
 struct hsr_table {
@@ -67,8 +70,11 @@ struct hsr_stream {
 	struct hsr_stream_drop drop;
 };
 
+struct hsr_node_table;
+
 struct hsr_node {
 	struct list_head	list;
+	struct hsr_node_table	*table;
 	uint8_t			mac[6];
 	uint8_t			fwdmask;
 	uint8_t			stream_max;
@@ -77,8 +83,26 @@ struct hsr_node {
 	uint32_t		gen_id;
 	uint32_t		rec_id;
 	bool			isring;
-	uint32_t		cnt;
+	uint32_t		last_seen;	/* node forget period the node was last seen in */
 	uint16_t		seqnum;
+	uint32_t		rx_burst;	/* last RX burst the node was learned in */
+	uint16_t		rx_vid;		/* vlan and bridge ports the node was learned from, in that burst */
+	uint8_t			rx_port_mask;
+};
+
+/* Node table, indexed by MAC address through an open addressing (linear probing) hash.
+ * The hash is sized from the configured maximum number of nodes, to keep its load below 3/4.
+ * The list is kept in LRU order (most recently seen node first), so that the node forget
+ * timer only needs to walk the nodes not seen during the last period.
+ */
+struct hsr_node_table {
+	struct list_head	list;
+	struct hsr_node		**hash;
+	unsigned int		hash_bits;
+	unsigned int		hash_mask;
+	unsigned int		max;
+	unsigned int		count;
+	uint32_t		period;		/* current node forget period */
 };
 
 struct hsr_port_config {
@@ -98,10 +122,11 @@ struct hsr_ctx {
 	struct timer_ctx	*timer_ctx;
 	struct timer		lifecheck_timer;
 	struct timer		nodeforget_timer;
-	struct list_head	ring_list;
-	struct list_head	proxy_list;
+	struct hsr_node_table	ring_table;
+	struct hsr_node_table	proxy_table;
 	struct hsr_table	tables;
 	uint16_t		SupSequenceNumber;
+	uint32_t		rx_burst;	/* current RX burst */
 };
 
 static void hsr_node_moden_set(struct hsr_ctx *hsr, struct hsr_node *node);
@@ -152,11 +177,97 @@ static void hsr_table_id_free(uint8_t *table, uint32_t id)
 	}
 }
 
-static int hsr_node_list_add(struct list_head *head, uint8_t *mac, uint16_t vid,
+static unsigned int hsr_node_hash(struct hsr_node_table *table, const uint8_t *mac)
+{
+	uint32_t key;
+
+	/* OUI is likely shared by many nodes, hash on the lower 4 bytes */
+	key = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5];
+	key ^= (uint32_t)mac[0] << 8 | mac[1];
+
+	return (key * 2654435761U) >> (32 - table->hash_bits);
+}
+
+static int hsr_node_table_init(struct hsr_node_table *table, unsigned int max)
+{
+	unsigned int hash_bits = 1;
+
+	while ((1U << hash_bits) < (max * 4 + 2) / 3)
+		hash_bits++;
+
+	table->hash = os_malloc((1U << hash_bits) * sizeof(struct hsr_node *));
+	if (!table->hash)
+		return -1;
+
+	memset(table->hash, 0, (1U << hash_bits) * sizeof(struct hsr_node *));
+	table->hash_bits = hash_bits;
+	table->hash_mask = (1U << hash_bits) - 1;
+	table->max = max;
+
+	list_head_init(&table->list);
+	table->count = 0;
+	table->period = 0;
+
+	return 0;
+}
+
+static void hsr_node_table_exit(struct hsr_node_table *table)
+{
+	os_free(table->hash);
+}
+
+static unsigned int hsr_node_hash_slot(struct hsr_node_table *table, const uint8_t *mac)
+{
+	unsigned int i = hsr_node_hash(table, mac);
+
+	while (table->hash[i] && memcmp(table->hash[i]->mac, mac, 6))
+		i = (i + 1) & table->hash_mask;
+
+	return i;
+}
+
+static void hsr_node_hash_remove(struct hsr_node_table *table, struct hsr_node *node)
+{
+	unsigned int i, j, k;
+
+	i = hsr_node_hash_slot(table, node->mac);
+	if (table->hash[i] != node)
+		return;
+
+	/* Backward shift deletion, keeps probe sequences valid without tombstones */
+	j = i;
+	while (1) {
+		j = (j + 1) & table->hash_mask;
+		if (!table->hash[j])
+			break;
+
+		k = hsr_node_hash(table, table->hash[j]->mac);
+
+		/* Entry at j can be moved to i if its home slot k is not cyclically in (i, j] */
+		if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+			continue;
+
+		table->hash[i] = table->hash[j];
+		i = j;
+	}
+
+	table->hash[i] = NULL;
+	table->count--;
+}
+
+static int hsr_node_list_add(struct hsr_node_table *table, uint8_t *mac, uint16_t vid,
 			     bool tagged, uint8_t fwdmask, uint32_t streamid,
 			     uint32_t gen_id, uint32_t rec_id, bool isring)
 {
 	struct hsr_node *entry;
+	unsigned int slot;
+
+	if (table->count >= table->max)
+		return -1;
+
+	slot = hsr_node_hash_slot(table, mac);
+	if (table->hash[slot])
+		return -1;
 
 	entry = os_malloc(sizeof(struct hsr_node));
 	if (!entry)
@@ -164,6 +275,7 @@ static int hsr_node_list_add(struct list_head *head, uint8_t *mac, uint16_t vid,
 
 	memset(entry, 0, sizeof(struct hsr_node));
 	memcpy(entry->mac, mac, 6);
+	entry->table = table;
 	entry->gen_id = gen_id;
 	entry->rec_id = rec_id;
 	entry->fwdmask = fwdmask;
@@ -174,30 +286,38 @@ static int hsr_node_list_add(struct list_head *head, uint8_t *mac, uint16_t vid,
 	entry->stream[0].tagged = tagged;
 	entry->isring = isring;
 
-	list_add(head, &entry->list);
+	/* Not seen yet in the current period, oldest end of the LRU list */
+	entry->last_seen = table->period - 1;
+	list_add_tail(&table->list, &entry->list);
+
+	table->hash[slot] = entry;
+	table->count++;
 
 	return 0;
 }
 
 static void hsr_node_list_del(struct hsr_node *node)
 {
+	hsr_node_hash_remove(node->table, node);
+
 	list_del(&node->list);
 
 	os_free(node);
 }
 
-static struct hsr_node *hsr_node_list_find(struct list_head *head, uint8_t *mac)
+static struct hsr_node *hsr_node_list_find(struct hsr_node_table *table, uint8_t *mac)
 {
-	struct list_head *pos, *next;
-	struct hsr_node *entry;
+	return table->hash[hsr_node_hash_slot(table, mac)];
+}
 
-	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
-		entry = container_of(pos, struct hsr_node, list);
-		if (!memcmp(entry->mac, mac, 6))
-			return entry;
-	}
+static void hsr_node_list_seen(struct hsr_node *node)
+{
+	struct hsr_node_table *table = node->table;
 
-	return NULL;
+	node->last_seen = table->period;
+
+	list_del(&node->list);
+	list_add(&table->list, &node->list);
 }
 
 static int hsr_node_streamid_add(struct hsr_node *node, uint32_t streamid, uint16_t vid, bool tagged)
@@ -514,7 +634,7 @@ static int hsr_mac_filter_drop(struct hsr_ctx *hsr, uint8_t *mac, uint16_t vid,
 	struct hsr_node *entry;
 	int index, rc;
 
-	entry = hsr_node_list_find(&hsr->proxy_list, mac);
+	entry = hsr_node_list_find(&hsr->proxy_table, mac);
 	if (!entry)
 		return -1;
 
@@ -629,9 +749,9 @@ static void hsr_node_del(struct hsr_ctx *hsr, struct hsr_node *node)
 	hsr_node_list_del(node);
 }
 
-static void hsr_node_list_free(struct hsr_ctx *hsr, struct list_head *head)
+static void hsr_node_list_free(struct hsr_ctx *hsr, struct hsr_node_table *table)
 {
-	struct list_head *pos, *next;
+	struct list_head *pos, *next, *head = &table->list;
 	struct hsr_node *entry;
 
 	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
@@ -676,7 +796,7 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 		fwdmask = ring_port_mask;
 
 	if (hsr_fdb_entry_exist(&hsr->port_cfg, mac, vid, &old_fwdmask, NULL)) {
-		node = hsr_node_list_find(&hsr->proxy_list, mac);
+		node = hsr_node_list_find(&hsr->proxy_table, mac);
 		if (old_fwdmask != fwdmask && node && !is_ring_port) {
 			hsr_node_stream_del(hsr, node, vid);
 			if (node->stream_max == 0)
@@ -689,7 +809,7 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 	if (hsr_fdb_entry_add(&hsr->port_cfg, mac, vid, fwdmask, dynamic) < 0)
 		return;
 
-	node = hsr_node_list_find(&hsr->proxy_list, mac);
+	node = hsr_node_list_find(&hsr->proxy_table, mac);
 	if (node && node->fwdmask == fwdmask)
 		return;
 
@@ -707,7 +827,7 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 
 	if (is_ring_port) {
 		gen_id = HSR_NULL_ENTRY_ID;
-		node = hsr_node_list_find(&hsr->ring_list, mac);
+		node = hsr_node_list_find(&hsr->ring_table, mac);
 		if (node) {
 			hsr_node_streamid_add(node, streamid, vid, tagged);
 			hsr_frer_rec_add(&hsr->port_cfg, node->rec_id, streamid);
@@ -723,18 +843,18 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 		if (hsr_frer_rec_add(&hsr->port_cfg, rec_id, streamid) < 0)
 			goto frer_add_err;
 
-		rc = hsr_node_list_add(&hsr->ring_list, mac, vid, tagged, fwdmask, streamid, gen_id, rec_id, 0);
+		rc = hsr_node_list_add(&hsr->ring_table, mac, vid, tagged, fwdmask, streamid, gen_id, rec_id, 0);
 		if (rc < 0)
 			goto list_add_err;
 
 		if (hsr->mode == GENAVB_HSR_OPERATION_MODE_N) {
-			node = hsr_node_list_find(&hsr->ring_list, mac);
+			node = hsr_node_list_find(&hsr->ring_table, mac);
 			if (node)
 				hsr_node_moden_set(hsr, node);
 		}
 	} else {
 		rec_id = HSR_NULL_ENTRY_ID;
-		node = hsr_node_list_find(&hsr->proxy_list, mac);
+		node = hsr_node_list_find(&hsr->proxy_table, mac);
 		if (node) {
 			hsr_node_streamid_add(node, streamid, vid, tagged);
 			hsr_frer_gen_add(node->gen_id, streamid);
@@ -742,7 +862,7 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 			return;
 		}
 
-		node = hsr_node_list_find(&hsr->ring_list, mac);
+		node = hsr_node_list_find(&hsr->ring_table, mac);
 		if (node)
 			hsr_node_del(hsr, node);
 
@@ -756,7 +876,7 @@ static void hsr_maclearn_process(struct hsr_ctx *hsr, struct net_rx_desc *desc)
 			goto frer_add_err;
 
 		isring = (port == hsr->port_cfg.br_mgmt_port);
-		rc = hsr_node_list_add(&hsr->proxy_list, mac, vid, tagged, fwdmask, streamid, gen_id, rec_id, isring);
+		rc = hsr_node_list_add(&hsr->proxy_table, mac, vid, tagged, fwdmask, streamid, gen_id, rec_id, isring);
 		if (rc < 0)
 			goto list_add_err;
 
@@ -802,28 +922,83 @@ static void hsr_supervision_process(struct hsr_ctx *hsr, struct net_rx_desc *des
 	if (!(memcmp(smac, mac, 6)))
 		isring = 1;
 
-	node = hsr_node_list_find(&hsr->ring_list, mac);
+	node = hsr_node_list_find(&hsr->ring_table, mac);
 	if (node) {
-		node->cnt++;
-		if (node->cnt == 0)
-			node->cnt = 1;
+		hsr_node_list_seen(node);
 
 		node->isring = isring;
 	}
 }
 
-static void hsr_rx_process(struct net_rx *rx, struct net_rx_desc *desc)
+static struct hsr_node *hsr_maclearn_node(struct hsr_ctx *hsr, struct net_rx_desc *desc)
+{
+	uint8_t *mac = (uint8_t *)desc + desc->l2_offset + 6;
+	struct hsr_node *node;
+
+	node = hsr_node_list_find(&hsr->proxy_table, mac);
+	if (!node)
+		node = hsr_node_list_find(&hsr->ring_table, mac);
+
+	return node;
+}
+
+/* Check if the frame source (port, vlan, mac) was already learned earlier in the current RX burst.
+ * The learned sources are recorded in the node, for a single vlan per burst. Frames from other
+ * vlans, and from sources not in the node tables, are simply learned again.
+ */
+static bool hsr_maclearn_duplicate(struct hsr_ctx *hsr, struct net_rx_desc *desc)
+{
+	struct hsr_node *node;
+	uint32_t port;
+
+	if (hsr_logic_port_to_bridge_port(&hsr->port_cfg, desc->port, &port) < 0)
+		return false;
+
+	node = hsr_maclearn_node(hsr, desc);
+
+	return node && (node->rx_burst == hsr->rx_burst) && (node->rx_vid == desc->vid) && (node->rx_port_mask & (1 << port));
+}
+
+static void hsr_maclearn_done(struct hsr_ctx *hsr, struct net_rx_desc *desc)
+{
+	struct hsr_node *node;
+	uint32_t port;
+
+	if (hsr_logic_port_to_bridge_port(&hsr->port_cfg, desc->port, &port) < 0)
+		return;
+
+	node = hsr_maclearn_node(hsr, desc);
+	if (!node)
+		return;
+
+	if ((node->rx_burst != hsr->rx_burst) || (node->rx_vid != desc->vid)) {
+		node->rx_burst = hsr->rx_burst;
+		node->rx_vid = desc->vid;
+		node->rx_port_mask = 0;
+	}
+
+	node->rx_port_mask |= 1 << port;
+}
+
+static void hsr_rx_process(struct net_rx *rx, struct net_rx_desc **desc, unsigned int n)
 {
 	struct hsr_ctx *hsr;
+	unsigned int i;
 
 	hsr = container_of(rx, struct hsr_ctx, net_rx);
 
-	if (desc->ethertype == ETHERTYPE_HSR_SUPERVISION)
-		hsr_supervision_process(hsr, desc);
-	else
-		hsr_maclearn_process(hsr, desc);
+	hsr->rx_burst++;
+
+	for (i = 0; i < n; i++) {
+		if (desc[i]->ethertype == ETHERTYPE_HSR_SUPERVISION) {
+			hsr_supervision_process(hsr, desc[i]);
+		} else if (!hsr_maclearn_duplicate(hsr, desc[i])) {
+			hsr_maclearn_process(hsr, desc[i]);
+			hsr_maclearn_done(hsr, desc[i]);
+		}
+	}
 
-	net_rx_free(desc);
+	net_free_multi((void **)desc, n);
 }
 
 static void hsr_supervision_frame(uint8_t *addr, uint32_t len, uint8_t *smac, uint8_t *mac, uint32_t seqnum)
@@ -899,16 +1074,20 @@ static void hsr_nodeforget_timer_handler(void *data)
 	struct hsr_node *entry;
 	int i;
 
-	head = &hsr->ring_list;
-	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
+	/* Ring nodes are in LRU order, only walk the ones not seen during the last period */
+	head = &hsr->ring_table.list;
+	for (pos = list_last(head); pos != head; pos = next) {
 		entry = container_of(pos, struct hsr_node, list);
-		if (entry->cnt)
-			entry->cnt = 0;
-		else
-			hsr_node_del(hsr, entry);
+		if (entry->last_seen == hsr->ring_table.period)
+			break;
+
+		next = pos->prev;
+		hsr_node_del(hsr, entry);
 	}
 
-	head = &hsr->proxy_list;
+	hsr->ring_table.period++;
+
+	head = &hsr->proxy_table.list;
 	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
 		entry = container_of(pos, struct hsr_node, list);
 		hsr_frer_gen_seq_get(entry->gen_id, &seqnum);
@@ -935,7 +1114,7 @@ static void hsr_lifecheck_timer_handler(void *data)
 	struct hsr_ctx *hsr = (struct hsr_ctx *)data;
 
 	hsr->SupSequenceNumber++;
-	hsr_supervision_send(&hsr->net_tx, &hsr->proxy_list, hsr->SupSequenceNumber);
+	hsr_supervision_send(&hsr->net_tx, &hsr->proxy_table.list, hsr->SupSequenceNumber);
 
 	timer_start(&hsr->lifecheck_timer, HSR_TIMER_PERIOD);
 }
@@ -1123,7 +1302,7 @@ static void hsr_node_operation_modeu(struct hsr_ctx *hsr, bool enable)
 	struct hsr_node *entry;
 	int i;
 
-	head = &hsr->proxy_list;
+	head = &hsr->proxy_table.list;
 	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
 		entry = container_of(pos, struct hsr_node, list);
 
@@ -1140,7 +1319,7 @@ static void hsr_node_operation_moden(struct hsr_ctx *hsr, bool enable)
 	struct list_head *pos, *next, *head;
 	struct hsr_node *entry;
 
-	head = &hsr->ring_list;
+	head = &hsr->ring_table.list;
 	for (pos = list_first(head); next = list_next(pos), pos != head; pos = next) {
 		entry = container_of(pos, struct hsr_node, list);
 
@@ -1218,6 +1397,7 @@ __init void *hsr_init(struct hsr_config *cfg, unsigned long priv)
 {
 	struct hsr_ctx *hsr;
 	unsigned int timer_n;
+	unsigned int node_max;
 	struct net_address addr;
 
 	timer_n = HSR_MAX_TIMERS;
@@ -1229,14 +1409,19 @@ __init void *hsr_init(struct hsr_config *cfg, unsigned long priv)
 
 	hsr_port_config_init(&hsr->port_cfg, cfg);
 
-	list_head_init(&hsr->ring_list);
-	list_head_init(&hsr->proxy_list);
+	node_max = cfg->node_max ? cfg->node_max : HSR_NODE_MAX_DEFAULT;
+
+	if (hsr_node_table_init(&hsr->ring_table, node_max) < 0)
+		goto err_ring_table;
+
+	if (hsr_node_table_init(&hsr->proxy_table, node_max) < 0)
+		goto err_proxy_table;
 
 	memset(&addr, 0, sizeof(addr));
 	addr.ptype = PTYPE_HSR;
 	addr.port = PORT_ANY;
 
-	if (net_rx_init(&hsr->net_rx, &addr, hsr_rx_process, priv) < 0)
+	if (net_rx_init_multi(&hsr->net_rx, &addr, hsr_rx_process, 0, 0, priv) < 0)
 		goto err_rx_init;
 
 	addr.port = hsr->port_cfg.cpu_port;
@@ -1273,7 +1458,12 @@ err_tx_init:
 	net_rx_exit(&hsr->net_rx);
 
 err_rx_init:
-	os_free(hsr->timer_ctx);
+	hsr_node_table_exit(&hsr->proxy_table);
+
+err_proxy_table:
+	hsr_node_table_exit(&hsr->ring_table);
+
+err_ring_table:
 	os_free(hsr);
 
 err_malloc:
@@ -1288,14 +1478,15 @@ __exit int hsr_exit(void *hsr_h)
 
 	timer_pool_exit(hsr->timer_ctx);
 
-	os_free(hsr->timer_ctx);
-
 	net_rx_exit(&hsr->net_rx);
 
 	net_tx_exit(&hsr->net_tx);
 
-	hsr_node_list_free(hsr, &hsr->ring_list);
-	hsr_node_list_free(hsr, &hsr->proxy_list);
+	hsr_node_list_free(hsr, &hsr->ring_table);
+	hsr_node_list_free(hsr, &hsr->proxy_table);
+
+	hsr_node_table_exit(&hsr->ring_table);
+	hsr_node_table_exit(&hsr->proxy_table);
 
 	bridge_software_maclearn(0);
 
@@ -5,3 +5,9 @@ if(CONFIG_HSR)
 	genavb_target_add_srcs(TARGET ${avb} SRCS hsr.c)
 
 endif()
+
+if(BUILD_TESTS)
+
+	include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+
+endif()
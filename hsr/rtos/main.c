@@ -71,6 +71,7 @@ const struct hsr_config hsr_default_config = {
 		.logical_port = 6,
 		.type = HSR_INTERNAL_PORT,
 	},
+	.node_max = 384,
 };
 
 static void hsr_task(void *pvParameters)
@@ -114,7 +115,7 @@ static void hsr_task(void *pvParameters)
 
 		switch (e.type) {
 		case EVENT_TYPE_NET_RX:
-			net_rx((struct net_rx *)e.data);
+			net_rx_multi((struct net_rx *)e.data);
 			break;
 
 		case EVENT_TYPE_TIMER:
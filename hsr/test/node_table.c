@@ -0,0 +1,586 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief HSR node table test
+ @details
+ The HSR stack is initialized against stubbed switch services (a software FDB and stream identification table) and
+ fed with RX bursts of frames from ring and proxy sources, through its network receive callback.
+ - Once all the sources are learned, every RX burst must read the FDB exactly once per distinct source (port, vlan,
+   mac) in the burst, i.e the duplicate frames are all detected through the node tables.
+ - The number of nodes learned in a node table is limited by the configured maximum.
+ - All the stream identification entries are released when the stack exits.
+ With -b, a trace of frames from 512 ring sources (each frame received on both ring ports) is replayed in RX bursts
+ and the processing rate is reported, against the minimum size frame rate of two 1 Gbit/s ring ports.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "common/ipc.h"
+#include "common/timer.h"
+
+#include "os/stream_identification.h"
+#include "os/frer.h"
+#include "os/psfp.h"
+#include "os/vlan.h"
+#include "os/fdb.h"
+#include "os/net.h"
+
+#include "hsr/hsr.h"
+
+#define TEST_RING_SOURCES	192
+#define TEST_PROXY_SOURCES	64
+#define TEST_SOURCES		(TEST_RING_SOURCES + TEST_PROXY_SOURCES)
+#define TEST_BURSTS		10000
+#define TEST_BURST_SIZE		32
+#define TEST_NODE_MAX		90
+
+#define TEST_BENCH_SOURCES	512
+#define TEST_BENCH_FRAMES	(1 << 16)
+#define TEST_BENCH_RUNS		160
+
+/* Minimum size frames (64 bytes, plus preamble and inter frame gap) on two 1 Gbit/s ring ports */
+#define TEST_LINE_RATE		(2 * 1000000000.0 / ((64 + 20) * 8))
+
+#define TEST_MAX_SOURCES	TEST_BENCH_SOURCES
+#define TEST_STREAMS_MAX	1024
+
+/* Logical ports, the bridge ports are the same minus one (see test_config) */
+#define TEST_PORT_RING_A	1
+#define TEST_PORT_RING_B	2
+#define TEST_PORT_EXTERNAL	3
+#define TEST_PORT_INTERNAL	4
+#define TEST_PORT_MAX		5
+
+#define TEST_ETHERTYPE		0x0800
+
+struct test_frame {
+	struct net_rx_desc desc;
+	uint8_t data[64];
+};
+
+struct test_fdb_entry {
+	bool valid;
+	genavb_fdb_port_control_t control[TEST_PORT_MAX];
+};
+
+static struct hsr_config test_config = {
+	.hsr_enabled = 1,
+	.port_max = 6,
+	.hsr_port[1] = { .logical_port = 0, .type = HSR_HOST_PORT },
+	.hsr_port[2] = { .logical_port = TEST_PORT_RING_A, .type = HSR_RING_PORT },
+	.hsr_port[3] = { .logical_port = TEST_PORT_RING_B, .type = HSR_RING_PORT },
+	.hsr_port[4] = { .logical_port = TEST_PORT_EXTERNAL, .type = HSR_EXTERNAL_PORT },
+	.hsr_port[5] = { .logical_port = TEST_PORT_INTERNAL, .type = HSR_INTERNAL_PORT },
+};
+
+static struct test_fdb_entry fdb[TEST_MAX_SOURCES];
+static unsigned int fdb_read_n;
+static bool streams[TEST_STREAMS_MAX];
+static unsigned int streams_n;
+
+static struct net_rx *test_rx;
+static void (*test_rx_func)(struct net_rx *, struct net_rx_desc **, unsigned int);
+
+static struct test_frame frames[TEST_BURST_SIZE];
+static struct net_rx_desc *bench_desc[TEST_BENCH_FRAMES];
+
+static unsigned int seed = 1;
+
+static void test_frame_init(struct test_frame *frame, unsigned int source, unsigned int port)
+{
+	memset(frame, 0, sizeof(*frame));
+
+	frame->desc.l2_offset = offsetof(struct test_frame, data);
+	frame->desc.len = sizeof(frame->data);
+	frame->desc.port = port;
+	frame->desc.vid = VLAN_VID_NONE;
+	frame->desc.ethertype = TEST_ETHERTYPE;
+
+	/* Locally administered source MAC, the FDB stub is indexed by the last two bytes */
+	frame->data[6] = 0x02;
+	frame->data[10] = source >> 8;
+	frame->data[11] = source & 0xff;
+}
+
+static unsigned int test_source_port(unsigned int source)
+{
+	if (source < TEST_RING_SOURCES)
+		return (rand_r(&seed) & 1) ? TEST_PORT_RING_B : TEST_PORT_RING_A;
+	else
+		return TEST_PORT_EXTERNAL;
+}
+
+static void test_rx_burst(struct test_frame *frame, unsigned int n)
+{
+	struct net_rx_desc *desc[TEST_BURST_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		desc[i] = &frame[i].desc;
+
+	test_rx_func(test_rx, desc, n);
+}
+
+static void test_learn(unsigned int sources)
+{
+	unsigned int i;
+
+	for (i = 0; i < sources; i++) {
+		test_frame_init(&frames[0], i, test_source_port(i));
+		test_rx_burst(frames, 1);
+	}
+}
+
+/* Number of distinct sources (port, vlan, mac) in the burst */
+static unsigned int test_burst_sources(struct test_frame *frame, unsigned int n)
+{
+	unsigned int i, j, sources = 0;
+
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < i; j++)
+			if ((frame[j].desc.port == frame[i].desc.port) && !memcmp(frame[j].data + 6, frame[i].data + 6, 6))
+				break;
+
+		if (j == i)
+			sources++;
+	}
+
+	return sources;
+}
+
+static int test_dedup(void)
+{
+	unsigned int burst, n, i, sources, reads;
+	void *hsr;
+	int rc = -1;
+
+	test_config.node_max = 0;
+
+	hsr = hsr_init(&test_config, 0);
+	if (!hsr)
+		goto err_init;
+
+	test_learn(TEST_SOURCES);
+
+	/* One stream per ring node, two (source and drop filter) per proxy node */
+	if (streams_n != TEST_RING_SOURCES + 2 * TEST_PROXY_SOURCES) {
+		printf("dedup: %u streams after learning, expected %u\n", streams_n, TEST_RING_SOURCES + 2 * TEST_PROXY_SOURCES);
+		goto out;
+	}
+
+	for (burst = 0; burst < TEST_BURSTS; burst++) {
+		n = 1 + rand_r(&seed) % TEST_BURST_SIZE;
+
+		/* Few sources per burst, to get many duplicates */
+		for (i = 0; i < n; i++) {
+			unsigned int source = rand_r(&seed) % (1 + burst % TEST_SOURCES);
+
+			test_frame_init(&frames[i], source, test_source_port(source));
+		}
+
+		sources = test_burst_sources(frames, n);
+		reads = fdb_read_n;
+
+		test_rx_burst(frames, n);
+
+		if (fdb_read_n - reads != sources) {
+			printf("dedup: burst %u, %u frames, %u sources, %u fdb reads\n", burst, n, sources, fdb_read_n - reads);
+			goto out;
+		}
+	}
+
+	rc = 0;
+
+out:
+	hsr_exit(hsr);
+
+err_init:
+	return rc;
+}
+
+static int test_node_max(void)
+{
+	void *hsr;
+	int rc = -1;
+
+	test_config.node_max = TEST_NODE_MAX;
+
+	hsr = hsr_init(&test_config, 0);
+	if (!hsr)
+		goto err_init;
+
+	/* Ring sources only (2 * TEST_NODE_MAX < TEST_RING_SOURCES), each ring node owns a single stream */
+	test_learn(2 * TEST_NODE_MAX);
+	test_learn(2 * TEST_NODE_MAX);
+
+	if (streams_n != TEST_NODE_MAX) {
+		printf("node max: %u streams, expected %u\n", streams_n, TEST_NODE_MAX);
+		goto out;
+	}
+
+	rc = 0;
+
+out:
+	hsr_exit(hsr);
+
+err_init:
+	return rc;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int test_bench(void)
+{
+	struct test_frame *trace;
+	unsigned int i, j, n, reads, learned;
+	double start, duration, rate;
+	void *hsr;
+
+	trace = malloc(TEST_BENCH_FRAMES * sizeof(struct test_frame));
+	if (!trace)
+		return -1;
+
+	/* Each frame from a random source is received on both ring ports */
+	for (i = 0; i < TEST_BENCH_FRAMES; i += 2) {
+		unsigned int source = rand_r(&seed) % TEST_BENCH_SOURCES;
+
+		test_frame_init(&trace[i], source, TEST_PORT_RING_A);
+		test_frame_init(&trace[i + 1], source, TEST_PORT_RING_B);
+	}
+
+	for (i = 0; i < TEST_BENCH_FRAMES; i++)
+		bench_desc[i] = &trace[i].desc;
+
+	test_config.node_max = TEST_BENCH_SOURCES;
+
+	hsr = hsr_init(&test_config, 0);
+	if (!hsr) {
+		free(trace);
+		return -1;
+	}
+
+	/* Learning pass */
+	for (i = 0; i < TEST_BENCH_FRAMES; i += TEST_BURST_SIZE)
+		test_rx_func(test_rx, &bench_desc[i], TEST_BURST_SIZE);
+
+	learned = streams_n;
+	reads = fdb_read_n;
+	start = test_time();
+
+	for (j = 0; j < TEST_BENCH_RUNS; j++)
+		for (i = 0; i < TEST_BENCH_FRAMES; i += TEST_BURST_SIZE)
+			test_rx_func(test_rx, &bench_desc[i], TEST_BURST_SIZE);
+
+	duration = test_time() - start;
+	n = TEST_BENCH_RUNS * TEST_BENCH_FRAMES;
+	rate = n / duration;
+
+	printf("%u sources (%u learned), bursts of %u: %.1f ns/frame, %.2f Mframes/s (%.1fx line rate), %.2f fdb reads/frame\n",
+		TEST_BENCH_SOURCES, learned, TEST_BURST_SIZE, duration * 1e9 / n, rate / 1e6, rate / TEST_LINE_RATE,
+		(double)(fdb_read_n - reads) / n);
+
+	hsr_exit(hsr);
+	free(trace);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (test_dedup() < 0)
+		goto fail;
+
+	if (test_node_max() < 0)
+		goto fail;
+
+	if (streams_n) {
+		printf("%u streams left after exit\n", streams_n);
+		goto fail;
+	}
+
+	if (bench && (test_bench() < 0))
+		goto fail;
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
+
+/*
+ * Stubbed switch and network services
+ */
+
+static struct test_fdb_entry *test_fdb_entry(uint8_t *address)
+{
+	unsigned int source = (address[4] << 8) | address[5];
+
+	return (source < TEST_MAX_SOURCES) ? &fdb[source] : NULL;
+}
+
+int fdb_update(unsigned int port_id, uint8_t *address, uint16_t vid, bool dynamic, genavb_fdb_port_control_t control)
+{
+	struct test_fdb_entry *entry = test_fdb_entry(address);
+
+	if (!entry || (port_id >= TEST_PORT_MAX))
+		return -1;
+
+	if (!entry->valid) {
+		memset(entry, 0, sizeof(*entry));
+		entry->valid = true;
+	}
+
+	entry->control[port_id] = control;
+
+	return 0;
+}
+
+int fdb_delete(uint8_t *address, uint16_t vid, bool dynamic)
+{
+	struct test_fdb_entry *entry = test_fdb_entry(address);
+
+	if (!entry || !entry->valid)
+		return -1;
+
+	entry->valid = false;
+
+	return 0;
+}
+
+int fdb_read(uint8_t *address, uint16_t vid, bool *dynamic, struct genavb_fdb_port_map *map, genavb_fdb_status_t *status)
+{
+	struct test_fdb_entry *entry = test_fdb_entry(address);
+	unsigned int i;
+
+	fdb_read_n++;
+
+	if (!entry || !entry->valid)
+		return -1;
+
+	/* Bridge port i is logical port i + 1 */
+	for (i = 0; i < TEST_PORT_MAX - 1; i++) {
+		map[i].port_id = i + 1;
+		map[i].control = entry->control[i + 1];
+	}
+
+	*dynamic = false;
+	*status = GENAVB_FDB_STATUS_LEARNED;
+
+	return 0;
+}
+
+int stream_identity_update(uint32_t index, struct genavb_stream_identity *entry)
+{
+	if (index >= TEST_STREAMS_MAX)
+		return -1;
+
+	if (!streams[index])
+		streams_n++;
+
+	streams[index] = true;
+
+	return 0;
+}
+
+int stream_identity_delete(uint32_t index)
+{
+	if ((index >= TEST_STREAMS_MAX) || !streams[index])
+		return -1;
+
+	streams[index] = false;
+	streams_n--;
+
+	return 0;
+}
+
+int vlan_update(uint16_t vid, bool dynamic, struct genavb_vlan_port_map *map)
+{
+	return 0;
+}
+
+int vlan_read(uint16_t vid, bool *dynamic, struct genavb_vlan_port_map *map)
+{
+	return -1;
+}
+
+int vlan_port_get_default(unsigned int port_id, uint16_t *vid)
+{
+	*vid = 1;
+
+	return 0;
+}
+
+int sequence_generation_update(uint32_t index, struct genavb_sequence_generation *entry, unsigned int option)
+{
+	return 0;
+}
+
+int sequence_generation_delete(uint32_t index)
+{
+	return 0;
+}
+
+int sequence_generation_read(uint32_t index, struct genavb_sequence_generation *entry)
+{
+	return -1;
+}
+
+int sequence_recovery_update(uint32_t index, struct genavb_sequence_recovery *entry)
+{
+	return 0;
+}
+
+int sequence_recovery_delete(uint32_t index)
+{
+	return 0;
+}
+
+int sequence_recovery_read(uint32_t index, struct genavb_sequence_recovery *entry)
+{
+	return -1;
+}
+
+int sequence_identification_update(unsigned int port_id, bool direction_out_facing, struct genavb_sequence_identification *entry)
+{
+	return 0;
+}
+
+int sequence_identification_delete(unsigned int port_id, bool direction_out_facing)
+{
+	return 0;
+}
+
+int sequence_identification_read(unsigned int port_id, bool direction_out_facing, struct genavb_sequence_identification *entry)
+{
+	return -1;
+}
+
+int stream_filter_update(uint32_t index, struct genavb_stream_filter_instance *instance)
+{
+	return 0;
+}
+
+int stream_filter_delete(uint32_t index)
+{
+	return 0;
+}
+
+int bridge_software_maclearn(bool enable)
+{
+	return 0;
+}
+
+int net_rx_init_multi(struct net_rx *rx, struct net_address *addr, void (*func)(struct net_rx *, struct net_rx_desc **, unsigned int), unsigned int packets, unsigned int time, unsigned long priv)
+{
+	test_rx = rx;
+	test_rx_func = func;
+
+	return 0;
+}
+
+void net_rx_exit(struct net_rx *rx)
+{
+}
+
+void net_free_multi(void **buf, unsigned int n)
+{
+}
+
+int net_tx_init(struct net_tx *tx, struct net_address *addr)
+{
+	return 0;
+}
+
+void net_tx_exit(struct net_tx *tx)
+{
+}
+
+struct net_tx_desc *net_tx_alloc(struct net_tx *tx, unsigned int size)
+{
+	return NULL;
+}
+
+int net_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	return -1;
+}
+
+void net_tx_free(struct net_tx_desc *buf)
+{
+}
+
+int ipc_rx_init(struct ipc_rx *rx, ipc_id_t id, void (*func)(struct ipc_rx const *, struct ipc_desc *), unsigned long priv)
+{
+	return 0;
+}
+
+void ipc_rx_exit(struct ipc_rx *rx)
+{
+}
+
+unsigned int timer_pool_size(unsigned int n)
+{
+	return 0;
+}
+
+int timer_pool_init(struct timer_ctx *tctx, unsigned int n, unsigned long priv)
+{
+	return 0;
+}
+
+void timer_pool_exit(struct timer_ctx *tctx)
+{
+}
+
+int timer_init(struct timer_ctx *tctx, struct timer *t, unsigned int flags, unsigned int ms)
+{
+	return 0;
+}
+
+int timer_destroy(struct timer *t)
+{
+	return 0;
+}
+
+int timer_start(struct timer *t, unsigned int ms)
+{
+	return 0;
+}
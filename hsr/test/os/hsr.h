@@ -0,0 +1,15 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief HSR unit tests, OS specific HSR definitions
+ @details The HSR public API is RTOS only, the tests don't need any OS specific definition.
+*/
+#ifndef _OS_GENAVB_PUBLIC_HSR_API_H_
+#define _OS_GENAVB_PUBLIC_HSR_API_H_
+
+#endif /* _OS_GENAVB_PUBLIC_HSR_API_H_ */
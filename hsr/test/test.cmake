@@ -0,0 +1,4 @@
+# hsr unit tests, the HSR stack (only built for RTOS targets) is linked against stubbed switch and network services
+# (see node_table.c), the test include directory provides the OS specific HSR header.
+genavb_add_test(NAME hsr-node-table COMPONENT common SRCS node_table.c ../hsr.c LIBS common)
+target_include_directories(hsr-node-table BEFORE PRIVATE ${CMAKE_CURRENT_LIST_DIR})
@@ -81,6 +81,8 @@ struct avdecc_entity_config {
 	unsigned int max_listener_pairs;
 	unsigned int max_inflights;
 	unsigned int max_unsolicited_registrations;
+	unsigned int unsolicited_coalesce_ms; /**< Window (in ms) during which repeated unsolicited notifications for the same descriptor are merged, 0 to disable */
+	unsigned int max_unsolicited_pending; /**< Maximum number of distinct notifications pending in the coalescing window */
 	unsigned int max_ptlv_entries; /**< Maximum number of tracked clock ids in the path trace */
 	bool milan_mode;
 	void *aem;
@@ -238,6 +240,7 @@ struct fgptp_config {
 	unsigned int rsync; /* set to 1 to enable rsync feature */
 	unsigned int rsync_interval; /* defines rsync packet interval in ms*/
 	unsigned int statsInterval; /* defines the interval in second between statistics output */
+	unsigned int neighborRateRatioWindow; /* number of pdelay exchanges used for the neighbor rate ratio least-squares estimation (2 for the standard two-point method) */
 
 	/* Automotive profile params */
 	uint8_t neighborPropDelay_mode;					/* set to 1 if predefined pdelay mechanism is used. 0 means relying on standard pdelay exchange */
@@ -256,6 +259,8 @@ struct fgptp_config {
 
 	/* IEEE 802.1AS-2011 operation */
 	unsigned int force_2011;	/* set to 1 if the stask operates per IEEE 802.1AS-2011 standard (no multi domains support) */
+
+	unsigned int domain_threads;	/* set to 1 to run each domain instance, other than domain 0, in its own thread (if supported by the platform) */
 };
 
 /*
@@ -292,6 +297,7 @@ struct hsr_config {
 		unsigned int logical_port;
 		hsr_port_type type;
 	} hsr_port[CFG_MAX_LOGICAL_PORTS];
+	unsigned int node_max;	/* maximum number of nodes in each of the ring and proxy node tables, 0 for the stack default */
 };
 
 /**
@@ -30,7 +30,10 @@ extern "C" {
 typedef enum {
 	GENAVB_STREAM_FLAGS_MCR = (1 << 0),	/**< Enable media clock recovery for the stream. Only valid for listener streams and ::GENAVB_MEDIA_CLOCK_DOMAIN_STREAM clock domain*/
 	GENAVB_STREAM_FLAGS_CUSTOM_TSPEC = (1 << 1),	/**< Enable custom tspec definition. Only valid for talker streams */
-	GENAVB_STREAM_FLAGS_MAX_TRANSIT_TIME_VALID = (1 << 2)	/**< Valid presentation_time_offset in stream params. Only valid for talker streams */
+	GENAVB_STREAM_FLAGS_MAX_TRANSIT_TIME_VALID = (1 << 2),	/**< Valid presentation_time_offset in stream params. Only valid for talker streams */
+	GENAVB_STREAM_FLAGS_ACF_PACKING = (1 << 3),	/**< Aggregate several ACF messages, read from the media interface, in a single AVTP PDU (up to max_frame_size bytes). Only valid for TSCF/NTSCF talker streams */
+	GENAVB_STREAM_FLAGS_CONCEAL_SILENCE = (1 << 4),	/**< On media underrun, pad partial packets with silence instead of restarting the stream. Only valid for 61883-6 talker streams */
+	GENAVB_STREAM_FLAGS_CONCEAL_REPEAT = (1 << 5)	/**< On media underrun, pad partial packets by repeating the last frame instead of restarting the stream. Only valid for 61883-6 talker streams */
 } genavb_stream_flags_t;
 
 /**
@@ -28,11 +28,21 @@ struct genavb_xdp_key {
 	uint8_t dst_mac[6];	/**< destination MAC */
 };
 
+/* Per stream counters maintained by the XDP program, one instance per cpu */
+struct genavb_xdp_stream_stats {
+	uint64_t packets;	/**< frames redirected for the stream */
+	uint64_t bytes;		/**< bytes redirected for the stream */
+	uint64_t seq_errors;	/**< AVTP sequence number discontinuities */
+	uint8_t last_seq;	/**< sequence number of the last frame */
+	uint8_t seq_valid;	/**< last_seq is valid */
+};
+
 enum NET_POOL_TYPE {
 	POOL_TYPE_STD     = 0, /**< Memory Pool for linux standard network interface */
 	POOL_TYPE_AVB     = 1, /**< Memory Pool for linux avb network interface */
 	POOL_TYPE_XDP     = 2, /**< Memory Pool for linux xdp network interface */
 	POOL_TYPE_IPC     = 3, /**< Memory Pool for linux ipc network interface */
+	POOL_TYPE_STD_URING = 4, /**< Memory Pool for linux standard network interface, io_uring transmit */
 	POOL_TYPE_MAX,
 };
 
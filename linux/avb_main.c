@@ -324,6 +324,12 @@ static int process_section_avdecc(struct _SECTIONENTRY *configtree, struct avdec
 			if (cfg_get_uint(configtree, section_name, "max_unsolicited_registratons", CFG_AECP_DEFAULT_NUM_UNSOLICITED, CFG_AECP_MIN_NUM_UNSOLICITED, CFG_AECP_MAX_NUM_UNSOLICITED, &entity_cfg->max_unsolicited_registrations))
 				goto err;
 
+			if (cfg_get_uint(configtree, section_name, "unsolicited_coalesce_ms", CFG_AECP_DEFAULT_UNSOLICITED_COALESCE_MS, CFG_AECP_MIN_UNSOLICITED_COALESCE_MS, CFG_AECP_MAX_UNSOLICITED_COALESCE_MS, &entity_cfg->unsolicited_coalesce_ms))
+				goto err;
+
+			if (cfg_get_uint(configtree, section_name, "max_unsolicited_pending", CFG_AECP_DEFAULT_NUM_UNSOLICITED_PENDING, CFG_AECP_MIN_NUM_UNSOLICITED_PENDING, CFG_AECP_MAX_NUM_UNSOLICITED_PENDING, &entity_cfg->max_unsolicited_pending))
+				goto err;
+
 			if (cfg_get_uint(configtree, section_name, "max_ptlv_entries", CFG_AEM_DEFAULT_NUM_PTLV_ENTRIES, CFG_AEM_MIN_NUM_PTLV_ENTRIES, CFG_AEM_MAX_NUM_PTLV_ENTRIES, &entity_cfg->max_ptlv_entries))
 				goto exit;
 
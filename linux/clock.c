@@ -758,3 +758,32 @@ int clock_time_from_hw(os_clock_id_t clk_id, uint64_t hw_ns, uint64_t *ns)
 err:
 	return -1;
 }
+
+/**
+ * Convert sw clock time to hw clock time.
+ * The result is a time of the root hw clock of the sw clock
+ * given as argument.
+ * \param id		clock id.
+ * \param ns		sw time to convert
+ * \param hw_ns		pointer to u64 variable that will hold the result.
+ * \return		0 on success, or negative value on error.
+ */
+int clock_time_to_hw(os_clock_id_t clk_id, uint64_t ns, uint64_t *hw_ns)
+{
+	struct os_clock *c;
+
+	c = clock_id_to_clock(clk_id);
+	if (!c || !c->parent_id)
+		goto err;
+
+	pthread_mutex_lock(&os_clock_mutex);
+
+	*hw_ns = __clock_time_to_hw(c, ns);
+
+	pthread_mutex_unlock(&os_clock_mutex);
+
+	return 0;
+
+err:
+	return -1;
+}
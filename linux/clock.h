@@ -70,6 +70,7 @@ struct os_clock {
 };
 
 int clock_time_from_hw(os_clock_id_t id, uint64_t hw_ns, uint64_t *ns);
+int clock_time_to_hw(os_clock_id_t id, uint64_t ns, uint64_t *hw_ns);
 int os_clock_gettime64_of_parent(os_clock_id_t id, u64 *ns);
 
 int os_clock_init(struct os_clock_config *config);
@@ -13,47 +13,48 @@ if(BUILD_XDP_EBPF_PROGRAM)
   endif()
 
   find_program(CLANG "clang" NO_CMAKE_FIND_ROOT_PATH)
-  if(CLANG STREQUAL "CLANG-NOTFOUND")
-    message(FATAL_ERROR "CLANG not found")
-  endif()
-
   find_program(LLVMLD "llvm-link" NO_CMAKE_FIND_ROOT_PATH)
-  if(LLVMD STREQUAL "LLVMD-NOTFOUND")
-    message(FATAL_ERROR "LLVMD not found")
-  endif()
 
   set(GENAVB_INCLUDE ${CMAKE_SOURCE_DIR}/include)
   set(CXXFLAGS -Wall -Wextra -Wmissing-prototypes -Wstrict-prototypes -Wunused -Wundef -Wold-style-definition -Wvla -Wshadow -Wdouble-promotion)
   set(CXXFLAGS ${CXXFLAGS} -I${GENAVB_INCLUDE} -I${GENAVB_INCLUDE}/linux)
 
   set(GENAVB_XDP ${CMAKE_BINARY_DIR}/ebpf/genavb-xdp.bin)
-  set(GENAVB_XDP_IR ${CMAKE_BINARY_DIR}/ebpf/genavb-xdp.bc)
   set(OBJ ${CMAKE_BINARY_DIR}/ebpf/genavb_xdp_main.bc)
   set(SOURCE ${CMAKE_CURRENT_LIST_DIR}/genavb_xdp_main.c)
 
+  # Without clang, build from the hand written IR of the C source
+  if(CLANG STREQUAL "CLANG-NOTFOUND" OR LLVMLD STREQUAL "LLVMLD-NOTFOUND")
+    message(STATUS "CLANG or LLVMLD not found, build ebpf program for XDP from genavb_xdp_main.ll")
+    set(GENAVB_XDP_IR ${CMAKE_CURRENT_LIST_DIR}/genavb_xdp_main.ll)
+  else()
+    set(GENAVB_XDP_IR ${CMAKE_BINARY_DIR}/ebpf/genavb-xdp.bc)
+
+    add_custom_command(
+      OUTPUT ${GENAVB_XDP_IR}
+      COMMAND ${LLVMLD} ${OBJ} -o ${GENAVB_XDP_IR}
+      DEPENDS ${OBJ}
+      COMMENT ""
+    )
+
+    add_custom_command(
+      OUTPUT ${OBJ}
+      COMMAND mkdir -p ${CMAKE_BINARY_DIR}/ebpf
+      COMMAND ${CLANG} -target arm64 ${CXXFLAGS} -O2 -emit-llvm -c ${SOURCE} -o ${OBJ}
+      DEPENDS ${SOURCE}
+      COMMENT ""
+    )
+  endif()
+
   add_custom_command(
     OUTPUT ${GENAVB_XDP}
+    COMMAND mkdir -p ${CMAKE_BINARY_DIR}/ebpf
     COMMAND ${LLC} ${GENAVB_XDP_IR} -march=bpf -filetype=obj -o ${GENAVB_XDP}
     DEPENDS ${GENAVB_XDP_IR}
   )
 
   add_custom_target(ebpf ALL DEPENDS ${GENAVB_XDP})
 
-  add_custom_command(
-    OUTPUT ${GENAVB_XDP_IR}
-    COMMAND ${LLVMLD} ${OBJ} -o ${GENAVB_XDP_IR}
-    DEPENDS ${OBJ}
-    COMMENT ""
-  )
-
-  add_custom_command(
-    OUTPUT ${OBJ}
-    COMMAND mkdir -p ${CMAKE_BINARY_DIR}/ebpf
-    COMMAND ${CLANG} -target arm64 ${CXXFLAGS} -O2 -emit-llvm -c ${SOURCE} -o ${OBJ}
-    DEPENDS ${SOURCE}
-    COMMENT ""
-  )
-
   install(FILES ${GENAVB_XDP} DESTINATION ${FIRMWARE_DIR})
 else()
   message(STATUS "Rebuild of ebpf program for XDP from source disabled, install pre-compiled binary")
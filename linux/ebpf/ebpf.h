@@ -18,6 +18,9 @@
 #define BPF_MAP_TYPE_PERCPU_ARRAY	6
 #define BPF_MAP_TYPE_XSKMAP		17
 
+#define BPF_ANY		0
+#define BPF_NOEXIST	1
+
 #define PIN_NONE	0
 #define PIN_GLOBAL_NS	2
 
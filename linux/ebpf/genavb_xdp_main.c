@@ -23,6 +23,91 @@ struct bpf_elf_map __section("maps") genavb_xskmap = {
 	.max_elem	= MAX_SOCKETS,
 };
 
+/* AVTP stream ID (network order) to XSK map index */
+struct bpf_elf_map __section("maps") genavb_xdpstream = {
+	.type		= BPF_MAP_TYPE_HASH,
+	.size_key	= sizeof(uint64_t),
+	.size_value	= sizeof(uint32_t),
+	.pinning	= PIN_GLOBAL_NS,
+	.max_elem	= MAX_SOCKETS,
+};
+
+/* AVTP stream ID (network order) to per-cpu stream counters */
+struct bpf_elf_map __section("maps") genavb_xdpstream_stats = {
+	.type		= BPF_MAP_TYPE_PERCPU_HASH,
+	.size_key	= sizeof(uint64_t),
+	.size_value	= sizeof(struct genavb_xdp_stream_stats),
+	.pinning	= PIN_GLOBAL_NS,
+	.max_elem	= MAX_SOCKETS,
+};
+
+/* Common part of the AVTP stream data header, IEEE 1722-2016 section 4.4.4 */
+struct avtp_stream_hdr {
+	uint8_t subtype;
+	uint8_t sv_version_flags;
+	uint8_t sequence_num;
+	uint8_t flags;
+	uint8_t stream_id[8];
+};
+
+#define AVTP_SV	0x80
+
+static __inline void genavb_xdp_stream_stats(uint64_t *stream_id, uint8_t seq, uint64_t len)
+{
+	struct genavb_xdp_stream_stats *stats;
+	struct genavb_xdp_stream_stats init = {};
+
+	stats = bpf_map_lookup_elem(&genavb_xdpstream_stats, stream_id);
+	if (!stats) {
+		bpf_map_update_elem(&genavb_xdpstream_stats, stream_id, &init, BPF_NOEXIST);
+
+		stats = bpf_map_lookup_elem(&genavb_xdpstream_stats, stream_id);
+		if (!stats)
+			return;
+	}
+
+	/* Per-cpu entry, a given stream is received on a single queue so no atomics are needed */
+	stats->packets++;
+	stats->bytes += len;
+
+	if (stats->seq_valid && ((uint8_t)(stats->last_seq + 1) != seq))
+		stats->seq_errors++;
+
+	stats->last_seq = seq;
+	stats->seq_valid = 1;
+}
+
+/*
+ * Steer AVTP stream data frames on their stream ID, so that streams sharing
+ * the same destination address can be received on different sockets.
+ * Returns the XDP action, or XDP_ABORTED if the frame is not a known stream.
+ */
+static __inline int genavb_xdp_stream(void *hdr, void *data, void *data_end)
+{
+	struct avtp_stream_hdr *avtp = (struct avtp_stream_hdr *)hdr;
+	uint64_t stream_id;
+	uint32_t *pxsk;
+	uint64_t xsk;
+
+	if ((void *)(avtp + 1) > data_end)
+		return XDP_ABORTED;
+
+	if (!(avtp->sv_version_flags & AVTP_SV))
+		return XDP_ABORTED;
+
+	__builtin_memcpy(&stream_id, avtp->stream_id, 8);
+
+	pxsk = bpf_map_lookup_elem(&genavb_xdpstream, &stream_id);
+	if (!pxsk)
+		return XDP_ABORTED;
+
+	xsk = *pxsk;
+
+	genavb_xdp_stream_stats(&stream_id, avtp->sequence_num, (uint64_t)(data_end - data));
+
+	return bpf_redirect_map(&genavb_xskmap, (void *)xsk, XDP_PASS);
+}
+
 __section("prog")
 static int genavb_xdp_prog(struct xdp_ctx *ctx)
 {
@@ -30,8 +115,10 @@ static int genavb_xdp_prog(struct xdp_ctx *ctx)
 	void *data_end = (void *)(long)ctx->data_end;
 	struct eth_hdr *eth = (struct eth_hdr *)data;
 	struct genavb_xdp_key key = {};
+	void *l3_hdr = (void *)(eth + 1);
 	uint64_t xsk;
-	uintptr_t *pxsk;
+	uint32_t *pxsk;
+	int action;
 
 	if ((void *)(eth + 1) > data_end)
 		return XDP_PASS;
@@ -47,10 +134,17 @@ static int genavb_xdp_prog(struct xdp_ctx *ctx)
 
 		key.protocol = vlan->type;
 		key.vlan_id = htons(VLAN_VID(vlan));
+		l3_hdr = (void *)(vlan + 1);
 	} else {
 		key.vlan_id = VLAN_VID_NONE;
 	}
 
+	if (key.protocol == htons(ETHERTYPE_AVTP)) {
+		action = genavb_xdp_stream(l3_hdr, data, data_end);
+		if (action != XDP_ABORTED)
+			return action;
+	}
+
 	pxsk = bpf_map_lookup_elem(&genavb_xdpkey, &key);
 	if (!pxsk)
 		return XDP_PASS;
@@ -0,0 +1,199 @@
+; Copyright 2024 NXP
+;
+; SPDX-License-Identifier: BSD-3-Clause
+;
+; Hand written LLVM IR of genavb_xdp_main.c (the helpers are inlined in genavb_xdp_prog), for BPF toolchains
+; without clang. It must be kept in sync with the C source, and is built with:
+;   llc -march=bpf -filetype=obj genavb_xdp_main.ll -o genavb-xdp.bin
+
+source_filename = "genavb_xdp_main.c"
+target datalayout = "e-m:e-p:64:64-i64:64-i128:128-n32:64-S128"
+target triple = "bpf"
+
+%struct.bpf_elf_map = type { i32, i32, i32, i32, i32, i32, i32, i32, i32 }
+%struct.xdp_ctx = type { i32, i32 }
+%struct.genavb_xdp_key = type { i16, i16, [6 x i8] }
+%struct.genavb_xdp_stream_stats = type { i64, i64, i64, i8, i8 }
+
+; type, size_key, size_value, max_elem (MAX_SOCKETS), flags, id, pinning (PIN_GLOBAL_NS), inner_id, inner_idx
+@genavb_xdpkey = dso_local global %struct.bpf_elf_map { i32 1, i32 10, i32 4, i32 256, i32 0, i32 0, i32 2, i32 0, i32 0 }, section "maps", align 4
+@genavb_xskmap = dso_local global %struct.bpf_elf_map { i32 17, i32 4, i32 4, i32 256, i32 0, i32 0, i32 2, i32 0, i32 0 }, section "maps", align 4
+@genavb_xdpstream = dso_local global %struct.bpf_elf_map { i32 1, i32 8, i32 4, i32 256, i32 0, i32 0, i32 2, i32 0, i32 0 }, section "maps", align 4
+@genavb_xdpstream_stats = dso_local global %struct.bpf_elf_map { i32 5, i32 8, i32 32, i32 256, i32 0, i32 0, i32 2, i32 0, i32 0 }, section "maps", align 4
+@_license = dso_local global [13 x i8] c"BSD-3-Clause\00", section "license", align 1
+
+@llvm.compiler.used = appending global [6 x i8*] [
+	i8* bitcast (%struct.bpf_elf_map* @genavb_xdpkey to i8*),
+	i8* bitcast (%struct.bpf_elf_map* @genavb_xskmap to i8*),
+	i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream to i8*),
+	i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream_stats to i8*),
+	i8* bitcast (i32 (%struct.xdp_ctx*)* @genavb_xdp_prog to i8*),
+	i8* getelementptr inbounds ([13 x i8], [13 x i8]* @_license, i32 0, i32 0)
+], section "llvm.metadata"
+
+define internal i32 @genavb_xdp_prog(%struct.xdp_ctx* nocapture readonly %ctx) #0 section "prog" {
+entry:
+  %key = alloca %struct.genavb_xdp_key, align 2
+  %stream_id = alloca i64, align 8
+  %init = alloca %struct.genavb_xdp_stream_stats, align 8
+  %data_p = getelementptr inbounds %struct.xdp_ctx, %struct.xdp_ctx* %ctx, i64 0, i32 0
+  %data32 = load i32, i32* %data_p, align 4
+  %data_end_p = getelementptr inbounds %struct.xdp_ctx, %struct.xdp_ctx* %ctx, i64 0, i32 1
+  %data_end32 = load i32, i32* %data_end_p, align 4
+  %data64 = zext i32 %data32 to i64
+  %data = inttoptr i64 %data64 to i8*
+  %data_end64 = zext i32 %data_end32 to i64
+  %data_end = inttoptr i64 %data_end64 to i8*
+  %key8 = bitcast %struct.genavb_xdp_key* %key to i8*
+  call void @llvm.memset.p0i8.i64(i8* align 2 %key8, i8 0, i64 10, i1 false)
+  ; if ((void *)(eth + 1) > data_end) return XDP_PASS
+  %eth_end = getelementptr inbounds i8, i8* %data, i64 14
+  %eth_short = icmp ugt i8* %eth_end, %data_end
+  br i1 %eth_short, label %pass, label %eth
+
+eth:
+  ; key.protocol = eth->type, key.dst_mac = eth->dst
+  %type8 = getelementptr inbounds i8, i8* %data, i64 12
+  %type_p = bitcast i8* %type8 to i16*
+  %type = load i16, i16* %type_p, align 2
+  %key_protocol = getelementptr inbounds %struct.genavb_xdp_key, %struct.genavb_xdp_key* %key, i64 0, i32 0
+  store i16 %type, i16* %key_protocol, align 2
+  %key_dst_mac = getelementptr inbounds %struct.genavb_xdp_key, %struct.genavb_xdp_key* %key, i64 0, i32 2, i64 0
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* align 2 %key_dst_mac, i8* align 2 %data, i64 6, i1 false)
+  ; htons(ETHERTYPE_VLAN)
+  %is_vlan = icmp eq i16 %type, 129
+  br i1 %is_vlan, label %vlan, label %no_vlan
+
+vlan:
+  %vlan_end = getelementptr inbounds i8, i8* %data, i64 18
+  %vlan_short = icmp ugt i8* %vlan_end, %data_end
+  br i1 %vlan_short, label %pass, label %vlan_ok
+
+vlan_ok:
+  ; key.protocol = vlan->type, key.vlan_id = htons(VLAN_VID(vlan))
+  %vlan_type8 = getelementptr inbounds i8, i8* %data, i64 16
+  %vlan_type_p = bitcast i8* %vlan_type8 to i16*
+  %vlan_type = load i16, i16* %vlan_type_p, align 2
+  %tci8 = getelementptr inbounds i8, i8* %data, i64 14
+  %tci_p = bitcast i8* %tci8 to i16*
+  %tci = load i16, i16* %tci_p, align 2
+  %vid = and i16 %tci, -241
+  br label %l3
+
+no_vlan:
+  br label %l3
+
+l3:
+  %protocol = phi i16 [ %vlan_type, %vlan_ok ], [ %type, %no_vlan ]
+  %vlan_id = phi i16 [ %vid, %vlan_ok ], [ -1, %no_vlan ]
+  %l3_hdr = phi i8* [ %vlan_end, %vlan_ok ], [ %eth_end, %no_vlan ]
+  store i16 %protocol, i16* %key_protocol, align 2
+  %key_vlan_id = getelementptr inbounds %struct.genavb_xdp_key, %struct.genavb_xdp_key* %key, i64 0, i32 1
+  store i16 %vlan_id, i16* %key_vlan_id, align 2
+  ; htons(ETHERTYPE_AVTP)
+  %is_avtp = icmp eq i16 %protocol, -4062
+  br i1 %is_avtp, label %avtp, label %key_lookup
+
+avtp:
+  ; genavb_xdp_stream(): if ((void *)(avtp + 1) > data_end) return XDP_ABORTED
+  %avtp_end = getelementptr inbounds i8, i8* %l3_hdr, i64 12
+  %avtp_short = icmp ugt i8* %avtp_end, %data_end
+  br i1 %avtp_short, label %key_lookup, label %avtp_ok
+
+avtp_ok:
+  ; if (!(avtp->sv_version_flags & AVTP_SV)) return XDP_ABORTED
+  %sv8 = getelementptr inbounds i8, i8* %l3_hdr, i64 1
+  %sv_flags = load i8, i8* %sv8, align 1
+  %sv = icmp slt i8 %sv_flags, 0
+  br i1 %sv, label %avtp_sv, label %key_lookup
+
+avtp_sv:
+  %stream_id8 = bitcast i64* %stream_id to i8*
+  %avtp_stream_id = getelementptr inbounds i8, i8* %l3_hdr, i64 4
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* align 8 %stream_id8, i8* align 1 %avtp_stream_id, i64 8, i1 false)
+  %pxsk_stream = call i8* inttoptr (i64 1 to i8* (i8*, i8*)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream to i8*), i8* %stream_id8)
+  %stream_miss = icmp eq i8* %pxsk_stream, null
+  br i1 %stream_miss, label %key_lookup, label %stream_found
+
+stream_found:
+  %pxsk_stream32 = bitcast i8* %pxsk_stream to i32*
+  %xsk_stream = load i32, i32* %pxsk_stream32, align 4
+  %seq8 = getelementptr inbounds i8, i8* %l3_hdr, i64 2
+  %seq = load i8, i8* %seq8, align 1
+  ; genavb_xdp_stream_stats()
+  %stats0 = call i8* inttoptr (i64 1 to i8* (i8*, i8*)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream_stats to i8*), i8* %stream_id8)
+  %stats0_null = icmp eq i8* %stats0, null
+  br i1 %stats0_null, label %stats_add, label %stats_update
+
+stats_add:
+  %init8 = bitcast %struct.genavb_xdp_stream_stats* %init to i8*
+  call void @llvm.memset.p0i8.i64(i8* align 8 %init8, i8 0, i64 32, i1 false)
+  %add = call i32 inttoptr (i64 2 to i32 (i8*, i8*, i8*, i64)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream_stats to i8*), i8* %stream_id8, i8* %init8, i64 1)
+  %stats1 = call i8* inttoptr (i64 1 to i8* (i8*, i8*)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xdpstream_stats to i8*), i8* %stream_id8)
+  %stats1_null = icmp eq i8* %stats1, null
+  br i1 %stats1_null, label %stream_redirect, label %stats_update
+
+stats_update:
+  %stats8 = phi i8* [ %stats0, %stream_found ], [ %stats1, %stats_add ]
+  %stats = bitcast i8* %stats8 to %struct.genavb_xdp_stream_stats*
+  %packets_p = getelementptr inbounds %struct.genavb_xdp_stream_stats, %struct.genavb_xdp_stream_stats* %stats, i64 0, i32 0
+  %packets = load i64, i64* %packets_p, align 8
+  %packets_inc = add i64 %packets, 1
+  store i64 %packets_inc, i64* %packets_p, align 8
+  %bytes_p = getelementptr inbounds %struct.genavb_xdp_stream_stats, %struct.genavb_xdp_stream_stats* %stats, i64 0, i32 1
+  %bytes = load i64, i64* %bytes_p, align 8
+  %len = sub i64 %data_end64, %data64
+  %bytes_add = add i64 %bytes, %len
+  store i64 %bytes_add, i64* %bytes_p, align 8
+  %last_seq_p = getelementptr inbounds %struct.genavb_xdp_stream_stats, %struct.genavb_xdp_stream_stats* %stats, i64 0, i32 3
+  %seq_valid_p = getelementptr inbounds %struct.genavb_xdp_stream_stats, %struct.genavb_xdp_stream_stats* %stats, i64 0, i32 4
+  %seq_valid = load i8, i8* %seq_valid_p, align 1
+  %seq_was_valid = icmp ne i8 %seq_valid, 0
+  br i1 %seq_was_valid, label %seq_check, label %seq_store
+
+seq_check:
+  %last_seq = load i8, i8* %last_seq_p, align 8
+  %expected = add i8 %last_seq, 1
+  %seq_ok = icmp eq i8 %expected, %seq
+  br i1 %seq_ok, label %seq_store, label %seq_error
+
+seq_error:
+  %seq_errors_p = getelementptr inbounds %struct.genavb_xdp_stream_stats, %struct.genavb_xdp_stream_stats* %stats, i64 0, i32 2
+  %seq_errors = load i64, i64* %seq_errors_p, align 8
+  %seq_errors_inc = add i64 %seq_errors, 1
+  store i64 %seq_errors_inc, i64* %seq_errors_p, align 8
+  br label %seq_store
+
+seq_store:
+  store i8 %seq, i8* %last_seq_p, align 8
+  store i8 1, i8* %seq_valid_p, align 1
+  br label %stream_redirect
+
+stream_redirect:
+  %xsk_stream64 = zext i32 %xsk_stream to i64
+  %xsk_stream_key = inttoptr i64 %xsk_stream64 to i8*
+  %action_stream = call i32 inttoptr (i64 51 to i32 (i8*, i8*, i32)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xskmap to i8*), i8* %xsk_stream_key, i32 2)
+  ret i32 %action_stream
+
+key_lookup:
+  %pxsk = call i8* inttoptr (i64 1 to i8* (i8*, i8*)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xdpkey to i8*), i8* %key8)
+  %key_miss = icmp eq i8* %pxsk, null
+  br i1 %key_miss, label %pass, label %key_redirect
+
+key_redirect:
+  %pxsk32 = bitcast i8* %pxsk to i32*
+  %xsk = load i32, i32* %pxsk32, align 4
+  %xsk64 = zext i32 %xsk to i64
+  %xsk_key = inttoptr i64 %xsk64 to i8*
+  %action = call i32 inttoptr (i64 51 to i32 (i8*, i8*, i32)*)(i8* bitcast (%struct.bpf_elf_map* @genavb_xskmap to i8*), i8* %xsk_key, i32 2)
+  ret i32 %action
+
+pass:
+  ret i32 2
+}
+
+declare void @llvm.memset.p0i8.i64(i8* nocapture writeonly, i8, i64, i1 immarg) #1
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* noalias nocapture writeonly, i8* noalias nocapture readonly, i64, i1 immarg) #1
+
+attributes #0 = { nounwind }
+attributes #1 = { argmemonly nofree nounwind willreturn }
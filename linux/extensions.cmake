@@ -25,6 +25,41 @@ function(genavb_add_executable)
   install(TARGETS ${ARG_NAME} DESTINATION ${BIN_DIR})
 endfunction()
 
+# genavb_add_test(NAME <target> COMPONENT <component> SRCS <src1 src2 ...> LIBS <lib1 lib2 ...> [NO_CLOCK])
+# Unit test, run by ctest. Tests that also provide a benchmark run it when called with -b.
+# Tests that can't run in the build environment (missing privileges, kernel support) exit with code 77.
+# Tests that simulate the time provide their own clock services (NO_CLOCK).
+function(genavb_add_test)
+  cmake_parse_arguments(ARG "NO_CLOCK" "NAME;COMPONENT" "SRCS;LIBS" ${ARGN})
+
+  if(NOT DEFINED ARG_NAME)
+    return()
+  endif()
+
+  foreach(src IN LISTS ARG_SRCS)
+    list(APPEND srcs "${CMAKE_CURRENT_LIST_DIR}/${src}")
+  endforeach()
+
+  if(NOT ARG_NO_CLOCK)
+    list(APPEND srcs ${TOPDIR}/linux/test/clock.c)
+  endif()
+
+  add_executable(${ARG_NAME} ${srcs} ${TOPDIR}/linux/log.c ${TOPDIR}/linux/stdlib.c ${TOPDIR}/linux/string.c)
+
+  genavb_add_os_component_defines(${ARG_NAME})
+
+  if(DEFINED ARG_COMPONENT)
+    target_compile_options(${ARG_NAME} PRIVATE -include ${TOPDIR}/${ARG_COMPONENT}/config.h)
+  endif()
+
+  target_link_libraries(${ARG_NAME} PRIVATE ${ARG_LIBS} m pthread)
+
+  set_target_properties(${ARG_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/test)
+
+  add_test(NAME ${ARG_NAME} COMMAND ${ARG_NAME})
+  set_tests_properties(${ARG_NAME} PROPERTIES SKIP_RETURN_CODE 77)
+endfunction()
+
 function(genavb_add_executable_alias exec_name alias_name)
   install(CODE "execute_process(COMMAND ln -rsf \$ENV{DESTDIR}/${CMAKE_INSTALL_PREFIX}/${BIN_DIR}/${exec_name} \$ENV{DESTDIR}/${CMAKE_INSTALL_PREFIX}/${BIN_DIR}/${alias_name})")
 endfunction()
@@ -33,16 +33,16 @@
 	(bpm)->family = PF_BRIDGE; \
 	(bpm)->ifindex = ifidx;
 
-static int std_bridge_rtnetlink(u8 *mac_addr, u16 vid, unsigned int port_id, bool add)
+struct std_bridge_mdb_req {
+	struct nlmsghdr nh;
+	struct br_port_msg bpm;
+	char buf[512];
+};
+
+static int std_bridge_mdb_req_init(struct std_bridge_mdb_req *req, u8 *mac_addr, u16 vid, unsigned int port_id, bool add)
 {
 	unsigned int ifindex, br_ifindex;
-	struct iovec iov;
 	u16 nlmsg_type, nlmsg_flags;
-	struct {
-		struct nlmsghdr nh;
-		struct br_port_msg bpm;
-		char buf[512];
-	} req;
 	struct br_mdb_entry entry = {
 		.state = MDB_PERMANENT,
 		.addr.proto = 0,
@@ -51,24 +51,24 @@ static int std_bridge_rtnetlink(u8 *mac_addr, u16 vid, unsigned int port_id, boo
 
 	if (!logical_port_valid(port_id)) {
 		os_log(LOG_ERR, "logical_port(%u) invalid\n", port_id);
-		goto err_no_log;
+		goto err;
 	}
 
 	if (!logical_port_is_bridge(port_id)) {
 		os_log(LOG_ERR, "logical_port(%u) is not a valid bridge port\n", port_id);
-		goto err_no_log;
+		goto err;
 	}
 
 	ifindex = if_nametoindex(logical_port_name(port_id));
 	if (!ifindex) {
 		os_log(LOG_ERR, "if_nametoindex(%s) failed: %s\n", logical_port_name(port_id), strerror(errno));
-		goto err_no_log;
+		goto err;
 	}
 
 	br_ifindex = if_nametoindex(logical_port_bridge_name(port_id));
 	if (!br_ifindex) {
 		os_log(LOG_ERR, "if_nametoindex(%s) failed: %s\n", logical_port_bridge_name(port_id), strerror(errno));
-		goto err_no_log;
+		goto err;
 	}
 
 	if (add) {
@@ -79,32 +79,70 @@ static int std_bridge_rtnetlink(u8 *mac_addr, u16 vid, unsigned int port_id, boo
 		nlmsg_flags = NLM_F_REQUEST;
 	}
 
-	rtnetlink_nlmsghdr_init(&req.nh, NLMSG_LENGTH(sizeof(struct br_port_msg)), nlmsg_type, nlmsg_flags);
+	rtnetlink_nlmsghdr_init(&req->nh, NLMSG_LENGTH(sizeof(struct br_port_msg)), nlmsg_type, nlmsg_flags);
 
-	br_port_msg_mdb_init(&req.bpm, br_ifindex);
+	br_port_msg_mdb_init(&req->bpm, br_ifindex);
 
 	entry.ifindex = ifindex; //port field
 	entry.addr.proto = 0;
 	memcpy(&entry.addr.u, mac_addr, 6);
 
-	if (rtnetlink_attr_add(&req.nh, sizeof(req), MDBA_SET_ENTRY, &entry, sizeof(entry)) < 0)
+	if (rtnetlink_attr_add(&req->nh, sizeof(*req), MDBA_SET_ENTRY, &entry, sizeof(entry)) < 0)
 		goto err;
 
-	iov.iov_base = &req;
-	iov.iov_len = req.nh.nlmsg_len;
-	if (rtnetlink_socket_send_iov(&iov, 1) < 0)
+	return 0;
+
+err:
+	return -1;
+}
+
+struct std_bridge_mdb_ctx {
+	u8 mac_addr[6];
+	u16 vid;
+	unsigned int port_id;
+	bool add;
+};
+
+static void std_bridge_mdb_done(void *data, int err)
+{
+	struct std_bridge_mdb_ctx *ctx = data;
+	u8 *mac_addr = ctx->mac_addr;
+
+	if (!err)
+		os_log(LOG_INFO, "%s MDB: bridge (%s) logical_port(%u) port (%s) mac_addr(%02x:%02x:%02x:%02x:%02x:%02x) vlan_id(%u)\n",
+			ctx->add ? "add" : "remove", logical_port_bridge_name(ctx->port_id), ctx->port_id, logical_port_name(ctx->port_id),
+			mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], ctx->vid);
+	else
+		os_log(LOG_ERR, "%s MDB failed: bridge (%s) logical_port(%u) port (%s) mac_addr(%02x:%02x:%02x:%02x:%02x:%02x) vlan_id(%u): %s\n",
+			ctx->add ? "add" : "remove", logical_port_bridge_name(ctx->port_id), ctx->port_id, logical_port_name(ctx->port_id),
+			mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], ctx->vid, strerror(-err));
+}
+
+/*
+ * The request is only queued, it is sent with the other pending rtnetlink requests
+ * on the next rtnetlink_flush() and its result is logged on acknowledgment.
+ */
+static int std_bridge_rtnetlink(u8 *mac_addr, u16 vid, unsigned int port_id, bool add)
+{
+	struct std_bridge_mdb_req req;
+	struct std_bridge_mdb_ctx ctx;
+
+	if (std_bridge_mdb_req_init(&req, mac_addr, vid, port_id, add) < 0)
 		goto err;
 
-	os_log(LOG_INFO, "%s MDB: bridge (%s, ifindex %u) logical_port(%u) port (%s, ifindex %u) mac_addr(%02x:%02x:%02x:%02x:%02x:%02x) vlan_id(%u)\n",
-			add ? "add" : "remove", logical_port_bridge_name(port_id), br_ifindex, port_id, logical_port_name(port_id), ifindex, mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], vid);
+	memcpy(ctx.mac_addr, mac_addr, 6);
+	ctx.vid = vid;
+	ctx.port_id = port_id;
+	ctx.add = add;
+
+	if (rtnetlink_queue(&req.nh, std_bridge_mdb_done, &ctx, sizeof(ctx)) < 0) {
+		os_log(LOG_ERR, "logical_port(%u) MDB request could not be queued\n", port_id);
+		goto err;
+	}
 
 	return 0;
 
 err:
-	os_log(LOG_ERR, "%s MDB failed: bridge (%s, ifindex %u) logical_port(%u) port (%s, ifindex %u) mac_addr(%02x:%02x:%02x:%02x:%02x:%02x) vlan_id(%u)\n",
-			add ? "add" : "remove", logical_port_bridge_name(port_id), br_ifindex, port_id, logical_port_name(port_id), ifindex, mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], vid);
-
-err_no_log:
 	return -1;
 }
 
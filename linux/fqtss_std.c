@@ -38,12 +38,36 @@
 
 #if defined(TCA_CBS_MAX)
 
+struct fqtss_std_cbs_ctx {
+	unsigned int port_id;
+	unsigned int ifindex;
+	uint64_t idle_slope;
+	u32 handle;
+	uint8_t traffic_class;
+};
+
+static void fqtss_std_cbs_done(void *data, int err)
+{
+	struct fqtss_std_cbs_ctx *ctx = data;
+
+	if (!err)
+		os_log(LOG_INFO, "logical_port(%u) port (%s, ifindex %u) tc(%u) cbs_qdisc_handle(%x:%x): set idle_slope %" PRIu64 " \n",
+			ctx->port_id, logical_port_name(ctx->port_id), ctx->ifindex, ctx->traffic_class, TC_H_MAJ(ctx->handle) >> 16, TC_H_MIN(ctx->handle), ctx->idle_slope);
+	else
+		os_log(LOG_ERR, "logical_port(%u) port (%s, ifindex %u) tc(%u) cbs_qdisc_handle(%x:%x): failed to set idle_slope %" PRIu64 ": %s\n",
+			ctx->port_id, logical_port_name(ctx->port_id), ctx->ifindex, ctx->traffic_class, TC_H_MAJ(ctx->handle) >> 16, TC_H_MIN(ctx->handle), ctx->idle_slope, strerror(-err));
+}
+
+/*
+ * The qdisc update is only queued, it is sent with the other pending rtnetlink requests
+ * on the next rtnetlink_flush() and its result is logged on acknowledgment.
+ */
 static int fqtss_std_set_oper_idle_slope(unsigned int port_id, uint8_t traffic_class, uint64_t idle_slope)
 {
 	unsigned int ifindex;
-	struct iovec iov;
 	bool up, point_to_point;
 	uint64_t port_rate;
+	struct fqtss_std_cbs_ctx ctx;
 	struct {
 		struct nlmsghdr nh;
 		struct tcmsg tcm;
@@ -103,14 +127,15 @@ static int fqtss_std_set_oper_idle_slope(unsigned int port_id, uint8_t traffic_c
 	/* Update the options nested attribute len */
 	options_attr->rta_len = (char *) NLMSG_NEXT_DATA(&req.nh) - (char *)options_attr;
 
-	iov.iov_base = &req;
-	iov.iov_len = req.nh.nlmsg_len;
+	ctx.port_id = port_id;
+	ctx.ifindex = ifindex;
+	ctx.idle_slope = idle_slope;
+	ctx.handle = handle;
+	ctx.traffic_class = traffic_class;
 
-	if (rtnetlink_socket_send_iov(&iov, 1) < 0)
+	if (rtnetlink_queue(&req.nh, fqtss_std_cbs_done, &ctx, sizeof(ctx)) < 0)
 		goto err;
 
-	os_log(LOG_INFO, "logical_port(%u) port (%s, ifindex %u) tc(%u) cbs_qdisc_handle(%x:%x): set idle_slope %" PRIu64 " \n", port_id, logical_port_name(port_id), ifindex, traffic_class, TC_H_MAJ(handle) >> 16, TC_H_MIN(handle), idle_slope);
-
 	return 0;
 
 err:
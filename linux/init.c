@@ -20,7 +20,7 @@
 
 __attribute__((weak)) int shmem_init(struct os_net_config *config) { return 0; };
 __attribute__((weak)) void shmem_exit(void) { };
-__attribute__((weak)) int net_init(struct os_net_config *config, struct os_xdp_config *xdp_config) { return 0; };
+__attribute__((weak)) int net_init(struct os_net_config *config, struct os_std_config *std_config, struct os_xdp_config *xdp_config) { return 0; };
 __attribute__((weak)) void net_exit(void) { };
 __attribute__((weak)) int fdb_init(struct os_net_config *config) { return 0; };
 __attribute__((weak)) void fdb_exit(void) { };
@@ -60,7 +60,7 @@ int os_init(struct os_net_config *net_config)
 	/*
 	* Network layer global init.
 	*/
-	if (net_init(net_config, &config.xdp_config) < 0)
+	if (net_init(net_config, &config.std_config, &config.xdp_config) < 0)
 		goto err_net;
 
 	/*
@@ -2,6 +2,12 @@ include(${CMAKE_CURRENT_LIST_DIR}/configs/configs.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/scripts/scripts.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/ebpf/ebpf.cmake)
 
+option(BUILD_TESTS "Build the unit tests and benchmarks" OFF)
+
+if(BUILD_TESTS)
+  enable_testing()
+endif()
+
 if(CONFIG_AVTP OR CONFIG_AVDECC OR CONFIG_MAAP)
   set(avb avb)
 endif()
@@ -83,6 +89,16 @@ genavb_target_add_srcs(TARGET ${tsn} SRCS net_std.c net_std_socket_filters.c rtn
 genavb_target_add_srcs(TARGET ${avb} SRCS net_avb.c shmem.c)
 genavb_target_add_srcs(TARGET ${tsn} SRCS net_avb.c shmem.c fqtss.c fqtss_avb.c)
 
+# Toolchain needs to have recent io_uring.h kernel header (>= 6.0) for standard sockets io_uring receive and transmit
+include(CheckSymbolExists)
+unset(HAVE_IO_URING_KERNEL_HEADERS CACHE)
+check_symbol_exists(IORING_RECV_MULTISHOT linux/io_uring.h HAVE_IO_URING_KERNEL_HEADERS)
+if(HAVE_IO_URING_KERNEL_HEADERS)
+  genavb_target_add_srcs(TARGET ${tsn} SRCS net_std_uring.c pool.c)
+else()
+  message(WARNING "Cannot detect recent io_uring.h kernel header, standard sockets will not include io_uring support.")
+endif()
+
 if(CONFIG_AVTP)
   genavb_target_add_srcs(TARGET ${avb} SRCS media_clock.c media.c timer_media.c)
   genavb_target_add_srcs(TARGET ${tsn} SRCS timer_media.c)
@@ -95,6 +111,10 @@ if(CONFIG_SOCKET)
   # net_std for genavb shared lib
   genavb_target_add_srcs(TARGET genavb SRCS net.c net_std.c net_std_socket_filters.c)
 
+  if(HAVE_IO_URING_KERNEL_HEADERS)
+    genavb_target_add_srcs(TARGET genavb SRCS net_std_uring.c pool.c)
+  endif()
+
   # Check that we have libbpf headers from sysroot
   unset(HAVE_LIBBPF_HEADERS CACHE)
   check_include_file("bpf/libbpf.h" HAVE_LIBBPF_HEADERS)
@@ -124,3 +144,7 @@ if(CONFIG_SOCKET)
     target_link_libraries(genavb PRIVATE dl)
   endif()
 endif()
+
+if(BUILD_TESTS)
+  include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+endif()
@@ -44,7 +44,7 @@ __attribute__((weak)) int net_xdp_socket_init(void *net_ops, bool is_rx) { retur
 __attribute__((weak)) int net_ipc_socket_init(void *net_ops, bool is_rx) { return -1; };
 
 __attribute__((weak)) int net_avb_init(struct net_mem_ops_cb *net_mem_ops) { return -1; };
-__attribute__((weak)) int net_std_init(struct net_mem_ops_cb *net_mem_ops) { return -1; };
+__attribute__((weak)) int net_std_init(struct os_std_config *std_config, struct net_mem_ops_cb *net_mem_ops, struct net_mem_ops_cb *uring_mem_ops) { return -1; };
 __attribute__((weak)) int net_ipc_init(struct net_mem_ops_cb *net_mem_ops) { return -1; };
 __attribute__((weak)) int net_xdp_init(struct os_xdp_config *xdp_config, struct net_mem_ops_cb *net_mem_ops) { return -1; };
 
@@ -205,6 +205,23 @@ int net_tx_ts_get(struct net_tx *tx, uint64_t *ts, unsigned int *private)
 	return tx->net_ops.net_tx_ts_get(tx, ts, private);
 }
 
+void net_tx_launch_errors(struct net_tx *tx, unsigned int *missed, unsigned int *invalid)
+{
+	*missed = 0;
+	*invalid = 0;
+
+	if (tx->net_ops.net_tx_launch_errors)
+		tx->net_ops.net_tx_launch_errors(tx, missed, invalid);
+}
+
+int net_tx_ts_enable(struct net_tx *tx)
+{
+	if (tx->net_ops.net_tx_ts_enable)
+		return tx->net_ops.net_tx_ts_enable(tx);
+
+	return -1;
+}
+
 struct net_tx_desc *net_tx_alloc(struct net_tx *tx, unsigned int size)
 {
 	return tx->net_ops.net_tx_alloc(size);
@@ -560,7 +577,7 @@ int bridge_software_maclearn(bool enable)
 	return -1;
 }
 
-int net_init(struct os_net_config *config, struct os_xdp_config *xdp_config)
+int net_init(struct os_net_config *config, struct os_std_config *std_config, struct os_xdp_config *xdp_config)
 {
 	socket_fd = socket(PF_INET, SOCK_DGRAM, 0);
 	if (socket_fd < 0) {
@@ -586,7 +603,7 @@ int net_init(struct os_net_config *config, struct os_xdp_config *xdp_config)
 	}
 
 	if (HAS_NET_MODE_ENABLED(net_config.enabled_modes_flag, NET_STD)) {
-		if (net_std_init(&net_mem_handler[POOL_TYPE_STD]) < 0) {
+		if (net_std_init(std_config, &net_mem_handler[POOL_TYPE_STD], &net_mem_handler[POOL_TYPE_STD_URING]) < 0) {
 			os_log(LOG_ERR, "Could not initialize STD network service implementation\n");
 			goto err;
 		}
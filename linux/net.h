@@ -18,7 +18,13 @@
 #include "osal/net.h"
 #include "os_config.h"
 
-int net_init(struct os_net_config *config, struct os_xdp_config *xdp_config);
+struct msghdr;
+struct iovec;
+
+#define NET_STD_RX_CONTROL_SIZE	128
+#define NET_STD_TX_CONTROL_SIZE	(CMSG_SPACE(sizeof(__u32)) + CMSG_SPACE(sizeof(__u64)))
+
+int net_init(struct os_net_config *config, struct os_std_config *std_config, struct os_xdp_config *xdp_config);
 void net_exit(void);
 
 int net_dflt_port_status(struct net_tx *tx, unsigned int port_id, bool *up, bool *point_to_point, uint64_t *rate);
@@ -28,6 +34,30 @@ int net_std_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned ch
 int net_std_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr);
 int net_port_sr_config(unsigned int port_id, uint8_t *sr_class);
 void net_std_rx_parser(struct net_rx *rx, struct net_rx_desc *desc);
+void net_std_rx_msg_complete(struct net_rx *rx, struct net_rx_desc *desc, struct msghdr *msg, unsigned int len);
+struct net_rx_desc *net_std_rx_alloc(unsigned int size);
+void net_std_rx_exit(struct net_rx *rx);
+void net_std_rx_multi(struct net_rx *rx);
+struct net_tx_desc *net_std_tx_alloc(unsigned int size);
+struct net_tx_desc *net_std_tx_clone(struct net_tx_desc *src);
+void net_std_tx_free(struct net_tx_desc *buf);
+void net_std_tx_exit(struct net_tx *tx);
+int net_std_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n);
+void net_std_tx_msg_init(struct net_tx *tx, struct net_tx_desc *desc, struct msghdr *msg, struct iovec *iov, char *control);
+
+int net_std_uring_rx_init(struct net_rx *rx, int epoll_fd);
+void net_std_uring_rx_exit(struct net_rx *rx);
+void net_std_uring_rx_multi(struct net_rx *rx);
+int net_std_uring_init(struct net_mem_ops_cb *net_mem_ops);
+void net_std_uring_exit(void);
+int net_std_uring_tx_init(struct net_tx *tx);
+void net_std_uring_tx_exit(struct net_tx *tx);
+int net_std_uring_tx(struct net_tx *tx, struct net_tx_desc *desc);
+int net_std_uring_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n);
+struct net_tx_desc *net_std_uring_tx_alloc(unsigned int size);
+int net_std_uring_tx_alloc_multi(struct net_tx_desc **desc, unsigned int n, unsigned int size);
+struct net_tx_desc *net_std_uring_tx_clone(struct net_tx_desc *src);
+void net_std_uring_tx_free(struct net_tx_desc *buf);
 int bridge_software_maclearn(bool enable);
 
 #endif /* _LINUX_NET_H_ */
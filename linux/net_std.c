@@ -43,6 +43,22 @@
 
 extern int net_set_hw_ts(unsigned int port_id, bool enable);
 
+__attribute__((weak)) int net_std_uring_rx_init(struct net_rx *rx, int epoll_fd) { return -1; };
+__attribute__((weak)) void net_std_uring_rx_exit(struct net_rx *rx) { return; };
+__attribute__((weak)) void net_std_uring_rx_multi(struct net_rx *rx) { return; };
+__attribute__((weak)) int net_std_uring_init(struct net_mem_ops_cb *net_mem_ops) { return -1; };
+__attribute__((weak)) void net_std_uring_exit(void) { return; };
+__attribute__((weak)) int net_std_uring_tx_init(struct net_tx *tx) { return -1; };
+__attribute__((weak)) void net_std_uring_tx_exit(struct net_tx *tx) { return; };
+__attribute__((weak)) int net_std_uring_tx(struct net_tx *tx, struct net_tx_desc *desc) { return -1; };
+__attribute__((weak)) int net_std_uring_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n) { return -1; };
+__attribute__((weak)) struct net_tx_desc *net_std_uring_tx_alloc(unsigned int size) { return NULL; };
+__attribute__((weak)) int net_std_uring_tx_alloc_multi(struct net_tx_desc **desc, unsigned int n, unsigned int size) { return 0; };
+__attribute__((weak)) struct net_tx_desc *net_std_uring_tx_clone(struct net_tx_desc *src) { return NULL; };
+__attribute__((weak)) void net_std_uring_tx_free(struct net_tx_desc *buf) { return; };
+
+static unsigned int net_std_io_uring;
+
 
 struct net_rx_desc *net_std_rx_alloc(unsigned int size)
 {
@@ -112,7 +128,11 @@ exit:
 
 void net_std_tx_free(struct net_tx_desc *buf)
 {
-	free((void *)buf);
+	/* io_uring transmit buffers may be sent on any standard socket */
+	if (buf->pool_type == POOL_TYPE_STD_URING)
+		net_std_uring_tx_free(buf);
+	else
+		free((void *)buf);
 }
 
 void net_std_rx_free(struct net_rx_desc *buf)
@@ -207,6 +227,120 @@ err_sockopt:
 	return -1;
 }
 
+#ifdef SO_TXTIME
+/*
+ * Enables per frame launch time on a transmit socket. The launch time is
+ * a time of the network adapter clock, so this relies on the ETF qdisc
+ * (or its offload) configured with CLOCK_TAI and the adapter clock being
+ * synchronized to it.
+ */
+static void net_std_set_socket_txtime(struct net_tx *tx)
+{
+	struct sock_txtime txtime_cfg;
+
+	txtime_cfg.clockid = CLOCK_TAI;
+	txtime_cfg.flags = SOF_TXTIME_REPORT_ERRORS;
+
+	if (setsockopt(tx->fd, SOL_SOCKET, SO_TXTIME, &txtime_cfg, sizeof(txtime_cfg)) < 0) {
+		os_log(LOG_INFO, "logical_port(%u) setsockopt(SO_TXTIME) failed: %s, launch time disabled\n", tx->port_id, strerror(errno));
+		tx->txtime = false;
+	} else {
+		tx->txtime = true;
+	}
+
+	tx->txtime_missed = 0;
+	tx->txtime_invalid = 0;
+	tx->txtime_missed_pending = 0;
+	tx->txtime_invalid_pending = 0;
+}
+
+/*
+ * Counts a launch time error report, read from the socket error queue, in the pending errors.
+ * Returns 1 if the message is a launch time error report, 0 otherwise.
+ */
+static int net_std_tx_launch_error(struct net_tx *tx, struct msghdr *msg)
+{
+	struct cmsghdr *cm;
+	struct sock_extended_err *sock_exterr;
+	int rc = 0;
+
+	for (cm = CMSG_FIRSTHDR(msg); cm != NULL; cm = CMSG_NXTHDR(msg, cm)) {
+		if (cm->cmsg_level != SOL_PACKET || cm->cmsg_type != PACKET_TX_TIMESTAMP)
+			continue;
+
+		sock_exterr = (struct sock_extended_err *)CMSG_DATA(cm);
+		if (sock_exterr->ee_origin != SO_EE_ORIGIN_TXTIME)
+			continue;
+
+		if (sock_exterr->ee_code == SO_EE_CODE_TXTIME_MISSED)
+			tx->txtime_missed_pending++;
+		else
+			tx->txtime_invalid_pending++;
+
+		rc = 1;
+	}
+
+	return rc;
+}
+
+/*
+ * Drains the launch time errors reported by the kernel on the socket error queue.
+ * Called on socket error events or periodically (see net_tx_launch_errors()), never from the transmit path.
+ * Sockets used for transmit timestamps are skipped, their error queue is read by net_std_tx_ts_get()
+ * (which counts the launch time errors it reads, reported here).
+ */
+static void net_std_tx_launch_errors(struct net_tx *tx, unsigned int *n_missed, unsigned int *n_invalid)
+{
+	char control[256];
+	struct msghdr msg;
+	unsigned int missed, invalid;
+
+	if (!tx->txtime || tx->func_tx_ts)
+		return;
+
+	while (!tx->tx_ts) {
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		if (recvmsg(tx->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+			break;
+
+		net_std_tx_launch_error(tx, &msg);
+	}
+
+	missed = tx->txtime_missed_pending;
+	invalid = tx->txtime_invalid_pending;
+	tx->txtime_missed_pending = 0;
+	tx->txtime_invalid_pending = 0;
+
+	if (missed || invalid) {
+		tx->txtime_missed += missed;
+		tx->txtime_invalid += invalid;
+
+		os_log(LOG_ERR, "logical_port(%u) launch time errors, missed: %u (total %u), invalid: %u (total %u)\n",
+			tx->port_id, missed, tx->txtime_missed, invalid, tx->txtime_invalid);
+	}
+
+	*n_missed = missed;
+	*n_invalid = invalid;
+}
+#else
+static void net_std_set_socket_txtime(struct net_tx *tx)
+{
+	tx->txtime = false;
+}
+
+static int net_std_tx_launch_error(struct net_tx *tx, struct msghdr *msg)
+{
+	return 0;
+}
+
+static void net_std_tx_launch_errors(struct net_tx *tx, unsigned int *n_missed, unsigned int *n_invalid)
+{
+}
+#endif
+
 static int net_std_get_cmsg_timestamp(struct msghdr *msg, uint64_t *ts)
 {
 	struct cmsghdr *cm;
@@ -323,8 +457,14 @@ static int __net_std_rx_init(struct net_rx *rx, struct net_address *addr, void (
 	if (net_std_rx_bind(rx, addr) < 0)
 		goto err_bind;
 
+	rx->priv = NULL;
+
 	if (epoll_fd >= 0) {
-		if (epoll_ctl_add(epoll_fd, rx->fd, EPOLL_TYPE_NET_RX, rx, &rx->epoll_data, EPOLLIN) < 0) {
+		/* Event driven batched receive, try io_uring first and fallback to recvmmsg() */
+		if (func_multi && net_std_io_uring && !net_std_uring_rx_init(rx, epoll_fd)) {
+			rx->net_ops.net_rx_multi = net_std_uring_rx_multi;
+			rx->net_ops.net_rx_exit = net_std_uring_rx_exit;
+		} else if (epoll_ctl_add(epoll_fd, rx->fd, EPOLL_TYPE_NET_RX, rx, &rx->epoll_data, EPOLLIN) < 0) {
 			os_log(LOG_ERR, "net_rx(%p) epoll_ctl_add() failed\n", rx);
 			goto err_epoll_ctl;
 		}
@@ -335,7 +475,7 @@ static int __net_std_rx_init(struct net_rx *rx, struct net_address *addr, void (
 
 	rx->pool_type = POOL_TYPE_STD;
 
-	os_log(LOG_INIT, "fd(%d)\n", rx->fd);
+	os_log(LOG_INIT, "fd(%d)%s\n", rx->fd, rx->priv ? " io_uring" : "");
 
 	return 0;
 
@@ -368,29 +508,52 @@ void net_std_rx_exit(struct net_rx *rx)
 	os_log(LOG_INFO, "done\n");
 }
 
+static void net_std_rx_msg_init(struct net_rx_desc *desc, struct msghdr *msg, struct iovec *iov, char *control, struct sockaddr_ll *sock_addr)
+{
+	memset(msg, 0, sizeof(*msg));
+
+	iov->iov_base = NET_DATA_START(desc);
+	iov->iov_len = DEFAULT_NET_DATA_SIZE;
+
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	msg->msg_control = control;
+	msg->msg_controllen = NET_STD_RX_CONTROL_SIZE;
+	msg->msg_name = sock_addr;
+	msg->msg_namelen = sizeof(*sock_addr);
+}
+
+void net_std_rx_msg_complete(struct net_rx *rx, struct net_rx_desc *desc, struct msghdr *msg, unsigned int len)
+{
+	struct sockaddr_ll *sock_addr = msg->msg_name;
+	uint64_t ts;
+
+	desc->len = len;
+	desc->port = rx->port_id;
+
+	os_log(LOG_DEBUG, "recvmsg len %u on port %u\n", len, sock_addr->sll_ifindex);
+
+	net_std_get_cmsg_timestamp(msg, &ts);
+
+	clock_time_from_hw(rx->clock_domain, ts, &ts);
+	desc->ts = (uint32_t)ts;
+	desc->ts64 = ts;
+
+	net_std_rx_parser(rx, desc);
+}
+
 struct net_rx_desc *__net_std_rx(struct net_rx *rx)
 {
 	int cnt;
 	struct iovec iov;
 	struct msghdr msg;
-	char control[128];
+	char control[NET_STD_RX_CONTROL_SIZE];
 	struct sockaddr_ll sock_addr;
 	struct net_rx_desc *desc;
-	uint64_t ts;
 
 	desc = net_std_rx_alloc(DEFAULT_NET_DATA_SIZE);
 	if (desc) {
-		memset(&msg, 0, sizeof(msg));
-
-		iov.iov_base = NET_DATA_START(desc);
-		iov.iov_len = DEFAULT_NET_DATA_SIZE;
-
-		msg.msg_iov = &iov;
-		msg.msg_iovlen = 1;
-		msg.msg_control = control;
-		msg.msg_controllen = sizeof(control);
-		msg.msg_name = &sock_addr;
-		msg.msg_namelen = sizeof(sock_addr);
+		net_std_rx_msg_init(desc, &msg, &iov, control, &sock_addr);
 
 		cnt = recvmsg(rx->fd, &msg, 0);
 		if (cnt < 0) {
@@ -401,36 +564,54 @@ struct net_rx_desc *__net_std_rx(struct net_rx *rx)
 			return NULL;
 		}
 
-		desc->len = cnt;
-		desc->port = rx->port_id;
-
-		os_log(LOG_DEBUG, "recvmsg len %d on port %u\n", cnt, sock_addr.sll_ifindex);
-
-		net_std_get_cmsg_timestamp(&msg, &ts);
-
-		clock_time_from_hw(rx->clock_domain, ts, &ts);
-		desc->ts = (uint32_t)ts;
-		desc->ts64 = ts;
-
-		net_std_rx_parser(rx, desc);
+		net_std_rx_msg_complete(rx, desc, &msg, cnt);
 	}
 
 	return desc;
 }
 
+/*
+ * Receives up to NET_RX_BATCH frames with a single recvmmsg() call.
+ */
 void net_std_rx_multi(struct net_rx *rx)
 {
 	struct net_rx_desc *desc[NET_RX_BATCH];
-	int i = 0;
-
-	do {
-		desc[i] = __net_std_rx(rx);
-		if (!desc[i])
+	struct mmsghdr msgvec[NET_RX_BATCH];
+	struct iovec iov[NET_RX_BATCH];
+	char control[NET_RX_BATCH][NET_STD_RX_CONTROL_SIZE];
+	struct sockaddr_ll sock_addr[NET_RX_BATCH];
+	int n, cnt, i;
+
+	for (n = 0; n < NET_RX_BATCH; n++) {
+		desc[n] = net_std_rx_alloc(DEFAULT_NET_DATA_SIZE);
+		if (!desc[n])
 			break;
-		i++;
-	} while ( i < NET_RX_BATCH);
 
-	rx->func_multi(rx, desc, i);
+		net_std_rx_msg_init(desc[n], &msgvec[n].msg_hdr, &iov[n], control[n], &sock_addr[n]);
+		msgvec[n].msg_len = 0;
+	}
+
+	if (!n)
+		goto exit;
+
+	cnt = recvmmsg(rx->fd, msgvec, n, 0, NULL);
+	if (cnt < 0) {
+		if (errno != EAGAIN)
+			os_log(LOG_ERR, "recvmmsg failed: %s\n", strerror(errno));
+
+		cnt = 0;
+	}
+
+	for (i = 0; i < cnt; i++)
+		net_std_rx_msg_complete(rx, desc[i], &msgvec[i].msg_hdr, msgvec[i].msg_len);
+
+	for (i = cnt; i < n; i++)
+		net_std_rx_free(desc[i]);
+
+	n = cnt;
+
+exit:
+	rx->func_multi(rx, desc, n);
 }
 
 void net_std_rx(struct net_rx *rx)
@@ -485,8 +666,10 @@ static int net_std_tx_connect(struct net_tx *tx, struct net_address *addr)
 	return 0;
 }
 
-int net_std_tx_init(struct net_tx *tx, struct net_address *addr)
+static int __net_std_tx_init(struct net_tx *tx, struct net_address *addr, bool io_uring)
 {
+	bool bound;
+
 	if (addr && !net_address_is_supported(addr))
 		goto err_addr;
 
@@ -498,8 +681,11 @@ int net_std_tx_init(struct net_tx *tx, struct net_address *addr)
 		goto err_open_fd;
 	}
 
+	tx->priv = NULL;
+
 	if (addr) {
-		if (net_std_tx_bind(tx, addr) < 0)
+		bound = !(net_std_tx_bind(tx, addr) < 0);
+		if (!bound)
 			os_log(LOG_ERR, "net_std_tx_bind() failed: %s\n", strerror(errno));
 
 		if (net_std_tx_connect(tx, addr) < 0)
@@ -515,11 +701,26 @@ int net_std_tx_init(struct net_tx *tx, struct net_address *addr)
 		if (net_get_local_addr(tx->port_id, tx->eth_src) < 0)
 			goto err_get_local;
 
-		os_log(LOG_INIT, "fd(%d) logical_port(%u)\n", tx->fd, tx->port_id);
+		net_std_set_socket_txtime(tx);
+
+		/* Batched transmit, try io_uring first and fallback to sendmmsg(). Fixed buffer writes need a bound socket */
+		if (io_uring && bound && net_std_io_uring && !net_std_uring_tx_init(tx)) {
+			tx->net_ops.net_tx = net_std_uring_tx;
+			tx->net_ops.net_tx_multi = net_std_uring_tx_multi;
+			tx->net_ops.net_tx_alloc = net_std_uring_tx_alloc;
+			tx->net_ops.net_tx_alloc_multi = net_std_uring_tx_alloc_multi;
+			tx->net_ops.net_tx_clone = net_std_uring_tx_clone;
+			tx->net_ops.net_tx_exit = net_std_uring_tx_exit;
+		}
+
+		os_log(LOG_INIT, "fd(%d) logical_port(%u)%s\n", tx->fd, tx->port_id, tx->priv ? " io_uring" : "");
 	} else {
+		tx->txtime = false;
+
 		os_log(LOG_INIT, "fd(%d)\n", tx->fd);
 	}
 
+	tx->tx_ts = false;
 	tx->pool_type = POOL_TYPE_STD;
 
 	return 0;
@@ -534,6 +735,11 @@ err_addr:
 	return -1;
 }
 
+int net_std_tx_init(struct net_tx *tx, struct net_address *addr)
+{
+	return __net_std_tx_init(tx, addr, true);
+}
+
 void net_std_tx_exit(struct net_tx *tx)
 {
 	close(tx->fd);
@@ -542,41 +748,78 @@ void net_std_tx_exit(struct net_tx *tx)
 	os_log(LOG_INFO, "done\n");
 }
 
-int net_std_tx(struct net_tx *tx, struct net_tx_desc *desc)
+/*
+ * Prepares the message header used to transmit a descriptor
+ */
+void net_std_tx_msg_init(struct net_tx *tx, struct net_tx_desc *desc, struct msghdr *msg, struct iovec *iov, char *control)
 {
 	struct eth_hdr *ethhdr = (struct eth_hdr *)NET_DATA_START(desc);
-	struct msghdr msg;
 	struct cmsghdr *cmsg;
 	u32 *cmsg_data;
-	struct iovec iov[1];
-	char control[CMSG_SPACE(sizeof(__u32))];
-	int rc = -1;
+	size_t controllen;
+	u64 txtime;
+	bool has_txtime = false;
 
 	memcpy(ethhdr->src, tx->eth_src, ETH_ALEN);
 
-	iov[0].iov_base = NET_DATA_START(desc);
-	iov[0].iov_len = desc->len;
+	iov->iov_base = NET_DATA_START(desc);
+	iov->iov_len = desc->len;
+
+	memset(msg, 0, sizeof(struct msghdr));
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	msg->msg_name = NULL;
+	msg->msg_namelen = 0;
+	msg->msg_control = NULL;
+	msg->msg_controllen = 0;
+
+	if ((desc->flags & NET_TX_FLAGS_TS64) && tx->txtime) {
+		/* launch time is given in the clock domain of the port, the kernel expects a network adapter time */
+		if (clock_time_to_hw(tx->clock_domain, desc->ts64, &txtime) < 0)
+			os_log(LOG_ERR, "logical_port(%u) cannot convert launch time %" PRIu64 ", sending now\n", tx->port_id, desc->ts64);
+		else
+			has_txtime = true;
+	}
 
-	memset(&msg, 0, sizeof(struct msghdr));
-	msg.msg_iov = iov;
-	msg.msg_iovlen = 1;
-	msg.msg_name = NULL;
-	msg.msg_namelen = 0;
+	if ((desc->flags & NET_TX_FLAGS_HW_TS) || has_txtime) {
+		memset(control, 0, NET_STD_TX_CONTROL_SIZE);
+		msg->msg_control = control;
+		msg->msg_controllen = NET_STD_TX_CONTROL_SIZE;
+		cmsg = CMSG_FIRSTHDR(msg);
+		controllen = 0;
+
+		if (desc->flags & NET_TX_FLAGS_HW_TS) {
+			cmsg->cmsg_level  = SOL_SOCKET;
+			cmsg->cmsg_type = SO_TIMESTAMPING;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(__u32));
+			cmsg_data = (u32 *)CMSG_DATA(cmsg);
+			*cmsg_data = SOF_TIMESTAMPING_TX_HARDWARE;
+			controllen += CMSG_SPACE(sizeof(__u32));
+
+			cmsg = CMSG_NXTHDR(msg, cmsg);
+		}
 
-	if (desc->flags & NET_TX_FLAGS_HW_TS) {
-		msg.msg_control = control;
-		msg.msg_controllen = sizeof(control);
-		cmsg = CMSG_FIRSTHDR(&msg);
-		cmsg->cmsg_level  = SOL_SOCKET;
-		cmsg->cmsg_type = SO_TIMESTAMPING;
-		cmsg->cmsg_len = CMSG_LEN(sizeof(__u32));
-		cmsg_data = (u32 *)CMSG_DATA(cmsg);
-		*cmsg_data = SOF_TIMESTAMPING_TX_HARDWARE;
-		msg.msg_controllen = cmsg->cmsg_len;
-	} else {
-		msg.msg_control = NULL;
-		msg.msg_controllen = 0;
+#ifdef SO_TXTIME
+		if (has_txtime) {
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_TXTIME;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(__u64));
+			memcpy(CMSG_DATA(cmsg), &txtime, sizeof(__u64));
+			controllen += CMSG_SPACE(sizeof(__u64));
+		}
+#endif
+		msg->msg_controllen = controllen;
 	}
+}
+
+int net_std_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	struct msghdr msg;
+	struct iovec iov[1];
+	char control[NET_STD_TX_CONTROL_SIZE];
+	int rc = -1;
+
+	net_std_tx_msg_init(tx, desc, &msg, iov, control);
 
 	if (sendmsg(tx->fd, &msg, 0) < 0) {
 		os_log(LOG_ERR, "sendmsg() failed: %s (%d)\n", strerror(errno), tx->fd);
@@ -591,17 +834,43 @@ err_send:
 	return rc;
 }
 
+/*
+ * Transmits descriptors by batches of up to NET_TX_BATCH frames, with a single sendmmsg() call per batch.
+ */
 int net_std_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n)
 {
+	struct mmsghdr msgvec[NET_TX_BATCH];
+	struct iovec iov[NET_TX_BATCH];
+	char control[NET_TX_BATCH][NET_STD_TX_CONTROL_SIZE];
 	unsigned int written = 0;
-	int i, rc;
+	unsigned int n_now, i;
+	int rc;
 
 	while (written < n) {
-		rc = net_std_tx(tx, desc[written]);
-		if (rc < 0)
+		n_now = n - written;
+		if (n_now > NET_TX_BATCH)
+			n_now = NET_TX_BATCH;
+
+		for (i = 0; i < n_now; i++) {
+			net_std_tx_msg_init(tx, desc[written + i], &msgvec[i].msg_hdr, &iov[i], control[i]);
+
+			msgvec[i].msg_len = 0;
+		}
+
+		rc = sendmmsg(tx->fd, msgvec, n_now, 0);
+		if (rc <= 0) {
+			os_log(LOG_ERR, "sendmmsg() failed: %s (%d)\n", strerror(errno), tx->fd);
 			goto err;
+		}
+
+		for (i = 0; i < rc; i++)
+			net_std_tx_free(desc[written + i]);
+
+		written += rc;
 
-		written++;
+		/* Partial batch, the socket is full */
+		if (rc < n_now)
+			goto err;
 	}
 
 err:
@@ -624,17 +893,26 @@ int net_std_tx_ts_get(struct net_tx *tx, uint64_t *ts, unsigned int *private)
 	struct eth_hdr *ethhdr;
 	unsigned int ether_type;
 
-	memset(&msg, 0, sizeof(msg));
+	ssize_t len;
+	unsigned int offset;
+	uint32_t data;
 
-	msg.msg_iov = &iov;
-	msg.msg_iovlen = 1;
-	msg.msg_control = control;
-	msg.msg_controllen = sizeof(control);
+	do {
+		memset(&msg, 0, sizeof(msg));
 
-	if (recvmsg(tx->fd, &msg, MSG_ERRQUEUE) < 0) {
-		os_log(LOG_DEBUG, "recvmsg MSG_ERRQUEUE failed: %s\n", strerror(errno));
-		return -1;
-	}
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		len = recvmsg(tx->fd, &msg, MSG_ERRQUEUE);
+		if (len < 0) {
+			os_log(LOG_DEBUG, "recvmsg MSG_ERRQUEUE failed: %s\n", strerror(errno));
+			return -1;
+		}
+
+		/* launch time errors share the error queue, count them (reported by net_tx_launch_errors()) */
+	} while (tx->tx_ts && net_std_tx_launch_error(tx, &msg));
 
 	rc = net_std_get_cmsg_timestamp(&msg, ts);
 	if (rc > 0) {
@@ -646,6 +924,19 @@ int net_std_tx_ts_get(struct net_tx *tx, uint64_t *ts, unsigned int *private)
 
 			/* retreiving message type from the timestamped packet itself */
 			*private = (ptp->transport_specific << 24) | (ptp->domain_number << 16) | ptp->msg_type;
+		} else if (tx->tx_ts) {
+			/* retrieving the first 32 bits of the payload, following the VLAN tag if any */
+			offset = sizeof(struct eth_hdr);
+			if (ether_type == htons(ETHERTYPE_VLAN))
+				offset += sizeof(struct vlanhdr);
+
+			if ((size_t)len < offset + sizeof(data)) {
+				os_log(LOG_ERR, "logical_port(%u) TS on short frame (%zd)\n", tx->port_id, len);
+				rc = -1;
+			} else {
+				memcpy(&data, iobuf + offset, sizeof(data));
+				*private = ntohl(data);
+			}
 		} else {
 			os_log(LOG_ERR, "logical_port(%u) TS on non-PTP type (%d)\n", tx->port_id, ether_type);
 			rc = -1;
@@ -657,6 +948,22 @@ int net_std_tx_ts_get(struct net_tx *tx, uint64_t *ts, unsigned int *private)
 	return rc;
 }
 
+/*
+ * Enables transmit timestamps on a socket created by net_std_tx_init(), for the frames sent with NET_TX_FLAGS_HW_TS.
+ * Timestamping is enabled on the network adapter by the gPTP stack.
+ */
+static int net_std_tx_ts_enable(struct net_tx *tx)
+{
+	if (net_std_set_socket_ts(tx->port_id, tx->fd, 1, true) < 0) {
+		os_log(LOG_ERR, "net_set_socket_ts error\n");
+		return -1;
+	}
+
+	tx->tx_ts = true;
+
+	return 0;
+}
+
 int net_std_tx_ts_init(struct net_tx *tx, struct net_address *addr, void (*func)(struct net_tx *, uint64_t, unsigned int), unsigned long priv)
 {
 	int epoll_fd = priv;
@@ -666,7 +973,8 @@ int net_std_tx_ts_init(struct net_tx *tx, struct net_address *addr, void (*func)
 	if (addr->ptype != PTYPE_PTP)
 		goto err_wrong_ptype;
 
-	if (net_std_tx_init(tx, addr) < 0)
+	/* Transmit timestamps are read from the socket error queue, keep sendmsg() */
+	if (__net_std_tx_init(tx, addr, false) < 0)
 		goto err_tx_init;
 
 	if (net_set_hw_ts(addr->port, true) < 0) {
@@ -718,7 +1026,7 @@ unsigned int net_std_tx_available(struct net_tx *tx)
 
 void net_std_exit(void)
 {
-	return;
+	net_std_uring_exit();
 }
 
 const static struct net_rx_ops_cb net_rx_std_ops = {
@@ -746,6 +1054,8 @@ const static struct net_tx_ops_cb net_tx_std_ops = {
 		.net_tx_ts_get = net_std_tx_ts_get,
 		.net_tx_ts_init = net_std_tx_ts_init,
 		.net_tx_ts_exit = net_std_tx_ts_exit,
+		.net_tx_launch_errors = net_std_tx_launch_errors,
+		.net_tx_ts_enable = net_std_tx_ts_enable,
 
 		.net_tx_available = net_std_tx_available,
 		.net_port_status = net_dflt_port_status,
@@ -773,9 +1083,14 @@ int net_std_socket_init(void *net_ops, bool is_rx)
 	return 0;
 }
 
-int net_std_init(struct net_mem_ops_cb *net_mem_ops)
+int net_std_init(struct os_std_config *std_config, struct net_mem_ops_cb *net_mem_ops, struct net_mem_ops_cb *uring_mem_ops)
 {
 	memcpy(net_mem_ops, &net_std_mem_ops, sizeof(struct net_mem_ops_cb));
 
+	net_std_io_uring = std_config->io_uring;
+
+	if (net_std_io_uring && (net_std_uring_init(uring_mem_ops) < 0))
+		os_log(LOG_ERR, "io_uring transmit buffers not available, transmit will use sendmmsg()\n");
+
 	return 0;
 }
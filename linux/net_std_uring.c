@@ -0,0 +1,751 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Linux standard socket io_uring backend
+ @details
+ Batched receive for standard sockets, using a single multishot recvmsg request per socket.
+ Frames are received into a ring of buffers registered with the kernel (provided buffer ring),
+ so the kernel keeps receiving without any new request or system call from user space. The io_uring
+ file descriptor is polled instead of the socket one, and completions are reaped directly from the
+ shared completion queue.
+ Batched transmit for standard sockets, with one io_uring_enter() call per batch. Transmit descriptors
+ are allocated from a pool of buffers registered with each transmit ring (fixed buffers), and frames
+ without cmsg are sent with a fixed buffer write, so the kernel does not map the user pages for each frame.
+ Frames with a cmsg (launch time, timestamp request) and descriptors allocated outside the pool are sent
+ with a sendmsg request. Descriptors are owned by the ring until their completion is reaped.
+ Enabled with "io_uring = 1" in the [STD] section of the system configuration file. If the kernel
+ does not support it, receive falls back to recvmmsg() and transmit to sendmmsg().
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/if_packet.h>
+#include <linux/io_uring.h>
+
+#include "common/log.h"
+#include "common/net.h"
+#include "epoll.h"
+#include "net.h"
+#include "pool.h"
+
+#define NET_STD_URING_SQ_ENTRIES	4
+#define NET_STD_URING_CQ_ENTRIES	256
+#define NET_STD_URING_RX_BUFS		128	/* must be a power of 2 */
+#define NET_STD_URING_BGID		0
+
+#define NET_STD_URING_TX_ENTRIES	64	/* submission queue size, and maximum number of frames in flight per socket */
+#define NET_STD_URING_TX_BUF_ORDER	11	/* must hold NET_DATA_OFFSET + DEFAULT_NET_DATA_SIZE */
+#define NET_STD_URING_TX_BUFS		256
+#define NET_STD_URING_TX_POOL_SIZE	(NET_STD_URING_TX_BUFS << NET_STD_URING_TX_BUF_ORDER)
+#define NET_STD_URING_TX_BUF_INDEX	0	/* the whole pool is registered as a single fixed buffer */
+
+/* Multishot recvmsg buffer layout: header, name, control, payload */
+#define NET_STD_URING_HDR_SIZE		(sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_ll) + NET_STD_RX_CONTROL_SIZE)
+#define NET_STD_URING_BUF_SIZE		(NET_STD_URING_HDR_SIZE + DEFAULT_NET_DATA_SIZE)
+
+struct net_std_uring_ring {
+	int fd;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	void *cq_ring;
+	size_t cq_ring_size;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+};
+
+struct net_std_uring {
+	struct net_std_uring_ring ring;
+	int epoll_fd;
+
+	struct io_uring_buf_ring *buf_ring;
+	size_t buf_ring_size;
+	u16 buf_tail;
+	u8 *bufs;
+
+	struct msghdr msg;	/* multishot recvmsg template, only name and control lengths are used */
+};
+
+struct net_std_uring_tx_slot {
+	struct net_tx_desc *desc;
+	struct msghdr msg;
+	struct iovec iov;
+	char control[NET_STD_TX_CONTROL_SIZE];
+};
+
+struct net_std_uring_tx {
+	struct net_std_uring_ring ring;
+
+	struct net_std_uring_tx_slot slot[NET_STD_URING_TX_ENTRIES];
+	unsigned int slot_free[NET_STD_URING_TX_ENTRIES];
+	unsigned int n_free;
+};
+
+/* Transmit buffers, shared by all transmit rings */
+static void *net_std_uring_tx_area;
+static struct pool net_std_uring_tx_pool;
+
+static int io_uring_setup(unsigned int entries, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int io_uring_register(int fd, unsigned int opcode, void *arg, unsigned int nr_args)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void net_std_uring_buf_recycle(struct net_std_uring *ctx, unsigned int bid)
+{
+	struct io_uring_buf *buf = &ctx->buf_ring->bufs[ctx->buf_tail & (NET_STD_URING_RX_BUFS - 1)];
+
+	buf->addr = (unsigned long)(ctx->bufs + bid * NET_STD_URING_BUF_SIZE);
+	buf->len = NET_STD_URING_BUF_SIZE;
+	buf->bid = bid;
+
+	ctx->buf_tail++;
+}
+
+static void net_std_uring_buf_publish(struct net_std_uring *ctx)
+{
+	__atomic_store_n(&ctx->buf_ring->tail, ctx->buf_tail, __ATOMIC_RELEASE);
+}
+
+static struct io_uring_sqe *net_std_uring_sqe_get(struct net_std_uring_ring *ring, unsigned int tail)
+{
+	unsigned int index = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+
+	return sqe;
+}
+
+/*
+ * Queues the multishot recvmsg request. The request stays active until the kernel runs
+ * out of buffers, or an error occurs.
+ */
+static int net_std_uring_rx_arm(struct net_rx *rx, struct net_std_uring *ctx)
+{
+	unsigned int tail = *ctx->ring.sq_tail;
+	struct io_uring_sqe *sqe = net_std_uring_sqe_get(&ctx->ring, tail);
+
+	sqe->opcode = IORING_OP_RECVMSG;
+	sqe->fd = rx->fd;
+	sqe->addr = (unsigned long)&ctx->msg;
+	sqe->len = 1;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = NET_STD_URING_BGID;
+	sqe->user_data = (unsigned long)rx;
+
+	__atomic_store_n(ctx->ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	if (io_uring_enter(ctx->ring.fd, 1, 0, 0) < 0) {
+		os_log(LOG_ERR, "net_rx(%p) io_uring_enter() failed: %s\n", rx, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void net_std_uring_ring_exit(struct net_std_uring_ring *ring)
+{
+	if (ring->fd >= 0)
+		close(ring->fd);
+
+	if (ring->sqes)
+		munmap(ring->sqes, ring->sqes_size);
+
+	if (ring->cq_ring)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+
+	if (ring->sq_ring)
+		munmap(ring->sq_ring, ring->sq_ring_size);
+}
+
+static void net_std_uring_free(struct net_std_uring *ctx)
+{
+	net_std_uring_ring_exit(&ctx->ring);
+
+	if (ctx->buf_ring)
+		munmap(ctx->buf_ring, ctx->buf_ring_size);
+
+	free(ctx->bufs);
+	free(ctx);
+}
+
+static int net_std_uring_map(struct net_std_uring_ring *ring, struct io_uring_params *p)
+{
+	u8 *ptr;
+
+	ring->sq_ring_size = p->sq_off.array + p->sq_entries * sizeof(unsigned int);
+	ptr = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ptr == (u8 *)MAP_FAILED)
+		goto err;
+
+	ring->sq_ring = ptr;
+	ring->sq_tail = (unsigned int *)(ptr + p->sq_off.tail);
+	ring->sq_mask = (unsigned int *)(ptr + p->sq_off.ring_mask);
+	ring->sq_array = (unsigned int *)(ptr + p->sq_off.array);
+
+	ring->cq_ring_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+	ptr = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+	if (ptr == (u8 *)MAP_FAILED)
+		goto err;
+
+	ring->cq_ring = ptr;
+	ring->cq_head = (unsigned int *)(ptr + p->cq_off.head);
+	ring->cq_tail = (unsigned int *)(ptr + p->cq_off.tail);
+	ring->cq_mask = (unsigned int *)(ptr + p->cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(ptr + p->cq_off.cqes);
+
+	ring->sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+	ptr = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ptr == (u8 *)MAP_FAILED)
+		goto err;
+
+	ring->sqes = (struct io_uring_sqe *)ptr;
+
+	return 0;
+
+err:
+	os_log(LOG_ERR, "mmap() failed: %s\n", strerror(errno));
+
+	return -1;
+}
+
+static int net_std_uring_ring_init(struct net_std_uring_ring *ring, unsigned int sq_entries, unsigned int cq_entries)
+{
+	struct io_uring_params p;
+
+	memset(&p, 0, sizeof(p));
+	p.flags = IORING_SETUP_CQSIZE;
+	p.cq_entries = cq_entries;
+
+	ring->fd = io_uring_setup(sq_entries, &p);
+	if (ring->fd < 0) {
+		os_log(LOG_INFO, "io_uring_setup() failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return net_std_uring_map(ring, &p);
+}
+
+static int net_std_uring_buf_ring_init(struct net_std_uring *ctx)
+{
+	struct io_uring_buf_reg reg;
+	void *ptr;
+	unsigned int i;
+
+	ctx->bufs = malloc(NET_STD_URING_RX_BUFS * NET_STD_URING_BUF_SIZE);
+	if (!ctx->bufs)
+		goto err;
+
+	/* Ring must be page aligned */
+	ctx->buf_ring_size = NET_STD_URING_RX_BUFS * sizeof(struct io_uring_buf);
+	ptr = mmap(NULL, ctx->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED)
+		goto err;
+
+	ctx->buf_ring = ptr;
+
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (unsigned long)ctx->buf_ring;
+	reg.ring_entries = NET_STD_URING_RX_BUFS;
+	reg.bgid = NET_STD_URING_BGID;
+
+	if (io_uring_register(ctx->ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+		os_log(LOG_ERR, "io_uring_register(PBUF_RING) failed: %s\n", strerror(errno));
+		goto err;
+	}
+
+	ctx->buf_tail = 0;
+
+	for (i = 0; i < NET_STD_URING_RX_BUFS; i++)
+		net_std_uring_buf_recycle(ctx, i);
+
+	net_std_uring_buf_publish(ctx);
+
+	return 0;
+
+err:
+	return -1;
+}
+
+int net_std_uring_rx_init(struct net_rx *rx, int epoll_fd)
+{
+	struct net_std_uring *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx)
+		goto err_alloc;
+
+	if (net_std_uring_ring_init(&ctx->ring, NET_STD_URING_SQ_ENTRIES, NET_STD_URING_CQ_ENTRIES) < 0) {
+		os_log(LOG_INFO, "net_rx(%p) io_uring not available\n", rx);
+		goto err;
+	}
+
+	if (net_std_uring_buf_ring_init(ctx) < 0)
+		goto err;
+
+	ctx->msg.msg_namelen = sizeof(struct sockaddr_ll);
+	ctx->msg.msg_controllen = NET_STD_RX_CONTROL_SIZE;
+
+	if (net_std_uring_rx_arm(rx, ctx) < 0)
+		goto err;
+
+	if (epoll_ctl_add(epoll_fd, ctx->ring.fd, EPOLL_TYPE_NET_RX, rx, &rx->epoll_data, EPOLLIN) < 0) {
+		os_log(LOG_ERR, "net_rx(%p) epoll_ctl_add() failed\n", rx);
+		goto err;
+	}
+
+	ctx->epoll_fd = epoll_fd;
+	rx->priv = ctx;
+
+	return 0;
+
+err:
+	net_std_uring_free(ctx);
+
+err_alloc:
+	return -1;
+}
+
+void net_std_uring_rx_exit(struct net_rx *rx)
+{
+	struct net_std_uring *ctx = rx->priv;
+
+	if (ctx) {
+		epoll_ctl_del(ctx->epoll_fd, ctx->ring.fd);
+		net_std_uring_free(ctx);
+		rx->priv = NULL;
+	}
+
+	net_std_rx_exit(rx);
+}
+
+/*
+ * Switches the socket back to recvmmsg() based receive, if the multishot request
+ * cannot be used (e.g. not supported by the kernel).
+ */
+static void net_std_uring_fallback(struct net_rx *rx, struct net_std_uring *ctx)
+{
+	int epoll_fd = ctx->epoll_fd;
+
+	os_log(LOG_ERR, "net_rx(%p) fd(%d) io_uring disabled, fallback to recvmmsg()\n", rx, rx->fd);
+
+	epoll_ctl_del(epoll_fd, ctx->ring.fd);
+	net_std_uring_free(ctx);
+	rx->priv = NULL;
+
+	rx->net_ops.net_rx_multi = net_std_rx_multi;
+	rx->net_ops.net_rx_exit = net_std_rx_exit;
+
+	if (epoll_ctl_add(epoll_fd, rx->fd, EPOLL_TYPE_NET_RX, rx, &rx->epoll_data, EPOLLIN) < 0)
+		os_log(LOG_ERR, "net_rx(%p) epoll_ctl_add() failed\n", rx);
+}
+
+/*
+ * Copies a frame received by the multishot request to a new receive descriptor
+ * \return pointer to receive descriptor, NULL on error
+ */
+static struct net_rx_desc *net_std_uring_rx_frame(struct net_rx *rx, u8 *buf, unsigned int size)
+{
+	struct io_uring_recvmsg_out *out = (struct io_uring_recvmsg_out *)buf;
+	struct net_rx_desc *desc;
+	struct msghdr msg;
+	unsigned int len;
+
+	if (size < NET_STD_URING_HDR_SIZE)
+		return NULL;
+
+	/* Payload is truncated to the buffer size */
+	len = out->payloadlen;
+	if (len > (size - NET_STD_URING_HDR_SIZE))
+		len = size - NET_STD_URING_HDR_SIZE;
+
+	desc = net_std_rx_alloc(DEFAULT_NET_DATA_SIZE);
+	if (!desc)
+		return NULL;
+
+	memcpy(NET_DATA_START(desc), buf + NET_STD_URING_HDR_SIZE, len);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = out + 1;
+	msg.msg_namelen = out->namelen;
+	msg.msg_control = buf + sizeof(*out) + sizeof(struct sockaddr_ll);
+	msg.msg_controllen = out->controllen;
+	msg.msg_flags = out->flags;
+
+	net_std_rx_msg_complete(rx, desc, &msg, len);
+
+	return desc;
+}
+
+/*
+ * Reaps up to NET_RX_BATCH received frames from the completion queue, without any system call
+ * (except to re-arm the multishot request).
+ */
+void net_std_uring_rx_multi(struct net_rx *rx)
+{
+	struct net_std_uring *ctx = rx->priv;
+	struct net_rx_desc *desc[NET_RX_BATCH];
+	struct io_uring_cqe *cqe;
+	unsigned int head, tail, bid;
+	bool rearm = false, fallback = false;
+	int n = 0;
+
+	head = *ctx->ring.cq_head;
+	tail = __atomic_load_n(ctx->ring.cq_tail, __ATOMIC_ACQUIRE);
+
+	while ((head != tail) && (n < NET_RX_BATCH)) {
+		cqe = &ctx->ring.cqes[head & *ctx->ring.cq_mask];
+		head++;
+
+		if (!(cqe->flags & IORING_CQE_F_MORE))
+			rearm = true;
+
+		if (cqe->res < 0) {
+			/* Out of buffers is recovered by re-arming, any other error disables io_uring */
+			if (cqe->res != -ENOBUFS) {
+				os_log(LOG_ERR, "net_rx(%p) multishot recvmsg failed: %s\n", rx, strerror(-cqe->res));
+				fallback = true;
+			}
+
+			continue;
+		}
+
+		if (!(cqe->flags & IORING_CQE_F_BUFFER))
+			continue;
+
+		bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+		desc[n] = net_std_uring_rx_frame(rx, ctx->bufs + bid * NET_STD_URING_BUF_SIZE, cqe->res);
+		if (desc[n])
+			n++;
+
+		net_std_uring_buf_recycle(ctx, bid);
+	}
+
+	__atomic_store_n(ctx->ring.cq_head, head, __ATOMIC_RELEASE);
+	net_std_uring_buf_publish(ctx);
+
+	if (fallback)
+		net_std_uring_fallback(rx, ctx);
+	else if (rearm && (net_std_uring_rx_arm(rx, ctx) < 0))
+		net_std_uring_fallback(rx, ctx);
+
+	rx->func_multi(rx, desc, n);
+}
+
+static inline bool net_std_uring_tx_registered(void *addr)
+{
+	return (addr >= net_std_uring_tx_pool.baseaddr) && (addr < net_std_uring_tx_pool.end);
+}
+
+struct net_tx_desc *net_std_uring_tx_alloc(unsigned int size)
+{
+	struct net_tx_desc *desc;
+
+	if (size > DEFAULT_NET_DATA_SIZE)
+		return NULL;
+
+	/* Pool exhausted, fallback to a buffer sent with sendmsg */
+	desc = pool_alloc(&net_std_uring_tx_pool);
+	if (!desc)
+		return net_std_tx_alloc(size);
+
+	desc->flags = 0;
+	desc->len = 0;
+	desc->l2_offset = NET_DATA_OFFSET;
+	desc->pool_type = POOL_TYPE_STD_URING;
+
+	return desc;
+}
+
+int net_std_uring_tx_alloc_multi(struct net_tx_desc **desc, unsigned int n, unsigned int size)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		desc[i] = net_std_uring_tx_alloc(size);
+		if (!desc[i])
+			goto err_malloc;
+	}
+
+err_malloc:
+	return i;
+}
+
+struct net_tx_desc *net_std_uring_tx_clone(struct net_tx_desc *src)
+{
+	struct net_tx_desc *desc;
+
+	desc = pool_alloc(&net_std_uring_tx_pool);
+	if (!desc)
+		return net_std_tx_clone(src);
+
+	memcpy(desc, src, src->l2_offset + src->len);
+
+	desc->pool_type = POOL_TYPE_STD_URING;
+
+	return desc;
+}
+
+void net_std_uring_tx_free(struct net_tx_desc *buf)
+{
+	pool_free(&net_std_uring_tx_pool, (void *)pool_align(&net_std_uring_tx_pool, (unsigned long)buf));
+}
+
+void net_std_uring_free_multi(void **buf, unsigned int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		pool_free(&net_std_uring_tx_pool, (void *)pool_align(&net_std_uring_tx_pool, (unsigned long)buf[i]));
+}
+
+/*
+ * Reaps transmit completions, and releases the descriptors and slots of the completed frames.
+ * Frames sent on a non-blocking packet socket usually complete inline, during io_uring_enter().
+ */
+static void net_std_uring_tx_reap(struct net_tx *tx, struct net_std_uring_tx *ctx)
+{
+	struct net_std_uring_ring *ring = &ctx->ring;
+	struct io_uring_cqe *cqe;
+	unsigned int head, tail, index;
+
+	head = *ring->cq_head;
+	tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+	while (head != tail) {
+		cqe = &ring->cqes[head & *ring->cq_mask];
+		head++;
+
+		index = cqe->user_data;
+
+		if (cqe->res < 0)
+			os_log(LOG_ERR, "net_tx(%p) fd(%d) send failed: %s\n", tx, tx->fd, strerror(-cqe->res));
+
+		net_std_tx_free(ctx->slot[index].desc);
+		ctx->slot_free[ctx->n_free++] = index;
+	}
+
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void net_std_uring_tx_prep(struct net_tx *tx, struct net_std_uring_tx *ctx, struct io_uring_sqe *sqe, struct net_tx_desc *desc)
+{
+	unsigned int index = ctx->slot_free[--ctx->n_free];
+	struct net_std_uring_tx_slot *slot = &ctx->slot[index];
+
+	net_std_tx_msg_init(tx, desc, &slot->msg, &slot->iov, slot->control);
+	slot->desc = desc;
+
+	if (!slot->msg.msg_controllen && net_std_uring_tx_registered(desc)) {
+		/* The socket is bound to the port, a plain write sends the frame */
+		sqe->opcode = IORING_OP_WRITE_FIXED;
+		sqe->addr = (unsigned long)slot->iov.iov_base;
+		sqe->len = slot->iov.iov_len;
+		sqe->buf_index = NET_STD_URING_TX_BUF_INDEX;
+	} else {
+		sqe->opcode = IORING_OP_SENDMSG;
+		sqe->addr = (unsigned long)&slot->msg;
+		sqe->len = 1;
+	}
+
+	sqe->fd = tx->fd;
+	sqe->user_data = index;
+}
+
+/*
+ * Queues descriptors by batches of up to NET_STD_URING_TX_ENTRIES frames, with a single io_uring_enter() call per batch.
+ * Send errors are only known on completion, and are logged then.
+ * \return number of frames queued, -1 if none
+ */
+int net_std_uring_tx_multi(struct net_tx *tx, struct net_tx_desc **desc, unsigned int n)
+{
+	struct net_std_uring_tx *ctx = tx->priv;
+	struct net_std_uring_ring *ring = &ctx->ring;
+	unsigned int written = 0;
+	unsigned int n_now, tail, i;
+	int rc;
+
+	while (written < n) {
+		net_std_uring_tx_reap(tx, ctx);
+
+		n_now = n - written;
+		if (n_now > ctx->n_free)
+			n_now = ctx->n_free;
+
+		/* All slots in flight, the socket is full */
+		if (!n_now)
+			break;
+
+		tail = *ring->sq_tail;
+
+		for (i = 0; i < n_now; i++)
+			net_std_uring_tx_prep(tx, ctx, net_std_uring_sqe_get(ring, tail + i), desc[written + i]);
+
+		__atomic_store_n(ring->sq_tail, tail + n_now, __ATOMIC_RELEASE);
+
+		/* The descriptors are now owned by the ring, entries not consumed by this call are submitted by the next one */
+		written += n_now;
+
+		rc = io_uring_enter(ring->fd, NET_STD_URING_TX_ENTRIES, 0, 0);
+		if (rc < 0) {
+			os_log(LOG_ERR, "net_tx(%p) io_uring_enter() failed: %s\n", tx, strerror(errno));
+			break;
+		}
+	}
+
+	net_std_uring_tx_reap(tx, ctx);
+
+	for (i = written; i < n; i++)
+		net_std_tx_free(desc[i]);
+
+	if (written)
+		return written;
+	else
+		return -1;
+}
+
+int net_std_uring_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	return (net_std_uring_tx_multi(tx, &desc, 1) == 1) ? 0 : -1;
+}
+
+int net_std_uring_tx_init(struct net_tx *tx)
+{
+	struct net_std_uring_tx *ctx;
+	struct iovec iov;
+	unsigned int i;
+
+	if (!net_std_uring_tx_area)
+		goto err_alloc;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx)
+		goto err_alloc;
+
+	if (net_std_uring_ring_init(&ctx->ring, NET_STD_URING_TX_ENTRIES, 2 * NET_STD_URING_TX_ENTRIES) < 0) {
+		os_log(LOG_INFO, "net_tx(%p) io_uring not available\n", tx);
+		goto err;
+	}
+
+	iov.iov_base = net_std_uring_tx_pool.baseaddr;
+	iov.iov_len = (char *)net_std_uring_tx_pool.end - (char *)net_std_uring_tx_pool.baseaddr;
+
+	if (io_uring_register(ctx->ring.fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+		os_log(LOG_ERR, "net_tx(%p) io_uring_register(BUFFERS) failed: %s\n", tx, strerror(errno));
+		goto err;
+	}
+
+	for (i = 0; i < NET_STD_URING_TX_ENTRIES; i++)
+		ctx->slot_free[i] = NET_STD_URING_TX_ENTRIES - 1 - i;
+
+	ctx->n_free = NET_STD_URING_TX_ENTRIES;
+
+	tx->priv = ctx;
+
+	return 0;
+
+err:
+	net_std_uring_ring_exit(&ctx->ring);
+	free(ctx);
+
+err_alloc:
+	return -1;
+}
+
+void net_std_uring_tx_exit(struct net_tx *tx)
+{
+	struct net_std_uring_tx *ctx = tx->priv;
+	unsigned int i;
+
+	if (ctx) {
+		/* Closing the ring cancels the requests still in flight, their descriptors can then be released */
+		net_std_uring_ring_exit(&ctx->ring);
+
+		for (i = 0; i < ctx->n_free; i++)
+			ctx->slot[ctx->slot_free[i]].desc = NULL;
+
+		for (i = 0; i < NET_STD_URING_TX_ENTRIES; i++)
+			if (ctx->slot[i].desc)
+				net_std_tx_free(ctx->slot[i].desc);
+
+		free(ctx);
+		tx->priv = NULL;
+	}
+
+	net_std_tx_exit(tx);
+}
+
+/*
+ * Allocates the transmit buffer pool, registered with each transmit ring
+ */
+int net_std_uring_init(struct net_mem_ops_cb *net_mem_ops)
+{
+	net_std_uring_tx_area = mmap(NULL, NET_STD_URING_TX_POOL_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (net_std_uring_tx_area == MAP_FAILED) {
+		os_log(LOG_ERR, "mmap() failed: %s\n", strerror(errno));
+		goto err_mmap;
+	}
+
+	if (pool_init(&net_std_uring_tx_pool, net_std_uring_tx_area, NET_STD_URING_TX_POOL_SIZE, NET_STD_URING_TX_BUF_ORDER) < 0) {
+		os_log(LOG_ERR, "pool_init() failed\n");
+		goto err_pool;
+	}
+
+	net_mem_ops->net_tx_free = net_std_uring_tx_free;
+	net_mem_ops->net_rx_free = NULL;
+	net_mem_ops->net_free_multi = net_std_uring_free_multi;
+
+	return 0;
+
+err_pool:
+	munmap(net_std_uring_tx_area, NET_STD_URING_TX_POOL_SIZE);
+
+err_mmap:
+	net_std_uring_tx_area = NULL;
+
+	return -1;
+}
+
+void net_std_uring_exit(void)
+{
+	if (!net_std_uring_tx_area)
+		return;
+
+	pool_exit(&net_std_uring_tx_pool);
+	munmap(net_std_uring_tx_area, NET_STD_URING_TX_POOL_SIZE);
+	net_std_uring_tx_area = NULL;
+}
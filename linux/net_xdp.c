@@ -29,6 +29,7 @@
 #include <bpf/bpf.h>
 #include <linux/if_link.h>
 
+#include "genavb/avtp.h"
 #include "common/log.h"
 #include "common/net.h"
 #include "common/list.h"
@@ -79,6 +80,8 @@
 
 #define GENAVB_XDPKEY_NAME "/sys/fs/bpf/xdp/globals/genavb_xdpkey"
 #define GENAVB_XSKMAP_NAME "/sys/fs/bpf/xdp/globals/genavb_xskmap"
+#define GENAVB_XDPSTREAM_NAME "/sys/fs/bpf/xdp/globals/genavb_xdpstream"
+#define GENAVB_XDPSTREAM_STATS_NAME "/sys/fs/bpf/xdp/globals/genavb_xdpstream_stats"
 
 struct net_xdp_umem {
 	struct xsk_umem *umem;
@@ -104,6 +107,7 @@ typedef int  (*FUNC_bpf_map_update_elem)(int, const void *, const void *, __u64)
 typedef int  (*FUNC_bpf_obj_get)(const char *);
 typedef int  (*FUNC_bpf_map_lookup_elem)(int, const void *, void *);
 typedef int  (*FUNC_bpf_map_delete_elem)(int, const void *);
+typedef int  (*FUNC_libbpf_num_possible_cpus)(void);
 typedef int  (*FUNC_xsk_umem__create)(struct xsk_umem **, void *, __u64, struct xsk_ring_prod *, struct xsk_ring_cons *, const struct xsk_umem_config *);
 typedef int  (*FUNC_xsk_umem__delete)(struct xsk_umem *);
 typedef int  (*FUNC_xsk_socket__create)(struct xsk_socket **, const char *, __u32, struct xsk_umem *, struct xsk_ring_cons *, struct xsk_ring_prod *, const struct xsk_socket_config *);
@@ -119,6 +123,7 @@ struct xdp_dl_libs_ctx {
 	FUNC_bpf_obj_get		bpf_obj_get;
 	FUNC_bpf_map_lookup_elem	bpf_map_lookup_elem;
 	FUNC_bpf_map_delete_elem	bpf_map_delete_elem;
+	FUNC_libbpf_num_possible_cpus	libbpf_num_possible_cpus;
 	FUNC_xsk_umem__create		xsk_umem__create;
 	FUNC_xsk_umem__delete		xsk_umem__delete;
 	FUNC_xsk_socket__create		xsk_socket__create;
@@ -142,6 +147,8 @@ static uint64_t free_index_bmap[BMAP_ARRAY_LEN];
 
 static int xskmap_fd = -1;
 static int xdpkey_fd = -1;
+static int xdpstream_fd = -1; /* optional, only present if the XDP program supports per stream steering */
+static int xdpstream_stats_fd = -1;
 
 static struct os_xdp_config xdp_config;
 
@@ -187,12 +194,119 @@ err:
 	pthread_mutex_unlock(&umem_lock);
 }
 
+static int net_xdp_xskmap_add_stream(struct net_address *addr, int xsk_fd)
+{
+	uint64_t stream_id;
+	uint32_t xsk;
+	int rc;
+
+	if ((xdpstream_fd == -1) || (xskmap_fd == -1))
+		goto err_idx;
+
+	memcpy(&stream_id, addr->u.avtp.stream_id, 8);
+
+	rc = get_unique_index(&xsk);
+	if (rc < 0)
+		goto err_idx;
+
+	rc = xdp_dl_libs.bpf_map_update_elem(xdpstream_fd, &stream_id, &xsk, 0);
+	if (rc)
+		goto err_xdp;
+
+	rc = xdp_dl_libs.bpf_map_update_elem(xskmap_fd, &xsk, &xsk_fd, 0);
+	if (rc)
+		goto err_xsk;
+
+	return 0;
+
+err_xsk:
+	xdp_dl_libs.bpf_map_delete_elem(xdpstream_fd, &stream_id);
+err_xdp:
+	release_unique_index(xsk);
+err_idx:
+	return -1;
+}
+
+/*
+ * Sums the per-cpu counters of a stream
+ */
+static int net_xdp_stream_stats_get(uint64_t stream_id, struct genavb_xdp_stream_stats *stats)
+{
+	struct genavb_xdp_stream_stats *cpu_stats;
+	int n_cpus, i, rc = -1;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if (xdpstream_stats_fd == -1)
+		goto err;
+
+	n_cpus = xdp_dl_libs.libbpf_num_possible_cpus();
+	if (n_cpus <= 0)
+		goto err;
+
+	cpu_stats = calloc(n_cpus, sizeof(*cpu_stats));
+	if (!cpu_stats)
+		goto err;
+
+	if (xdp_dl_libs.bpf_map_lookup_elem(xdpstream_stats_fd, &stream_id, cpu_stats))
+		goto err_lookup;
+
+	for (i = 0; i < n_cpus; i++) {
+		stats->packets += cpu_stats[i].packets;
+		stats->bytes += cpu_stats[i].bytes;
+		stats->seq_errors += cpu_stats[i].seq_errors;
+	}
+
+	rc = 0;
+
+err_lookup:
+	free(cpu_stats);
+err:
+	return rc;
+}
+
+static int net_xdp_xskmap_del_stream(struct net_address *addr)
+{
+	struct genavb_xdp_stream_stats stats;
+	uint64_t stream_id;
+	uint32_t xsk;
+
+	if ((xdpstream_fd == -1) || (xskmap_fd == -1)) {
+		os_log(LOG_ERR, "File descriptors for eBPF maps not initialized\n");
+		return -1;
+	}
+
+	memcpy(&stream_id, addr->u.avtp.stream_id, 8);
+
+	if (xdp_dl_libs.bpf_map_lookup_elem(xdpstream_fd, &stream_id, &xsk)) {
+		os_log(LOG_ERR, "Could not find XDP entry for stream_id(%016"PRIx64")\n", ntohll(stream_id));
+		return -1;
+	}
+
+	if (!net_xdp_stream_stats_get(stream_id, &stats))
+		os_log(LOG_INFO, "stream_id(%016"PRIx64") packets(%"PRIu64") bytes(%"PRIu64") seq_errors(%"PRIu64")\n",
+			ntohll(stream_id), stats.packets, stats.bytes, stats.seq_errors);
+
+	xdp_dl_libs.bpf_map_delete_elem(xdpstream_fd, &stream_id);
+	xdp_dl_libs.bpf_map_delete_elem(xskmap_fd, &xsk);
+
+	if (xdpstream_stats_fd != -1)
+		xdp_dl_libs.bpf_map_delete_elem(xdpstream_stats_fd, &stream_id);
+
+	release_unique_index(xsk);
+
+	return 0;
+}
+
 static int net_xdp_xskmap_add_addr(struct net_address *addr, int xsk_fd)
 {
 	int rc;
 	struct genavb_xdp_key key;
 	uint32_t xsk;
 
+	if (addr->ptype == PTYPE_AVTP)
+		return net_xdp_xskmap_add_stream(addr, xsk_fd);
+
 	if ((xdpkey_fd == -1) || (xskmap_fd == -1))
 		goto err_idx;
 
@@ -228,6 +342,9 @@ static int net_xdp_xskmap_del_addr(struct net_address *addr)
 	uint32_t xsk;
 	int rc;
 
+	if (addr->ptype == PTYPE_AVTP)
+		return net_xdp_xskmap_del_stream(addr);
+
 	if ((xdpkey_fd == -1) || (xskmap_fd == -1)) {
 		os_log(LOG_ERR, "File descriptors for eBPF maps not initialized\n");
 		return -1;
@@ -507,6 +624,10 @@ static bool net_address_is_supported(struct net_address *addr)
 	case PTYPE_L2:
 		rc = true;
 		break;
+	case PTYPE_AVTP:
+		/* AVTP streams are steered on their stream ID, if the XDP program supports it */
+		rc = (xdpstream_fd != -1) && !is_avtp_avdecc(addr->u.avtp.subtype);
+		break;
 	default:
 		rc = false;
 		break;
@@ -1000,6 +1121,7 @@ static int xdp_dyn_load_libs_init(struct xdp_dl_libs_ctx *dl_libs_ctx)
 	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_bpf_hdl, bpf_map_lookup_elem, status);
 	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_bpf_hdl, bpf_map_update_elem, status);
 	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_bpf_hdl, bpf_obj_get, status);
+	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_bpf_hdl, libbpf_num_possible_cpus, status);
 
 	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_xdp_hdl, xsk_umem__create, status);
 	LOAD_LIB_SYMBOL(dl_libs_ctx, dl_libs_ctx->lib_xdp_hdl, xsk_socket__create, status);
@@ -1071,6 +1193,15 @@ int net_xdp_init(struct os_xdp_config *config, struct net_mem_ops_cb *net_mem_op
 		}
 	}
 
+	xdpstream_fd = xdp_dl_libs.bpf_obj_get(GENAVB_XDPSTREAM_NAME);
+	if (xdpstream_fd == -1) {
+		os_log(LOG_INFO, "Could not find XDP stream map, per stream steering disabled\n");
+	} else {
+		xdpstream_stats_fd = xdp_dl_libs.bpf_obj_get(GENAVB_XDPSTREAM_STATS_NAME);
+		if (xdpstream_stats_fd == -1)
+			os_log(LOG_INFO, "Could not find XDP stream stats map\n");
+	}
+
 	memset(free_index_bmap, 0xff, sizeof(free_index_bmap));
 
 	os_memcpy(&xdp_config, config, sizeof(struct os_xdp_config));
@@ -24,6 +24,8 @@
 const int XDP_ENDPOINT_QUEUE_RX_DEFAULT[2] = { 0, 0 };
 const int XDP_ENDPOINT_QUEUE_TX_DEFAULT[2] = { 1, 1 };
 
+#define STD_IO_URING_DEFAULT	0
+
 static int process_section_logical_port(struct _SECTIONENTRY *configtree, struct os_logical_port_config *config)
 {
 	if (cfg_get_string_list(configtree, "LOGICAL_PORT", "endpoint", LOGICAL_PORT_ENDPOINT_DEFAULT, config->endpoint, CFG_MAX_ENDPOINTS) < 0)
@@ -89,6 +91,17 @@ err:
 	return -1;
 }
 
+static int process_section_std(struct _SECTIONENTRY *configtree, struct os_std_config *config)
+{
+	if (cfg_get_uint(configtree, "STD", "io_uring", STD_IO_URING_DEFAULT, 0, 1, &config->io_uring) < 0)
+		goto err;
+
+	return 0;
+
+err:
+	return -1;
+}
+
 static int process_os_config(struct os_config *config, struct _SECTIONENTRY *configtree)
 {
 
@@ -105,6 +118,9 @@ static int process_os_config(struct os_config *config, struct _SECTIONENTRY *con
 	if (process_section_xdp(configtree, &config->xdp_config))
 		goto err;
 
+	if (process_section_std(configtree, &config->std_config))
+		goto err;
+
 	return 0;
 
 err:
@@ -56,6 +56,10 @@ struct os_config {
 		int endpoint_queue_rx[CFG_MAX_ENDPOINTS];
 		int endpoint_queue_tx[CFG_MAX_ENDPOINTS];
 	} xdp_config;
+
+	struct os_std_config {
+		unsigned int io_uring;		/* receive and transmit with io_uring instead of recvmmsg()/sendmmsg(), if supported */
+	} std_config;
 };
 
 int os_config_get(struct os_config *config);
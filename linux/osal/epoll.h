@@ -21,6 +21,7 @@ typedef enum {
 	EPOLL_TYPE_MEDIA,
 	EPOLL_TYPE_NET_TX_TS,
 	EPOLL_TYPE_NET_TX_EVENT,
+	EPOLL_TYPE_EVENT,
 } epoll_type_t;
 
 
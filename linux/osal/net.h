@@ -39,6 +39,8 @@ struct net_tx_ops_cb {
 	int (*net_tx_ts_get)(struct net_tx *, uint64_t *, unsigned int *);
 	int (*net_tx_ts_init)(struct net_tx *, struct net_address *, void (*func)(struct net_tx *, uint64_t, unsigned int), unsigned long);
 	int (*net_tx_ts_exit)(struct net_tx *);
+	void (*net_tx_launch_errors)(struct net_tx *, unsigned int *, unsigned int *);
+	int (*net_tx_ts_enable)(struct net_tx *);
 
 	unsigned int (*net_tx_available)(struct net_tx *);
 	int (*net_port_status)(struct net_tx *, unsigned int, bool *, bool *, uint64_t *);
@@ -70,6 +72,12 @@ struct net_tx {
 	unsigned int pool_type;
 	struct net_tx_ops_cb net_ops;
 	struct ipc_tx ipc_tx; /* used for sending network buffers over IPC */
+	bool txtime; /* launch time (SO_TXTIME) enabled, frames with NET_TX_FLAGS_TS64 are sent at desc->ts64 */
+	unsigned int txtime_missed; /* frames dropped because their launch time was missed */
+	unsigned int txtime_invalid; /* frames dropped because of an invalid launch time */
+	bool tx_ts; /* transmit timestamps enabled (net_tx_ts_enable()), the error queue is read by net_tx_ts_get() */
+	unsigned int txtime_missed_pending; /* launch time errors read by net_tx_ts_get(), not yet reported */
+	unsigned int txtime_invalid_pending;
 };
 
 struct net_rx {
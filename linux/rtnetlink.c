@@ -8,6 +8,7 @@
 #include <linux/rtnetlink.h>
 #include <sys/socket.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <errno.h>
 #include <string.h>
 
@@ -16,6 +17,23 @@
 #include "common/log.h"
 
 static int fd_netlink = -1;
+static unsigned int seq_netlink = 0;
+
+#define RTNETLINK_BATCH_MAX		64
+#define RTNETLINK_BATCH_BUF_SIZE	16384
+
+/* Requests queued until the next rtnetlink_flush(), sent with a single sendmsg() and acknowledged individually */
+static struct {
+	char buf[RTNETLINK_BATCH_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+	unsigned int len;
+	unsigned int n;
+	unsigned int seq_first; /* sequence number of the first request */
+	struct {
+		int err; /* 0 or negative errno, valid after send */
+		void (*done)(void *ctx, int err);
+		uint64_t ctx[RTNETLINK_REQ_CTX_SIZE / sizeof(uint64_t)];
+	} req[RTNETLINK_BATCH_MAX];
+} batch;
 
 int rtnetlink_attr_add(struct nlmsghdr *nh, unsigned int req_buf_size, int type, const void *data, unsigned int data_len)
 {
@@ -71,9 +89,129 @@ exit:
 
 }
 
+/**
+ * Queue a request for the next rtnetlink_flush(). The request is copied, so the caller buffer can be reused.
+ * The queue is flushed first if it is full.
+ * The done callback must not queue new requests.
+ * \return	0 on success, -1 on error
+ * \param nh	request to queue
+ * \param done	callback called with the request result (0 or negative errno) once acknowledged, may be NULL
+ * \param ctx	callback context, copied
+ * \param ctx_len	callback context length, at most RTNETLINK_REQ_CTX_SIZE
+ */
+int rtnetlink_queue(struct nlmsghdr *nh, void (*done)(void *ctx, int err), const void *ctx, unsigned int ctx_len)
+{
+	struct nlmsghdr *dst;
+	unsigned int i;
+
+	if ((ctx_len > RTNETLINK_REQ_CTX_SIZE) || (NLMSG_ALIGN(nh->nlmsg_len) > RTNETLINK_BATCH_BUF_SIZE))
+		goto err;
+
+	/* sequence number 0 is used by requests sent without acknowledgment, don't wrap inside a batch */
+	if ((batch.n >= RTNETLINK_BATCH_MAX) || (batch.len + NLMSG_ALIGN(nh->nlmsg_len) > RTNETLINK_BATCH_BUF_SIZE)
+	    || (batch.n && !(seq_netlink + 1)))
+		rtnetlink_flush();
+
+	if (!++seq_netlink)
+		seq_netlink++;
+
+	if (!batch.n)
+		batch.seq_first = seq_netlink;
+
+	i = batch.n;
+
+	dst = (struct nlmsghdr *)(batch.buf + batch.len);
+	memcpy(dst, nh, nh->nlmsg_len);
+
+	dst->nlmsg_flags |= NLM_F_ACK;
+	dst->nlmsg_seq = seq_netlink;
+
+	batch.req[i].err = -ETIMEDOUT;
+	batch.req[i].done = done;
+	if (ctx_len)
+		memcpy(batch.req[i].ctx, ctx, ctx_len);
+
+	batch.len += NLMSG_ALIGN(nh->nlmsg_len);
+	batch.n++;
+
+	return 0;
+
+err:
+	return -1;
+}
+
+/**
+ * Send all queued requests with a single sendmsg() and report their results.
+ * Acknowledgments are matched on sequence number, and passed to the done callback of each request.
+ * The kernel processes rtnetlink requests synchronously in sendmsg(), so all acknowledgments are
+ * already queued on the socket when it returns and reading them never blocks.
+ */
+void rtnetlink_flush(void)
+{
+	char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+	struct iovec iov;
+	struct nlmsghdr *nh;
+	struct nlmsgerr *nlerr;
+	unsigned int acked = 0, i;
+	int len;
+
+	if (!batch.n)
+		return;
+
+	iov.iov_base = batch.buf;
+	iov.iov_len = batch.len;
+
+	if (rtnetlink_socket_send_iov(&iov, 1) < 0) {
+		for (i = 0; i < batch.n; i++)
+			batch.req[i].err = -EIO;
+
+		goto done;
+	}
+
+	while (acked < batch.n) {
+		len = recv(fd_netlink, buf, sizeof(buf), MSG_DONTWAIT);
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+
+			os_log(LOG_ERR, "recv() failed: %s, %u/%u requests acknowledged\n", strerror(errno), acked, batch.n);
+			break;
+		}
+
+		for (nh = (struct nlmsghdr *)buf; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+			if (nh->nlmsg_type != NLMSG_ERROR)
+				continue;
+
+			/* Ignore replies to requests sent outside of this batch */
+			i = nh->nlmsg_seq - batch.seq_first;
+			if (i >= batch.n)
+				continue;
+
+			if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(struct nlmsgerr)))
+				continue;
+
+			nlerr = (struct nlmsgerr *)NLMSG_DATA(nh);
+
+			if (batch.req[i].err == -ETIMEDOUT)
+				acked++;
+
+			batch.req[i].err = nlerr->error;
+		}
+	}
+
+done:
+	for (i = 0; i < batch.n; i++)
+		if (batch.req[i].done)
+			batch.req[i].done(batch.req[i].ctx, batch.req[i].err);
+
+	batch.len = 0;
+	batch.n = 0;
+}
+
 int rtnetlink_socket_init(void)
 {
 	struct sockaddr_nl sa;
+	int opt;
 
 	fd_netlink = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
 	if (fd_netlink < 0) {
@@ -91,6 +229,15 @@ int rtnetlink_socket_init(void)
 		goto err_bind;
 	}
 
+#ifdef NETLINK_CAP_ACK
+	/* Don't echo the requests in error acknowledgments, this keeps the replies to a large batch small */
+	opt = 1;
+	if (setsockopt(fd_netlink, SOL_NETLINK, NETLINK_CAP_ACK, &opt, sizeof(opt)) < 0)
+		os_log(LOG_INFO, "setsockopt(NETLINK_CAP_ACK) failed: %s\n", strerror(errno));
+#else
+	(void)opt;
+#endif
+
 	return 0;
 
 err_bind:
@@ -103,6 +250,8 @@ err_socket:
 
 void rtnetlink_socket_exit(void)
 {
+	rtnetlink_flush();
+
 	close(fd_netlink);
 	fd_netlink = -1;
 }
@@ -26,9 +26,13 @@
 	(nh)->nlmsg_seq = 0; \
 	(nh)->nlmsg_pid = 0;
 
+#define RTNETLINK_REQ_CTX_SIZE	32
+
 int rtnetlink_socket_init(void);
 void rtnetlink_socket_exit(void);
 int rtnetlink_socket_send_iov(struct iovec *iov, unsigned int iovlen);
 int rtnetlink_attr_add(struct nlmsghdr *nh, unsigned int req_buf_size, int type, const void *data, unsigned int data_len);
+int rtnetlink_queue(struct nlmsghdr *nh, void (*done)(void *ctx, int err), const void *ctx, unsigned int ctx_len);
+void rtnetlink_flush(void);
 
 #endif /* _LINUX_RTNETLINK_H_ */
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Unit tests clock services
+ @details
+ All the stack clocks follow the host monotonic clock, which is enough for the stack logs and for tests that
+ don't depend on the gPTP time.
+*/
+
+#define _GNU_SOURCE
+
+#include <time.h>
+
+#include "common/types.h"
+
+#include "os/clock.h"
+
+int os_clock_gettime64(os_clock_id_t id, u64 *ns)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	*ns = (u64)now.tv_sec * NSECS_PER_SEC + now.tv_nsec;
+
+	return 0;
+}
+
+int os_clock_gettime32(os_clock_id_t id, u32 *ns)
+{
+	u64 now;
+
+	os_clock_gettime64(id, &now);
+
+	*ns = (u32)now;
+
+	return 0;
+}
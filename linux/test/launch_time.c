@@ -0,0 +1,401 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Standard socket backend launch time test
+ @details
+ The test runs in its own network namespace, with a veth pair whose transmit side has an ETF qdisc (software mode,
+ CLOCK_TAI). The standard socket backend sources are included, with the logical port, clock and epoll services
+ stubbed: logical port 0 is the veth transmit side and launch times are given directly in CLOCK_TAI.
+ - Frames sent with a launch time (net_std_tx() and net_std_tx_multi()) must be received on the other veth end in
+   order, no earlier than their launch time minus the ETF delta and no later than TEST_LATE_MAX after it.
+ - A frame whose launch time is already in the past must be dropped, and reported as a launch time error by
+   net_std_tx_launch_errors().
+ The test needs root privileges, veth and ETF qdisc support, and the ip/tc tools. It is skipped otherwise.
+*/
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+
+#include "linux/net_std.c"
+
+#define TEST_TX_ITF		"gavb-tx"
+#define TEST_RX_ITF		"gavb-rx"
+#define TEST_ETHERTYPE		0x88b5	/* local experimental */
+#define TEST_ETF_DELTA		300000	/* ns */
+#define TEST_LEAD		20000000	/* ns, first launch time after the current time */
+#define TEST_SPACING		500000	/* ns, between launch times */
+#define TEST_LATE_MAX		2000000	/* ns */
+#define TEST_FRAMES		16
+#define TEST_BATCH		4
+#define TEST_FRAME_SIZE		64
+#define TEST_SKIP		77
+
+static const u8 test_src[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const u8 test_dst[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+static u64 test_tai(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_TAI, &now);
+
+	return (u64)now.tv_sec * NSECS_PER_SEC + now.tv_nsec;
+}
+
+/* CLOCK_TAI - CLOCK_REALTIME, the receive software timestamps are CLOCK_REALTIME */
+static s64 test_tai_offset(void)
+{
+	struct timespec now;
+	u64 tai = test_tai();
+
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	return (s64)(tai - ((u64)now.tv_sec * NSECS_PER_SEC + now.tv_nsec));
+}
+
+static int test_setup(void)
+{
+	char cmd[128];
+
+	if (unshare(CLONE_NEWNET) < 0) {
+		printf("unshare(CLONE_NEWNET) failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (system("ip link add " TEST_TX_ITF " type veth peer name " TEST_RX_ITF " >/dev/null 2>&1")
+	|| system("ip link set " TEST_TX_ITF " up >/dev/null 2>&1")
+	|| system("ip link set " TEST_RX_ITF " up >/dev/null 2>&1")) {
+		printf("cannot create the veth pair\n");
+		return -1;
+	}
+
+	snprintf(cmd, sizeof(cmd), "tc qdisc add dev %s root etf clockid CLOCK_TAI delta %u >/dev/null 2>&1", TEST_TX_ITF, TEST_ETF_DELTA);
+
+	if (system(cmd)) {
+		printf("cannot add the ETF qdisc\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_rx_open(void)
+{
+	struct sockaddr_ll addr;
+	int enable = 1;
+	int fd;
+
+	fd = socket(AF_PACKET, SOCK_RAW, htons(TEST_ETHERTYPE));
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(TEST_ETHERTYPE);
+	addr.sll_ifindex = if_nametoindex(TEST_RX_ITF);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		goto err;
+
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+		goto err;
+
+	return fd;
+
+err:
+	close(fd);
+	return -1;
+}
+
+/* Waits for a frame, returns its sequence number and receive time (CLOCK_TAI) */
+static int test_rx(int fd, unsigned int timeout_ms, u32 *seq, u64 *ts)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	u8 buf[256];
+	char control[256];
+	struct iovec iov = { buf, sizeof(buf) };
+	struct msghdr msg;
+	struct cmsghdr *cm;
+	struct timespec *rx_ts = NULL;
+	ssize_t len;
+
+	if (poll(&pfd, 1, timeout_ms) <= 0)
+		return -1;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	len = recvmsg(fd, &msg, 0);
+	if (len < (ssize_t)(sizeof(struct eth_hdr) + sizeof(u32)))
+		return -1;
+
+	for (cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+		if ((cm->cmsg_level == SOL_SOCKET) && (cm->cmsg_type == SCM_TIMESTAMPNS))
+			rx_ts = (struct timespec *)CMSG_DATA(cm);
+
+	if (!rx_ts)
+		return -1;
+
+	memcpy(seq, buf + sizeof(struct eth_hdr), sizeof(u32));
+	*ts = (u64)rx_ts->tv_sec * NSECS_PER_SEC + rx_ts->tv_nsec + test_tai_offset();
+
+	return 0;
+}
+
+static struct net_tx_desc *test_frame(u32 seq, u64 launch)
+{
+	struct net_tx_desc *desc = net_std_tx_alloc(TEST_FRAME_SIZE);
+	struct eth_hdr *eth;
+
+	if (!desc)
+		return NULL;
+
+	eth = NET_DATA_START(desc);
+	memset(eth, 0, TEST_FRAME_SIZE);
+	memcpy(eth->dst, test_dst, 6);
+	eth->type = htons(TEST_ETHERTYPE);
+	memcpy(eth + 1, &seq, sizeof(seq));
+
+	desc->len = TEST_FRAME_SIZE;
+	desc->ts64 = launch;
+	desc->flags = NET_TX_FLAGS_TS64;
+
+	return desc;
+}
+
+static int test_launch(struct net_tx *tx, int rx_fd)
+{
+	struct net_tx_desc *desc[TEST_BATCH];
+	u64 launch[TEST_FRAMES];
+	u64 start, ts;
+	u32 seq;
+	unsigned int i, j;
+
+	start = test_tai() + TEST_LEAD;
+
+	for (i = 0; i < TEST_FRAMES; i++)
+		launch[i] = start + i * TEST_SPACING;
+
+	/* First half one by one, second half in batches */
+	for (i = 0; i < TEST_FRAMES / 2; i++) {
+		desc[0] = test_frame(i, launch[i]);
+		if (!desc[0] || (net_std_tx(tx, desc[0]) < 0)) {
+			printf("net_std_tx(%u) failed\n", i);
+			return -1;
+		}
+	}
+
+	for (; i < TEST_FRAMES; i += TEST_BATCH) {
+		for (j = 0; j < TEST_BATCH; j++)
+			desc[j] = test_frame(i + j, launch[i + j]);
+
+		if (net_std_tx_multi(tx, desc, TEST_BATCH) != TEST_BATCH) {
+			printf("net_std_tx_multi(%u) failed\n", i);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		if (test_rx(rx_fd, 1000, &seq, &ts) < 0) {
+			printf("frame %u not received\n", i);
+			return -1;
+		}
+
+		if (seq != i) {
+			printf("frame %u received instead of %u\n", seq, i);
+			return -1;
+		}
+
+		if ((ts + TEST_ETF_DELTA < launch[i]) || (ts > launch[i] + TEST_LATE_MAX)) {
+			printf("frame %u received at launch time %+lld ns\n", i, (long long)(ts - launch[i]));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int test_missed(struct net_tx *tx, int rx_fd)
+{
+	struct net_tx_desc *desc;
+	unsigned int missed = 0, invalid = 0;
+	u64 ts;
+	u32 seq;
+
+	desc = test_frame(TEST_FRAMES, test_tai() - TEST_LEAD);
+	if (!desc)
+		return -1;
+
+	/* ETF drops the frame on enqueue (invalid launch time) or dequeue (missed launch time), reporting it on the socket error queue */
+	net_std_tx(tx, desc);
+
+	if (!test_rx(rx_fd, 100, &seq, &ts)) {
+		printf("late frame %u received\n", seq);
+		return -1;
+	}
+
+	net_std_tx_launch_errors(tx, &missed, &invalid);
+
+	if ((missed + invalid != 1) || (tx->txtime_missed + tx->txtime_invalid != 1)) {
+		printf("late frame: %u missed, %u invalid reported\n", missed, invalid);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct net_address addr;
+	struct net_tx tx;
+	int rx_fd;
+	int rc = 1;
+
+	if (test_setup() < 0) {
+		printf("SKIP\n");
+		return TEST_SKIP;
+	}
+
+	rx_fd = test_rx_open();
+	if (rx_fd < 0) {
+		printf("cannot open the receive socket\n");
+		goto err_rx;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.ptype = PTYPE_L2;
+	addr.port = 0;
+	addr.priority = 0;
+
+	memset(&tx, 0, sizeof(tx));
+
+	if (net_std_tx_init(&tx, &addr) < 0) {
+		printf("net_std_tx_init() failed\n");
+		goto err_tx;
+	}
+
+	if (!tx.txtime) {
+		printf("launch time not enabled on the transmit socket\n");
+		goto out;
+	}
+
+	if (test_launch(&tx, rx_fd) < 0)
+		goto out;
+
+	if (test_missed(&tx, rx_fd) < 0)
+		goto out;
+
+	rc = 0;
+
+out:
+	net_std_tx_exit(&tx);
+
+err_tx:
+	close(rx_fd);
+
+err_rx:
+	printf("%s\n", rc ? "FAIL" : "PASS");
+
+	return rc;
+}
+
+/*
+ * Stubbed logical port, clock and epoll services
+ */
+
+bool logical_port_valid(unsigned int port_id)
+{
+	return port_id == 0;
+}
+
+const char *logical_port_name(unsigned int port_id)
+{
+	return TEST_TX_ITF;
+}
+
+os_clock_id_t logical_port_to_local_clock(unsigned int port_id)
+{
+	return OS_CLOCK_SYSTEM_MONOTONIC;
+}
+
+os_clock_id_t logical_port_to_gptp_clock(unsigned int port_id, unsigned int domain)
+{
+	return OS_CLOCK_SYSTEM_MONOTONIC;
+}
+
+/* Launch times are given in CLOCK_TAI, the ETF qdisc clock */
+int clock_time_to_hw(os_clock_id_t id, uint64_t ns, uint64_t *hw_ns)
+{
+	*hw_ns = ns;
+
+	return 0;
+}
+
+int clock_time_from_hw(os_clock_id_t id, uint64_t hw_ns, uint64_t *ns)
+{
+	*ns = hw_ns;
+
+	return 0;
+}
+
+int net_get_local_addr(unsigned int port_id, unsigned char *addr)
+{
+	memcpy(addr, test_src, 6);
+
+	return 0;
+}
+
+int net_set_hw_ts(unsigned int port_id, bool enable)
+{
+	return -1;
+}
+
+int net_dflt_port_status(struct net_tx *tx, unsigned int port_id, bool *up, bool *point_to_point, uint64_t *rate)
+{
+	return -1;
+}
+
+unsigned int net_dflt_port_mtu_size_get(unsigned int port_id)
+{
+	return 1500;
+}
+
+int net_std_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+int net_std_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+void net_std_rx_parser(struct net_rx *rx, struct net_rx_desc *desc)
+{
+}
+
+int sock_filter_get_bpf_code(struct net_address *addr, void *buf, unsigned int *inst_count)
+{
+	return -1;
+}
+
+int epoll_ctl_add(int epoll_fd, int fd, epoll_type_t type, void *ptr, struct linux_epoll_data *data, unsigned int event_type)
+{
+	return -1;
+}
+
+int epoll_ctl_del(int epoll_fd, int fd)
+{
+	return -1;
+}
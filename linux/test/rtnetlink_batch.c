@@ -0,0 +1,397 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Batched rtnetlink requests test
+ @details
+ The test runs in its own network namespace, with a bridge whose only port is one end of a veth pair. The rtnetlink
+ and standard FDB backend sources are included, with the logical port service stubbed: logical port 0 is the bridge
+ port.
+ - MDB entries added and removed through the FDB backend (more than a batch worth of them, so the queue is also
+   flushed when full) must all be acknowledged without error, and be present in (then absent from) the bridge MDB.
+ - In a batch mixing valid and invalid MDB and qdisc requests, each request must get its own result: 0 for the valid
+   ones, the kernel error for the invalid ones (entry not found, unknown interface), whatever its position.
+ - Requests are only sent on rtnetlink_flush(), not when queued.
+ The test needs root privileges, veth and bridge support, and the ip/bridge tools. It is skipped otherwise.
+ With -b, the time to add and remove TEST_BENCH_ENTRIES MDB entries is compared between batched requests and one
+ flush per request.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/pkt_sched.h>
+
+#include "linux/rtnetlink.c"
+
+/* The FDB backend requests are queued through test_queue(), which counts their results */
+static int test_queue(struct nlmsghdr *nh, void (*done)(void *ctx, int err), const void *ctx, unsigned int ctx_len);
+
+#define rtnetlink_queue test_queue
+#include "linux/fdb_std.c"
+#undef rtnetlink_queue
+
+#define TEST_BRIDGE		"gavb-br"
+#define TEST_PORT_ITF		"gavb-p0"
+#define TEST_PEER_ITF		"gavb-p1"
+#define TEST_ENTRIES		(3 * RTNETLINK_BATCH_MAX / 2)
+#define TEST_MIXED		32
+#define TEST_BENCH_ENTRIES	1000
+#define TEST_SKIP		77
+
+static unsigned int done_calls;
+static unsigned int done_errors;
+
+struct test_ctx {
+	unsigned int index;
+};
+
+static int results[TEST_MIXED];
+
+static void test_addr(u8 *addr, unsigned int i)
+{
+	addr[0] = 0x91;
+	addr[1] = 0xe0;
+	addr[2] = 0xf0;
+	addr[3] = 0x00;
+	addr[4] = (i >> 8) & 0xff;
+	addr[5] = i & 0xff;
+}
+
+static int test_setup(void)
+{
+	if (unshare(CLONE_NEWNET) < 0) {
+		printf("unshare(CLONE_NEWNET) failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (system("ip link add " TEST_BRIDGE " type bridge mcast_snooping 1 >/dev/null 2>&1")
+	|| system("ip link add " TEST_PORT_ITF " type veth peer name " TEST_PEER_ITF " >/dev/null 2>&1")
+	|| system("ip link set " TEST_PORT_ITF " master " TEST_BRIDGE " >/dev/null 2>&1")
+	|| system("ip link set " TEST_PEER_ITF " up >/dev/null 2>&1")
+	|| system("ip link set " TEST_PORT_ITF " up >/dev/null 2>&1")
+	|| system("ip link set " TEST_BRIDGE " up >/dev/null 2>&1")) {
+		printf("cannot create the veth bridge\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Number of test MDB entries of the bridge (other entries, e.g. IPv6 groups, are not counted), as reported by the bridge tool */
+static int test_mdb_count(void)
+{
+	char line[256];
+	FILE *f;
+	int n = 0;
+
+	f = popen("bridge mdb show dev " TEST_BRIDGE " 2>/dev/null", "r");
+	if (!f)
+		return -1;
+
+	while (fgets(line, sizeof(line), f))
+		if (strstr(line, "grp 91:e0:f0:"))
+			n++;
+
+	if (pclose(f))
+		return -1;
+
+	return n;
+}
+
+static void test_done(void *data, int err)
+{
+	struct test_ctx *ctx = data;
+
+	results[ctx->index] = err;
+}
+
+struct test_queue_ctx {
+	void (*done)(void *ctx, int err);
+	u8 ctx[RTNETLINK_REQ_CTX_SIZE - sizeof(void *)];
+};
+
+static void test_queue_done(void *data, int err)
+{
+	struct test_queue_ctx *qctx = data;
+
+	if (qctx->done)
+		qctx->done(qctx->ctx, err);
+
+	done_calls++;
+	if (err)
+		done_errors++;
+}
+
+static int test_queue(struct nlmsghdr *nh, void (*done)(void *ctx, int err), const void *ctx, unsigned int ctx_len)
+{
+	struct test_queue_ctx qctx;
+
+	if (ctx_len > sizeof(qctx.ctx))
+		return -1;
+
+	qctx.done = done;
+	memcpy(qctx.ctx, ctx, ctx_len);
+
+	return rtnetlink_queue(nh, test_queue_done, &qctx, sizeof(qctx));
+}
+
+static int test_mdb(struct fdb_ops_cb *ops, bool add, unsigned int n, bool flush_each)
+{
+	u8 addr[6];
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		test_addr(addr, i);
+
+		if (ops->bridge_rtnetlink(addr, 0, 0, add) < 0) {
+			printf("%s MDB entry %u could not be queued\n", add ? "add" : "remove", i);
+			return -1;
+		}
+
+		if (flush_each)
+			rtnetlink_flush();
+	}
+
+	rtnetlink_flush();
+
+	return 0;
+}
+
+static int test_mdb_batch(struct fdb_ops_cb *ops)
+{
+	int count;
+
+	done_calls = 0;
+	done_errors = 0;
+
+	if (test_mdb(ops, true, TEST_ENTRIES, false) < 0)
+		return -1;
+
+	count = test_mdb_count();
+
+	if ((done_calls != TEST_ENTRIES) || done_errors || (count != TEST_ENTRIES)) {
+		printf("add: %u results, %u errors, %d MDB entries, expected %u\n", done_calls, done_errors, count, TEST_ENTRIES);
+		return -1;
+	}
+
+	done_calls = 0;
+
+	if (test_mdb(ops, false, TEST_ENTRIES, false) < 0)
+		return -1;
+
+	count = test_mdb_count();
+
+	if ((done_calls != TEST_ENTRIES) || done_errors || count) {
+		printf("remove: %u results, %u errors, %d MDB entries left\n", done_calls, done_errors, count);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* RTM_NEWQDISC (pfifo) request on an interface, invalid if the interface index is 0 */
+static int test_queue_qdisc(unsigned int ifindex, struct test_ctx *ctx)
+{
+	struct {
+		struct nlmsghdr nh;
+		struct tcmsg tc;
+		char buf[64];
+	} req;
+
+	memset(&req, 0, sizeof(req));
+
+	rtnetlink_nlmsghdr_init(&req.nh, NLMSG_LENGTH(sizeof(struct tcmsg)), RTM_NEWQDISC, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_REPLACE);
+
+	req.tc.tcm_family = AF_UNSPEC;
+	req.tc.tcm_ifindex = ifindex;
+	req.tc.tcm_parent = TC_H_ROOT;
+	req.tc.tcm_handle = 0x10000;
+
+	if (rtnetlink_attr_add(&req.nh, sizeof(req), TCA_KIND, "pfifo", sizeof("pfifo")) < 0)
+		return -1;
+
+	return rtnetlink_queue(&req.nh, test_done, ctx, sizeof(*ctx));
+}
+
+static int test_mixed_batch(void)
+{
+	struct std_bridge_mdb_req req;
+	struct test_ctx ctx;
+	int expected[TEST_MIXED];
+	unsigned int ifindex = if_nametoindex(TEST_PEER_ITF);
+	u8 addr[6];
+	unsigned int i;
+	bool add;
+
+	for (i = 0; i < TEST_MIXED; i++) {
+		ctx.index = i;
+		results[i] = 1;
+
+		switch (i % 4) {
+		case 0:
+		case 1:
+			/* Add entry i, remove entry i - 1 (added by the previous request), or a missing entry */
+			add = !(i % 4);
+			test_addr(addr, add ? i : ((i % 8) == 1 ? i - 1 : 0x800 + i));
+
+			if ((std_bridge_mdb_req_init(&req, addr, 0, 0, add) < 0)
+			|| (rtnetlink_queue(&req.nh, test_done, &ctx, sizeof(ctx)) < 0))
+				return -1;
+
+			/* The bridge reports a missing MDB entry with EINVAL */
+			expected[i] = (add || ((i % 8) == 1)) ? 0 : -EINVAL;
+			break;
+
+		case 2:
+			if (test_queue_qdisc(ifindex, &ctx) < 0)
+				return -1;
+
+			expected[i] = 0;
+			break;
+
+		case 3:
+			if (test_queue_qdisc(0, &ctx) < 0)
+				return -1;
+
+			expected[i] = -ENODEV;
+			break;
+		}
+	}
+
+	/* Nothing is sent before the flush */
+	for (i = 0; i < TEST_MIXED; i++)
+		if (results[i] != 1) {
+			printf("request %u completed before the flush\n", i);
+			return -1;
+		}
+
+	if (test_mdb_count()) {
+		printf("MDB entries added before the flush\n");
+		return -1;
+	}
+
+	rtnetlink_flush();
+
+	for (i = 0; i < TEST_MIXED; i++)
+		if (results[i] != expected[i]) {
+			printf("request %u: result %d, expected %d\n", i, results[i], expected[i]);
+			return -1;
+		}
+
+	return 0;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int test_bench(struct fdb_ops_cb *ops)
+{
+	double start, batched, single;
+
+	start = test_time();
+
+	if ((test_mdb(ops, true, TEST_BENCH_ENTRIES, false) < 0) || (test_mdb(ops, false, TEST_BENCH_ENTRIES, false) < 0))
+		return -1;
+
+	batched = test_time() - start;
+
+	start = test_time();
+
+	if ((test_mdb(ops, true, TEST_BENCH_ENTRIES, true) < 0) || (test_mdb(ops, false, TEST_BENCH_ENTRIES, true) < 0))
+		return -1;
+
+	single = test_time() - start;
+
+	printf("%u MDB entries added and removed: batched %.2f ms, one flush per request %.2f ms (%.1fx)\n",
+		TEST_BENCH_ENTRIES, batched * 1e3, single * 1e3, single / batched);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct fdb_ops_cb ops;
+	unsigned int bench = 0;
+	int opt;
+	int rc = 1;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (geteuid() || (test_setup() < 0) || (test_mdb_count() < 0)) {
+		printf("SKIP\n");
+		return TEST_SKIP;
+	}
+
+	if (rtnetlink_socket_init() < 0)
+		goto out;
+
+	fdb_std_init(&ops);
+
+	if (test_mdb_batch(&ops) < 0)
+		goto exit;
+
+	if (test_mixed_batch() < 0)
+		goto exit;
+
+	if (bench && (test_bench(&ops) < 0))
+		goto exit;
+
+	rc = 0;
+
+exit:
+	rtnetlink_socket_exit();
+
+out:
+	printf("%s\n", rc ? "FAIL" : "PASS");
+
+	return rc;
+}
+
+/*
+ * Stubbed logical port service
+ */
+
+bool logical_port_valid(unsigned int port_id)
+{
+	return port_id == 0;
+}
+
+bool logical_port_is_bridge(unsigned int port_id)
+{
+	return port_id == 0;
+}
+
+const char *logical_port_name(unsigned int port_id)
+{
+	return TEST_PORT_ITF;
+}
+
+const char *logical_port_bridge_name(unsigned int port_id)
+{
+	return TEST_BRIDGE;
+}
@@ -0,0 +1,11 @@
+# linux unit tests, the tests include the backend sources under test and stub the services they depend on
+genavb_add_test(NAME linux-launch-time COMPONENT linux SRCS launch_time.c LIBS common)
+
+if(HAVE_IO_URING_KERNEL_HEADERS)
+  genavb_add_test(NAME linux-uring-tx COMPONENT linux SRCS uring_tx.c ../net_std.c ../pool.c LIBS common)
+endif()
+
+genavb_add_test(NAME linux-xdp-prog COMPONENT linux SRCS xdp_prog.c LIBS common)
+target_compile_definitions(linux-xdp-prog PRIVATE TEST_XDP_PROG="${CMAKE_SOURCE_DIR}/linux/firmware/genavb-xdp.bin")
+
+genavb_add_test(NAME linux-rtnetlink-batch COMPONENT linux SRCS rtnetlink_batch.c LIBS common)
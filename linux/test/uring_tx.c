@@ -0,0 +1,476 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief Standard socket io_uring transmit test
+ @details
+ The test runs in its own network namespace, with a veth pair. The io_uring backend sources are included, and the
+ standard socket backend is linked, with the logical port, clock and epoll services stubbed: logical port 0 is the
+ veth transmit side.
+ - Frames are sent in batches through the io_uring transmit socket: registered pool buffers (fixed buffer write),
+   malloc'ed buffers and pool buffers with a timestamp request cmsg (sendmsg). They must be received on the other
+   veth end in order and with their length.
+ - Once all completions are reaped, all the pool buffers and ring slots must be free again.
+ - When the pool is exhausted, allocation must fallback to the standard backend buffers.
+ The test needs root privileges, veth and io_uring support, and the ip tool. It is skipped otherwise.
+ With -b, the transmit cost per frame of the sendmmsg() and io_uring backends is reported.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <sched.h>
+#include <poll.h>
+#include <time.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+
+#include "linux/net_std_uring.c"
+
+#define TEST_TX_ITF		"gavb-tx"
+#define TEST_RX_ITF		"gavb-rx"
+#define TEST_ETHERTYPE		0x88b5	/* local experimental */
+#define TEST_FRAMES		1024
+#define TEST_BATCH		16
+#define TEST_FRAME_SIZE		64
+#define TEST_BENCH_FRAMES	(1000 * 1000)
+#define TEST_SKIP		77
+
+/* Standard socket backend entry points, called by net.c through weak references */
+int net_std_init(struct os_std_config *std_config, struct net_mem_ops_cb *net_mem_ops, struct net_mem_ops_cb *uring_mem_ops);
+void net_std_exit(void);
+int net_std_socket_init(void *net_ops, bool is_rx);
+int net_std_tx_init(struct net_tx *tx, struct net_address *addr);
+
+static const u8 test_src[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const u8 test_dst[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+static int test_setup(void)
+{
+	if (unshare(CLONE_NEWNET) < 0) {
+		printf("unshare(CLONE_NEWNET) failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (system("ip link add " TEST_TX_ITF " type veth peer name " TEST_RX_ITF " >/dev/null 2>&1")
+	|| system("ip link set " TEST_TX_ITF " up >/dev/null 2>&1")
+	|| system("ip link set " TEST_RX_ITF " up >/dev/null 2>&1")) {
+		printf("cannot create the veth pair\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_rx_open(void)
+{
+	struct sockaddr_ll addr;
+	int size = 4 * 1024 * 1024;
+	int fd;
+
+	fd = socket(AF_PACKET, SOCK_RAW, htons(TEST_ETHERTYPE));
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(TEST_ETHERTYPE);
+	addr.sll_ifindex = if_nametoindex(TEST_RX_ITF);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		goto err;
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size));
+
+	return fd;
+
+err:
+	close(fd);
+	return -1;
+}
+
+/* Waits for a frame, returns its sequence number and length */
+static int test_rx(int fd, u32 *seq, unsigned int *len)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	u8 buf[2048];
+	ssize_t rc;
+
+	if (poll(&pfd, 1, 1000) <= 0)
+		return -1;
+
+	rc = recv(fd, buf, sizeof(buf), 0);
+	if (rc < (ssize_t)(sizeof(struct eth_hdr) + sizeof(u32)))
+		return -1;
+
+	memcpy(seq, buf + sizeof(struct eth_hdr), sizeof(u32));
+	*len = rc;
+
+	return 0;
+}
+
+static void test_frame_init(struct net_tx_desc *desc, u32 seq, unsigned int size)
+{
+	struct eth_hdr *eth = NET_DATA_START(desc);
+
+	memset(eth, 0, size);
+	memcpy(eth->dst, test_dst, 6);
+	eth->type = htons(TEST_ETHERTYPE);
+	memcpy(eth + 1, &seq, sizeof(seq));
+
+	desc->len = size;
+}
+
+/*
+ * Frame sizes vary with the sequence number. Frames are alternatively allocated from the registered pool,
+ * from the standard backend, and from the registered pool with a timestamp request (sent with sendmsg).
+ */
+static struct net_tx_desc *test_frame(struct net_tx *tx, u32 seq)
+{
+	unsigned int size = TEST_FRAME_SIZE + (seq % 64);
+	struct net_tx_desc *desc;
+
+	if ((seq % 3) == 1)
+		desc = net_std_tx_alloc(size);
+	else
+		desc = tx->net_ops.net_tx_alloc(size);
+
+	if (!desc)
+		return NULL;
+
+	test_frame_init(desc, seq, size);
+
+	if ((seq % 3) == 2)
+		desc->flags = NET_TX_FLAGS_HW_TS;
+
+	return desc;
+}
+
+static unsigned int test_pool_free_count(struct pool *pool)
+{
+	unsigned int i, n = 0;
+
+	pthread_mutex_lock(&pool->lock);
+
+	for (i = pool->first; i != POOL_BUFFER_NULL; i = pool->list[i].next)
+		n++;
+
+	pthread_mutex_unlock(&pool->lock);
+
+	return n;
+}
+
+static int test_tx(struct net_tx *tx, int rx_fd)
+{
+	struct net_std_uring_tx *ctx = tx->priv;
+	struct net_tx_desc *desc[TEST_BATCH];
+	unsigned int len, i, j, n;
+	u32 seq;
+
+	for (i = 0; i < TEST_FRAMES; i += n) {
+		/* Single frames and batches of varying sizes */
+		n = 1 + (i / TEST_BATCH) % TEST_BATCH;
+		if (n > TEST_FRAMES - i)
+			n = TEST_FRAMES - i;
+
+		for (j = 0; j < n; j++) {
+			desc[j] = test_frame(tx, i + j);
+			if (!desc[j]) {
+				printf("frame %u allocation failed\n", i + j);
+				return -1;
+			}
+		}
+
+		if (n == 1) {
+			if (tx->net_ops.net_tx(tx, desc[0]) < 0) {
+				printf("net_tx(%u) failed\n", i);
+				return -1;
+			}
+		} else if (tx->net_ops.net_tx_multi(tx, desc, n) != n) {
+			printf("net_tx_multi(%u, %u) failed\n", i, n);
+			return -1;
+		}
+
+		for (j = 0; j < n; j++) {
+			if (test_rx(rx_fd, &seq, &len) < 0) {
+				printf("frame %u not received\n", i + j);
+				return -1;
+			}
+
+			if ((seq != i + j) || (len != TEST_FRAME_SIZE + (seq % 64))) {
+				printf("frame %u (length %u) received instead of %u\n", seq, len, i + j);
+				return -1;
+			}
+		}
+	}
+
+	/* An empty batch only reaps the remaining completions */
+	tx->net_ops.net_tx_multi(tx, desc, 0);
+
+	if (ctx->n_free != NET_STD_URING_TX_ENTRIES) {
+		printf("%u ring slots still in use\n", NET_STD_URING_TX_ENTRIES - ctx->n_free);
+		return -1;
+	}
+
+	n = test_pool_free_count(&net_std_uring_tx_pool);
+	if (n != net_std_uring_tx_pool.count_total) {
+		printf("%u pool buffers still in use\n", net_std_uring_tx_pool.count_total - n);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_pool_exhausted(struct net_tx *tx)
+{
+	static struct net_tx_desc *desc[NET_STD_URING_TX_BUFS + 1];
+	unsigned int i;
+	int rc = 0;
+
+	for (i = 0; i < NET_STD_URING_TX_BUFS + 1; i++) {
+		desc[i] = tx->net_ops.net_tx_alloc(TEST_FRAME_SIZE);
+		if (!desc[i]) {
+			printf("allocation %u failed\n", i);
+			rc = -1;
+			break;
+		}
+
+		if ((i < NET_STD_URING_TX_BUFS) != (desc[i]->pool_type == POOL_TYPE_STD_URING)) {
+			printf("allocation %u from pool type %u\n", i, desc[i]->pool_type);
+			rc = -1;
+		}
+	}
+
+	while (i--)
+		net_std_tx_free(desc[i]);
+
+	return rc;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void test_bench_one(struct net_tx *tx, bool io_uring, unsigned int size)
+{
+	struct net_tx_desc *desc[NET_TX_BATCH];
+	unsigned int i, j, sent = 0;
+	double start;
+	int rc;
+
+	start = test_time();
+
+	for (i = 0; i < TEST_BENCH_FRAMES; i += NET_TX_BATCH) {
+		for (j = 0; j < NET_TX_BATCH; j++) {
+			desc[j] = io_uring ? tx->net_ops.net_tx_alloc(size) : net_std_tx_alloc(size);
+			test_frame_init(desc[j], i + j, size);
+		}
+
+		rc = io_uring ? tx->net_ops.net_tx_multi(tx, desc, NET_TX_BATCH) : net_std_tx_multi(tx, desc, NET_TX_BATCH);
+		if (rc > 0)
+			sent += rc;
+	}
+
+	start = test_time() - start;
+
+	printf("%-9s %4u bytes: %6.1f ns/frame, %5.2f Mfps (%u/%u frames queued)\n", io_uring ? "io_uring" : "sendmmsg",
+		size, start * 1e9 / TEST_BENCH_FRAMES, TEST_BENCH_FRAMES / start / 1e6, sent, TEST_BENCH_FRAMES);
+}
+
+static void test_bench(struct net_tx *tx)
+{
+	static const unsigned int sizes[] = {64, 512, 1500};
+	unsigned int i;
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		test_bench_one(tx, false, sizes[i]);
+		test_bench_one(tx, true, sizes[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct os_std_config std_config = { .io_uring = 1 };
+	struct net_mem_ops_cb std_mem_ops, uring_mem_ops;
+	struct net_address addr;
+	struct net_tx tx;
+	unsigned int bench = 0;
+	int opt, rx_fd;
+	int rc = 1;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (test_setup() < 0) {
+		printf("SKIP\n");
+		return TEST_SKIP;
+	}
+
+	if (net_std_init(&std_config, &std_mem_ops, &uring_mem_ops) < 0) {
+		printf("net_std_init() failed\n");
+		goto err_init;
+	}
+
+	rx_fd = test_rx_open();
+	if (rx_fd < 0) {
+		printf("cannot open the receive socket\n");
+		goto err_rx;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.ptype = PTYPE_L2;
+	addr.port = 0;
+	addr.priority = 0;
+
+	memset(&tx, 0, sizeof(tx));
+	net_std_socket_init(&tx.net_ops, false);
+
+	if (net_std_tx_init(&tx, &addr) < 0) {
+		printf("net_std_tx_init() failed\n");
+		goto err_tx;
+	}
+
+	if (!tx.priv) {
+		printf("io_uring not available\nSKIP\n");
+		rc = TEST_SKIP;
+		goto out;
+	}
+
+	if (test_tx(&tx, rx_fd) < 0)
+		goto out;
+
+	if (test_pool_exhausted(&tx) < 0)
+		goto out;
+
+	if (bench) {
+		close(rx_fd);
+		rx_fd = -1;
+		test_bench(&tx);
+	}
+
+	rc = 0;
+
+out:
+	tx.net_ops.net_tx_exit(&tx);
+
+err_tx:
+	if (rx_fd >= 0)
+		close(rx_fd);
+
+err_rx:
+	net_std_exit();
+
+err_init:
+	if (rc != TEST_SKIP)
+		printf("%s\n", rc ? "FAIL" : "PASS");
+
+	return rc;
+}
+
+/*
+ * Stubbed logical port, clock and epoll services
+ */
+
+bool logical_port_valid(unsigned int port_id)
+{
+	return port_id == 0;
+}
+
+const char *logical_port_name(unsigned int port_id)
+{
+	return TEST_TX_ITF;
+}
+
+os_clock_id_t logical_port_to_local_clock(unsigned int port_id)
+{
+	return OS_CLOCK_SYSTEM_MONOTONIC;
+}
+
+os_clock_id_t logical_port_to_gptp_clock(unsigned int port_id, unsigned int domain)
+{
+	return OS_CLOCK_SYSTEM_MONOTONIC;
+}
+
+int clock_time_to_hw(os_clock_id_t id, uint64_t ns, uint64_t *hw_ns)
+{
+	*hw_ns = ns;
+
+	return 0;
+}
+
+int clock_time_from_hw(os_clock_id_t id, uint64_t hw_ns, uint64_t *ns)
+{
+	*ns = hw_ns;
+
+	return 0;
+}
+
+int net_get_local_addr(unsigned int port_id, unsigned char *addr)
+{
+	memcpy(addr, test_src, 6);
+
+	return 0;
+}
+
+int net_set_hw_ts(unsigned int port_id, bool enable)
+{
+	return -1;
+}
+
+int net_dflt_port_status(struct net_tx *tx, unsigned int port_id, bool *up, bool *point_to_point, uint64_t *rate)
+{
+	return -1;
+}
+
+unsigned int net_dflt_port_mtu_size_get(unsigned int port_id)
+{
+	return 1500;
+}
+
+int net_std_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+int net_std_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+void net_std_rx_parser(struct net_rx *rx, struct net_rx_desc *desc)
+{
+}
+
+int sock_filter_get_bpf_code(struct net_address *addr, void *buf, unsigned int *inst_count)
+{
+	return -1;
+}
+
+int epoll_ctl_add(int epoll_fd, int fd, epoll_type_t type, void *ptr, struct linux_epoll_data *data, unsigned int event_type)
+{
+	return -1;
+}
+
+int epoll_ctl_del(int epoll_fd, int fd)
+{
+	return -1;
+}
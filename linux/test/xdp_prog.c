@@ -0,0 +1,661 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief XDP program test
+ @details
+ The pre-compiled XDP program (linux/firmware/genavb-xdp.bin) is loaded with raw bpf() system calls: its maps are
+ created from the "maps" section (iproute2 struct bpf_elf_map), the map relocations of the "prog" section are resolved,
+ and the program is loaded (and so checked by the kernel verifier). Frames are then run through the program with
+ BPF_PROG_TEST_RUN:
+ - AVTP stream data frames whose stream ID is in the stream map are steered on the stream ID (even if their destination
+   address is also in the key map), with or without a VLAN tag, and their per-cpu counters (packets, bytes, sequence
+   errors) are updated.
+ - Other frames (unknown stream ID, no stream valid bit, truncated AVTP header, other ethertype) fall back to the
+   (destination address, ethertype, VLAN) key lookup, and are not counted.
+ - Frames with a truncated VLAN header are passed to the network stack.
+ XSK map entries need a bound AF_XDP socket: one is bound to the loopback interface of a private network namespace.
+ If AF_XDP is not available, redirections can't be told apart from the XDP_PASS fallback, and only the counters are
+ checked. The test needs root privileges, and is skipped otherwise.
+ With -b, the program run time per frame is reported for the stream, key and non-AVTP paths.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <elf.h>
+#include <sched.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_xdp.h>
+
+#include "genavb/net_types.h"
+#include "genavb/ether.h"
+
+#ifndef TEST_XDP_PROG
+#define TEST_XDP_PROG		"genavb-xdp.bin"
+#endif
+
+#define TEST_SKIP		77
+#define TEST_MAPS_MAX		8
+#define TEST_LOG_SIZE		(1 << 20)
+#define TEST_FRAME_MAX		256
+#define TEST_PAYLOAD		64
+#define TEST_BENCH_REPEAT	(1000 * 1000)
+
+#define TEST_XSK_INDEX		0	/* XSK map entry with a bound AF_XDP socket */
+#define TEST_XSK_INDEX_EMPTY	1	/* XSK map entry without socket */
+#define TEST_VLAN_ID		2
+
+/* iproute2 ELF map definition, see linux/ebpf/ebpf.h */
+struct test_elf_map {
+	uint32_t type;
+	uint32_t size_key;
+	uint32_t size_value;
+	uint32_t max_elem;
+	uint32_t flags;
+	uint32_t id;
+	uint32_t pinning;
+	uint32_t inner_id;
+	uint32_t inner_idx;
+};
+
+struct test_map {
+	char name[32];
+	unsigned long offset;	/* in the maps section */
+	int fd;
+};
+
+static struct test_map maps[TEST_MAPS_MAX];
+static unsigned int n_maps;
+static int prog_fd = -1;
+static bool xsk_bound;
+static unsigned int n_cpus;
+
+static const uint8_t dst_mac[6] = {0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x01};
+static const uint8_t other_mac[6] = {0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x02};
+static const uint8_t src_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+/* Stream A is steered to an empty XSK map entry, stream B is unknown, stream C is steered to the bound socket */
+static const uint8_t stream_a[8] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x0a};
+static const uint8_t stream_b[8] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x0b};
+static const uint8_t stream_c[8] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x0c};
+
+static int test_bpf(int cmd, union bpf_attr *attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int test_map_fd(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_maps; i++)
+		if (!strcmp(maps[i].name, name))
+			return maps[i].fd;
+
+	return -1;
+}
+
+static int test_map_update(const char *name, const void *key, const void *value)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = test_map_fd(name);
+	attr.key = (unsigned long)key;
+	attr.value = (unsigned long)value;
+	attr.flags = BPF_ANY;
+
+	return test_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+static int test_map_lookup(const char *name, const void *key, void *value)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = test_map_fd(name);
+	attr.key = (unsigned long)key;
+	attr.value = (unsigned long)value;
+
+	return test_bpf(BPF_MAP_LOOKUP_ELEM, &attr);
+}
+
+static unsigned int test_possible_cpus(void)
+{
+	unsigned int first, last;
+	FILE *f;
+
+	f = fopen("/sys/devices/system/cpu/possible", "r");
+	if (!f)
+		return 0;
+
+	if (fscanf(f, "%u-%u", &first, &last) != 2)
+		last = first;
+
+	fclose(f);
+
+	return last + 1;
+}
+
+/*
+ * Creates the program maps and loads the program, resolving the map relocations.
+ * \return 0 on success, -1 on error
+ */
+static int test_load(const char *path)
+{
+	Elf64_Ehdr *ehdr;
+	Elf64_Shdr *shdr, *maps_shdr = NULL, *prog_shdr = NULL, *rel_shdr = NULL, *sym_shdr = NULL;
+	Elf64_Sym *sym;
+	Elf64_Rel *rel;
+	struct bpf_insn *insns;
+	const char *shstrtab, *strtab;
+	char *log;
+	struct stat st;
+	union bpf_attr attr;
+	unsigned int maps_index = 0, prog_index = 0, n_insns, n_syms, i, j;
+	uint8_t *elf;
+	int fd, rc = -1;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("cannot open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0)
+		goto err_close;
+
+	elf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (elf == MAP_FAILED)
+		goto err_close;
+
+	ehdr = (Elf64_Ehdr *)elf;
+	if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) || (ehdr->e_ident[EI_CLASS] != ELFCLASS64) || (ehdr->e_machine != EM_BPF)) {
+		printf("%s is not a BPF object\n", path);
+		goto err_unmap;
+	}
+
+	shdr = (Elf64_Shdr *)(elf + ehdr->e_shoff);
+	shstrtab = (const char *)(elf + shdr[ehdr->e_shstrndx].sh_offset);
+
+	for (i = 0; i < ehdr->e_shnum; i++) {
+		const char *name = shstrtab + shdr[i].sh_name;
+
+		if (!strcmp(name, "maps")) {
+			maps_shdr = &shdr[i];
+			maps_index = i;
+		} else if (!strcmp(name, "prog")) {
+			prog_shdr = &shdr[i];
+			prog_index = i;
+		} else if (shdr[i].sh_type == SHT_SYMTAB) {
+			sym_shdr = &shdr[i];
+		}
+	}
+
+	for (i = 0; i < ehdr->e_shnum; i++)
+		if ((shdr[i].sh_type == SHT_REL) && (shdr[i].sh_info == prog_index))
+			rel_shdr = &shdr[i];
+
+	if (!maps_shdr || !prog_shdr || !sym_shdr) {
+		printf("missing maps, prog or symbol table section\n");
+		goto err_unmap;
+	}
+
+	sym = (Elf64_Sym *)(elf + sym_shdr->sh_offset);
+	n_syms = sym_shdr->sh_size / sizeof(*sym);
+	strtab = (const char *)(elf + shdr[sym_shdr->sh_link].sh_offset);
+
+	/* Maps */
+	for (i = 0; i < n_syms; i++) {
+		struct test_elf_map *def;
+
+		if (sym[i].st_shndx != maps_index)
+			continue;
+
+		if (n_maps == TEST_MAPS_MAX)
+			goto err_maps;
+
+		def = (struct test_elf_map *)(elf + maps_shdr->sh_offset + sym[i].st_value);
+
+		memset(&attr, 0, sizeof(attr));
+		attr.map_type = def->type;
+		attr.key_size = def->size_key;
+		attr.value_size = def->size_value;
+		attr.max_entries = def->max_elem;
+		attr.map_flags = def->flags;
+
+		maps[n_maps].fd = test_bpf(BPF_MAP_CREATE, &attr);
+		if (maps[n_maps].fd < 0) {
+			printf("map %s creation failed: %s\n", strtab + sym[i].st_name, strerror(errno));
+			goto err_maps;
+		}
+
+		snprintf(maps[n_maps].name, sizeof(maps[n_maps].name), "%s", strtab + sym[i].st_name);
+		maps[n_maps].offset = sym[i].st_value;
+		n_maps++;
+	}
+
+	/* Program, with the map addresses replaced by the map file descriptors */
+	n_insns = prog_shdr->sh_size / sizeof(*insns);
+	insns = malloc(prog_shdr->sh_size);
+	if (!insns)
+		goto err_maps;
+
+	memcpy(insns, elf + prog_shdr->sh_offset, prog_shdr->sh_size);
+
+	if (rel_shdr) {
+		rel = (Elf64_Rel *)(elf + rel_shdr->sh_offset);
+
+		for (i = 0; i < rel_shdr->sh_size / sizeof(*rel); i++) {
+			Elf64_Sym *s = &sym[ELF64_R_SYM(rel[i].r_info)];
+			struct bpf_insn *insn = &insns[rel[i].r_offset / sizeof(*insn)];
+
+			for (j = 0; j < n_maps; j++)
+				if ((s->st_shndx == maps_index) && (maps[j].offset == s->st_value))
+					break;
+
+			if ((j == n_maps) || (insn->code != (BPF_LD | BPF_IMM | BPF_DW))) {
+				printf("unexpected relocation at instruction %lu\n", (unsigned long)(rel[i].r_offset / sizeof(*insn)));
+				goto err_insns;
+			}
+
+			insn->src_reg = BPF_PSEUDO_MAP_FD;
+			insn->imm = maps[j].fd;
+		}
+	}
+
+	log = calloc(1, TEST_LOG_SIZE);
+	if (!log)
+		goto err_insns;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.insns = (unsigned long)insns;
+	attr.insn_cnt = n_insns;
+	attr.license = (unsigned long)"BSD-3-Clause";
+	attr.log_buf = (unsigned long)log;
+	attr.log_size = TEST_LOG_SIZE;
+	attr.log_level = 1;
+
+	prog_fd = test_bpf(BPF_PROG_LOAD, &attr);
+	if (prog_fd < 0) {
+		printf("program load failed: %s\n%s\n", strerror(errno), log);
+		goto err_log;
+	}
+
+	printf("%s: %u instructions, %u maps\n", path, n_insns, n_maps);
+
+	rc = 0;
+
+err_log:
+	free(log);
+
+err_insns:
+	free(insns);
+
+err_maps:
+err_unmap:
+	munmap(elf, st.st_size);
+
+err_close:
+	close(fd);
+
+	return rc;
+}
+
+/*
+ * Binds an AF_XDP socket (copy mode) to the loopback interface, so that it can be added to the XSK map.
+ * \return socket file descriptor, -1 on error
+ */
+static int test_xsk_open(void)
+{
+	struct xdp_umem_reg umem;
+	struct sockaddr_xdp addr;
+	unsigned int size = 4096 * 16;
+	int ring = 16;
+	void *area;
+	int fd;
+
+	if (system("ip link set lo up >/dev/null 2>&1"))
+		return -1;
+
+	fd = socket(AF_XDP, SOCK_RAW, 0);
+	if (fd < 0)
+		return -1;
+
+	area = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (area == MAP_FAILED)
+		goto err;
+
+	memset(&umem, 0, sizeof(umem));
+	umem.addr = (unsigned long)area;
+	umem.len = size;
+	umem.chunk_size = 2048;
+
+	if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &umem, sizeof(umem)) < 0
+	|| setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring, sizeof(ring)) < 0
+	|| setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring, sizeof(ring)) < 0
+	|| setsockopt(fd, SOL_XDP, XDP_RX_RING, &ring, sizeof(ring)) < 0)
+		goto err;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sxdp_family = AF_XDP;
+	addr.sxdp_ifindex = if_nametoindex("lo");
+	addr.sxdp_queue_id = 0;
+	addr.sxdp_flags = XDP_COPY;
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		goto err;
+
+	return fd;
+
+err:
+	close(fd);
+	return -1;
+}
+
+static unsigned int test_frame(uint8_t *buf, const uint8_t *dst, bool vlan, uint16_t type, const uint8_t *stream_id, uint8_t seq, bool sv)
+{
+	struct eth_hdr *eth = (struct eth_hdr *)buf;
+	uint8_t *hdr = (uint8_t *)(eth + 1);
+	uint16_t tci;
+
+	memset(buf, 0, TEST_FRAME_MAX);
+	memcpy(eth->dst, dst, 6);
+	memcpy(eth->src, src_mac, 6);
+
+	if (vlan) {
+		eth->type = htons(ETHERTYPE_VLAN);
+		tci = htons((3 << 13) | TEST_VLAN_ID);
+		memcpy(hdr, &tci, 2);
+		type = htons(type);
+		memcpy(hdr + 2, &type, 2);
+		hdr += 4;
+	} else {
+		eth->type = htons(type);
+	}
+
+	/* AVTP stream data header: subtype, sv/version, sequence number, flags, stream ID */
+	hdr[0] = 0x02;
+	hdr[1] = sv ? 0x80 : 0x00;
+	hdr[2] = seq;
+	memcpy(hdr + 4, stream_id, 8);
+
+	return (hdr - buf) + 24 + TEST_PAYLOAD;
+}
+
+static int test_run(const uint8_t *frame, unsigned int len, unsigned int repeat, uint32_t *duration)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.test.prog_fd = prog_fd;
+	attr.test.data_in = (unsigned long)frame;
+	attr.test.data_size_in = len;
+	attr.test.repeat = repeat;
+
+	if (test_bpf(BPF_PROG_TEST_RUN, &attr) < 0) {
+		printf("BPF_PROG_TEST_RUN failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (duration)
+		*duration = attr.test.duration;
+
+	return attr.test.retval;
+}
+
+/* Sums the per-cpu counters of a stream, returns false if the stream has no counters */
+static bool test_stats(const uint8_t *stream_id, struct genavb_xdp_stream_stats *total)
+{
+	struct genavb_xdp_stream_stats stats[n_cpus];
+	unsigned int i;
+
+	memset(total, 0, sizeof(*total));
+
+	if (test_map_lookup("genavb_xdpstream_stats", stream_id, stats) < 0)
+		return false;
+
+	for (i = 0; i < n_cpus; i++) {
+		total->packets += stats[i].packets;
+		total->bytes += stats[i].bytes;
+		total->seq_errors += stats[i].seq_errors;
+
+		if (stats[i].seq_valid) {
+			total->last_seq = stats[i].last_seq;
+			total->seq_valid = 1;
+		}
+	}
+
+	return true;
+}
+
+static int test_check_stats(const char *name, const uint8_t *stream_id, uint64_t packets, uint64_t bytes, uint64_t seq_errors)
+{
+	struct genavb_xdp_stream_stats total;
+	bool found = test_stats(stream_id, &total);
+
+	if (!packets && !found)
+		return 0;
+
+	if (!found || (total.packets != packets) || (total.bytes != bytes) || (total.seq_errors != seq_errors)) {
+		printf("%s: packets %llu bytes %llu seq errors %llu, expected %llu %llu %llu\n", name,
+			(unsigned long long)total.packets, (unsigned long long)total.bytes, (unsigned long long)total.seq_errors,
+			(unsigned long long)packets, (unsigned long long)bytes, (unsigned long long)seq_errors);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_expect(const char *name, const uint8_t *frame, unsigned int len, int expected)
+{
+	int action = test_run(frame, len, 1, NULL);
+
+	/* Without a bound socket, redirections to the XSK map fallback to XDP_PASS */
+	if (!xsk_bound && (expected == XDP_REDIRECT))
+		expected = XDP_PASS;
+
+	if (action != expected) {
+		printf("%s: action %d, expected %d\n", name, action, expected);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_steering(void)
+{
+	struct genavb_xdp_key key;
+	uint8_t frame[TEST_FRAME_MAX];
+	uint32_t index;
+	uint64_t bytes_a = 0, bytes_c = 0;
+	uint8_t seq[] = {10, 11, 13, 14, 255, 0};
+	unsigned int len, i;
+
+	/* Key map: AVTP frames to dst_mac, without VLAN, to the bound socket */
+	memset(&key, 0, sizeof(key));
+	key.protocol = htons(ETHERTYPE_AVTP);
+	key.vlan_id = VLAN_VID_NONE;
+	memcpy(key.dst_mac, dst_mac, 6);
+	index = TEST_XSK_INDEX;
+
+	if (test_map_update("genavb_xdpkey", &key, &index) < 0)
+		goto err_map;
+
+	index = TEST_XSK_INDEX_EMPTY;
+	if (test_map_update("genavb_xdpstream", stream_a, &index) < 0)
+		goto err_map;
+
+	index = TEST_XSK_INDEX;
+	if (test_map_update("genavb_xdpstream", stream_c, &index) < 0)
+		goto err_map;
+
+	/* Ethernet header only (BPF_PROG_TEST_RUN rejects shorter frames), key lookup */
+	test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_a, 0, true);
+	if (test_expect("header only", frame, sizeof(struct eth_hdr), XDP_REDIRECT) < 0)
+		return -1;
+
+	test_frame(frame, dst_mac, true, ETHERTYPE_AVTP, stream_a, 0, true);
+	if (test_expect("truncated VLAN header", frame, sizeof(struct eth_hdr) + 2, XDP_PASS) < 0)
+		return -1;
+
+	/* Stream A takes precedence over the key lookup, one sequence error (11 -> 13), 255 -> 0 wraps */
+	for (i = 0; i < sizeof(seq); i++) {
+		len = test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_a, seq[i], true);
+		bytes_a += len;
+
+		if (test_expect("stream A", frame, len, XDP_PASS) < 0)
+			return -1;
+	}
+
+	if (test_check_stats("stream A", stream_a, sizeof(seq), bytes_a, 2) < 0)
+		return -1;
+
+	/* Stream C, with and without VLAN tag */
+	for (i = 0; i < 4; i++) {
+		len = test_frame(frame, other_mac, i & 1, ETHERTYPE_AVTP, stream_c, i, true);
+		bytes_c += len;
+
+		if (test_expect("stream C", frame, len, XDP_REDIRECT) < 0)
+			return -1;
+	}
+
+	if (test_check_stats("stream C", stream_c, 4, bytes_c, 0) < 0)
+		return -1;
+
+	/* Unknown stream B, key lookup: only the untagged frame to dst_mac matches */
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_b, 0, true);
+	if (test_expect("stream B", frame, len, XDP_REDIRECT) < 0)
+		return -1;
+
+	len = test_frame(frame, dst_mac, true, ETHERTYPE_AVTP, stream_b, 0, true);
+	if (test_expect("stream B VLAN", frame, len, XDP_PASS) < 0)
+		return -1;
+
+	len = test_frame(frame, other_mac, false, ETHERTYPE_AVTP, stream_b, 0, true);
+	if (test_expect("stream B other address", frame, len, XDP_PASS) < 0)
+		return -1;
+
+	if (test_check_stats("stream B", stream_b, 0, 0, 0) < 0)
+		return -1;
+
+	/* Stream A frames that are not steered on the stream ID, and not counted: no stream valid bit, truncated header */
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_a, 1, false);
+	if (test_expect("stream A no sv", frame, len, XDP_REDIRECT) < 0)
+		return -1;
+
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_a, 1, true);
+	if (test_expect("stream A truncated", frame, sizeof(struct eth_hdr) + 11, XDP_REDIRECT) < 0)
+		return -1;
+
+	/* Other ethertype, with the same payload */
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_PTP, stream_a, 1, true);
+	if (test_expect("PTP", frame, len, XDP_PASS) < 0)
+		return -1;
+
+	if (test_check_stats("stream A", stream_a, sizeof(seq), bytes_a, 2) < 0)
+		return -1;
+
+	return 0;
+
+err_map:
+	printf("map update failed: %s\n", strerror(errno));
+	return -1;
+}
+
+static void test_bench(void)
+{
+	uint8_t frame[TEST_FRAME_MAX];
+	uint32_t duration;
+	unsigned int len;
+
+	len = test_frame(frame, other_mac, true, ETHERTYPE_AVTP, stream_c, 0, true);
+	if (test_run(frame, len, TEST_BENCH_REPEAT, &duration) >= 0)
+		printf("stream ID steering (VLAN): %u ns/frame\n", duration);
+
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_AVTP, stream_b, 0, true);
+	if (test_run(frame, len, TEST_BENCH_REPEAT, &duration) >= 0)
+		printf("key steering:              %u ns/frame\n", duration);
+
+	len = test_frame(frame, dst_mac, false, ETHERTYPE_PTP, stream_b, 0, true);
+	if (test_run(frame, len, TEST_BENCH_REPEAT, &duration) >= 0)
+		printf("non AVTP frame:            %u ns/frame\n", duration);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = TEST_XDP_PROG;
+	unsigned int bench = 0;
+	uint32_t index = TEST_XSK_INDEX;
+	int opt, xsk_fd;
+	int rc = 1;
+
+	while ((opt = getopt(argc, argv, "bf:")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		case 'f':
+			path = optarg;
+			break;
+
+		default:
+			printf("Usage: %s [-b] [-f <xdp program>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	n_cpus = test_possible_cpus();
+
+	if (geteuid()) {
+		printf("not running as root\nSKIP\n");
+		return TEST_SKIP;
+	}
+
+	if (unshare(CLONE_NEWNET) < 0) {
+		printf("unshare(CLONE_NEWNET) failed: %s\nSKIP\n", strerror(errno));
+		return TEST_SKIP;
+	}
+
+	if (test_load(path) < 0)
+		goto out;
+
+	xsk_fd = test_xsk_open();
+	if ((xsk_fd >= 0) && !test_map_update("genavb_xskmap", &index, &xsk_fd))
+		xsk_bound = true;
+	else
+		printf("AF_XDP socket not available, redirections not checked\n");
+
+	if (test_steering() < 0)
+		goto out;
+
+	if (bench)
+		test_bench();
+
+	rc = 0;
+
+out:
+	printf("%s\n", rc ? "FAIL" : "PASS");
+
+	return rc;
+}
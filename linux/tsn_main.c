@@ -216,6 +216,12 @@ static int process_section_general(struct _SECTIONENTRY *configtree, int instanc
 		goto exit;
 	}
 
+	/* neighbor rate ratio estimation window */
+	if (cfg_get_uint(configtree, "FGPTP_GENERAL", "neighborRateRatioWindow", CFG_GPTP_RATE_RATIO_WINDOW_DEFAULT, CFG_GPTP_RATE_RATIO_WINDOW_MIN, CFG_GPTP_RATE_RATIO_WINDOW_MAX, &cfg->neighborRateRatioWindow)) {
+		rc = -1;
+		goto exit;
+	}
+
 	/* IEEE 802.1AS-2011 interoperability mode */
 	if (cfg_get_string(configtree, "FGPTP_GENERAL", "force_2011", CFG_GPTP_DEFAULT_FORCE_2011_STRING, stringvalue)) {
 		rc = -1;
@@ -227,6 +233,12 @@ static int process_section_general(struct _SECTIONENTRY *configtree, int instanc
 	else
 		cfg->force_2011 = 0;
 
+	/* run domain instances, other than domain 0, in their own thread */
+	if (cfg_get_uint(configtree, "FGPTP_GENERAL", "domain_threads", CFG_GPTP_DOMAIN_THREADS_DEFAULT, CFG_GPTP_DOMAIN_THREADS_MIN_DEFAULT, CFG_GPTP_DOMAIN_THREADS_MAX_DEFAULT, &cfg->domain_threads)) {
+		rc = -1;
+		goto exit;
+	}
+
 exit:
 	return rc;
 }
@@ -20,4 +20,8 @@
 
 #define CFG_MAAP_MAX_TIMERS	1
 
+#ifndef CFG_MAAP_PORT_MAX_RANGES
+#define CFG_MAAP_PORT_MAX_RANGES	128	/* maximum number of ranges allocated per port */
+#endif
+
 #endif /* _MAAP_CFG_H_ */
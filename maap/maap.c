@@ -71,16 +71,177 @@ static bool maap_is_in_dynamic_pool(const u8 *start_address, unsigned int count)
 	return (check_start && check_end);
 }
 
+static inline u64 maap_range_start(struct maap_range *range)
+{
+	return MAC_VALUE(range->start_mac_addr);
+}
+
+static inline u64 maap_range_end(struct maap_range *range)
+{
+	return MAC_VALUE(range->start_mac_addr) + (range->mac_count - 1);
+}
+
+/**
+ * Find the position of the first indexed range whose start address is not lower than a given value
+ * \return position in the port range index, range_index_count if all ranges start before value
+ * \param port, the port
+ * \param value, start address value to search for
+ */
+static unsigned int maap_range_index_lower_bound(struct maap_port *port, u64 value)
+{
+	unsigned int lo = 0, hi = port->range_index_count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (maap_range_start(port->range_index[mid]) < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * Find the position of the first indexed range that may overlap addresses starting at a given value.
+ * Ranges are sorted by start address, so any range overlapping value starts at most range_index_max_mac_count - 1 addresses before it.
+ * \return position in the port range index
+ * \param port, the port
+ * \param value, first address of the queried block
+ */
+static unsigned int maap_range_index_first_overlap(struct maap_port *port, u64 value)
+{
+	u64 min_start;
+
+	if (value >= port->range_index_max_mac_count)
+		min_start = value - port->range_index_max_mac_count + 1;
+	else
+		min_start = 0;
+
+	return maap_range_index_lower_bound(port, min_start);
+}
+
+/**
+ * Insert a range in the port range index, keeping it sorted by start address
+ * \param port, the port
+ * \param range, the range to insert
+ */
+static void maap_range_index_add(struct maap_port *port, struct maap_range *range)
+{
+	unsigned int pos, i;
+
+	if (port->range_index_count >= MAAP_PORT_MAX_RANGES_ALLOCATION)
+		return;
+
+	pos = maap_range_index_lower_bound(port, maap_range_start(range));
+
+	for (i = port->range_index_count; i > pos; i--)
+		port->range_index[i] = port->range_index[i - 1];
+
+	port->range_index[pos] = range;
+	port->range_index_count++;
+
+	if (range->mac_count > port->range_index_max_mac_count)
+		port->range_index_max_mac_count = range->mac_count;
+}
+
+/**
+ * Remove a range from the port range index
+ * \return true if the range was indexed, false otherwise
+ * \param port, the port
+ * \param range, the range to remove
+ */
+static bool maap_range_index_del(struct maap_port *port, struct maap_range *range)
+{
+	unsigned int pos, i;
+
+	pos = maap_range_index_lower_bound(port, maap_range_start(range));
+
+	while ((pos < port->range_index_count) && (port->range_index[pos] != range)) {
+		if (maap_range_start(port->range_index[pos]) != maap_range_start(range))
+			return false;
+
+		pos++;
+	}
+
+	if (pos >= port->range_index_count)
+		return false;
+
+	port->range_index_count--;
+
+	for (i = pos; i < port->range_index_count; i++)
+		port->range_index[i] = port->range_index[i + 1];
+
+	/* Only rescan the index if the removed range may have been the largest one */
+	if (range->mac_count == port->range_index_max_mac_count) {
+		port->range_index_max_mac_count = 0;
+
+		for (i = 0; i < port->range_index_count; i++)
+			if (port->range_index[i]->mac_count > port->range_index_max_mac_count)
+				port->range_index_max_mac_count = port->range_index[i]->mac_count;
+	}
+
+	return true;
+}
+
+/**
+ * Find the first block of free addresses in the dynamic pool, not overlapping any indexed range of the port.
+ * The search starts at a given address and wraps around to the start of the dynamic pool.
+ * \return true if a free block was found, false otherwise
+ * \param port, the port
+ * \param from, address value where the search starts
+ * \param count, number of addresses in the block
+ * \param start, OUTPUT, first address value of the free block
+ */
+static bool maap_range_index_find_free(struct maap_port *port, u64 from, unsigned int count, u64 *start)
+{
+	const u8 addr_min[6] = MAAP_DYNAMIC_POOL_MIN;
+	const u8 addr_max[6] = MAAP_DYNAMIC_POOL_MAX;
+	struct maap_range *range;
+	u64 candidate;
+	unsigned int i, pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		candidate = pass ? MAC_VALUE(addr_min) : from;
+
+		for (i = maap_range_index_first_overlap(port, candidate); i < port->range_index_count; i++) {
+			range = port->range_index[i];
+
+			if (maap_range_end(range) < candidate)
+				continue;
+
+			/* Enough free addresses before this range */
+			if (maap_range_start(range) > candidate + (count - 1))
+				break;
+
+			candidate = maap_range_end(range) + 1;
+		}
+
+		if (candidate + (count - 1) <= MAC_VALUE(addr_max)) {
+			*start = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /**
  * Generate a random mac address between 91:E0:F0:00:00:00 and 91:E0:F0:00:FD:FF
+ * If the random address overlaps another range of the same port, the next free block of addresses is used instead.
  * \param range, the pointer to the range that need to generate its first MAC address
  * \param count, number of addresses in the range, max 65024
  */
 /* FIXME : Seed should depend of the local mac address */
 static void maap_generate_address(struct maap_range *range, unsigned int count)
 {
+	const u8 addr_min[6] = MAAP_DYNAMIC_POOL_MIN;
+	struct maap_port *port = range->port;
 	u16 rand_bytes;
 	unsigned int max;
+	u64 start;
+	bool indexed;
 
 	if (count > MAAP_DYNAMIC_POOL_SIZE)
 		count = MAAP_DYNAMIC_POOL_SIZE;
@@ -88,12 +249,21 @@ static void maap_generate_address(struct maap_range *range, unsigned int count)
 	max = MAAP_DYNAMIC_POOL_SIZE - count;
 	rand_bytes = random_range(0x0000, max);
 
+	/* The range must not conflict with its own previous address */
+	indexed = maap_range_index_del(port, range);
+
+	if (maap_range_index_find_free(port, MAC_VALUE(addr_min) + rand_bytes, count, &start))
+		rand_bytes = (u16)(start - MAC_VALUE(addr_min));
+
 	range->start_mac_addr[0] = 0x91;
 	range->start_mac_addr[1] = 0xE0;
 	range->start_mac_addr[2] = 0xF0;
 	range->start_mac_addr[3] = 0x00;
 	range->start_mac_addr[4] = (rand_bytes >> 8) & 0xFF;
 	range->start_mac_addr[5] = rand_bytes & 0xFF;
+
+	if (indexed)
+		maap_range_index_add(port, range);
 }
 
 /**
@@ -158,14 +328,18 @@ static bool are_ranges_in_conflict(struct maap_port *port, const u8 *addr_local,
  */
 static bool check_internal_conflict(struct maap_port *port, struct maap_range *new_range)
 {
-	struct list_head *entry, *entry_next;
 	struct maap_range *range;
 	struct maap_range_info range_info;
+	u64 new_end = maap_range_end(new_range);
+	unsigned int i;
 
-	/* Check conflict on each range of this port */
-	for (entry = list_first(&port->range); entry_next = list_next(entry), entry != &port->range; entry = entry_next) {
+	/* Check conflict only on the ranges of this port that may overlap the new one */
+	for (i = maap_range_index_first_overlap(port, maap_range_start(new_range)); i < port->range_index_count; i++) {
 
-		range = container_of(entry, struct maap_range, list);
+		range = port->range_index[i];
+
+		if (maap_range_start(range) > new_end)
+			break;
 
 		if (are_ranges_in_conflict(port, range->start_mac_addr, range->mac_count, new_range->start_mac_addr, new_range->mac_count, &range_info.conflict))
 			return true;
@@ -174,6 +348,42 @@ static bool check_internal_conflict(struct maap_port *port, struct maap_range *n
 	return false;
 }
 
+/**
+ * Get the list of the port ranges overlapping a block of addresses.
+ * The list is linked through maap_range.match_next, so it remains valid even if the state machine moves a range in the index.
+ * \return the first overlapping range, NULL if none
+ * \param port, the port
+ * \param addr, first address of the block
+ * \param count, number of addresses in the block
+ */
+static struct maap_range *maap_range_index_overlap(struct maap_port *port, const u8 *addr, unsigned int count)
+{
+	struct maap_range *range, *first = NULL, **last = &first;
+	u64 start = MAC_VALUE(addr);
+	u64 end = start + (count - 1);
+	unsigned int i;
+
+	if (!count)
+		return NULL;
+
+	for (i = maap_range_index_first_overlap(port, start); i < port->range_index_count; i++) {
+		range = port->range_index[i];
+
+		if (maap_range_start(range) > end)
+			break;
+
+		if (maap_range_end(range) < start)
+			continue;
+
+		*last = range;
+		last = &range->match_next;
+	}
+
+	*last = NULL;
+
+	return first;
+}
+
 /**
  * Get the range accroding to its id
  * \return the range with this id, NULL if the id is not used
@@ -591,8 +801,7 @@ unsigned int maap_port_to_logical(struct maap_ctx *maap, unsigned int port_id)
 static void maap_handle_probe(struct maap_port *port, struct maap_pdu *pdu, struct net_rx_desc *desc)
 {
 	struct eth_hdr *eth = (struct eth_hdr *)((u8 *)desc + desc->l2_offset);
-	struct maap_range *range;
-	struct list_head *entry, *entry_next;
+	struct maap_range *range, *next;
 	struct maap_range_info range_info;
 	u16 requested_count;
 
@@ -603,10 +812,10 @@ static void maap_handle_probe(struct maap_port *port, struct maap_pdu *pdu, stru
 				pdu->requested_start_address[2], pdu->requested_start_address[3], pdu->requested_start_address[4],
 				pdu->requested_start_address[5], requested_count);
 
-	/* Check conflict on each range of this port */
-	for (entry = list_first(&port->range); entry_next = list_next(entry), entry != &port->range; entry = entry_next) {
+	/* Check conflict only on the ranges of this port overlapping the requested addresses */
+	for (range = maap_range_index_overlap(port, pdu->requested_start_address, requested_count); range; range = next) {
 
-		range = container_of(entry, struct maap_range, list);
+		next = range->match_next;
 
 		/* Only receive packets that conflict with the range's addresses */
 		if (!are_ranges_in_conflict(port, range->start_mac_addr, range->mac_count, pdu->requested_start_address, requested_count, &range_info.conflict))
@@ -633,8 +842,7 @@ static void maap_handle_probe(struct maap_port *port, struct maap_pdu *pdu, stru
 static void maap_handle_announce(struct maap_port *port, struct maap_pdu *pdu, struct net_rx_desc *desc)
 {
 	struct eth_hdr *eth = (struct eth_hdr *)((u8 *)desc + desc->l2_offset);
-	struct maap_range *range;
-	struct list_head *entry, *entry_next;
+	struct maap_range *range, *next;
 	struct maap_range_info range_info;
 	u16 requested_count;
 
@@ -645,9 +853,9 @@ static void maap_handle_announce(struct maap_port *port, struct maap_pdu *pdu, s
 				pdu->requested_start_address[2], pdu->requested_start_address[3], pdu->requested_start_address[4],
 				pdu->requested_start_address[5], requested_count);
 
-	for (entry = list_first(&port->range); entry_next = list_next(entry), entry != &port->range; entry = entry_next) {
+	for (range = maap_range_index_overlap(port, pdu->requested_start_address, requested_count); range; range = next) {
 
-		range = container_of(entry, struct maap_range, list);
+		next = range->match_next;
 
 		/* Only receive packets that conflict with the range's address range */
 		if (!are_ranges_in_conflict(port, range->start_mac_addr, range->mac_count, pdu->requested_start_address, requested_count, &range_info.conflict))
@@ -676,16 +884,15 @@ static void maap_handle_announce(struct maap_port *port, struct maap_pdu *pdu, s
 static void maap_handle_defend(struct maap_port *port, struct maap_pdu *pdu, struct net_rx_desc *desc)
 {
 	struct eth_hdr *eth = (struct eth_hdr *)((u8 *)desc + desc->l2_offset);
-	struct maap_range *range;
-	struct list_head *entry, *entry_next;
+	struct maap_range *range, *next;
 	struct maap_range_info range_info;
 	u16 requested_count;
 
 	requested_count = ntohs(pdu->requested_count);
 
-	for (entry = list_first(&port->range); entry_next = list_next(entry), entry != &port->range; entry = entry_next) {
+	for (range = maap_range_index_overlap(port, pdu->requested_start_address, requested_count); range; range = next) {
 
-		range = container_of(entry, struct maap_range, list);
+		next = range->match_next;
 
 		/* Retrieve the range that sent the PROBE that triggered this DEFEND respond */
 		if ((os_memcmp(range->start_mac_addr, pdu->requested_start_address, sizeof(u8) * 6) == 0) && (range->mac_count == requested_count)) {
@@ -1190,6 +1397,9 @@ static struct maap_range *maap_range_alloc(struct maap_ctx *maap, struct maap_po
 	if (!range)
 		goto err_alloc;
 
+	/* Zero the range, so that it is never found in the port range index before being added to it */
+	os_memset(range, 0, sizeof(struct maap_range));
+
 	list_head_init(&range->list);
 
 	/* Keep port information where the range is allocated */
@@ -1283,6 +1493,8 @@ __init static int maap_ports_init(struct maap_ctx *maap, struct maap_config *cfg
 		maap->port[i].logical_port = logical_port;
 		maap->port[i].initialized = false;
 		maap->port[i].allocated_ranges_count = 0;
+		maap->port[i].range_index_count = 0;
+		maap->port[i].range_index_max_mac_count = 0;
 
 		addr.ptype = PTYPE_AVTP;
 		addr.port = logical_port;
@@ -1463,6 +1675,7 @@ struct maap_range *maap_new_range_on_port(struct maap_ctx *maap, struct maap_por
 
 	/* Add range to the linked list of MAC address range of the port */
 	list_add(&port->range, &range->list);
+	maap_range_index_add(port, range);
 
 	/* Start the range's state machine */
 	maap_sm(range, port, MAAP_EVENT_BEGIN, NULL);
@@ -1497,6 +1710,7 @@ int maap_remove_all_range_on_port(struct maap_ctx *maap, struct maap_port *port)
 		range = container_of(entry, struct maap_range, list);
 
 		list_del(entry);
+		maap_range_index_del(port, range);
 		maap_range_free(range);
 	}
 
@@ -1528,6 +1742,7 @@ int maap_remove_range_on_port(struct maap_ctx *maap, struct maap_port *port, u32
 			*count = range->mac_count;
 
 			list_del(entry);
+			maap_range_index_del(port, range);
 			maap_range_free(range);
 
 			os_log(LOG_INFO, "maap(%p) success range(%02x:%02x:%02x:%02x:%02x:%02x, %u) on port(%u) freed\n", maap,
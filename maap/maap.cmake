@@ -10,3 +10,9 @@ if(CONFIG_MAAP)
   genavb_link_libraries(TARGET ${avb} LIB maap)
 
 endif()
+
+if(BUILD_TESTS)
+
+  include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+
+endif()
@@ -35,7 +35,7 @@
 #define MAAP_RESERVED_POOL_MAX {0x91, 0xE0, 0xF0, 0x00, 0xFF, 0xFF}
 
 #define MAAP_DYNAMIC_POOL_SIZE (0xFDFF - 0x0000 + 1)
-#define MAAP_PORT_MAX_RANGES_ALLOCATION 128
+#define MAAP_PORT_MAX_RANGES_ALLOCATION CFG_MAAP_PORT_MAX_RANGES
 
 /**
  * MAAP probe constant values from IEEE Std 1722-2016, Table B.8
@@ -183,6 +183,9 @@ struct maap_range {
 	/* Start MAC address */
 	u8 start_mac_addr[6];
 
+	/* Next range matching a received PDU, only valid while handling that PDU */
+	struct maap_range *match_next;
+
 	/* MAAP state machine per range, 1..1 */
 	struct maap_sm sm;
 };
@@ -207,6 +210,11 @@ struct maap_port {
 
 	/* MAC address range, 0..n */
 	struct list_head range;
+
+	/* Ranges of the port sorted by start address, used for overlap queries */
+	struct maap_range *range_index[MAAP_PORT_MAX_RANGES_ALLOCATION];
+	unsigned int range_index_count;
+	unsigned int range_index_max_mac_count; /* Upper bound of mac_count over the indexed ranges */
 };
 
 /**
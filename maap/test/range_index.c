@@ -0,0 +1,368 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief MAAP port range index test
+ @details
+ The MAAP stack sources are included, so that the static range index functions can be tested directly.
+ Ranges of random sizes (possibly overlapping each other) are randomly added to and removed from the index of a
+ port, and after each change random queries are checked against a linear scan of all the ranges:
+ - maap_range_index_overlap() must return exactly the ranges overlapping the queried block, each once.
+ - maap_range_index_find_free() must return the first free block of the dynamic pool at or after the queried
+   address, wrapping around to the start of the pool.
+ - the index must stay sorted by start address, with an exact range size upper bound.
+ With -b, 1000 ranges are indexed and the overlap query cost is compared to a linear scan of the port range list.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "maap/maap.c"
+
+#define TEST_MAX_RANGES		MAAP_PORT_MAX_RANGES_ALLOCATION
+#define TEST_STEPS		20000
+#define TEST_QUERIES		8
+#define TEST_BENCH_RANGES	1000
+#define TEST_BENCH_QUERIES	(1000 * 1000)
+
+static struct maap_port port;
+static struct maap_range ranges[TEST_MAX_RANGES];
+static bool live[TEST_MAX_RANGES];
+static unsigned int live_n;
+static bool matched[TEST_MAX_RANGES];
+
+static unsigned int seed = 1;
+
+static u64 test_pool_min(void)
+{
+	const u8 addr_min[6] = MAAP_DYNAMIC_POOL_MIN;
+
+	return MAC_VALUE(addr_min);
+}
+
+static u64 test_pool_max(void)
+{
+	const u8 addr_max[6] = MAAP_DYNAMIC_POOL_MAX;
+
+	return MAC_VALUE(addr_max);
+}
+
+/* Address at a given offset in the dynamic pool */
+static void test_addr_set(u8 *addr, unsigned int offset)
+{
+	addr[0] = 0x91;
+	addr[1] = 0xE0;
+	addr[2] = 0xF0;
+	addr[3] = 0x00;
+	addr[4] = (offset >> 8) & 0xFF;
+	addr[5] = offset & 0xFF;
+}
+
+static void test_range_set(struct maap_range *range, unsigned int offset, unsigned int count)
+{
+	test_addr_set(range->start_mac_addr, offset);
+	range->mac_count = count;
+	range->port = &port;
+}
+
+/* Mostly small ranges, with a few large ones to exercise the size upper bound */
+static unsigned int test_random_count(unsigned int max)
+{
+	unsigned int r = rand_r(&seed) % 100;
+
+	if (r < 70)
+		return 1 + rand_r(&seed) % 16;
+	else if (r < 95)
+		return 1 + rand_r(&seed) % 256;
+	else
+		return 1 + rand_r(&seed) % max;
+}
+
+static void test_range_add(unsigned int i, unsigned int max_count)
+{
+	unsigned int count = test_random_count(max_count);
+	unsigned int offset = rand_r(&seed) % (MAAP_DYNAMIC_POOL_SIZE - count + 1);
+
+	test_range_set(&ranges[i], offset, count);
+
+	maap_range_index_add(&port, &ranges[i]);
+	live[i] = true;
+	live_n++;
+}
+
+static int test_range_del(unsigned int i)
+{
+	live[i] = false;
+	live_n--;
+
+	if (!maap_range_index_del(&port, &ranges[i])) {
+		printf("range %u not found in the index\n", i);
+		return -1;
+	}
+
+	return 0;
+}
+
+static bool test_overlap(struct maap_range *range, u64 start, u64 end)
+{
+	return (maap_range_start(range) <= end) && (maap_range_end(range) >= start);
+}
+
+static int test_check_index(void)
+{
+	unsigned int i, max = 0;
+
+	if (port.range_index_count != live_n) {
+		printf("index count %u, expected %u\n", port.range_index_count, live_n);
+		return -1;
+	}
+
+	for (i = 0; i < port.range_index_count; i++) {
+		if (i && (maap_range_start(port.range_index[i]) < maap_range_start(port.range_index[i - 1]))) {
+			printf("index not sorted at %u\n", i);
+			return -1;
+		}
+
+		if (port.range_index[i]->mac_count > max)
+			max = port.range_index[i]->mac_count;
+	}
+
+	if (port.range_index_max_mac_count != max) {
+		printf("index max mac count %u, expected %u\n", port.range_index_max_mac_count, max);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_check_overlap(unsigned int offset, unsigned int count)
+{
+	struct maap_range *range;
+	u8 addr[6];
+	u64 start, end;
+	unsigned int i, n = 0, expected = 0;
+
+	test_addr_set(addr, offset);
+
+	start = MAC_VALUE(addr);
+	end = start + count - 1;
+
+	memset(matched, 0, sizeof(matched));
+
+	for (range = maap_range_index_overlap(&port, addr, count); range; range = range->match_next) {
+		i = range - ranges;
+
+		if (!live[i] || matched[i] || !test_overlap(range, start, end)) {
+			printf("overlap(%u, %u): unexpected range %u (live %u, matched %u)\n", offset, count, i, live[i], matched[i]);
+			return -1;
+		}
+
+		matched[i] = true;
+		n++;
+	}
+
+	for (i = 0; i < TEST_MAX_RANGES; i++)
+		if (live[i] && test_overlap(&ranges[i], start, end))
+			expected++;
+
+	if (n != expected) {
+		printf("overlap(%u, %u): %u ranges, expected %u\n", offset, count, n, expected);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Linear reference of maap_range_index_find_free() */
+static bool test_find_free(u64 from, unsigned int count, u64 *start)
+{
+	u64 candidate;
+	unsigned int i, pass;
+	bool moved;
+
+	for (pass = 0; pass < 2; pass++) {
+		candidate = pass ? test_pool_min() : from;
+
+		do {
+			moved = false;
+
+			for (i = 0; i < TEST_MAX_RANGES; i++)
+				if (live[i] && test_overlap(&ranges[i], candidate, candidate + count - 1)) {
+					candidate = maap_range_end(&ranges[i]) + 1;
+					moved = true;
+				}
+		} while (moved);
+
+		if (candidate + count - 1 <= test_pool_max()) {
+			*start = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int test_check_find_free(unsigned int offset, unsigned int count)
+{
+	u64 from = test_pool_min() + offset;
+	u64 start = 0, expected = 0;
+	bool found, expected_found;
+
+	found = maap_range_index_find_free(&port, from, count, &start);
+	expected_found = test_find_free(from, count, &expected);
+
+	if ((found != expected_found) || (found && (start != expected))) {
+		printf("find_free(%u, %u): found %u start %llx, expected %u start %llx\n", offset, count,
+			found, (unsigned long long)start, expected_found, (unsigned long long)expected);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int test_random(unsigned int target, unsigned int max_count)
+{
+	unsigned int step, q, i;
+
+	memset(&port, 0, sizeof(port));
+	memset(live, 0, sizeof(live));
+	live_n = 0;
+
+	for (step = 0; step < TEST_STEPS; step++) {
+		/* Remove a random range, or add one if the index holds less than target ranges */
+		i = rand_r(&seed) % TEST_MAX_RANGES;
+
+		if (live[i]) {
+			if (test_range_del(i) < 0)
+				return -1;
+		} else if (live_n < target) {
+			test_range_add(i, max_count);
+		}
+
+		if (test_check_index() < 0)
+			return -1;
+
+		for (q = 0; q < TEST_QUERIES; q++) {
+			unsigned int count = test_random_count(max_count);
+
+			if (test_check_overlap(rand_r(&seed) % MAAP_DYNAMIC_POOL_SIZE, count) < 0)
+				return -1;
+
+			if (test_check_find_free(rand_r(&seed) % MAAP_DYNAMIC_POOL_SIZE, count) < 0)
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+static double test_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void test_bench(void)
+{
+	static u8 addr[TEST_BENCH_QUERIES][6];
+	static u16 count[TEST_BENCH_QUERIES];
+	struct list_head *entry;
+	struct maap_range *range;
+	volatile unsigned int sink = 0;
+	unsigned int i;
+	double start, indexed, linear;
+
+	memset(&port, 0, sizeof(port));
+	list_head_init(&port.range);
+
+	for (i = 0; i < TEST_BENCH_RANGES; i++) {
+		test_range_set(&ranges[i], rand_r(&seed) % (MAAP_DYNAMIC_POOL_SIZE - 64), 1 + rand_r(&seed) % 64);
+		list_add(&port.range, &ranges[i].list);
+		maap_range_index_add(&port, &ranges[i]);
+	}
+
+	for (i = 0; i < TEST_BENCH_QUERIES; i++) {
+		unsigned int offset = rand_r(&seed) % (MAAP_DYNAMIC_POOL_SIZE - 16);
+
+		test_addr_set(addr[i], offset);
+		count[i] = 1 + rand_r(&seed) % 16;
+	}
+
+	start = test_time();
+
+	for (i = 0; i < TEST_BENCH_QUERIES; i++)
+		for (range = maap_range_index_overlap(&port, addr[i], count[i]); range; range = range->match_next)
+			sink++;
+
+	indexed = test_time() - start;
+
+	start = test_time();
+
+	/* The overlap check done on every range of the port before the index */
+	for (i = 0; i < TEST_BENCH_QUERIES; i++) {
+		u64 qstart = MAC_VALUE(addr[i]);
+
+		for (entry = list_first(&port.range); entry != &port.range; entry = list_next(entry)) {
+			range = container_of(entry, struct maap_range, list);
+
+			if (test_overlap(range, qstart, qstart + count[i] - 1))
+				sink++;
+		}
+	}
+
+	linear = test_time() - start;
+
+	printf("%u ranges, overlap query: index %.1f ns, linear scan %.1f ns (%.1fx)\n", TEST_BENCH_RANGES,
+		indexed * 1e9 / TEST_BENCH_QUERIES, linear * 1e9 / TEST_BENCH_QUERIES, linear / indexed);
+
+	(void)sink;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int bench = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b")) != -1) {
+		switch (opt) {
+		case 'b':
+			bench = 1;
+			break;
+
+		default:
+			printf("Usage: %s [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	/* Sparse small ranges, then a dense index with large ranges (the whole dynamic pool may be used) */
+	if (test_random(64, 1024) < 0)
+		goto fail;
+
+	if (test_random(TEST_MAX_RANGES, 8192) < 0)
+		goto fail;
+
+	if (bench)
+		test_bench();
+
+	printf("PASS\n");
+
+	return 0;
+
+fail:
+	printf("FAIL\n");
+
+	return 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ @file
+ @brief maap unit tests, stubbed stack services
+ @details
+ The tests only exercise the range index of a port, the network, ipc and timer services of the MAAP stack are
+ never called.
+*/
+
+#include "common/ipc.h"
+#include "common/timer.h"
+
+#include "os/net.h"
+
+int ipc_rx_init(struct ipc_rx *rx, ipc_id_t id, void (*func)(struct ipc_rx const *, struct ipc_desc *), unsigned long priv)
+{
+	return -1;
+}
+
+void ipc_rx_exit(struct ipc_rx *rx)
+{
+}
+
+int ipc_tx_init(struct ipc_tx *tx, ipc_id_t id)
+{
+	return -1;
+}
+
+void ipc_tx_exit(struct ipc_tx *tx)
+{
+}
+
+int ipc_tx_connect(struct ipc_tx *tx, struct ipc_rx *rx)
+{
+	return -1;
+}
+
+struct ipc_desc *ipc_alloc(struct ipc_tx const *tx, unsigned int size)
+{
+	return NULL;
+}
+
+void ipc_free(void const *ipc, struct ipc_desc *desc)
+{
+}
+
+int ipc_tx(struct ipc_tx const *tx, struct ipc_desc *desc)
+{
+	return -1;
+}
+
+int net_rx_init(struct net_rx *rx, struct net_address *addr, void (*func)(struct net_rx *, struct net_rx_desc *), unsigned long priv)
+{
+	return -1;
+}
+
+void net_rx_exit(struct net_rx *rx)
+{
+}
+
+void net_rx_free(struct net_rx_desc *buf)
+{
+}
+
+int net_tx_init(struct net_tx *tx, struct net_address *addr)
+{
+	return -1;
+}
+
+void net_tx_exit(struct net_tx *tx)
+{
+}
+
+struct net_tx_desc *net_tx_alloc(struct net_tx *tx, unsigned int size)
+{
+	return NULL;
+}
+
+int net_tx(struct net_tx *tx, struct net_tx_desc *desc)
+{
+	return -1;
+}
+
+void net_tx_free(struct net_tx_desc *buf)
+{
+}
+
+int net_get_local_addr(unsigned int port_id, unsigned char *addr)
+{
+	return -1;
+}
+
+int net_add_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+int net_del_multi(struct net_rx *rx, unsigned int port_id, const unsigned char *hw_addr)
+{
+	return -1;
+}
+
+unsigned int timer_pool_size(unsigned int n)
+{
+	return 0;
+}
+
+int timer_pool_init(struct timer_ctx *tctx, unsigned int n, unsigned long priv)
+{
+	return -1;
+}
+
+void timer_pool_exit(struct timer_ctx *tctx)
+{
+}
+
+int timer_init(struct timer_ctx *tctx, struct timer *t, unsigned int flags, unsigned int ms)
+{
+	return -1;
+}
+
+int timer_destroy(struct timer *t)
+{
+	return -1;
+}
+
+int timer_start(struct timer *t, unsigned int ms)
+{
+	return -1;
+}
+
+void timer_stop(struct timer *t)
+{
+}
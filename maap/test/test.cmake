@@ -0,0 +1,4 @@
+# maap unit tests, the test includes the maap sources to reach the static range index functions (see stubs.c for
+# the stack services). The index is sized for the 1000 ranges benchmark.
+genavb_add_test(NAME maap-range-index COMPONENT maap SRCS range_index.c stubs.c LIBS common)
+target_compile_definitions(maap-range-index PRIVATE CFG_MAAP_PORT_MAX_RANGES=1024)
@@ -174,6 +174,30 @@ int net_tx_ts_get(struct net_tx *tx, uint64_t *ts, unsigned int *private);
  */
 void net_tx_ts_process(struct net_tx *tx);
 
+/** Network transmit launch time errors
+ *
+ * Frames transmitted with a launch time (NET_TX_FLAGS_TS64) are dropped by the network stack if the launch time
+ * is missed or invalid, and reported asynchronously. The function drains the pending reports, so it should be called
+ * periodically or on transmit error events, not after each transmit.
+ *
+ * \return	none
+ * \param tx		pointer to network transmit context
+ * \param missed	pointer to number of frames dropped because their launch time was missed, since the last call
+ * \param invalid	pointer to number of frames dropped because of an invalid launch time, since the last call
+ */
+void net_tx_launch_errors(struct net_tx *tx, unsigned int *missed, unsigned int *invalid);
+
+/** Enables transmit timestamps on a network transmit context
+ *
+ * Frames transmitted with NET_TX_FLAGS_HW_TS on a context created by net_tx_init() are timestamped by the network
+ * adapter. The timestamps (in gPTP time) are read back with net_tx_ts_get(), the private data being the first 32 bits
+ * (in host order) following the Ethernet header (and VLAN tag) of the timestamped frame.
+ *
+ * \return	0 on success, -1 on error or if not supported
+ * \param tx	pointer to network transmit context
+ */
+int net_tx_ts_enable(struct net_tx *tx);
+
 /** Multicast address add
  *
  * This function programs the network device associated to the net_rx context
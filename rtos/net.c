@@ -555,6 +555,19 @@ int net_tx_event_disable(struct net_tx *tx)
 	return 0;
 }
 
+void net_tx_launch_errors(struct net_tx *tx, unsigned int *missed, unsigned int *invalid)
+{
+	/* Launch time errors are not reported by the network stack */
+	*missed = 0;
+	*invalid = 0;
+}
+
+int net_tx_ts_enable(struct net_tx *tx)
+{
+	/* Transmit timestamps are only returned on the PTP socket */
+	return -1;
+}
+
 unsigned int net_tx_available(struct net_tx *tx)
 {
 	os_log(LOG_INFO, "tx(%p)\n", tx);
@@ -39,4 +39,8 @@
 #define MAAP_CFG_PRIORITY		(GPTP_CFG_PRIORITY)
 #define HSR_CFG_PRIORITY		(GPTP_CFG_PRIORITY)
 
+/* Statistics histograms limited to +/-16.7ms with 1/4 precision (184 buckets instead of 480) */
+#define HIST_CFG_SUB_BITS		2
+#define HIST_CFG_MAX_BITS		24
+
 #endif /* _RTOS_OSAL_CFG_H_ */
@@ -25,6 +25,7 @@
 #include "common/log.h"
 
 #include "linux/tsn.h"
+#include "linux/rtnetlink.h"
 
 #include "os/config.h"
 #include "os/sys_types.h"
@@ -134,6 +135,9 @@ void *srp_thread_main(void *arg)
 				}
 			}
 		}
+
+		/* Send the FDB and CBS updates triggered by these events in a single rtnetlink batch */
+		rtnetlink_flush();
 	}
 
 	pthread_cleanup_pop(1);